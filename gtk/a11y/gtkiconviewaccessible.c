@@ -232,7 +232,7 @@ get_pixbuf_box (GtkIconView     *icon_view,
   GetPixbufBoxData data = { { 0, }, FALSE };
   GtkCellAreaContext *context;
 
-  context = g_ptr_array_index (icon_view->priv->row_contexts, item->row);
+  context = _gtk_icon_view_get_row_context (icon_view, item);
 
   _gtk_icon_view_set_cell_data (icon_view, item);
   gtk_cell_area_foreach_alloc (icon_view->priv->cell_area, context,
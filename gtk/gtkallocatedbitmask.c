@@ -318,6 +318,108 @@ _gtk_allocated_bitmask_invert_range (GtkBitmask *mask,
   return gtk_allocated_bitmask_shrink (mask);
 }
 
+GtkBitmask *
+_gtk_allocated_bitmask_shift_left (GtkBitmask *mask,
+                                   guint       amount)
+{
+  guint shift_word, shift_bit;
+  gsize i, old_len;
+
+  gtk_internal_return_val_if_fail (mask != NULL, NULL);
+
+  mask = gtk_bitmask_ensure_allocated (mask);
+  if (mask->len == 0 || amount == 0)
+    return gtk_allocated_bitmask_shrink (mask);
+
+  gtk_allocated_bitmask_indexes (amount, &shift_word, &shift_bit);
+
+  old_len = mask->len;
+  mask = gtk_allocated_bitmask_resize (mask, old_len + shift_word + 1);
+
+  /* Go backwards so we only read words we haven't overwritten yet */
+  for (i = mask->len; i-- > shift_word; )
+    {
+      gsize src = i - shift_word;
+      VALUE_TYPE value = 0;
+
+      if (src < old_len)
+        value = mask->data[src] << shift_bit;
+      if (shift_bit != 0 && src > 0 && src - 1 < old_len)
+        value |= mask->data[src - 1] >> (VALUE_SIZE_BITS - shift_bit);
+
+      mask->data[i] = value;
+    }
+  for (i = 0; i < shift_word; i++)
+    mask->data[i] = 0;
+
+  return gtk_allocated_bitmask_shrink (mask);
+}
+
+GtkBitmask *
+_gtk_allocated_bitmask_shift_right (GtkBitmask *mask,
+                                    guint       amount)
+{
+  guint shift_word, shift_bit;
+  gsize i;
+
+  gtk_internal_return_val_if_fail (mask != NULL, NULL);
+
+  mask = gtk_bitmask_ensure_allocated (mask);
+
+  gtk_allocated_bitmask_indexes (amount, &shift_word, &shift_bit);
+
+  for (i = 0; i < mask->len; i++)
+    {
+      gsize src = i + shift_word;
+      VALUE_TYPE value = 0;
+
+      if (src < mask->len)
+        value = mask->data[src] >> shift_bit;
+      if (shift_bit != 0 && src + 1 < mask->len)
+        value |= mask->data[src + 1] << (VALUE_SIZE_BITS - shift_bit);
+
+      mask->data[i] = value;
+    }
+
+  return gtk_allocated_bitmask_shrink (mask);
+}
+
+gboolean
+_gtk_allocated_bitmask_next_set (const GtkBitmask *mask,
+                                 guint             start,
+                                 guint            *index_)
+{
+  GtkBitmask mask_allocated;
+  guint array_index, bit_index;
+  VALUE_TYPE value;
+
+  gtk_internal_return_val_if_fail (mask != NULL, FALSE);
+  gtk_internal_return_val_if_fail (index_ != NULL, FALSE);
+
+  ENSURE_ALLOCATED (mask, mask_allocated);
+  gtk_allocated_bitmask_indexes (start, &array_index, &bit_index);
+
+  if (array_index >= mask->len)
+    return FALSE;
+
+  /* skip empty words, then find the bit in the first one that is not */
+  value = mask->data[array_index] & (ALL_BITS << bit_index);
+  while (value == 0)
+    {
+      array_index++;
+      if (array_index >= mask->len)
+        return FALSE;
+      value = mask->data[array_index];
+    }
+
+  for (bit_index = 0; !(value & VALUE_BIT (bit_index)); bit_index++)
+    ;
+
+  *index_ = array_index * VALUE_SIZE_BITS + bit_index;
+
+  return TRUE;
+}
+
 gboolean
 _gtk_allocated_bitmask_equals (const GtkBitmask  *mask,
                                const GtkBitmask  *other)
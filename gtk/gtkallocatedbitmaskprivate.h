@@ -61,6 +61,14 @@ GtkBitmask *   _gtk_allocated_bitmask_set               (GtkBitmask        *mask
 GtkBitmask *   _gtk_allocated_bitmask_invert_range      (GtkBitmask        *mask,
                                                          guint              start,
                                                          guint              end) G_GNUC_WARN_UNUSED_RESULT;
+GtkBitmask *   _gtk_allocated_bitmask_shift_left        (GtkBitmask        *mask,
+                                                         guint              amount) G_GNUC_WARN_UNUSED_RESULT;
+GtkBitmask *   _gtk_allocated_bitmask_shift_right       (GtkBitmask        *mask,
+                                                         guint              amount) G_GNUC_WARN_UNUSED_RESULT;
+
+gboolean       _gtk_allocated_bitmask_next_set          (const GtkBitmask  *mask,
+                                                         guint              start,
+                                                         guint             *index_);
 
 gboolean       _gtk_allocated_bitmask_equals            (const GtkBitmask  *mask,
                                                          const GtkBitmask  *other);
@@ -49,6 +49,14 @@ static inline GtkBitmask *      _gtk_bitmask_set                  (GtkBitmask
 static inline GtkBitmask *      _gtk_bitmask_invert_range         (GtkBitmask        *mask,
                                                                    guint              start,
                                                                    guint              end) G_GNUC_WARN_UNUSED_RESULT;
+static inline GtkBitmask *      _gtk_bitmask_shift_left           (GtkBitmask        *mask,
+                                                                   guint              amount) G_GNUC_WARN_UNUSED_RESULT;
+static inline GtkBitmask *      _gtk_bitmask_shift_right          (GtkBitmask        *mask,
+                                                                   guint              amount) G_GNUC_WARN_UNUSED_RESULT;
+
+static inline gboolean          _gtk_bitmask_next_set             (const GtkBitmask  *mask,
+                                                                   guint              start,
+                                                                   guint             *index_);
 
 static inline gboolean          _gtk_bitmask_is_empty             (const GtkBitmask  *mask);
 static inline gboolean          _gtk_bitmask_equals               (const GtkBitmask  *mask,
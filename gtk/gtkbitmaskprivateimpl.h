@@ -135,6 +135,58 @@ _gtk_bitmask_invert_range (GtkBitmask *mask,
     }
 }
 
+static inline GtkBitmask *
+_gtk_bitmask_shift_left (GtkBitmask *mask,
+                         guint       amount)
+{
+  if (_gtk_bitmask_is_allocated (mask) ||
+      (amount >= GTK_BITMASK_N_DIRECT_BITS) ||
+      (_gtk_bitmask_to_bits (mask) >> (GTK_BITMASK_N_DIRECT_BITS - amount)) != 0)
+    return _gtk_allocated_bitmask_shift_left (mask, amount);
+  else
+    return _gtk_bitmask_from_bits (_gtk_bitmask_to_bits (mask) << amount);
+}
+
+static inline GtkBitmask *
+_gtk_bitmask_shift_right (GtkBitmask *mask,
+                          guint       amount)
+{
+  if (_gtk_bitmask_is_allocated (mask))
+    return _gtk_allocated_bitmask_shift_right (mask, amount);
+  else if (amount >= GTK_BITMASK_N_DIRECT_BITS)
+    return _gtk_bitmask_new ();
+  else
+    return _gtk_bitmask_from_bits (_gtk_bitmask_to_bits (mask) >> amount);
+}
+
+/* Finds the first set bit at @start or after it, so loops over the set
+ * bits of a sparse mask do not test every index:
+ *
+ *   for (i = 0; _gtk_bitmask_next_set (mask, i, &i); i++)
+ */
+static inline gboolean
+_gtk_bitmask_next_set (const GtkBitmask *mask,
+                       guint             start,
+                       guint            *index_)
+{
+  gsize bits;
+
+  if (_gtk_bitmask_is_allocated (mask))
+    return _gtk_allocated_bitmask_next_set (mask, start, index_);
+
+  if (start >= GTK_BITMASK_N_DIRECT_BITS)
+    return FALSE;
+
+  bits = _gtk_bitmask_to_bits (mask) >> start;
+  if (bits == 0)
+    return FALSE;
+
+  for (*index_ = start; !(bits & 1); bits >>= 1)
+    (*index_)++;
+
+  return TRUE;
+}
+
 static inline gboolean
 _gtk_bitmask_is_empty (const GtkBitmask *mask)
 {
@@ -349,6 +349,7 @@
 #include "gtkcelllayout.h"
 #include "gtkcellarea.h"
 #include "gtkcellareacontext.h"
+#include "gtkcellrenderertextprivate.h"
 #include "gtkmarshalers.h"
 #include "gtkprivate.h"
 #include "gtkrender.h"
@@ -577,13 +578,30 @@ struct _GtkCellAreaPrivate
 
   /* Tracking which cells are focus siblings of focusable cells */
   GHashTable      *focus_siblings;
+
+  /* Requests of identical cells, see gtk_cell_area_set_cache_sizes() */
+  GHashTable      *size_cache;
+  GtkWidget       *size_cache_widget;
+  guint            size_cache_serial;
 };
 
+typedef struct
+{
+  gint minimum_size;
+  gint natural_size;
+} CachedSize;
+
+/* Columns of mostly distinct strings don't profit from the cache,
+ * start over rather than letting it grow with the model.
+ */
+#define SIZE_CACHE_MAX_ENTRIES 1024
+
 enum {
   PROP_0,
   PROP_FOCUS_CELL,
   PROP_EDITED_CELL,
-  PROP_EDIT_WIDGET
+  PROP_EDIT_WIDGET,
+  PROP_CACHE_SIZES
 };
 
 enum {
@@ -830,11 +848,77 @@ gtk_cell_area_class_init (GtkCellAreaClass *class)
                                     GTK_TYPE_CELL_EDITABLE,
                                     G_PARAM_READABLE));
 
+  /**
+   * GtkCellArea:cache-sizes:
+   *
+   * Whether size requests of identical text cells are reused.
+   * See gtk_cell_area_set_cache_sizes().
+   *
+   * Since: 3.90
+   */
+  g_object_class_install_property (object_class,
+                                   PROP_CACHE_SIZES,
+                                   g_param_spec_boolean
+                                   ("cache-sizes",
+                                    P_("Cache Sizes"),
+                                    P_("Whether size requests of identical cells are reused"),
+                                    FALSE,
+                                    GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY));
+
   /* Pool for Cell Properties */
   if (!cell_property_pool)
     cell_property_pool = g_param_spec_pool_new (FALSE);
 }
 
+/*************************************************************
+ *                      Size cache                           *
+ *************************************************************/
+static void
+cached_size_free (gpointer data)
+{
+  g_slice_free (CachedSize, data);
+}
+
+/* Returns the key for the request, or %NULL if it can't be cached.
+ * The cache is dropped if the fonts of @widget might have changed.
+ */
+static gchar *
+gtk_cell_area_get_size_cache_key (GtkCellArea     *area,
+                                  GtkCellRenderer *renderer,
+                                  GtkOrientation   orientation,
+                                  GtkWidget       *widget,
+                                  gint             for_size)
+{
+  GtkCellAreaPrivate *priv = area->priv;
+  PangoContext *pango_context;
+  GString *key;
+
+  if (!GTK_IS_CELL_RENDERER_TEXT (renderer))
+    return NULL;
+
+  pango_context = gtk_widget_get_pango_context (widget);
+
+  if (priv->size_cache_widget != widget ||
+      priv->size_cache_serial != pango_context_get_serial (pango_context) ||
+      g_hash_table_size (priv->size_cache) >= SIZE_CACHE_MAX_ENTRIES)
+    {
+      g_hash_table_remove_all (priv->size_cache);
+      priv->size_cache_widget = widget;
+      priv->size_cache_serial = pango_context_get_serial (pango_context);
+    }
+
+  key = g_string_new (NULL);
+  g_string_append_printf (key, "%p %d %d ", renderer, orientation, for_size);
+
+  if (!_gtk_cell_renderer_text_append_size_key (GTK_CELL_RENDERER_TEXT (renderer), widget, key))
+    {
+      g_string_free (key, TRUE);
+      return NULL;
+    }
+
+  return g_string_free (key, FALSE);
+}
+
 /*************************************************************
  *                    CellInfo Basics                        *
  *************************************************************/
@@ -917,6 +1001,8 @@ gtk_cell_area_finalize (GObject *object)
    */
   g_hash_table_destroy (priv->cell_info);
   g_hash_table_destroy (priv->focus_siblings);
+  if (priv->size_cache)
+    g_hash_table_destroy (priv->size_cache);
 
   g_free (priv->current_path);
 
@@ -954,6 +1040,9 @@ gtk_cell_area_set_property (GObject       *object,
     case PROP_FOCUS_CELL:
       gtk_cell_area_set_focus_cell (area, (GtkCellRenderer *)g_value_get_object (value));
       break;
+    case PROP_CACHE_SIZES:
+      gtk_cell_area_set_cache_sizes (area, g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -980,6 +1069,9 @@ gtk_cell_area_get_property (GObject     *object,
     case PROP_EDIT_WIDGET:
       g_value_set_object (value, priv->edit_widget);
       break;
+    case PROP_CACHE_SIZES:
+      g_value_set_boolean (value, priv->size_cache != NULL);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1649,6 +1741,10 @@ gtk_cell_area_remove (GtkCellArea        *area,
   /* Remove any custom attributes and custom cell data func here first */
   g_hash_table_remove (priv->cell_info, renderer);
 
+  /* Cached sizes are keyed by renderer */
+  if (priv->size_cache)
+    g_hash_table_remove_all (priv->size_cache);
+
   /* Remove focus siblings of this renderer */
   g_hash_table_remove (priv->focus_siblings, renderer);
 
@@ -3597,6 +3693,9 @@ gtk_cell_area_request_renderer (GtkCellArea        *area,
 {
   GtkBorder border;
   GtkStyleContext *context;
+  CachedSize *cached = NULL;
+  gchar *key = NULL;
+  gint padding;
 
   g_return_if_fail (GTK_IS_CELL_AREA (area));
   g_return_if_fail (GTK_IS_CELL_RENDERER (renderer));
@@ -3608,35 +3707,112 @@ gtk_cell_area_request_renderer (GtkCellArea        *area,
   gtk_style_context_get_padding (context, &border);
 
   if (orientation == GTK_ORIENTATION_HORIZONTAL)
+    padding = border.left + border.right;
+  else
+    padding = border.top + border.bottom;
+
+  if (for_size >= 0)
+    for_size = MAX (0, for_size - padding);
+
+  if (area->priv->size_cache)
+    {
+      key = gtk_cell_area_get_size_cache_key (area, renderer, orientation, widget, for_size);
+      if (key)
+        cached = g_hash_table_lookup (area->priv->size_cache, key);
+    }
+
+  if (cached)
+    {
+      *minimum_size = cached->minimum_size;
+      *natural_size = cached->natural_size;
+    }
+  else if (orientation == GTK_ORIENTATION_HORIZONTAL)
     {
       if (for_size < 0)
           gtk_cell_renderer_get_preferred_width (renderer, widget, minimum_size, natural_size);
       else
-        {
-          for_size = MAX (0, for_size - border.left - border.right);
-
-          gtk_cell_renderer_get_preferred_width_for_height (renderer, widget, for_size,
-                                                            minimum_size, natural_size);
-        }
-
-      *minimum_size += border.left + border.right;
-      *natural_size += border.left + border.right;
+        gtk_cell_renderer_get_preferred_width_for_height (renderer, widget, for_size,
+                                                          minimum_size, natural_size);
     }
   else /* GTK_ORIENTATION_VERTICAL */
     {
       if (for_size < 0)
         gtk_cell_renderer_get_preferred_height (renderer, widget, minimum_size, natural_size);
       else
-        {
-          for_size = MAX (0, for_size - border.top - border.bottom);
-
-          gtk_cell_renderer_get_preferred_height_for_width (renderer, widget, for_size,
-                                                            minimum_size, natural_size);
-        }
+        gtk_cell_renderer_get_preferred_height_for_width (renderer, widget, for_size,
+                                                          minimum_size, natural_size);
+    }
 
-      *minimum_size += border.top + border.bottom;
-      *natural_size += border.top + border.bottom;
+  if (key && !cached)
+    {
+      cached = g_slice_new (CachedSize);
+      cached->minimum_size = *minimum_size;
+      cached->natural_size = *natural_size;
+      g_hash_table_insert (area->priv->size_cache, key, cached);
     }
+  else
+    g_free (key);
+
+  *minimum_size += padding;
+  *natural_size += padding;
+}
+
+/**
+ * gtk_cell_area_set_cache_sizes:
+ * @area: a #GtkCellArea
+ * @cache_sizes: whether to reuse size requests of identical cells
+ *
+ * Sets whether @area remembers the size requests of its text cells.
+ * If enabled, cells that show the same text with the same attributes,
+ * like the few distinct values of a status column, are only measured
+ * once instead of once per row.
+ *
+ * Only #GtkCellRendererText cells are cached. The cache is dropped
+ * when the font of the widget changes or a cell is removed from @area.
+ *
+ * Since: 3.90
+ */
+void
+gtk_cell_area_set_cache_sizes (GtkCellArea *area,
+                               gboolean     cache_sizes)
+{
+  GtkCellAreaPrivate *priv;
+
+  g_return_if_fail (GTK_IS_CELL_AREA (area));
+
+  priv = area->priv;
+
+  if (cache_sizes == (priv->size_cache != NULL))
+    return;
+
+  if (cache_sizes)
+    priv->size_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                              g_free, cached_size_free);
+  else
+    g_clear_pointer (&priv->size_cache, g_hash_table_destroy);
+
+  priv->size_cache_widget = NULL;
+
+  g_object_notify (G_OBJECT (area), "cache-sizes");
+}
+
+/**
+ * gtk_cell_area_get_cache_sizes:
+ * @area: a #GtkCellArea
+ *
+ * Gets whether @area remembers the size requests of its text cells.
+ * See gtk_cell_area_set_cache_sizes().
+ *
+ * Returns: %TRUE if size requests are cached
+ *
+ * Since: 3.90
+ */
+gboolean
+gtk_cell_area_get_cache_sizes (GtkCellArea *area)
+{
+  g_return_val_if_fail (GTK_IS_CELL_AREA (area), FALSE);
+
+  return area->priv->size_cache != NULL;
 }
 
 void
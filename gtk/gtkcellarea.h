@@ -516,6 +516,13 @@ void                  gtk_cell_area_request_renderer               (GtkCellArea
                                                                     gint               *minimum_size,
                                                                     gint               *natural_size);
 
+/* Reuse size requests of identical cells */
+GDK_AVAILABLE_IN_3_90
+void                  gtk_cell_area_set_cache_sizes                (GtkCellArea        *area,
+                                                                    gboolean            cache_sizes);
+GDK_AVAILABLE_IN_3_90
+gboolean              gtk_cell_area_get_cache_sizes                (GtkCellArea        *area);
+
 /* For api stability, this is called from gtkcelllayout.c in order to ensure the correct
  * object is passed to the user function in gtk_cell_layout_set_cell_data_func.
  *
@@ -17,7 +17,7 @@
 
 #include "config.h"
 
-#include "gtkcellrenderertext.h"
+#include "gtkcellrenderertextprivate.h"
 
 #include <stdlib.h>
 
@@ -176,6 +176,7 @@ struct _GtkCellRendererTextPrivate
 
   gchar *text;
   gchar *placeholder_text;
+  gchar *markup;        /* source of text and extra_attrs, if set from markup */
 
   gdouble font_scale;
 
@@ -703,6 +704,7 @@ gtk_cell_renderer_text_finalize (GObject *object)
 
   g_free (priv->text);
   g_free (priv->placeholder_text);
+  g_free (priv->markup);
 
   if (priv->extra_attrs)
     pango_attr_list_unref (priv->extra_attrs);
@@ -1129,6 +1131,7 @@ gtk_cell_renderer_text_set_property (GObject      *object,
             pango_attr_list_unref (priv->extra_attrs);
           priv->extra_attrs = NULL;
           priv->markup_set = FALSE;
+          g_clear_pointer (&priv->markup, g_free);
         }
 
       priv->text = g_value_dup_string (value);
@@ -1142,6 +1145,7 @@ gtk_cell_renderer_text_set_property (GObject      *object,
       priv->extra_attrs = g_value_get_boxed (value);
       if (priv->extra_attrs)
         pango_attr_list_ref (priv->extra_attrs);
+      g_clear_pointer (&priv->markup, g_free);
       break;
     case PROP_MARKUP:
       {
@@ -1167,6 +1171,9 @@ gtk_cell_renderer_text_set_property (GObject      *object,
 	priv->text = text;
 	priv->extra_attrs = attrs;
         priv->markup_set = TRUE;
+
+        g_free (priv->markup);
+        priv->markup = g_strdup (str);
       }
       break;
 
@@ -2230,6 +2237,72 @@ gtk_cell_renderer_text_get_preferred_height (GtkCellRenderer *cell,
                                                          minimum_size, natural_size);
 }
 
+/* Appends everything that the size requests of @celltext depend on to
+ * @key, so that GtkCellArea can reuse requests for identical cells.
+ * Returns %FALSE if the requests can't be cached.
+ */
+gboolean
+_gtk_cell_renderer_text_append_size_key (GtkCellRendererText *celltext,
+                                         GtkWidget           *widget,
+                                         GString             *key)
+{
+  GtkCellRendererTextPrivate *priv = celltext->priv;
+  GtkCellRendererClass *cell_class = GTK_CELL_RENDERER_GET_CLASS (celltext);
+  GtkCellRendererClass *text_class = g_type_class_peek (GTK_TYPE_CELL_RENDERER_TEXT);
+  gint xpad, ypad, fixed_width, fixed_height;
+  gchar *font;
+
+  /* Subclasses may measure differently */
+  if (cell_class->get_preferred_width != text_class->get_preferred_width ||
+      cell_class->get_preferred_height != text_class->get_preferred_height ||
+      cell_class->get_preferred_height_for_width != text_class->get_preferred_height_for_width)
+    return FALSE;
+
+  /* Attributes we can't compare, and one-off fixed height calculations */
+  if ((priv->extra_attrs && !priv->markup) || priv->calc_fixed_height)
+    return FALSE;
+
+  gtk_cell_renderer_get_padding (GTK_CELL_RENDERER (celltext), &xpad, &ypad);
+  gtk_cell_renderer_get_fixed_size (GTK_CELL_RENDERER (celltext), &fixed_width, &fixed_height);
+  font = pango_font_description_to_string (priv->font);
+
+  g_string_append_printf (key, "%d %d %d %d %d %s %d %g %d %d %d %d %d %d %d %d %d %d %s ",
+                          xpad, ypad, fixed_width, fixed_height,
+                          gtk_widget_get_direction (widget),
+                          font,
+                          priv->scale_set, priv->scale_set ? priv->font_scale : 1.0,
+                          priv->rise_set ? priv->rise : 0,
+                          priv->underline_set ? priv->underline_style : PANGO_UNDERLINE_NONE,
+                          priv->single_paragraph,
+                          priv->ellipsize_set ? priv->ellipsize : PANGO_ELLIPSIZE_NONE,
+                          priv->wrap_width,
+                          priv->wrap_mode,
+                          priv->width_chars,
+                          priv->max_width_chars,
+                          priv->align_set ? priv->align : -1,
+                          show_placeholder_text (celltext),
+                          priv->language_set ? pango_language_to_string (priv->language) : "");
+
+  g_free (font);
+
+  /* The text goes last, so it can't be confused with the fields above */
+  if (show_placeholder_text (celltext))
+    g_string_append (key, priv->placeholder_text);
+  else if (priv->markup)
+    {
+      g_string_append_c (key, 'm');
+      g_string_append (key, priv->markup);
+    }
+  else
+    {
+      g_string_append_c (key, 't');
+      if (priv->text)
+        g_string_append (key, priv->text);
+    }
+
+  return TRUE;
+}
+
 static void
 gtk_cell_renderer_text_get_aligned_area (GtkCellRenderer       *cell,
 					 GtkWidget             *widget,
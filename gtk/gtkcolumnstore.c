@@ -0,0 +1,1896 @@
+/* gtkcolumnstore.c
+ * Copyright (C) 2017 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <string.h>
+#include <gobject/gvaluecollector.h>
+#include "gtktreemodel.h"
+#include "gtkcolumnstore.h"
+#include "gtkcolumnstoreprivate.h"
+#include "gtktreedatalist.h"
+#include "gtkintl.h"
+
+
+/**
+ * SECTION:gtkcolumnstore
+ * @Short_description: A list model that stores its data by column
+ * @Title: GtkColumnStore
+ * @See_also: #GtkListStore, #GtkTreeModel
+ *
+ * The #GtkColumnStore object is a list model for use with a #GtkTreeView
+ * widget. Like #GtkListStore, it implements the #GtkTreeModel and
+ * #GtkTreeSortable interfaces, but it keeps the values of each column
+ * in one contiguous array instead of allocating every cell separately.
+ *
+ * This makes it a better fit for large tables with many rows of simple
+ * data. Numeric and boolean columns take no more memory than the values
+ * themselves, equal strings within the store are shared, and sorting on
+ * a column with the default comparison works directly on the column
+ * array. A #GtkTreeModelFilter with a visible column reads the column
+ * array directly, too.
+ *
+ * Columns of other types, such as objects or boxed types, are supported
+ * as well, but don't profit from the column layout.
+ *
+ * Iters into a #GtkColumnStore stay valid until the row is removed,
+ * like those of a #GtkListStore. Inserting or removing a row in the
+ * middle of the store needs to move the following rows, so prefer
+ * appending when filling large stores, or fill the store before
+ * setting a sort column.
+ */
+
+
+typedef struct _GtkColumnStoreColumn GtkColumnStoreColumn;
+typedef struct _GtkColumnStoreString GtkColumnStoreString;
+
+struct _GtkColumnStoreColumn
+{
+  GType type;
+  GType fundamental;
+  GArray *cells;        /* indexed by slot */
+};
+
+struct _GtkColumnStoreString
+{
+  guint ref_count;
+  gchar string[1];
+};
+
+struct _GtkColumnStorePrivate
+{
+  GtkColumnStoreColumn *columns;
+  gint n_columns;
+
+  GArray *rows;         /* position -> slot */
+  GArray *positions;    /* slot -> position, or ROW_FREE/ROW_PENDING */
+  guint n_valid_positions;  /* rows whose position is up to date */
+  GArray *free_slots;
+
+  GHashTable *strings;  /* shared strings of all string columns */
+
+  GList *sort_list;
+  GtkTreeIterCompareFunc default_sort_func;
+  gpointer default_sort_data;
+  GDestroyNotify default_sort_destroy;
+
+  gint sort_column_id;
+  GtkSortType order;
+
+  gint stamp;
+};
+
+/* Positions of slots that are not rows. Pending slots are being
+ * filled or sorted, and valid for the compare functions.
+ */
+#define ROW_FREE G_MAXUINT
+#define ROW_PENDING (G_MAXUINT - 1)
+
+#define GTK_COLUMN_STORE_IS_SORTED(store) (((GtkColumnStore*)(store))->priv->sort_column_id != GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID)
+
+#define ROW_SLOT(priv, position) (g_array_index ((priv)->rows, guint, (position)))
+#define SLOT_POSITION(priv, slot) (g_array_index ((priv)->positions, guint, (slot)))
+
+static void         gtk_column_store_tree_model_init (GtkTreeModelIface    *iface);
+static void         gtk_column_store_sortable_init   (GtkTreeSortableIface *iface);
+static void         gtk_column_store_finalize        (GObject              *object);
+static GtkTreeModelFlags gtk_column_store_get_flags  (GtkTreeModel         *tree_model);
+static gint         gtk_column_store_get_n_columns   (GtkTreeModel         *tree_model);
+static GType        gtk_column_store_get_column_type (GtkTreeModel         *tree_model,
+                                                      gint                  index);
+static gboolean     gtk_column_store_get_iter        (GtkTreeModel         *tree_model,
+                                                      GtkTreeIter          *iter,
+                                                      GtkTreePath          *path);
+static GtkTreePath *gtk_column_store_get_path        (GtkTreeModel         *tree_model,
+                                                      GtkTreeIter          *iter);
+static void         gtk_column_store_get_value       (GtkTreeModel         *tree_model,
+                                                      GtkTreeIter          *iter,
+                                                      gint                  column,
+                                                      GValue               *value);
+static gboolean     gtk_column_store_iter_next       (GtkTreeModel         *tree_model,
+                                                      GtkTreeIter          *iter);
+static gboolean     gtk_column_store_iter_previous   (GtkTreeModel         *tree_model,
+                                                      GtkTreeIter          *iter);
+static gboolean     gtk_column_store_iter_children   (GtkTreeModel         *tree_model,
+                                                      GtkTreeIter          *iter,
+                                                      GtkTreeIter          *parent);
+static gboolean     gtk_column_store_iter_has_child  (GtkTreeModel         *tree_model,
+                                                      GtkTreeIter          *iter);
+static gint         gtk_column_store_iter_n_children (GtkTreeModel         *tree_model,
+                                                      GtkTreeIter          *iter);
+static gboolean     gtk_column_store_iter_nth_child  (GtkTreeModel         *tree_model,
+                                                      GtkTreeIter          *iter,
+                                                      GtkTreeIter          *parent,
+                                                      gint                  n);
+static gboolean     gtk_column_store_iter_parent     (GtkTreeModel         *tree_model,
+                                                      GtkTreeIter          *iter,
+                                                      GtkTreeIter          *child);
+
+/* sortable */
+static void     gtk_column_store_sort                  (GtkColumnStore         *column_store);
+static void     gtk_column_store_sort_iter_changed     (GtkColumnStore         *column_store,
+                                                        GtkTreeIter            *iter);
+static gboolean gtk_column_store_get_sort_column_id    (GtkTreeSortable        *sortable,
+                                                        gint                   *sort_column_id,
+                                                        GtkSortType            *order);
+static void     gtk_column_store_set_sort_column_id    (GtkTreeSortable        *sortable,
+                                                        gint                    sort_column_id,
+                                                        GtkSortType             order);
+static void     gtk_column_store_set_sort_func         (GtkTreeSortable        *sortable,
+                                                        gint                    sort_column_id,
+                                                        GtkTreeIterCompareFunc  func,
+                                                        gpointer                data,
+                                                        GDestroyNotify          destroy);
+static void     gtk_column_store_set_default_sort_func (GtkTreeSortable        *sortable,
+                                                        GtkTreeIterCompareFunc  func,
+                                                        gpointer                data,
+                                                        GDestroyNotify          destroy);
+static gboolean gtk_column_store_has_default_sort_func (GtkTreeSortable        *sortable);
+
+
+G_DEFINE_TYPE_WITH_CODE (GtkColumnStore, gtk_column_store, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (GtkColumnStore)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+                                                gtk_column_store_tree_model_init)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_SORTABLE,
+                                                gtk_column_store_sortable_init))
+
+
+static void
+gtk_column_store_class_init (GtkColumnStoreClass *class)
+{
+  GObjectClass *object_class;
+
+  object_class = (GObjectClass*) class;
+
+  object_class->finalize = gtk_column_store_finalize;
+}
+
+static void
+gtk_column_store_tree_model_init (GtkTreeModelIface *iface)
+{
+  iface->get_flags = gtk_column_store_get_flags;
+  iface->get_n_columns = gtk_column_store_get_n_columns;
+  iface->get_column_type = gtk_column_store_get_column_type;
+  iface->get_iter = gtk_column_store_get_iter;
+  iface->get_path = gtk_column_store_get_path;
+  iface->get_value = gtk_column_store_get_value;
+  iface->iter_next = gtk_column_store_iter_next;
+  iface->iter_previous = gtk_column_store_iter_previous;
+  iface->iter_children = gtk_column_store_iter_children;
+  iface->iter_has_child = gtk_column_store_iter_has_child;
+  iface->iter_n_children = gtk_column_store_iter_n_children;
+  iface->iter_nth_child = gtk_column_store_iter_nth_child;
+  iface->iter_parent = gtk_column_store_iter_parent;
+}
+
+static void
+gtk_column_store_sortable_init (GtkTreeSortableIface *iface)
+{
+  iface->get_sort_column_id = gtk_column_store_get_sort_column_id;
+  iface->set_sort_column_id = gtk_column_store_set_sort_column_id;
+  iface->set_sort_func = gtk_column_store_set_sort_func;
+  iface->set_default_sort_func = gtk_column_store_set_default_sort_func;
+  iface->has_default_sort_func = gtk_column_store_has_default_sort_func;
+}
+
+static void
+gtk_column_store_init (GtkColumnStore *column_store)
+{
+  GtkColumnStorePrivate *priv;
+
+  column_store->priv = gtk_column_store_get_instance_private (column_store);
+  priv = column_store->priv;
+
+  priv->rows = g_array_new (FALSE, FALSE, sizeof (guint));
+  priv->positions = g_array_new (FALSE, FALSE, sizeof (guint));
+  priv->free_slots = g_array_new (FALSE, FALSE, sizeof (guint));
+  priv->strings = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+  priv->stamp = g_random_int ();
+  priv->sort_column_id = GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID;
+}
+
+static gboolean
+iter_is_valid (GtkTreeIter    *iter,
+               GtkColumnStore *column_store)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  guint slot;
+
+  if (iter == NULL || iter->stamp != priv->stamp)
+    return FALSE;
+
+  slot = GPOINTER_TO_UINT (iter->user_data);
+
+  return slot < priv->positions->len &&
+         SLOT_POSITION (priv, slot) != ROW_FREE;
+}
+
+static GType
+get_fundamental_type (GType type)
+{
+  GType result;
+
+  result = G_TYPE_FUNDAMENTAL (type);
+
+  if (result == G_TYPE_INTERFACE)
+    {
+      if (g_type_is_a (type, G_TYPE_OBJECT))
+        result = G_TYPE_OBJECT;
+    }
+
+  return result;
+}
+
+static guint
+get_cell_size (GType fundamental)
+{
+  switch (fundamental)
+    {
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_CHAR:
+    case G_TYPE_INT:
+    case G_TYPE_ENUM:
+      return sizeof (gint);
+    case G_TYPE_UCHAR:
+    case G_TYPE_UINT:
+    case G_TYPE_FLAGS:
+      return sizeof (guint);
+    case G_TYPE_LONG:
+    case G_TYPE_INT64:
+      return sizeof (gint64);
+    case G_TYPE_ULONG:
+    case G_TYPE_UINT64:
+      return sizeof (guint64);
+    case G_TYPE_FLOAT:
+      return sizeof (gfloat);
+    case G_TYPE_DOUBLE:
+      return sizeof (gdouble);
+    case G_TYPE_STRING:
+    case G_TYPE_POINTER:
+      return sizeof (gpointer);
+    default:
+      return sizeof (GValue);
+    }
+}
+
+/* Strings are shared between all string columns of the store and
+ * only freed when the last cell using them changes.
+ */
+static const gchar *
+string_ref (GtkColumnStore *column_store,
+            const gchar    *string)
+{
+  GtkColumnStoreString *entry;
+  gsize len;
+
+  if (string == NULL)
+    return NULL;
+
+  entry = g_hash_table_lookup (column_store->priv->strings, string);
+  if (entry == NULL)
+    {
+      len = strlen (string);
+      entry = g_malloc (G_STRUCT_OFFSET (GtkColumnStoreString, string) + len + 1);
+      entry->ref_count = 0;
+      memcpy (entry->string, string, len + 1);
+      g_hash_table_insert (column_store->priv->strings, entry->string, entry);
+    }
+
+  entry->ref_count++;
+
+  return entry->string;
+}
+
+static void
+string_unref (GtkColumnStore *column_store,
+              const gchar    *string)
+{
+  GtkColumnStoreString *entry;
+
+  if (string == NULL)
+    return;
+
+  entry = g_hash_table_lookup (column_store->priv->strings, string);
+  g_assert (entry != NULL);
+
+  entry->ref_count--;
+  if (entry->ref_count == 0)
+    g_hash_table_remove (column_store->priv->strings, string);
+}
+
+/**
+ * gtk_column_store_new:
+ * @n_columns: number of columns in the column store
+ * @...: all #GType types for the columns, from first to last
+ *
+ * Creates a new column store with @n_columns columns each of the
+ * types passed in. The same types as for gtk_list_store_new() are
+ * supported.
+ *
+ * Returns: a new #GtkColumnStore
+ *
+ * Since: 3.90
+ */
+GtkColumnStore *
+gtk_column_store_new (gint n_columns,
+                      ...)
+{
+  GtkColumnStore *retval;
+  GType *types;
+  va_list args;
+  gint i;
+
+  g_return_val_if_fail (n_columns > 0, NULL);
+
+  types = g_new (GType, n_columns);
+
+  va_start (args, n_columns);
+  for (i = 0; i < n_columns; i++)
+    types[i] = va_arg (args, GType);
+  va_end (args);
+
+  retval = gtk_column_store_newv (n_columns, types);
+
+  g_free (types);
+
+  return retval;
+}
+
+/**
+ * gtk_column_store_newv: (rename-to gtk_column_store_new)
+ * @n_columns: number of columns in the column store
+ * @types: (array length=n_columns): an array of #GType types for the columns, from first to last
+ *
+ * Non-vararg creation function. Used primarily by language bindings.
+ *
+ * Returns: (transfer full): a new #GtkColumnStore
+ *
+ * Since: 3.90
+ **/
+GtkColumnStore *
+gtk_column_store_newv (gint   n_columns,
+                       GType *types)
+{
+  GtkColumnStore *retval;
+  GtkColumnStorePrivate *priv;
+  gint i;
+
+  g_return_val_if_fail (n_columns > 0, NULL);
+
+  for (i = 0; i < n_columns; i++)
+    {
+      if (! _gtk_tree_data_list_check_type (types[i]))
+        {
+          g_warning ("%s: Invalid type %s", G_STRLOC, g_type_name (types[i]));
+          return NULL;
+        }
+    }
+
+  retval = g_object_new (GTK_TYPE_COLUMN_STORE, NULL);
+  priv = retval->priv;
+
+  priv->n_columns = n_columns;
+  priv->columns = g_new (GtkColumnStoreColumn, n_columns);
+  for (i = 0; i < n_columns; i++)
+    {
+      GtkColumnStoreColumn *column = &priv->columns[i];
+
+      column->type = types[i];
+      column->fundamental = get_fundamental_type (types[i]);
+      column->cells = g_array_new (FALSE, TRUE, get_cell_size (column->fundamental));
+    }
+
+  priv->sort_list = _gtk_tree_data_list_header_new (n_columns, types);
+
+  return retval;
+}
+
+static void
+gtk_column_store_finalize (GObject *object)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (object);
+  GtkColumnStorePrivate *priv = column_store->priv;
+  gint i;
+  guint slot;
+
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      GtkColumnStoreColumn *column = &priv->columns[i];
+
+      if (get_cell_size (column->fundamental) == sizeof (GValue))
+        {
+          for (slot = 0; slot < column->cells->len; slot++)
+            {
+              GValue *cell = &g_array_index (column->cells, GValue, slot);
+
+              if (G_VALUE_TYPE (cell) != G_TYPE_INVALID)
+                g_value_unset (cell);
+            }
+        }
+
+      g_array_free (column->cells, TRUE);
+    }
+  g_free (priv->columns);
+
+  g_array_free (priv->rows, TRUE);
+  g_array_free (priv->positions, TRUE);
+  g_array_free (priv->free_slots, TRUE);
+  g_hash_table_destroy (priv->strings);
+
+  _gtk_tree_data_list_header_free (priv->sort_list);
+
+  if (priv->default_sort_destroy)
+    {
+      GDestroyNotify d = priv->default_sort_destroy;
+
+      priv->default_sort_destroy = NULL;
+      d (priv->default_sort_data);
+      priv->default_sort_data = NULL;
+    }
+
+  G_OBJECT_CLASS (gtk_column_store_parent_class)->finalize (object);
+}
+
+/* Row storage */
+
+static guint
+gtk_column_store_alloc_slot (GtkColumnStore *column_store)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  guint slot;
+  gint i;
+
+  if (priv->free_slots->len > 0)
+    {
+      slot = g_array_index (priv->free_slots, guint, priv->free_slots->len - 1);
+      g_array_set_size (priv->free_slots, priv->free_slots->len - 1);
+    }
+  else
+    {
+      slot = priv->positions->len;
+      g_array_set_size (priv->positions, slot + 1);
+
+      for (i = 0; i < priv->n_columns; i++)
+        g_array_set_size (priv->columns[i].cells, slot + 1);
+    }
+
+  SLOT_POSITION (priv, slot) = ROW_PENDING;
+
+  return slot;
+}
+
+static void
+gtk_column_store_clear_slot (GtkColumnStore *column_store,
+                             guint           slot)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  gint i;
+
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      GtkColumnStoreColumn *column = &priv->columns[i];
+      GValue *cell;
+
+      switch (column->fundamental)
+        {
+        case G_TYPE_STRING:
+          string_unref (column_store, g_array_index (column->cells, const gchar *, slot));
+          g_array_index (column->cells, const gchar *, slot) = NULL;
+          break;
+
+        case G_TYPE_BOOLEAN:
+        case G_TYPE_CHAR:
+        case G_TYPE_UCHAR:
+        case G_TYPE_INT:
+        case G_TYPE_UINT:
+        case G_TYPE_ENUM:
+        case G_TYPE_FLAGS:
+        case G_TYPE_LONG:
+        case G_TYPE_ULONG:
+        case G_TYPE_INT64:
+        case G_TYPE_UINT64:
+        case G_TYPE_FLOAT:
+        case G_TYPE_DOUBLE:
+        case G_TYPE_POINTER:
+          memset (column->cells->data + slot * get_cell_size (column->fundamental),
+                  0, get_cell_size (column->fundamental));
+          break;
+
+        default:
+          cell = &g_array_index (column->cells, GValue, slot);
+          if (G_VALUE_TYPE (cell) != G_TYPE_INVALID)
+            g_value_unset (cell);
+          memset (cell, 0, sizeof (GValue));
+          break;
+        }
+    }
+}
+
+static void
+gtk_column_store_invalidate_positions (GtkColumnStore *column_store,
+                                       guint           first)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+
+  priv->n_valid_positions = MIN (priv->n_valid_positions, first);
+}
+
+/* Returns the position of @slot, renumbering the rows up to it if
+ * needed. A row before n_valid_positions always has the right position,
+ * so a row that isn't where its position says is after them.
+ */
+static guint
+gtk_column_store_get_position (GtkColumnStore *column_store,
+                               guint           slot)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  guint position, i;
+
+  position = SLOT_POSITION (priv, slot);
+  if (position < priv->rows->len && ROW_SLOT (priv, position) == slot)
+    return position;
+
+  for (i = priv->n_valid_positions; i < priv->rows->len; i++)
+    {
+      SLOT_POSITION (priv, ROW_SLOT (priv, i)) = i;
+      if (ROW_SLOT (priv, i) == slot)
+        {
+          priv->n_valid_positions = i + 1;
+          return i;
+        }
+    }
+
+  /* Not a row */
+  priv->n_valid_positions = priv->rows->len;
+
+  return position;
+}
+
+static void
+gtk_column_store_link_slot (GtkColumnStore *column_store,
+                            guint           slot,
+                            guint           position)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+
+  g_array_insert_val (priv->rows, position, slot);
+  SLOT_POSITION (priv, slot) = position;
+  gtk_column_store_invalidate_positions (column_store, position);
+}
+
+static void
+gtk_column_store_unlink_slot (GtkColumnStore *column_store,
+                              guint           slot)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  guint position;
+
+  position = gtk_column_store_get_position (column_store, slot);
+  g_array_remove_index (priv->rows, position);
+  SLOT_POSITION (priv, slot) = ROW_PENDING;
+  gtk_column_store_invalidate_positions (column_store, position);
+}
+
+static void
+gtk_column_store_cell_to_value (GtkColumnStore *column_store,
+                                guint           slot,
+                                gint            column_index,
+                                GValue         *value)
+{
+  GtkColumnStoreColumn *column = &column_store->priv->columns[column_index];
+  GValue *cell;
+
+  g_value_init (value, column->type);
+
+  switch (column->fundamental)
+    {
+    case G_TYPE_BOOLEAN:
+      g_value_set_boolean (value, g_array_index (column->cells, gint, slot));
+      break;
+    case G_TYPE_CHAR:
+      g_value_set_schar (value, g_array_index (column->cells, gint, slot));
+      break;
+    case G_TYPE_INT:
+      g_value_set_int (value, g_array_index (column->cells, gint, slot));
+      break;
+    case G_TYPE_ENUM:
+      g_value_set_enum (value, g_array_index (column->cells, gint, slot));
+      break;
+    case G_TYPE_UCHAR:
+      g_value_set_uchar (value, g_array_index (column->cells, guint, slot));
+      break;
+    case G_TYPE_UINT:
+      g_value_set_uint (value, g_array_index (column->cells, guint, slot));
+      break;
+    case G_TYPE_FLAGS:
+      g_value_set_flags (value, g_array_index (column->cells, guint, slot));
+      break;
+    case G_TYPE_LONG:
+      g_value_set_long (value, g_array_index (column->cells, gint64, slot));
+      break;
+    case G_TYPE_INT64:
+      g_value_set_int64 (value, g_array_index (column->cells, gint64, slot));
+      break;
+    case G_TYPE_ULONG:
+      g_value_set_ulong (value, g_array_index (column->cells, guint64, slot));
+      break;
+    case G_TYPE_UINT64:
+      g_value_set_uint64 (value, g_array_index (column->cells, guint64, slot));
+      break;
+    case G_TYPE_FLOAT:
+      g_value_set_float (value, g_array_index (column->cells, gfloat, slot));
+      break;
+    case G_TYPE_DOUBLE:
+      g_value_set_double (value, g_array_index (column->cells, gdouble, slot));
+      break;
+    case G_TYPE_STRING:
+      g_value_set_string (value, g_array_index (column->cells, const gchar *, slot));
+      break;
+    case G_TYPE_POINTER:
+      g_value_set_pointer (value, g_array_index (column->cells, gpointer, slot));
+      break;
+    default:
+      cell = &g_array_index (column->cells, GValue, slot);
+      if (G_VALUE_TYPE (cell) != G_TYPE_INVALID)
+        g_value_copy (cell, value);
+      break;
+    }
+}
+
+static void
+gtk_column_store_value_to_cell (GtkColumnStore *column_store,
+                                guint           slot,
+                                gint            column_index,
+                                const GValue   *value)
+{
+  GtkColumnStoreColumn *column = &column_store->priv->columns[column_index];
+  const gchar *old_string;
+  GValue *cell;
+
+  switch (column->fundamental)
+    {
+    case G_TYPE_BOOLEAN:
+      g_array_index (column->cells, gint, slot) = g_value_get_boolean (value);
+      break;
+    case G_TYPE_CHAR:
+      g_array_index (column->cells, gint, slot) = g_value_get_schar (value);
+      break;
+    case G_TYPE_INT:
+      g_array_index (column->cells, gint, slot) = g_value_get_int (value);
+      break;
+    case G_TYPE_ENUM:
+      g_array_index (column->cells, gint, slot) = g_value_get_enum (value);
+      break;
+    case G_TYPE_UCHAR:
+      g_array_index (column->cells, guint, slot) = g_value_get_uchar (value);
+      break;
+    case G_TYPE_UINT:
+      g_array_index (column->cells, guint, slot) = g_value_get_uint (value);
+      break;
+    case G_TYPE_FLAGS:
+      g_array_index (column->cells, guint, slot) = g_value_get_flags (value);
+      break;
+    case G_TYPE_LONG:
+      g_array_index (column->cells, gint64, slot) = g_value_get_long (value);
+      break;
+    case G_TYPE_INT64:
+      g_array_index (column->cells, gint64, slot) = g_value_get_int64 (value);
+      break;
+    case G_TYPE_ULONG:
+      g_array_index (column->cells, guint64, slot) = g_value_get_ulong (value);
+      break;
+    case G_TYPE_UINT64:
+      g_array_index (column->cells, guint64, slot) = g_value_get_uint64 (value);
+      break;
+    case G_TYPE_FLOAT:
+      g_array_index (column->cells, gfloat, slot) = g_value_get_float (value);
+      break;
+    case G_TYPE_DOUBLE:
+      g_array_index (column->cells, gdouble, slot) = g_value_get_double (value);
+      break;
+    case G_TYPE_STRING:
+      old_string = g_array_index (column->cells, const gchar *, slot);
+      g_array_index (column->cells, const gchar *, slot) =
+        string_ref (column_store, g_value_get_string (value));
+      string_unref (column_store, old_string);
+      break;
+    case G_TYPE_POINTER:
+      g_array_index (column->cells, gpointer, slot) = g_value_get_pointer (value);
+      break;
+    default:
+      cell = &g_array_index (column->cells, GValue, slot);
+      if (G_VALUE_TYPE (cell) != G_TYPE_INVALID)
+        g_value_unset (cell);
+      g_value_init (cell, column->type);
+      g_value_copy (value, cell);
+      break;
+    }
+}
+
+/* Fulfill the GtkTreeModel requirements */
+static GtkTreeModelFlags
+gtk_column_store_get_flags (GtkTreeModel *tree_model)
+{
+  return GTK_TREE_MODEL_ITERS_PERSIST | GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+gtk_column_store_get_n_columns (GtkTreeModel *tree_model)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+
+  return column_store->priv->n_columns;
+}
+
+static GType
+gtk_column_store_get_column_type (GtkTreeModel *tree_model,
+                                  gint          index)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+  GtkColumnStorePrivate *priv = column_store->priv;
+
+  g_return_val_if_fail (index < priv->n_columns, G_TYPE_INVALID);
+
+  return priv->columns[index].type;
+}
+
+static gboolean
+gtk_column_store_get_iter (GtkTreeModel *tree_model,
+                           GtkTreeIter  *iter,
+                           GtkTreePath  *path)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+  GtkColumnStorePrivate *priv = column_store->priv;
+  gint i;
+
+  i = gtk_tree_path_get_indices (path)[0];
+
+  if (i < 0 || i >= (gint) priv->rows->len)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  iter->stamp = priv->stamp;
+  iter->user_data = GUINT_TO_POINTER (ROW_SLOT (priv, i));
+
+  return TRUE;
+}
+
+static GtkTreePath *
+gtk_column_store_get_path (GtkTreeModel *tree_model,
+                           GtkTreeIter  *iter)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+  GtkColumnStorePrivate *priv = column_store->priv;
+  GtkTreePath *path;
+
+  g_return_val_if_fail (iter->stamp == priv->stamp, NULL);
+
+  path = gtk_tree_path_new ();
+  gtk_tree_path_append_index (path, gtk_column_store_get_position (column_store, GPOINTER_TO_UINT (iter->user_data)));
+
+  return path;
+}
+
+static void
+gtk_column_store_get_value (GtkTreeModel *tree_model,
+                            GtkTreeIter  *iter,
+                            gint          column,
+                            GValue       *value)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+  GtkColumnStorePrivate *priv = column_store->priv;
+
+  g_return_if_fail (column < priv->n_columns);
+  g_return_if_fail (iter_is_valid (iter, column_store));
+
+  gtk_column_store_cell_to_value (column_store,
+                                  GPOINTER_TO_UINT (iter->user_data),
+                                  column, value);
+}
+
+static gboolean
+gtk_column_store_iter_next (GtkTreeModel *tree_model,
+                            GtkTreeIter  *iter)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+  GtkColumnStorePrivate *priv = column_store->priv;
+  guint position;
+
+  g_return_val_if_fail (priv->stamp == iter->stamp, FALSE);
+
+  position = gtk_column_store_get_position (column_store, GPOINTER_TO_UINT (iter->user_data)) + 1;
+  if (position >= priv->rows->len)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  iter->user_data = GUINT_TO_POINTER (ROW_SLOT (priv, position));
+
+  return TRUE;
+}
+
+static gboolean
+gtk_column_store_iter_previous (GtkTreeModel *tree_model,
+                                GtkTreeIter  *iter)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+  GtkColumnStorePrivate *priv = column_store->priv;
+  guint position;
+
+  g_return_val_if_fail (priv->stamp == iter->stamp, FALSE);
+
+  position = gtk_column_store_get_position (column_store, GPOINTER_TO_UINT (iter->user_data));
+  if (position == 0)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  iter->user_data = GUINT_TO_POINTER (ROW_SLOT (priv, position - 1));
+
+  return TRUE;
+}
+
+static gboolean
+gtk_column_store_iter_children (GtkTreeModel *tree_model,
+                                GtkTreeIter  *iter,
+                                GtkTreeIter  *parent)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+  GtkColumnStorePrivate *priv = column_store->priv;
+
+  /* this is a list, nodes have no children */
+  if (parent || priv->rows->len == 0)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  iter->stamp = priv->stamp;
+  iter->user_data = GUINT_TO_POINTER (ROW_SLOT (priv, 0));
+
+  return TRUE;
+}
+
+static gboolean
+gtk_column_store_iter_has_child (GtkTreeModel *tree_model,
+                                 GtkTreeIter  *iter)
+{
+  return FALSE;
+}
+
+static gint
+gtk_column_store_iter_n_children (GtkTreeModel *tree_model,
+                                  GtkTreeIter  *iter)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+  GtkColumnStorePrivate *priv = column_store->priv;
+
+  if (iter == NULL)
+    return priv->rows->len;
+
+  g_return_val_if_fail (priv->stamp == iter->stamp, -1);
+
+  return 0;
+}
+
+static gboolean
+gtk_column_store_iter_nth_child (GtkTreeModel *tree_model,
+                                 GtkTreeIter  *iter,
+                                 GtkTreeIter  *parent,
+                                 gint          n)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+  GtkColumnStorePrivate *priv = column_store->priv;
+
+  iter->stamp = 0;
+
+  if (parent || n < 0 || n >= (gint) priv->rows->len)
+    return FALSE;
+
+  iter->stamp = priv->stamp;
+  iter->user_data = GUINT_TO_POINTER (ROW_SLOT (priv, n));
+
+  return TRUE;
+}
+
+static gboolean
+gtk_column_store_iter_parent (GtkTreeModel *tree_model,
+                              GtkTreeIter  *iter,
+                              GtkTreeIter  *child)
+{
+  iter->stamp = 0;
+  return FALSE;
+}
+
+/* Setting values */
+
+static gboolean
+gtk_column_store_real_set_value (GtkColumnStore *column_store,
+                                 guint           slot,
+                                 gint            column,
+                                 GValue         *value)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  GType type = priv->columns[column].type;
+  GValue real_value = G_VALUE_INIT;
+
+  if (g_type_is_a (G_VALUE_TYPE (value), type))
+    {
+      gtk_column_store_value_to_cell (column_store, slot, column, value);
+      return TRUE;
+    }
+
+  if (! (g_value_type_transformable (G_VALUE_TYPE (value), type)))
+    {
+      g_warning ("%s: Unable to convert from %s to %s",
+                 G_STRLOC,
+                 g_type_name (G_VALUE_TYPE (value)),
+                 g_type_name (type));
+      return FALSE;
+    }
+
+  g_value_init (&real_value, type);
+  if (!g_value_transform (value, &real_value))
+    {
+      g_warning ("%s: Unable to make conversion from %s to %s",
+                 G_STRLOC,
+                 g_type_name (G_VALUE_TYPE (value)),
+                 g_type_name (type));
+      g_value_unset (&real_value);
+      return FALSE;
+    }
+
+  gtk_column_store_value_to_cell (column_store, slot, column, &real_value);
+  g_value_unset (&real_value);
+
+  return TRUE;
+}
+
+/* Whether changing @column may change the sort position of a row */
+static gboolean
+gtk_column_store_column_affects_sort (GtkColumnStore *column_store,
+                                      gint            column)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  GtkTreeDataSortHeader *header;
+
+  if (!GTK_COLUMN_STORE_IS_SORTED (column_store))
+    return FALSE;
+
+  if (priv->sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
+    return TRUE;
+
+  header = _gtk_tree_data_list_get_header (priv->sort_list, priv->sort_column_id);
+  if (header == NULL || header->func != _gtk_tree_data_list_compare_func)
+    return TRUE;
+
+  return GPOINTER_TO_INT (header->data) == column;
+}
+
+static void
+gtk_column_store_emit_row_changed (GtkColumnStore *column_store,
+                                   GtkTreeIter    *iter)
+{
+  GtkTreePath *path;
+
+  path = gtk_column_store_get_path (GTK_TREE_MODEL (column_store), iter);
+  gtk_tree_model_row_changed (GTK_TREE_MODEL (column_store), path, iter);
+  gtk_tree_path_free (path);
+}
+
+/**
+ * gtk_column_store_set_value:
+ * @column_store: A #GtkColumnStore
+ * @iter: A valid #GtkTreeIter for the row being modified
+ * @column: column number to modify
+ * @value: new value for the cell
+ *
+ * Sets the data in the cell specified by @iter and @column.
+ * The type of @value must be convertible to the type of the
+ * column.
+ *
+ * Since: 3.90
+ */
+void
+gtk_column_store_set_value (GtkColumnStore *column_store,
+                            GtkTreeIter    *iter,
+                            gint            column,
+                            GValue         *value)
+{
+  GtkColumnStorePrivate *priv;
+
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+  g_return_if_fail (iter_is_valid (iter, column_store));
+  g_return_if_fail (G_IS_VALUE (value));
+  priv = column_store->priv;
+  g_return_if_fail (column >= 0 && column < priv->n_columns);
+
+  if (gtk_column_store_real_set_value (column_store,
+                                       GPOINTER_TO_UINT (iter->user_data),
+                                       column, value))
+    {
+      gtk_column_store_emit_row_changed (column_store, iter);
+
+      if (gtk_column_store_column_affects_sort (column_store, column))
+        gtk_column_store_sort_iter_changed (column_store, iter);
+    }
+}
+
+static gboolean
+gtk_column_store_set_vector_internal (GtkColumnStore *column_store,
+                                      guint           slot,
+                                      gboolean       *maybe_need_sort,
+                                      gint           *columns,
+                                      GValue         *values,
+                                      gint            n_values)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  gboolean changed = FALSE;
+  gint i;
+
+  for (i = 0; i < n_values; i++)
+    {
+      if (columns[i] < 0 || columns[i] >= priv->n_columns)
+        {
+          g_warning ("%s: Invalid column number %d", G_STRLOC, columns[i]);
+          continue;
+        }
+
+      if (gtk_column_store_real_set_value (column_store, slot,
+                                           columns[i], &values[i]))
+        {
+          changed = TRUE;
+          if (gtk_column_store_column_affects_sort (column_store, columns[i]))
+            *maybe_need_sort = TRUE;
+        }
+    }
+
+  return changed;
+}
+
+/**
+ * gtk_column_store_set_valuesv: (rename-to gtk_column_store_set)
+ * @column_store: A #GtkColumnStore
+ * @iter: A valid #GtkTreeIter for the row being modified
+ * @columns: (array length=n_values): an array of column numbers
+ * @values: (array length=n_values): an array of GValues
+ * @n_values: the length of the @columns and @values arrays
+ *
+ * A variant of gtk_column_store_set_valist() which takes
+ * the columns and values as two arrays, instead of varargs.
+ *
+ * Since: 3.90
+ */
+void
+gtk_column_store_set_valuesv (GtkColumnStore *column_store,
+                              GtkTreeIter    *iter,
+                              gint           *columns,
+                              GValue         *values,
+                              gint            n_values)
+{
+  gboolean maybe_need_sort = FALSE;
+
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+  g_return_if_fail (iter_is_valid (iter, column_store));
+
+  if (gtk_column_store_set_vector_internal (column_store,
+                                            GPOINTER_TO_UINT (iter->user_data),
+                                            &maybe_need_sort,
+                                            columns, values, n_values))
+    {
+      gtk_column_store_emit_row_changed (column_store, iter);
+
+      if (maybe_need_sort)
+        gtk_column_store_sort_iter_changed (column_store, iter);
+    }
+}
+
+/**
+ * gtk_column_store_set_valist:
+ * @column_store: A #GtkColumnStore
+ * @iter: A valid #GtkTreeIter for the row being modified
+ * @var_args: va_list of column/value pairs
+ *
+ * See gtk_column_store_set(); this version takes a va_list for use
+ * by language bindings.
+ *
+ * Since: 3.90
+ */
+void
+gtk_column_store_set_valist (GtkColumnStore *column_store,
+                             GtkTreeIter    *iter,
+                             va_list         var_args)
+{
+  GtkColumnStorePrivate *priv;
+  gboolean changed = FALSE;
+  gboolean maybe_need_sort = FALSE;
+  guint slot;
+  gint column;
+
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+  g_return_if_fail (iter_is_valid (iter, column_store));
+
+  priv = column_store->priv;
+  slot = GPOINTER_TO_UINT (iter->user_data);
+
+  column = va_arg (var_args, gint);
+
+  while (column != -1)
+    {
+      GValue value = G_VALUE_INIT;
+      gchar *error = NULL;
+
+      if (column < 0 || column >= priv->n_columns)
+        {
+          g_warning ("%s: Invalid column number %d added to iter (remember to end your list of columns with a -1)", G_STRLOC, column);
+          break;
+        }
+
+      G_VALUE_COLLECT_INIT (&value, priv->columns[column].type,
+                            var_args, 0, &error);
+      if (error)
+        {
+          g_warning ("%s: %s", G_STRLOC, error);
+          g_free (error);
+
+          /* we purposely leak the value here, it might not be
+           * in a sane state if an error condition occoured
+           */
+          break;
+        }
+
+      if (gtk_column_store_real_set_value (column_store, slot, column, &value))
+        {
+          changed = TRUE;
+          if (gtk_column_store_column_affects_sort (column_store, column))
+            maybe_need_sort = TRUE;
+        }
+
+      g_value_unset (&value);
+
+      column = va_arg (var_args, gint);
+    }
+
+  if (changed)
+    {
+      gtk_column_store_emit_row_changed (column_store, iter);
+
+      if (maybe_need_sort)
+        gtk_column_store_sort_iter_changed (column_store, iter);
+    }
+}
+
+/**
+ * gtk_column_store_set:
+ * @column_store: a #GtkColumnStore
+ * @iter: row iterator
+ * @...: pairs of column number and value, terminated with -1
+ *
+ * Sets the value of one or more cells in the row referenced by @iter.
+ * The variable argument list should contain integer column numbers,
+ * each column number followed by the value to be set, and is
+ * terminated by -1, like for gtk_list_store_set().
+ *
+ * Since: 3.90
+ */
+void
+gtk_column_store_set (GtkColumnStore *column_store,
+                      GtkTreeIter    *iter,
+                      ...)
+{
+  va_list var_args;
+
+  va_start (var_args, iter);
+  gtk_column_store_set_valist (column_store, iter, var_args);
+  va_end (var_args);
+}
+
+/**
+ * gtk_column_store_remove:
+ * @column_store: A #GtkColumnStore
+ * @iter: A valid #GtkTreeIter
+ *
+ * Removes the given row from the column store. After being removed,
+ * @iter is set to be the next valid row, or invalidated if it pointed
+ * to the last row in @column_store.
+ *
+ * Returns: %TRUE if @iter is valid, %FALSE if not.
+ *
+ * Since: 3.90
+ */
+gboolean
+gtk_column_store_remove (GtkColumnStore *column_store,
+                         GtkTreeIter    *iter)
+{
+  GtkColumnStorePrivate *priv;
+  GtkTreePath *path;
+  guint slot, position;
+
+  g_return_val_if_fail (GTK_IS_COLUMN_STORE (column_store), FALSE);
+  g_return_val_if_fail (iter_is_valid (iter, column_store), FALSE);
+
+  priv = column_store->priv;
+  slot = GPOINTER_TO_UINT (iter->user_data);
+  position = gtk_column_store_get_position (column_store, slot);
+
+  gtk_column_store_unlink_slot (column_store, slot);
+  gtk_column_store_clear_slot (column_store, slot);
+  SLOT_POSITION (priv, slot) = ROW_FREE;
+  g_array_append_val (priv->free_slots, slot);
+
+  path = gtk_tree_path_new_from_indices (position, -1);
+  gtk_tree_model_row_deleted (GTK_TREE_MODEL (column_store), path);
+  gtk_tree_path_free (path);
+
+  if (position >= priv->rows->len)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  iter->stamp = priv->stamp;
+  iter->user_data = GUINT_TO_POINTER (ROW_SLOT (priv, position));
+
+  return TRUE;
+}
+
+static void
+gtk_column_store_insert_slot (GtkColumnStore *column_store,
+                              GtkTreeIter    *iter,
+                              guint           slot,
+                              guint           position)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  GtkTreePath *path;
+
+  gtk_column_store_link_slot (column_store, slot, position);
+
+  iter->stamp = priv->stamp;
+  iter->user_data = GUINT_TO_POINTER (slot);
+
+  path = gtk_tree_path_new_from_indices (position, -1);
+  gtk_tree_model_row_inserted (GTK_TREE_MODEL (column_store), path, iter);
+  gtk_tree_path_free (path);
+}
+
+/**
+ * gtk_column_store_insert:
+ * @column_store: A #GtkColumnStore
+ * @iter: (out): An unset #GtkTreeIter to set to the new row
+ * @position: position to insert the new row, or -1 for last
+ *
+ * Creates a new row at @position. @iter will be changed to point to
+ * this new row. If @position is -1 or is larger than the number of rows
+ * in the store, then the new row will be appended. The row will be
+ * empty after this function is called. To fill in values, you need to
+ * call gtk_column_store_set() or gtk_column_store_set_value().
+ *
+ * Since: 3.90
+ */
+void
+gtk_column_store_insert (GtkColumnStore *column_store,
+                         GtkTreeIter    *iter,
+                         gint            position)
+{
+  GtkColumnStorePrivate *priv;
+
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+  g_return_if_fail (iter != NULL);
+
+  priv = column_store->priv;
+
+  if (position < 0 || position > (gint) priv->rows->len)
+    position = priv->rows->len;
+
+  gtk_column_store_insert_slot (column_store, iter,
+                                gtk_column_store_alloc_slot (column_store),
+                                position);
+}
+
+/**
+ * gtk_column_store_append:
+ * @column_store: A #GtkColumnStore
+ * @iter: (out): An unset #GtkTreeIter to set to the appended row
+ *
+ * Appends a new row to @column_store. @iter will be changed to point
+ * to this new row. The row will be empty after this function is called.
+ *
+ * Since: 3.90
+ */
+void
+gtk_column_store_append (GtkColumnStore *column_store,
+                         GtkTreeIter    *iter)
+{
+  gtk_column_store_insert (column_store, iter, -1);
+}
+
+static guint gtk_column_store_find_sorted_position (GtkColumnStore *column_store,
+                                                    guint           slot);
+
+/**
+ * gtk_column_store_insert_with_valuesv:
+ * @column_store: A #GtkColumnStore
+ * @iter: (out) (allow-none): An unset #GtkTreeIter to set to the new row, or %NULL.
+ * @position: position to insert the new row, or -1 for last
+ * @columns: (array length=n_values): an array of column numbers
+ * @values: (array length=n_values): an array of GValues
+ * @n_values: the length of the @columns and @values arrays
+ *
+ * Creates a new row at @position and fills it with the given values,
+ * emitting only a single #GtkTreeModel::row-inserted signal. If the
+ * store is sorted, the row is inserted at its sorted position and
+ * @position is ignored.
+ *
+ * Since: 3.90
+ */
+void
+gtk_column_store_insert_with_valuesv (GtkColumnStore *column_store,
+                                      GtkTreeIter    *iter,
+                                      gint            position,
+                                      gint           *columns,
+                                      GValue         *values,
+                                      gint            n_values)
+{
+  GtkColumnStorePrivate *priv;
+  GtkTreeIter tmp_iter;
+  gboolean maybe_need_sort = FALSE;
+  guint slot;
+
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+
+  priv = column_store->priv;
+
+  if (!iter)
+    iter = &tmp_iter;
+
+  slot = gtk_column_store_alloc_slot (column_store);
+  gtk_column_store_set_vector_internal (column_store, slot,
+                                        &maybe_need_sort,
+                                        columns, values, n_values);
+
+  if (GTK_COLUMN_STORE_IS_SORTED (column_store))
+    position = gtk_column_store_find_sorted_position (column_store, slot);
+  else if (position < 0 || position > (gint) priv->rows->len)
+    position = priv->rows->len;
+
+  gtk_column_store_insert_slot (column_store, iter, slot, position);
+}
+
+/**
+ * gtk_column_store_clear:
+ * @column_store: a #GtkColumnStore.
+ *
+ * Removes all rows from the column store.
+ *
+ * Since: 3.90
+ */
+void
+gtk_column_store_clear (GtkColumnStore *column_store)
+{
+  GtkColumnStorePrivate *priv;
+  GtkTreeIter iter;
+  gint i;
+
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+
+  priv = column_store->priv;
+
+  /* Removing from the end doesn't need to move any rows */
+  while (priv->rows->len > 0)
+    {
+      iter.stamp = priv->stamp;
+      iter.user_data = GUINT_TO_POINTER (ROW_SLOT (priv, priv->rows->len - 1));
+      gtk_column_store_remove (column_store, &iter);
+    }
+
+  g_array_set_size (priv->positions, 0);
+  g_array_set_size (priv->free_slots, 0);
+  for (i = 0; i < priv->n_columns; i++)
+    g_array_set_size (priv->columns[i].cells, 0);
+
+  do
+    {
+      priv->stamp++;
+    }
+  while (priv->stamp == 0);
+}
+
+/**
+ * gtk_column_store_iter_is_valid:
+ * @column_store: A #GtkColumnStore.
+ * @iter: A #GtkTreeIter.
+ *
+ * Checks if the given iter is a valid iter for this #GtkColumnStore.
+ *
+ * Returns: %TRUE if the iter is valid, %FALSE if the iter is invalid.
+ *
+ * Since: 3.90
+ */
+gboolean
+gtk_column_store_iter_is_valid (GtkColumnStore *column_store,
+                                GtkTreeIter    *iter)
+{
+  g_return_val_if_fail (GTK_IS_COLUMN_STORE (column_store), FALSE);
+  g_return_val_if_fail (iter != NULL, FALSE);
+
+  return iter_is_valid (iter, column_store);
+}
+
+gboolean
+_gtk_column_store_get_boolean (GtkColumnStore *column_store,
+                               GtkTreeIter    *iter,
+                               gint            column)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+
+  g_return_val_if_fail (column >= 0 && column < priv->n_columns, FALSE);
+  g_return_val_if_fail (priv->columns[column].fundamental == G_TYPE_BOOLEAN, FALSE);
+  g_return_val_if_fail (iter_is_valid (iter, column_store), FALSE);
+
+  return g_array_index (priv->columns[column].cells, gint,
+                        GPOINTER_TO_UINT (iter->user_data));
+}
+
+/* Sorting */
+
+typedef struct
+{
+  GtkColumnStore *column_store;
+
+  /* The column to compare directly, or NULL to use func */
+  GtkColumnStoreColumn *column;
+  GHashTable *keys;     /* shared string -> collation key */
+
+  GtkTreeIterCompareFunc func;
+  gpointer data;
+
+  gboolean descending;
+} SortData;
+
+#define COMPARE(a, b) ((a) < (b) ? -1 : ((a) > (b) ? 1 : 0))
+
+static void
+sort_data_init (SortData       *sort,
+                GtkColumnStore *column_store,
+                gboolean        use_keys)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  GtkTreeDataSortHeader *header;
+  gint column;
+
+  sort->column_store = column_store;
+  sort->column = NULL;
+  sort->keys = NULL;
+  sort->descending = priv->order == GTK_SORT_DESCENDING;
+
+  if (priv->sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
+    {
+      sort->func = priv->default_sort_func;
+      sort->data = priv->default_sort_data;
+      return;
+    }
+
+  header = _gtk_tree_data_list_get_header (priv->sort_list, priv->sort_column_id);
+  g_assert (header != NULL);
+
+  sort->func = header->func;
+  sort->data = header->data;
+
+  if (header->func != _gtk_tree_data_list_compare_func)
+    return;
+
+  /* The default comparison: compare the column arrays directly,
+   * unless the column type isn't sortable and we want the
+   * warning from _gtk_tree_data_list_compare_func().
+   */
+  column = GPOINTER_TO_INT (header->data);
+  if (column < 0 || column >= priv->n_columns)
+    return;
+
+  switch (priv->columns[column].fundamental)
+    {
+    case G_TYPE_POINTER:
+      return;
+
+    case G_TYPE_STRING:
+      if (use_keys)
+        sort->keys = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+      break;
+
+    default:
+      if (get_cell_size (priv->columns[column].fundamental) == sizeof (GValue))
+        return;
+      break;
+    }
+
+  sort->column = &priv->columns[column];
+}
+
+static void
+sort_data_clear (SortData *sort)
+{
+  if (sort->keys)
+    g_hash_table_destroy (sort->keys);
+}
+
+static const gchar *
+sort_data_get_key (SortData    *sort,
+                   const gchar *string)
+{
+  gchar *key;
+
+  key = g_hash_table_lookup (sort->keys, string);
+  if (key == NULL)
+    {
+      key = g_utf8_collate_key (string ? string : "", -1);
+      g_hash_table_insert (sort->keys, (gpointer) string, key);
+    }
+
+  return key;
+}
+
+static gint
+gtk_column_store_compare_slots (SortData *sort,
+                                guint     a,
+                                guint     b)
+{
+  GtkColumnStoreColumn *column = sort->column;
+  GtkTreeIter iter_a, iter_b;
+  const gchar *stra, *strb;
+  gint retval;
+
+  if (column == NULL)
+    {
+      iter_a.stamp = sort->column_store->priv->stamp;
+      iter_a.user_data = GUINT_TO_POINTER (a);
+      iter_b.stamp = sort->column_store->priv->stamp;
+      iter_b.user_data = GUINT_TO_POINTER (b);
+
+      retval = (* sort->func) (GTK_TREE_MODEL (sort->column_store),
+                               &iter_a, &iter_b, sort->data);
+      retval = COMPARE (retval, 0);
+    }
+  else
+    {
+      switch (column->fundamental)
+        {
+        case G_TYPE_BOOLEAN:
+        case G_TYPE_CHAR:
+        case G_TYPE_INT:
+        case G_TYPE_ENUM:
+          retval = COMPARE (g_array_index (column->cells, gint, a),
+                            g_array_index (column->cells, gint, b));
+          break;
+        case G_TYPE_UCHAR:
+        case G_TYPE_UINT:
+        case G_TYPE_FLAGS:
+          retval = COMPARE (g_array_index (column->cells, guint, a),
+                            g_array_index (column->cells, guint, b));
+          break;
+        case G_TYPE_LONG:
+        case G_TYPE_INT64:
+          retval = COMPARE (g_array_index (column->cells, gint64, a),
+                            g_array_index (column->cells, gint64, b));
+          break;
+        case G_TYPE_ULONG:
+        case G_TYPE_UINT64:
+          retval = COMPARE (g_array_index (column->cells, guint64, a),
+                            g_array_index (column->cells, guint64, b));
+          break;
+        case G_TYPE_FLOAT:
+          retval = COMPARE (g_array_index (column->cells, gfloat, a),
+                            g_array_index (column->cells, gfloat, b));
+          break;
+        case G_TYPE_DOUBLE:
+          retval = COMPARE (g_array_index (column->cells, gdouble, a),
+                            g_array_index (column->cells, gdouble, b));
+          break;
+        case G_TYPE_STRING:
+          stra = g_array_index (column->cells, const gchar *, a);
+          strb = g_array_index (column->cells, const gchar *, b);
+          if (stra == strb)
+            retval = 0;
+          else if (sort->keys)
+            retval = strcmp (sort_data_get_key (sort, stra),
+                             sort_data_get_key (sort, strb));
+          else
+            retval = g_utf8_collate (stra ? stra : "", strb ? strb : "");
+          retval = COMPARE (retval, 0);
+          break;
+        default:
+          g_assert_not_reached ();
+          retval = 0;
+          break;
+        }
+    }
+
+  return sort->descending ? -retval : retval;
+}
+
+static gint
+gtk_column_store_compare_func (gconstpointer a,
+                               gconstpointer b,
+                               gpointer      user_data)
+{
+  return gtk_column_store_compare_slots (user_data,
+                                         *(const guint *) a,
+                                         *(const guint *) b);
+}
+
+static void
+gtk_column_store_sort (GtkColumnStore *column_store)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  GtkTreePath *path;
+  SortData sort;
+  gint *new_order;
+  guint *slots;
+  guint i, n_rows;
+
+  n_rows = priv->rows->len;
+  if (!GTK_COLUMN_STORE_IS_SORTED (column_store) || n_rows <= 1)
+    return;
+
+  slots = g_memdup (priv->rows->data, n_rows * sizeof (guint));
+
+  sort_data_init (&sort, column_store, TRUE);
+  g_qsort_with_data (slots, n_rows, sizeof (guint),
+                     gtk_column_store_compare_func, &sort);
+  sort_data_clear (&sort);
+
+  new_order = g_new (gint, n_rows);
+  for (i = 0; i < n_rows; i++)
+    new_order[i] = gtk_column_store_get_position (column_store, slots[i]);
+  memcpy (priv->rows->data, slots, n_rows * sizeof (guint));
+  g_free (slots);
+
+  gtk_column_store_invalidate_positions (column_store, 0);
+
+  /* Let the world know about our new order */
+  path = gtk_tree_path_new ();
+  gtk_tree_model_rows_reordered (GTK_TREE_MODEL (column_store),
+                                 path, NULL, new_order);
+  gtk_tree_path_free (path);
+  g_free (new_order);
+}
+
+/* Finds the position among the rows where @slot, which is not
+ * one of them, belongs. Equal rows keep their order.
+ */
+static guint
+gtk_column_store_find_sorted_position (GtkColumnStore *column_store,
+                                       guint           slot)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  SortData sort;
+  guint lo, hi, mid;
+
+  sort_data_init (&sort, column_store, FALSE);
+
+  lo = 0;
+  hi = priv->rows->len;
+  while (lo < hi)
+    {
+      mid = lo + (hi - lo) / 2;
+      if (gtk_column_store_compare_slots (&sort, ROW_SLOT (priv, mid), slot) > 0)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+
+  sort_data_clear (&sort);
+
+  return lo;
+}
+
+static gboolean
+iter_is_sorted (GtkColumnStore *column_store,
+                guint           slot)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  SortData sort;
+  guint position;
+  gboolean retval = TRUE;
+
+  position = gtk_column_store_get_position (column_store, slot);
+
+  sort_data_init (&sort, column_store, FALSE);
+
+  if (position > 0 &&
+      gtk_column_store_compare_slots (&sort, ROW_SLOT (priv, position - 1), slot) > 0)
+    retval = FALSE;
+  else if (position + 1 < priv->rows->len &&
+           gtk_column_store_compare_slots (&sort, slot, ROW_SLOT (priv, position + 1)) > 0)
+    retval = FALSE;
+
+  sort_data_clear (&sort);
+
+  return retval;
+}
+
+static void
+gtk_column_store_sort_iter_changed (GtkColumnStore *column_store,
+                                    GtkTreeIter    *iter)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  GtkTreePath *path;
+  gint *new_order;
+  guint slot, old_pos, new_pos, i;
+
+  slot = GPOINTER_TO_UINT (iter->user_data);
+
+  if (iter_is_sorted (column_store, slot))
+    return;
+
+  old_pos = gtk_column_store_get_position (column_store, slot);
+  gtk_column_store_unlink_slot (column_store, slot);
+  new_pos = gtk_column_store_find_sorted_position (column_store, slot);
+  gtk_column_store_link_slot (column_store, slot, new_pos);
+
+  new_order = g_new (gint, priv->rows->len);
+  for (i = 0; i < priv->rows->len; i++)
+    {
+      if (i == new_pos)
+        new_order[i] = old_pos;
+      else if (old_pos < new_pos && i >= old_pos && i < new_pos)
+        new_order[i] = i + 1;
+      else if (new_pos < old_pos && i > new_pos && i <= old_pos)
+        new_order[i] = i - 1;
+      else
+        new_order[i] = i;
+    }
+
+  path = gtk_tree_path_new ();
+  gtk_tree_model_rows_reordered (GTK_TREE_MODEL (column_store),
+                                 path, NULL, new_order);
+  gtk_tree_path_free (path);
+  g_free (new_order);
+}
+
+static gboolean
+gtk_column_store_get_sort_column_id (GtkTreeSortable *sortable,
+                                     gint            *sort_column_id,
+                                     GtkSortType     *order)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (sortable);
+  GtkColumnStorePrivate *priv = column_store->priv;
+
+  if (sort_column_id)
+    * sort_column_id = priv->sort_column_id;
+  if (order)
+    * order = priv->order;
+
+  if (priv->sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID ||
+      priv->sort_column_id == GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID)
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+gtk_column_store_set_sort_column_id (GtkTreeSortable *sortable,
+                                     gint             sort_column_id,
+                                     GtkSortType      order)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (sortable);
+  GtkColumnStorePrivate *priv = column_store->priv;
+
+  if ((priv->sort_column_id == sort_column_id) &&
+      (priv->order == order))
+    return;
+
+  if (sort_column_id != GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID)
+    {
+      if (sort_column_id != GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
+        {
+          GtkTreeDataSortHeader *header = NULL;
+
+          header = _gtk_tree_data_list_get_header (priv->sort_list,
+                                                   sort_column_id);
+
+          /* We want to make sure that we have a function */
+          g_return_if_fail (header != NULL);
+          g_return_if_fail (header->func != NULL);
+        }
+      else
+        {
+          g_return_if_fail (priv->default_sort_func != NULL);
+        }
+    }
+
+  priv->sort_column_id = sort_column_id;
+  priv->order = order;
+
+  gtk_tree_sortable_sort_column_changed (sortable);
+
+  gtk_column_store_sort (column_store);
+}
+
+static void
+gtk_column_store_set_sort_func (GtkTreeSortable        *sortable,
+                                gint                    sort_column_id,
+                                GtkTreeIterCompareFunc  func,
+                                gpointer                data,
+                                GDestroyNotify          destroy)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (sortable);
+  GtkColumnStorePrivate *priv = column_store->priv;
+
+  priv->sort_list = _gtk_tree_data_list_set_header (priv->sort_list,
+                                                    sort_column_id,
+                                                    func, data, destroy);
+
+  if (priv->sort_column_id == sort_column_id)
+    gtk_column_store_sort (column_store);
+}
+
+static void
+gtk_column_store_set_default_sort_func (GtkTreeSortable        *sortable,
+                                        GtkTreeIterCompareFunc  func,
+                                        gpointer                data,
+                                        GDestroyNotify          destroy)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (sortable);
+  GtkColumnStorePrivate *priv = column_store->priv;
+
+  if (priv->default_sort_destroy)
+    {
+      GDestroyNotify d = priv->default_sort_destroy;
+
+      priv->default_sort_destroy = NULL;
+      d (priv->default_sort_data);
+    }
+
+  priv->default_sort_func = func;
+  priv->default_sort_data = data;
+  priv->default_sort_destroy = destroy;
+
+  if (priv->sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
+    gtk_column_store_sort (column_store);
+}
+
+static gboolean
+gtk_column_store_has_default_sort_func (GtkTreeSortable *sortable)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (sortable);
+
+  return (column_store->priv->default_sort_func != NULL);
+}
@@ -0,0 +1,31 @@
+/* gtkcolumnstoreprivate.h
+ * Copyright (C) 2017 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_COLUMN_STORE_PRIVATE_H__
+#define __GTK_COLUMN_STORE_PRIVATE_H__
+
+#include "gtkcolumnstore.h"
+
+G_BEGIN_DECLS
+
+gboolean _gtk_column_store_get_boolean (GtkColumnStore *column_store,
+                                        GtkTreeIter    *iter,
+                                        gint            column);
+
+G_END_DECLS
+
+#endif /* __GTK_COLUMN_STORE_PRIVATE_H__ */
@@ -0,0 +1,426 @@
+/* gtkfilecrawler.c
+ * Copyright (C) 2017 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkfilecrawlerprivate.h"
+
+/* GtkFileCrawler walks a directory tree with a few worker threads.
+ *
+ * Every worker has its own deque of directories. It pushes the
+ * subdirectories it finds at the tail and takes its next directory
+ * from the tail too, so it goes depth first and mostly works on its
+ * own deque without contention. A worker that runs out of directories
+ * steals one from the head of another deque, where the oldest and
+ * usually biggest subtrees are. Workers that find nothing to steal
+ * sleep until a directory is queued, or until all directories are
+ * done, which ends the crawl.
+ *
+ * Directories are enumerated with just the attributes the caller needs
+ * to decide about a match; the match function can query more for the
+ * hits. Hits are handed to the main context in batches. Only a few
+ * batches can wait there; when the main context falls behind, workers
+ * block instead of piling up hits.
+ */
+
+#define BATCH_SIZE 500
+#define MAX_QUEUED_BATCHES 4
+#define MAX_WORKERS 8
+
+typedef struct _Worker Worker;
+
+struct _Worker
+{
+  GtkFileCrawler *crawler;
+  guint index;
+
+  GMutex lock;
+  GQueue directories;
+
+  GList *hits;
+  guint n_processed_files;
+};
+
+struct _GtkFileCrawler
+{
+  GtkFileCrawlerFuncs funcs;
+  gchar *attributes;
+  gpointer user_data;
+  GDestroyNotify destroy;
+
+  GMainContext *context;
+  GCancellable *cancellable;
+  gulong cancelled_id;
+
+  Worker *workers;
+  guint n_workers;
+  gint n_running;
+
+  /* Directories queued or being visited, and queued only */
+  gint n_pending;
+  gint n_queued;
+
+  GMutex idle_lock;
+  GCond idle_cond;
+  guint n_idle;
+
+  GMutex batch_lock;
+  GCond batch_cond;
+  GQueue batches;
+  gboolean flush_queued;
+};
+
+static void
+crawler_invoke (GtkFileCrawler *crawler,
+                GSourceFunc     func,
+                const gchar    *name)
+{
+  GSource *source;
+
+  source = g_idle_source_new ();
+  g_source_set_callback (source, func, crawler, NULL);
+  g_source_set_name (source, name);
+  g_source_attach (source, crawler->context);
+  g_source_unref (source);
+}
+
+static void
+wake_idle_workers (GtkFileCrawler *crawler)
+{
+  g_mutex_lock (&crawler->idle_lock);
+  g_cond_broadcast (&crawler->idle_cond);
+  g_mutex_unlock (&crawler->idle_lock);
+}
+
+static void
+crawler_cancelled (GCancellable   *cancellable,
+                   GtkFileCrawler *crawler)
+{
+  wake_idle_workers (crawler);
+
+  g_mutex_lock (&crawler->batch_lock);
+  g_cond_broadcast (&crawler->batch_cond);
+  g_mutex_unlock (&crawler->batch_lock);
+}
+
+static void
+queue_directory (Worker *worker,
+                 GFile  *dir)
+{
+  GtkFileCrawler *crawler = worker->crawler;
+
+  g_atomic_int_inc (&crawler->n_pending);
+  g_atomic_int_inc (&crawler->n_queued);
+
+  g_mutex_lock (&worker->lock);
+  g_queue_push_tail (&worker->directories, g_object_ref (dir));
+  g_mutex_unlock (&worker->lock);
+
+  g_mutex_lock (&crawler->idle_lock);
+  if (crawler->n_idle > 0)
+    g_cond_signal (&crawler->idle_cond);
+  g_mutex_unlock (&crawler->idle_lock);
+}
+
+static GFile *
+take_directory (Worker *worker)
+{
+  GtkFileCrawler *crawler = worker->crawler;
+  GFile *dir;
+  guint i;
+
+  g_mutex_lock (&worker->lock);
+  dir = g_queue_pop_tail (&worker->directories);
+  g_mutex_unlock (&worker->lock);
+
+  for (i = 1; dir == NULL && i < crawler->n_workers; i++)
+    {
+      Worker *victim = &crawler->workers[(worker->index + i) % crawler->n_workers];
+
+      g_mutex_lock (&victim->lock);
+      dir = g_queue_pop_head (&victim->directories);
+      g_mutex_unlock (&victim->lock);
+    }
+
+  if (dir)
+    g_atomic_int_add (&crawler->n_queued, -1);
+
+  return dir;
+}
+
+static gboolean
+flush_batches (gpointer user_data)
+{
+  GtkFileCrawler *crawler = user_data;
+  GQueue batches;
+  GList *hits;
+
+  g_mutex_lock (&crawler->batch_lock);
+  batches = crawler->batches;
+  g_queue_init (&crawler->batches);
+  crawler->flush_queued = FALSE;
+  g_cond_broadcast (&crawler->batch_cond);
+  g_mutex_unlock (&crawler->batch_lock);
+
+  while ((hits = g_queue_pop_head (&batches)) != NULL)
+    {
+      if (!g_cancellable_is_cancelled (crawler->cancellable))
+        crawler->funcs.hits (hits, crawler->user_data);
+
+      g_list_free_full (hits, crawler->funcs.hit_free);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+send_batch (Worker *worker)
+{
+  GtkFileCrawler *crawler = worker->crawler;
+  GList *hits;
+
+  hits = worker->hits;
+  worker->hits = NULL;
+  worker->n_processed_files = 0;
+
+  if (hits == NULL)
+    return;
+
+  g_mutex_lock (&crawler->batch_lock);
+
+  while (crawler->batches.length >= MAX_QUEUED_BATCHES &&
+         !g_cancellable_is_cancelled (crawler->cancellable))
+    g_cond_wait (&crawler->batch_cond, &crawler->batch_lock);
+
+  if (g_cancellable_is_cancelled (crawler->cancellable))
+    {
+      g_mutex_unlock (&crawler->batch_lock);
+      g_list_free_full (hits, crawler->funcs.hit_free);
+      return;
+    }
+
+  g_queue_push_tail (&crawler->batches, hits);
+  if (!crawler->flush_queued)
+    {
+      crawler->flush_queued = TRUE;
+      crawler_invoke (crawler, flush_batches, "[gtk+] file crawler hits");
+    }
+
+  g_mutex_unlock (&crawler->batch_lock);
+}
+
+static void
+visit_directory (Worker *worker,
+                 GFile  *dir)
+{
+  GtkFileCrawler *crawler = worker->crawler;
+  GFileEnumerator *enumerator;
+  GFileInfo *info;
+  GFile *child;
+  gpointer hit;
+
+  enumerator = g_file_enumerate_children (dir, crawler->attributes,
+                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                          crawler->cancellable, NULL);
+  if (!enumerator)
+    return;
+
+  while (g_file_enumerator_iterate (enumerator, &info, &child, crawler->cancellable, NULL))
+    {
+      if (info == NULL)
+        break;
+
+      hit = crawler->funcs.match (child, info, crawler->cancellable, crawler->user_data);
+      if (hit)
+        worker->hits = g_list_prepend (worker->hits, hit);
+
+      worker->n_processed_files++;
+      if (worker->n_processed_files > BATCH_SIZE)
+        send_batch (worker);
+
+      if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY &&
+          (crawler->funcs.descend == NULL ||
+           crawler->funcs.descend (child, info, crawler->user_data)))
+        queue_directory (worker, child);
+    }
+
+  g_object_unref (enumerator);
+}
+
+static void
+crawler_free (GtkFileCrawler *crawler)
+{
+  GFile *dir;
+  guint i;
+
+  g_cancellable_disconnect (crawler->cancellable, crawler->cancelled_id);
+
+  for (i = 0; i < crawler->n_workers; i++)
+    {
+      Worker *worker = &crawler->workers[i];
+
+      /* Left over after a cancellation */
+      while ((dir = g_queue_pop_head (&worker->directories)) != NULL)
+        g_object_unref (dir);
+
+      g_mutex_clear (&worker->lock);
+    }
+  g_free (crawler->workers);
+
+  if (crawler->destroy)
+    crawler->destroy (crawler->user_data);
+
+  g_mutex_clear (&crawler->idle_lock);
+  g_cond_clear (&crawler->idle_cond);
+  g_mutex_clear (&crawler->batch_lock);
+  g_cond_clear (&crawler->batch_cond);
+
+  g_object_unref (crawler->cancellable);
+  g_main_context_unref (crawler->context);
+  g_free (crawler->attributes);
+
+  g_slice_free (GtkFileCrawler, crawler);
+}
+
+static gboolean
+crawler_done (gpointer user_data)
+{
+  GtkFileCrawler *crawler = user_data;
+
+  flush_batches (crawler);
+
+  if (crawler->funcs.done)
+    crawler->funcs.done (g_cancellable_is_cancelled (crawler->cancellable),
+                         crawler->user_data);
+
+  crawler_free (crawler);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gpointer
+worker_func (gpointer user_data)
+{
+  Worker *worker = user_data;
+  GtkFileCrawler *crawler = worker->crawler;
+  GFile *dir;
+
+  while (!g_cancellable_is_cancelled (crawler->cancellable))
+    {
+      dir = take_directory (worker);
+      if (dir)
+        {
+          visit_directory (worker, dir);
+          g_object_unref (dir);
+
+          if (g_atomic_int_dec_and_test (&crawler->n_pending))
+            wake_idle_workers (crawler);
+
+          continue;
+        }
+
+      /* Nothing to steal; wait for more directories or the end */
+      g_mutex_lock (&crawler->idle_lock);
+      if (g_atomic_int_get (&crawler->n_pending) == 0 ||
+          g_cancellable_is_cancelled (crawler->cancellable))
+        {
+          g_mutex_unlock (&crawler->idle_lock);
+          break;
+        }
+      if (g_atomic_int_get (&crawler->n_queued) <= 0)
+        {
+          crawler->n_idle++;
+          g_cond_wait (&crawler->idle_cond, &crawler->idle_lock);
+          crawler->n_idle--;
+        }
+      g_mutex_unlock (&crawler->idle_lock);
+    }
+
+  send_batch (worker);
+
+  /* The crawler is freed in the main context after this */
+  if (g_atomic_int_dec_and_test (&crawler->n_running))
+    crawler_invoke (crawler, crawler_done, "[gtk+] file crawler done");
+
+  return NULL;
+}
+
+/* Starts crawling @root, or nothing if it is %NULL. @attributes must
+ * include the file type. Pass 0 as @n_workers for one worker per
+ * processor. The crawler frees itself after calling the done function.
+ */
+GtkFileCrawler *
+_gtk_file_crawler_start (GFile                     *root,
+                         const gchar               *attributes,
+                         guint                      n_workers,
+                         const GtkFileCrawlerFuncs *funcs,
+                         gpointer                   user_data,
+                         GDestroyNotify             destroy)
+{
+  GtkFileCrawler *crawler;
+  guint i;
+
+  g_return_val_if_fail (root == NULL || G_IS_FILE (root), NULL);
+  g_return_val_if_fail (funcs->match != NULL && funcs->hits != NULL, NULL);
+
+  if (n_workers == 0)
+    n_workers = CLAMP (g_get_num_processors (), 1, MAX_WORKERS);
+
+  crawler = g_slice_new0 (GtkFileCrawler);
+  crawler->funcs = *funcs;
+  crawler->attributes = g_strdup (attributes);
+  crawler->user_data = user_data;
+  crawler->destroy = destroy;
+
+  crawler->context = g_main_context_ref_thread_default ();
+  crawler->cancellable = g_cancellable_new ();
+  crawler->cancelled_id = g_cancellable_connect (crawler->cancellable,
+                                                 G_CALLBACK (crawler_cancelled),
+                                                 crawler, NULL);
+
+  g_mutex_init (&crawler->idle_lock);
+  g_cond_init (&crawler->idle_cond);
+  g_mutex_init (&crawler->batch_lock);
+  g_cond_init (&crawler->batch_cond);
+  g_queue_init (&crawler->batches);
+
+  crawler->n_workers = n_workers;
+  crawler->workers = g_new0 (Worker, n_workers);
+  for (i = 0; i < n_workers; i++)
+    {
+      crawler->workers[i].crawler = crawler;
+      crawler->workers[i].index = i;
+      g_mutex_init (&crawler->workers[i].lock);
+      g_queue_init (&crawler->workers[i].directories);
+    }
+
+  if (root)
+    queue_directory (&crawler->workers[0], root);
+
+  crawler->n_running = n_workers;
+  for (i = 0; i < n_workers; i++)
+    g_thread_unref (g_thread_new ("file-crawler", worker_func, &crawler->workers[i]));
+
+  return crawler;
+}
+
+/* The done function is still called, from the main context */
+void
+_gtk_file_crawler_cancel (GtkFileCrawler *crawler)
+{
+  g_cancellable_cancel (crawler->cancellable);
+}
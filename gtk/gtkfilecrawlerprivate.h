@@ -0,0 +1,57 @@
+/* gtkfilecrawlerprivate.h
+ * Copyright (C) 2017 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_FILE_CRAWLER_PRIVATE_H__
+#define __GTK_FILE_CRAWLER_PRIVATE_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GtkFileCrawler GtkFileCrawler;
+
+typedef struct
+{
+  /* Called in the worker threads */
+  gpointer (* match)   (GFile        *file,
+                        GFileInfo    *info,
+                        GCancellable *cancellable,
+                        gpointer      user_data);
+  gboolean (* descend) (GFile        *dir,
+                        GFileInfo    *info,
+                        gpointer      user_data);
+
+  /* Called in the main context the crawler was started in */
+  void     (* hits)    (GList        *hits,
+                        gpointer      user_data);
+  void     (* done)    (gboolean      cancelled,
+                        gpointer      user_data);
+
+  GDestroyNotify hit_free;
+} GtkFileCrawlerFuncs;
+
+GtkFileCrawler *_gtk_file_crawler_start  (GFile                     *root,
+                                          const gchar               *attributes,
+                                          guint                      n_workers,
+                                          const GtkFileCrawlerFuncs *funcs,
+                                          gpointer                   user_data,
+                                          GDestroyNotify             destroy);
+void            _gtk_file_crawler_cancel (GtkFileCrawler            *crawler);
+
+G_END_DECLS
+
+#endif /* __GTK_FILE_CRAWLER_PRIVATE_H__ */
@@ -639,6 +639,57 @@ _gtk_file_filter_get_as_patterns (GtkFileFilter      *filter)
   return (char **)g_ptr_array_free (array, FALSE);
 }
 
+/* Returns a copy of @filter that can be used from another thread while
+ * @filter gets changed, or %NULL if @filter has custom rules, which call
+ * back into the application.
+ */
+GtkFileFilter *
+_gtk_file_filter_copy_for_thread (GtkFileFilter *filter)
+{
+  GtkFileFilter *copy;
+  GSList *tmp_list;
+
+  for (tmp_list = filter->rules; tmp_list; tmp_list = tmp_list->next)
+    {
+      FilterRule *rule = tmp_list->data;
+
+      if (rule->type == FILTER_RULE_CUSTOM)
+        return NULL;
+    }
+
+  copy = g_object_ref_sink (gtk_file_filter_new ());
+
+  for (tmp_list = filter->rules; tmp_list; tmp_list = tmp_list->next)
+    {
+      FilterRule *rule = tmp_list->data;
+      FilterRule *rule_copy;
+
+      rule_copy = g_slice_new (FilterRule);
+      rule_copy->type = rule->type;
+      rule_copy->needed = rule->needed;
+
+      switch (rule->type)
+        {
+        case FILTER_RULE_MIME_TYPE:
+          rule_copy->u.mime_type = g_strdup (rule->u.mime_type);
+          break;
+        case FILTER_RULE_PATTERN:
+          rule_copy->u.pattern = g_strdup (rule->u.pattern);
+          break;
+        case FILTER_RULE_PIXBUF_FORMATS:
+          rule_copy->u.pixbuf_formats = g_slist_copy (rule->u.pixbuf_formats);
+          break;
+        case FILTER_RULE_CUSTOM:
+        default:
+          g_assert_not_reached ();
+        }
+
+      file_filter_add_rule (copy, rule_copy);
+    }
+
+  return copy;
+}
+
 /**
  * gtk_file_filter_filter:
  * @filter: a #GtkFileFilter
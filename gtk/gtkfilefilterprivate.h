@@ -24,6 +24,7 @@
 G_BEGIN_DECLS
 
 char ** _gtk_file_filter_get_as_patterns (GtkFileFilter      *filter);
+GtkFileFilter * _gtk_file_filter_copy_for_thread (GtkFileFilter      *filter);
 
 G_END_DECLS
 
@@ -23,6 +23,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "gtkfilefilterprivate.h"
 #include "gtkfilesystem.h"
 #include "gtkintl.h"
 #include "gtkmarshalers.h"
@@ -115,6 +116,13 @@
  * freeze_updates()) during the intial population process.  When the model is
  * frozen, sorting will not happen.  The model will sort itself when the freeze
  * count goes back to zero, via corresponding calls to thaw_updates().
+ *
+ * When loading a directory, each batch of files from the enumerator is
+ * prepared in a thread: the GFiles are created there, and the filter runs
+ * there too unless it has custom rules, which call into the application.
+ * The main thread then sorts just the batch and merges it into the sorted
+ * array in one pass, see add_files_batch(), and announces each run of new
+ * consecutive rows with a single rows-inserted emission.
  */
 
 /*** DEFINES ***/
@@ -151,7 +159,6 @@ struct _GtkFileSystemModel
   GObject               parent_instance;
 
   GFile *               dir;            /* directory that's displayed */
-  guint                 dir_thaw_source;/* GSource id for unfreezing the model */
   char *                attributes;     /* attributes the file info must contain, or NULL for all attributes */
   GFileMonitor *        dir_monitor;    /* directory that is monitored, or NULL if monitoring was not supported */
 
@@ -310,6 +317,19 @@ emit_row_inserted_for_node (GtkFileSystemModel *model, guint id)
   gtk_tree_path_free (path);
 }
 
+/* The @n_rows visible rows from the node @id on are new */
+static void
+emit_rows_inserted_for_nodes (GtkFileSystemModel *model, guint id, gint n_rows)
+{
+  GtkTreePath *path;
+  GtkTreeIter iter;
+
+  path = tree_path_new_from_node (model, id);
+  ITER_INIT_FROM_INDEX (model, &iter, id);
+  gtk_tree_model_rows_inserted (GTK_TREE_MODEL (model), path, &iter, n_rows);
+  gtk_tree_path_free (path);
+}
+
 static void
 emit_row_changed_for_node (GtkFileSystemModel *model, guint id)
 {
@@ -371,10 +391,14 @@ node_set_visible_and_filtered_out (GtkFileSystemModel *model, guint id, gboolean
     }
 }
 
+/* Also used from the threads that prepare batches of files, see
+ * files_batch_thread(); it must not touch the model.
+ */
 static gboolean
-node_should_be_filtered_out (GtkFileSystemModel *model, guint id)
+file_is_filtered_out (GtkFileFilter *filter,
+                      GFile         *file,
+                      GFileInfo     *info)
 {
-  FileModelNode *node = get_node (model, id);
   GtkFileFilterInfo filter_info = { 0, };
   GtkFileFilterFlags required;
   gboolean result;
@@ -382,21 +406,21 @@ node_should_be_filtered_out (GtkFileSystemModel *model, guint id)
   char *filename = NULL;
   char *uri = NULL;
 
-  if (node->info == NULL)
+  if (info == NULL)
     return TRUE;
 
-  if (model->filter == NULL)
+  if (filter == NULL)
     return FALSE;
 
   /* fill info */
-  required = gtk_file_filter_get_needed (model->filter);
+  required = gtk_file_filter_get_needed (filter);
 
   filter_info.contains = GTK_FILE_FILTER_DISPLAY_NAME;
-  filter_info.display_name = g_file_info_get_display_name (node->info);
+  filter_info.display_name = g_file_info_get_display_name (info);
 
   if (required & GTK_FILE_FILTER_MIME_TYPE)
     {
-      const char *s = g_file_info_get_content_type (node->info);
+      const char *s = g_file_info_get_content_type (info);
       if (s)
 	{
 	  mime_type = g_content_type_get_mime_type (s);
@@ -410,7 +434,7 @@ node_should_be_filtered_out (GtkFileSystemModel *model, guint id)
 
   if (required & GTK_FILE_FILTER_FILENAME)
     {
-      filename = g_file_get_path (node->file);
+      filename = g_file_get_path (file);
       if (filename)
         {
           filter_info.filename = filename;
@@ -420,7 +444,7 @@ node_should_be_filtered_out (GtkFileSystemModel *model, guint id)
 
   if (required & GTK_FILE_FILTER_URI)
     {
-      uri = g_file_get_uri (node->file);
+      uri = g_file_get_uri (file);
       if (uri)
         {
           filter_info.uri = uri;
@@ -428,7 +452,7 @@ node_should_be_filtered_out (GtkFileSystemModel *model, guint id)
         }
     }
 
-  result = !gtk_file_filter_filter (model->filter, &filter_info);
+  result = !gtk_file_filter_filter (filter, &filter_info);
 
   g_free (mime_type);
   g_free (filename);
@@ -437,6 +461,14 @@ node_should_be_filtered_out (GtkFileSystemModel *model, guint id)
   return result;
 }
 
+static gboolean
+node_should_be_filtered_out (GtkFileSystemModel *model, guint id)
+{
+  FileModelNode *node = get_node (model, id);
+
+  return file_is_filtered_out (model->filter, node->file, node->info);
+}
+
 static gboolean
 node_should_be_visible (GtkFileSystemModel *model, guint id, gboolean filtered_out)
 {
@@ -1023,12 +1055,6 @@ gtk_file_system_model_dispose (GObject *object)
 {
   GtkFileSystemModel *model = GTK_FILE_SYSTEM_MODEL (object);
 
-  if (model->dir_thaw_source)
-    {
-      g_source_remove (model->dir_thaw_source);
-      model->dir_thaw_source = 0;
-    }
-
   g_cancellable_cancel (model->cancellable);
   if (model->dir_monitor)
     g_file_monitor_cancel (model->dir_monitor);
@@ -1118,69 +1144,327 @@ gtk_file_system_model_closed_enumerator (GObject *object, GAsyncResult *res, gpo
   g_file_enumerator_close_finish (G_FILE_ENUMERATOR (object), res, NULL);
 }
 
-static gboolean
-thaw_func (gpointer data)
+typedef struct _FilesBatch FilesBatch;
+struct _FilesBatch {
+  GFileEnumerator *     enumerator;
+  GFile *               dir;
+  GtkFileFilter *       model_filter;   /* the model's filter when the batch was made */
+  GtkFileFilter *       filter;         /* copy of it applied in the thread, or NULL */
+  GArray *              entries;        /* BatchEntry */
+};
+
+typedef struct {
+  GFile *               file;           /* NULL if the info has no name */
+  GFileInfo *           info;
+  gboolean              filtered_out;   /* only set if the batch has a filter */
+} BatchEntry;
+
+/* Takes over the infos */
+static FilesBatch *
+files_batch_new (GtkFileSystemModel *model,
+                 GFileEnumerator    *enumerator,
+                 GList              *infos)
 {
-  GtkFileSystemModel *model = data;
+  FilesBatch *batch;
+  GList *walk;
 
-  thaw_updates (model);
-  model->dir_thaw_source = 0;
+  batch = g_slice_new0 (FilesBatch);
+  batch->enumerator = g_object_ref (enumerator);
+  batch->dir = g_object_ref (model->dir);
+  if (model->filter)
+    {
+      batch->model_filter = g_object_ref (model->filter);
+      batch->filter = _gtk_file_filter_copy_for_thread (model->filter);
+    }
 
-  return FALSE;
+  batch->entries = g_array_sized_new (FALSE, FALSE, sizeof (BatchEntry), g_list_length (infos));
+  for (walk = infos; walk; walk = walk->next)
+    {
+      BatchEntry entry = { NULL, walk->data, FALSE };
+
+      g_array_append_val (batch->entries, entry);
+    }
+  g_list_free (infos);
+
+  return batch;
 }
 
 static void
-gtk_file_system_model_got_files (GObject *object, GAsyncResult *res, gpointer data)
+files_batch_free (gpointer data)
 {
-  GFileEnumerator *enumerator = G_FILE_ENUMERATOR (object);
-  GtkFileSystemModel *model = data;
-  GList *walk, *files;
-  GError *error = NULL;
+  FilesBatch *batch = data;
+  guint i;
 
-  gdk_threads_enter ();
+  for (i = 0; i < batch->entries->len; i++)
+    {
+      BatchEntry *entry = &g_array_index (batch->entries, BatchEntry, i);
 
-  files = g_file_enumerator_next_files_finish (enumerator, res, &error);
+      if (entry->file)
+        g_object_unref (entry->file);
+      g_object_unref (entry->info);
+    }
+  g_array_free (batch->entries, TRUE);
 
-  if (files)
+  if (batch->filter)
+    g_object_unref (batch->filter);
+  if (batch->model_filter)
+    g_object_unref (batch->model_filter);
+  g_object_unref (batch->dir);
+  g_object_unref (batch->enumerator);
+
+  g_slice_free (FilesBatch, batch);
+}
+
+static void
+files_batch_thread (GTask        *task,
+                    gpointer      source_object,
+                    gpointer      task_data,
+                    GCancellable *cancellable)
+{
+  FilesBatch *batch = task_data;
+  guint i;
+
+  for (i = 0; i < batch->entries->len; i++)
     {
-      if (model->dir_thaw_source == 0)
+      BatchEntry *entry = &g_array_index (batch->entries, BatchEntry, i);
+      const char *name;
+
+      if (g_cancellable_is_cancelled (cancellable))
+        break;
+
+      name = g_file_info_get_name (entry->info);
+      if (name == NULL)
         {
-          freeze_updates (model);
-          model->dir_thaw_source = gdk_threads_add_timeout_full (IO_PRIORITY + 1,
-                                                                 50,
-                                                                 thaw_func,
-                                                                 model,
-                                                                 NULL);
-          g_source_set_name_by_id (model->dir_thaw_source, "[gtk+] thaw_func");
+          /* Shouldn't happen, but the APIs allow it */
+          continue;
         }
 
-      for (walk = files; walk; walk = walk->next)
+      entry->file = g_file_get_child (batch->dir, name);
+      if (batch->filter)
+        entry->filtered_out = file_is_filtered_out (batch->filter, entry->file, entry->info);
+    }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+/* The nodes from @start on were just added and are sorted, and so are
+ * the ones before.  Finds the place of every new node with a binary
+ * search, then moves all nodes in a single pass from the end.
+ *
+ * Returns: the index of the first new node
+ */
+static guint
+merge_sorted_nodes (GtkFileSystemModel *model,
+                    guint               start,
+                    SortData           *data)
+{
+  guint n_added, i, lo, hi, mid, src, dest, n_move;
+  guint *positions;
+  gchar *added;
+
+  n_added = model->files->len - start;
+  positions = g_new (guint, n_added);
+
+  /* The new nodes are sorted, so each search starts where the last one
+   * ended.  Index 0 is the editable row, which is not sorted.
+   */
+  lo = 1;
+  for (i = 0; i < n_added; i++)
+    {
+      hi = start;
+      while (lo < hi)
         {
-          const char *name;
-          GFileInfo *info;
-          GFile *file;
-          
-          info = walk->data;
-          name = g_file_info_get_name (info);
-          if (name == NULL)
+          mid = lo + (hi - lo) / 2;
+          if (compare_array_element (get_node (model, mid), get_node (model, start + i), data) <= 0)
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+      positions[i] = lo;
+    }
+
+  added = g_memdup (get_node (model, start), n_added * model->node_size);
+
+  src = start;
+  dest = model->files->len;
+  for (i = n_added; i-- > 0; )
+    {
+      n_move = src - positions[i];
+      src = positions[i];
+      dest -= n_move;
+      memmove (get_node (model, dest), get_node (model, src), n_move * model->node_size);
+
+      dest--;
+      memcpy (get_node (model, dest), added + i * model->node_size, model->node_size);
+    }
+
+  g_assert (dest == positions[0]);
+
+  g_free (added);
+  g_free (positions);
+
+  return dest;
+}
+
+/* Adds the files of a batch prepared by files_batch_thread().  Instead
+ * of sorting all files again, only the batch is sorted and merged in.
+ */
+static void
+add_files_batch (GtkFileSystemModel *model,
+                 FilesBatch         *batch)
+{
+  FileModelNode *node;
+  SortData data;
+  gboolean filtered;
+  guint start, first, run_start, i;
+  gint n_run;
+
+  if (model->frozen)
+    {
+      for (i = 0; i < batch->entries->len; i++)
+        {
+          BatchEntry *entry = &g_array_index (batch->entries, BatchEntry, i);
+
+          if (entry->file)
+            add_file (model, entry->file, entry->info);
+        }
+      return;
+    }
+
+  start = model->files->len;
+  for (i = 0; i < batch->entries->len; i++)
+    {
+      BatchEntry *entry = &g_array_index (batch->entries, BatchEntry, i);
+
+      if (entry->file == NULL)
+        continue;
+
+      g_array_set_size (model->files, model->files->len + 1);
+      node = get_node (model, model->files->len - 1);
+      memset (node, 0, model->node_size);
+      node->file = g_object_ref (entry->file);
+      node->info = g_object_ref (entry->info);
+      node->filtered_out = entry->filtered_out;
+      /* not announced yet */
+      node->frozen_add = TRUE;
+    }
+
+  if (model->files->len == start)
+    return;
+
+  first = start;
+  if (sort_data_init (&data, model))
+    {
+      g_qsort_with_data (get_node (model, start),
+                         model->files->len - start,
+                         model->node_size,
+                         compare_array_element,
+                         &data);
+      first = merge_sorted_nodes (model, start, &data);
+      if (first < start)
+        g_hash_table_remove_all (model->file_lookup);
+    }
+
+  /* The new nodes are not visible yet, so the rows of the others did
+   * not change, only the new nodes need their rows computed.
+   */
+  node_invalidate_index (model, first);
+
+  /* The filter may have changed while the batch was prepared */
+  filtered = batch->filter != NULL && batch->model_filter == model->filter;
+
+  /* New visible nodes with only hidden nodes between them are
+   * consecutive rows, announced together.
+   */
+  run_start = 0;
+  n_run = 0;
+  for (i = first; i < model->files->len; i++)
+    {
+      gboolean filtered_out;
+
+      node = get_node (model, i);
+      if (!node->frozen_add)
+        {
+          if (node->visible && n_run > 0)
             {
-              /* Shouldn't happen, but the APIs allow it */
-              g_object_unref (info);
-              continue;
+              emit_rows_inserted_for_nodes (model, run_start, n_run);
+              n_run = 0;
             }
-          file = g_file_get_child (model->dir, name);
-          add_file (model, file, info);
-          g_object_unref (file);
-          g_object_unref (info);
+          continue;
         }
-      g_list_free (files);
 
-      g_file_enumerator_next_files_async (enumerator,
-					  g_file_is_native (model->dir) ? 50 * FILES_PER_QUERY : FILES_PER_QUERY,
-					  IO_PRIORITY,
-					  model->cancellable,
-					  gtk_file_system_model_got_files,
-					  model);
+      node->frozen_add = FALSE;
+      if (filtered)
+        filtered_out = node->filtered_out;
+      else
+        filtered_out = node_should_be_filtered_out (model, i);
+      node->filtered_out = filtered_out;
+
+      if (!node_should_be_visible (model, i, filtered_out))
+        continue;
+
+      node->visible = TRUE;
+      if (n_run++ == 0)
+        {
+          run_start = i;
+          node_invalidate_index (model, i);
+        }
+    }
+
+  if (n_run > 0)
+    emit_rows_inserted_for_nodes (model, run_start, n_run);
+}
+
+static void gtk_file_system_model_got_files (GObject      *object,
+                                             GAsyncResult *res,
+                                             gpointer      data);
+
+static void
+gtk_file_system_model_got_batch (GObject *object, GAsyncResult *res, gpointer data)
+{
+  GtkFileSystemModel *model = GTK_FILE_SYSTEM_MODEL (object);
+  FilesBatch *batch;
+
+  if (!g_task_propagate_boolean (G_TASK (res), NULL))
+    return;
+
+  batch = g_task_get_task_data (G_TASK (res));
+
+  gdk_threads_enter ();
+
+  add_files_batch (model, batch);
+
+  g_file_enumerator_next_files_async (batch->enumerator,
+                                      g_file_is_native (model->dir) ? 50 * FILES_PER_QUERY : FILES_PER_QUERY,
+                                      IO_PRIORITY,
+                                      model->cancellable,
+                                      gtk_file_system_model_got_files,
+                                      model);
+
+  gdk_threads_leave ();
+}
+
+static void
+gtk_file_system_model_got_files (GObject *object, GAsyncResult *res, gpointer data)
+{
+  GFileEnumerator *enumerator = G_FILE_ENUMERATOR (object);
+  GtkFileSystemModel *model = data;
+  GList *files;
+  GError *error = NULL;
+
+  gdk_threads_enter ();
+
+  files = g_file_enumerator_next_files_finish (enumerator, res, &error);
+
+  if (files)
+    {
+      GTask *task;
+
+      /* The next files are asked for once this batch is in the model */
+      task = g_task_new (model, model->cancellable, gtk_file_system_model_got_batch, NULL);
+      g_task_set_task_data (task, files_batch_new (model, enumerator, files), files_batch_free);
+      g_task_run_in_thread (task, files_batch_thread);
+      g_object_unref (task);
     }
   else
     {
@@ -1191,12 +1475,6 @@ gtk_file_system_model_got_files (GObject *object, GAsyncResult *res, gpointer da
                                          model->cancellable,
                                          gtk_file_system_model_closed_enumerator,
                                          NULL);
-          if (model->dir_thaw_source != 0)
-            {
-              g_source_remove (model->dir_thaw_source);
-              model->dir_thaw_source = 0;
-              thaw_updates (model);
-            }
 
           g_signal_emit (model, file_system_model_signals[FINISHED_LOADING], 0, error);
         }
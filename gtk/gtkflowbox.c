@@ -72,6 +72,9 @@
 #include <config.h>
 
 #include "gtkflowbox.h"
+#include "gtkbitmaskprivate.h"
+#include "gtkflowlinesprivate.h"
+#include "gtkvirtualrangeprivate.h"
 #include "gtkmarshalers.h"
 #include "gtkprivate.h"
 #include "gtkorientableprivate.h"
@@ -110,6 +113,29 @@ static void gtk_flow_box_bound_model_changed (GListModel *list,
                                               gpointer    user_data);
 
 static void gtk_flow_box_check_model_compat  (GtkFlowBox *box);
+static void gtk_flow_box_insert_css_node     (GtkFlowBox    *box,
+                                              GtkWidget     *child,
+                                              GSequenceIter *iter);
+
+static gboolean         gtk_flow_box_is_virtual                 (GtkFlowBox      *box);
+static guint            gtk_flow_box_virtual_get_position       (GtkFlowBox      *box,
+                                                                 GtkFlowBoxChild *child);
+static void             gtk_flow_box_virtual_measure_child      (GtkWidget       *widget,
+                                                                 GtkWidget       *child);
+static GtkFlowBoxChild *gtk_flow_box_virtual_get_cursor_target  (GtkFlowBox      *box,
+                                                                 GtkMovementStep  step,
+                                                                 gint             count);
+static void             gtk_flow_box_virtual_measure            (GtkFlowBox      *box,
+                                                                 GtkOrientation   orientation,
+                                                                 gint             for_size,
+                                                                 gint            *minimum,
+                                                                 gint            *natural);
+static void             gtk_flow_box_virtual_allocate           (GtkFlowBox          *box,
+                                                                 const GtkAllocation *allocation);
+static void             gtk_flow_box_virtual_queue_update       (GtkFlowBox      *box);
+static void             gtk_flow_box_virtual_clear              (GtkFlowBox      *box);
+
+static const GtkVirtualRangeFuncs virtual_range_funcs;
 
 static void
 get_current_selection_modifiers (GtkWidget *widget,
@@ -671,6 +697,9 @@ gtk_flow_box_child_new (void)
  *
  * Gets the current index of the @child in its #GtkFlowBox container.
  *
+ * For a model bound with gtk_flow_box_bind_model_virtual(), this is
+ * the position of the item that @child currently shows.
+ *
  * Returns: the index of the @child, or -1 if the @child is not
  *     in a flow box.
  *
@@ -680,13 +709,20 @@ gint
 gtk_flow_box_child_get_index (GtkFlowBoxChild *child)
 {
   GtkFlowBoxChildPrivate *priv;
+  GtkFlowBox *box;
 
   g_return_val_if_fail (GTK_IS_FLOW_BOX_CHILD (child), -1);
 
   priv = CHILD_PRIV (child);
 
   if (priv->iter != NULL)
-    return g_sequence_iter_get_position (priv->iter);
+    {
+      box = gtk_flow_box_child_get_box (child);
+      if (box != NULL && gtk_flow_box_is_virtual (box))
+        return gtk_flow_box_virtual_get_position (box, child);
+
+      return g_sequence_iter_get_position (priv->iter);
+    }
 
   return -1;
 }
@@ -745,6 +781,13 @@ gtk_flow_box_child_changed (GtkFlowBoxChild *child)
   if (box == NULL)
     return;
 
+  /* The item of the child may have a different size now */
+  if (gtk_flow_box_is_virtual (box))
+    {
+      gtk_flow_box_virtual_measure_child (GTK_WIDGET (box), GTK_WIDGET (child));
+      return;
+    }
+
   gtk_flow_box_apply_sort (box, child);
   gtk_flow_box_apply_filter (box, child);
 }
@@ -754,6 +797,7 @@ gtk_flow_box_child_changed (GtkFlowBoxChild *child)
 /* Constants {{{2 */
 
 #define DEFAULT_MAX_CHILDREN_PER_LINE 7
+#define VIRTUAL_INITIAL_CHILDREN 64
 #define RUBBERBAND_START_DISTANCE 32
 #define AUTOSCROLL_FAST_DISTANCE 32
 #define AUTOSCROLL_FACTOR 20
@@ -843,6 +887,13 @@ struct _GtkFlowBoxPrivate {
   GtkFlowBoxCreateWidgetFunc  create_widget_func;
   gpointer                    create_widget_func_data;
   GDestroyNotify              create_widget_func_data_destroy;
+
+  /* Virtualized models, see gtk_flow_box_bind_model_virtual() */
+  GtkFlowBoxBindChildFunc     bind_child_func;
+  GtkFlowLines               *lines;
+  gint                        homogeneous_width;
+  gint                        homogeneous_height;
+  GtkVirtualRange             range;
 };
 
 #define BOX_PRIV(box) ((GtkFlowBoxPrivate*)gtk_flow_box_get_instance_private ((GtkFlowBox*)(box)))
@@ -979,19 +1030,36 @@ gtk_flow_box_apply_sort (GtkFlowBox      *box,
 
 /* Selection utilities {{{3 */
 
+static void
+gtk_flow_box_child_update_selected (GtkFlowBoxChild *child,
+                                    gboolean         selected)
+{
+  CHILD_PRIV (child)->selected = selected;
+  if (selected)
+    gtk_widget_set_state_flags (GTK_WIDGET (child),
+                                GTK_STATE_FLAG_SELECTED, FALSE);
+  else
+    gtk_widget_unset_state_flags (GTK_WIDGET (child),
+                                  GTK_STATE_FLAG_SELECTED);
+}
+
 static gboolean
 gtk_flow_box_child_set_selected (GtkFlowBoxChild *child,
                                  gboolean         selected)
 {
+  GtkFlowBox *box;
+
   if (CHILD_PRIV (child)->selected != selected)
     {
-      CHILD_PRIV (child)->selected = selected;
-      if (selected)
-        gtk_widget_set_state_flags (GTK_WIDGET (child),
-                                    GTK_STATE_FLAG_SELECTED, FALSE);
-      else
-        gtk_widget_unset_state_flags (GTK_WIDGET (child),
-                                      GTK_STATE_FLAG_SELECTED);
+      gtk_flow_box_child_update_selected (child, selected);
+
+      /* Virtualized children only show the selection of their position */
+      box = gtk_flow_box_child_get_box (child);
+      if (box != NULL && BOX_PRIV (box)->bind_child_func != NULL)
+        BOX_PRIV (box)->range.selected_positions =
+          _gtk_bitmask_set (BOX_PRIV (box)->range.selected_positions,
+                            gtk_flow_box_virtual_get_position (box, child),
+                            selected);
 
       return TRUE;
     }
@@ -1017,6 +1085,14 @@ gtk_flow_box_unselect_all_internal (GtkFlowBox *box)
       dirty |= gtk_flow_box_child_set_selected (child, FALSE);
     }
 
+  if (BOX_PRIV (box)->bind_child_func != NULL &&
+      !_gtk_bitmask_is_empty (BOX_PRIV (box)->range.selected_positions))
+    {
+      _gtk_bitmask_free (BOX_PRIV (box)->range.selected_positions);
+      BOX_PRIV (box)->range.selected_positions = _gtk_bitmask_new ();
+      dirty = TRUE;
+    }
+
   return dirty;
 }
 
@@ -1042,6 +1118,8 @@ gtk_flow_box_update_cursor (GtkFlowBox      *box,
                             GtkFlowBoxChild *child)
 {
   BOX_PRIV (box)->cursor_child = child;
+  if (BOX_PRIV (box)->bind_child_func != NULL)
+    BOX_PRIV (box)->range.cursor_position = gtk_flow_box_virtual_get_position (box, child);
   gtk_widget_grab_focus (GTK_WIDGET (child));
   gtk_widget_queue_draw (GTK_WIDGET (child));
   _gtk_flow_box_accessible_update_cursor (GTK_WIDGET (box), GTK_WIDGET (child));
@@ -1073,6 +1151,19 @@ gtk_flow_box_select_all_between (GtkFlowBox      *box,
 {
   GSequenceIter *iter, *iter1, *iter2;
 
+  if (BOX_PRIV (box)->bind_child_func != NULL)
+    {
+      if (_gtk_flow_lines_get_n_items (BOX_PRIV (box)->lines) == 0)
+        return;
+
+      _gtk_virtual_range_select_range (&BOX_PRIV (box)->range,
+                                       child1 ? gtk_flow_box_virtual_get_position (box, child1) : 0,
+                                       child2 ? gtk_flow_box_virtual_get_position (box, child2)
+                                              : _gtk_flow_lines_get_n_items (BOX_PRIV (box)->lines) - 1,
+                                       modify);
+      return;
+    }
+
   if (child1)
     iter1 = CHILD_PRIV (child1)->iter;
   else
@@ -1143,7 +1234,14 @@ gtk_flow_box_update_selection (GtkFlowBox      *box,
       if (extend)
         {
           gtk_flow_box_unselect_all_internal (box);
-          if (priv->selected_child == NULL)
+
+          /* The child of the anchor may have been recycled */
+          if (priv->selected_child == NULL && priv->range.selected_position >= 0 &&
+              priv->bind_child_func != NULL)
+            _gtk_virtual_range_select_range (&priv->range, priv->range.selected_position,
+                                             gtk_flow_box_virtual_get_position (box, child),
+                                             FALSE);
+          else if (priv->selected_child == NULL)
             {
               gtk_flow_box_child_set_selected (child, TRUE);
               priv->selected_child = child;
@@ -1658,6 +1756,13 @@ gtk_flow_box_allocate (GtkCssGadget        *gadget,
   gint i, this_line_size;
   GSequenceIter *iter;
 
+  if (priv->bind_child_func != NULL)
+    {
+      gtk_flow_box_virtual_allocate (box, allocation);
+      gtk_container_get_children_clip (GTK_CONTAINER (widget), out_clip);
+      return;
+    }
+
   min_items = MAX (1, priv->min_children_per_line);
 
   if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
@@ -2135,6 +2240,12 @@ gtk_flow_box_measure (GtkCssGadget   *gadget,
   GtkFlowBox *box = GTK_FLOW_BOX (widget);
   GtkFlowBoxPrivate *priv = BOX_PRIV (box);
 
+  if (priv->bind_child_func != NULL)
+    {
+      gtk_flow_box_virtual_measure (box, orientation, for_size, minimum, natural);
+      return;
+    }
+
   if (orientation == GTK_ORIENTATION_HORIZONTAL)
     {
       if (for_size < 0)
@@ -3344,6 +3455,10 @@ gtk_flow_box_focus (GtkWidget        *widget,
     {
       if (BOX_PRIV (box)->selected_child)
         next_focus_child = BOX_PRIV (box)->selected_child;
+      else if (BOX_PRIV (box)->bind_child_func != NULL &&
+               BOX_PRIV (box)->range.cursor_position >= 0)
+        next_focus_child = GTK_FLOW_BOX_CHILD (_gtk_virtual_range_realize_position (&BOX_PRIV (box)->range,
+                                                                                    BOX_PRIV (box)->range.cursor_position));
       else
         {
           if (direction == GTK_DIR_UP || direction == GTK_DIR_TAB_BACKWARD)
@@ -3477,7 +3592,9 @@ gtk_flow_box_move_cursor (GtkFlowBox      *box,
     }
 
   child = NULL;
-  switch (step)
+  if (priv->bind_child_func != NULL)
+    child = gtk_flow_box_virtual_get_cursor_target (box, step, count);
+  else switch (step)
     {
     case GTK_MOVEMENT_VISUAL_POSITIONS:
       if (priv->cursor_child != NULL)
@@ -3704,6 +3821,7 @@ gtk_flow_box_set_property (GObject      *object,
         {
           priv->orientation = g_value_get_enum (value);
           _gtk_orientable_set_style_classes (GTK_ORIENTABLE (box));
+          gtk_flow_box_check_model_compat (box);
           /* Re-box the children in the new orientation */
           gtk_widget_queue_resize (GTK_WIDGET (box));
           g_object_notify_by_pspec (object, pspec);
@@ -3748,6 +3866,9 @@ gtk_flow_box_finalize (GObject *obj)
 
   g_sequence_free (priv->children);
   g_clear_object (&priv->hadjustment);
+  if (priv->vadjustment)
+    g_signal_handlers_disconnect_by_func (priv->vadjustment,
+                                          gtk_flow_box_virtual_queue_update, obj);
   g_clear_object (&priv->vadjustment);
 
   g_object_unref (priv->drag_gesture);
@@ -3762,6 +3883,9 @@ gtk_flow_box_finalize (GObject *obj)
       g_clear_object (&priv->bound_model);
     }
 
+  g_clear_pointer (&priv->lines, _gtk_flow_lines_free);
+  _gtk_virtual_range_clear (&priv->range);
+
   g_clear_object (&priv->gadget);
 
   G_OBJECT_CLASS (gtk_flow_box_parent_class)->finalize (obj);
@@ -4116,6 +4240,8 @@ gtk_flow_box_init (GtkFlowBox *box)
   _gtk_orientable_set_style_classes (GTK_ORIENTABLE (box));
 
   priv->children = g_sequence_new (NULL);
+  _gtk_virtual_range_init (&priv->range, GTK_WIDGET (box), &virtual_range_funcs,
+                           priv->children, VIRTUAL_INITIAL_CHILDREN);
 
   priv->multipress_gesture = gtk_gesture_multi_press_new (GTK_WIDGET (box));
   gtk_gesture_single_set_touch_only (GTK_GESTURE_SINGLE (priv->multipress_gesture),
@@ -4153,6 +4279,494 @@ gtk_flow_box_init (GtkFlowBox *box)
                                                      NULL);
 }
 
+/* Virtualized models {{{2 */
+
+/* With gtk_flow_box_bind_model_virtual(), children only exist for a
+ * window of the model around the visible area. The lines are broken by
+ * GtkFlowLines, from the sizes of the items that had a child at some
+ * point and an estimate for the others. Changes to the model only break
+ * the lines around the changed items again.
+ *
+ * The window of children, and selection and cursor, are kept by
+ * GtkVirtualRange, the same as for GtkListBox.
+ */
+
+static gboolean
+gtk_flow_box_is_virtual (GtkFlowBox *box)
+{
+  return BOX_PRIV (box)->bind_child_func != NULL;
+}
+
+static guint
+gtk_flow_box_virtual_get_position (GtkFlowBox      *box,
+                                   GtkFlowBoxChild *child)
+{
+  return _gtk_virtual_range_get_position (&BOX_PRIV (box)->range, CHILD_PRIV (child)->iter);
+}
+
+/* The size of items that were not measured; in homogeneous boxes,
+ * of all items: the largest one measured so far
+ */
+static void
+gtk_flow_box_virtual_get_item_size (GtkFlowBox *box,
+                                    gint       *width,
+                                    gint       *height)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+
+  if (priv->homogeneous)
+    {
+      *width = priv->homogeneous_width;
+      *height = priv->homogeneous_height;
+    }
+  else
+    _gtk_flow_lines_get_estimate (priv->lines, width, height);
+}
+
+/* The lines are broken again the next time they are looked at */
+static void
+gtk_flow_box_virtual_set_width (GtkFlowBox *box,
+                                gint        width)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+
+  if (priv->homogeneous)
+    _gtk_flow_lines_set_estimate (priv->lines,
+                                  priv->homogeneous_width,
+                                  priv->homogeneous_height);
+  _gtk_flow_lines_set_params (priv->lines,
+                              MAX (width, 0),
+                              priv->column_spacing,
+                              priv->row_spacing,
+                              priv->min_children_per_line,
+                              priv->max_children_per_line,
+                              priv->homogeneous);
+}
+
+/* Returns the height of the lines for @width. Breaking them again is
+ * O(n_items), so unless they already are broken for @width, this is
+ * estimated from the estimated item size. Only allocating breaks them.
+ */
+static gint
+gtk_flow_box_virtual_get_height_for_width (GtkFlowBox *box,
+                                           gint        width)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  gint item_width, item_height;
+  gint column_spacing, row_spacing;
+  guint n_items, min_items, per_line, n_lines;
+
+  width = MAX (width, 0);
+  n_items = _gtk_flow_lines_get_n_items (priv->lines);
+  if (n_items == 0)
+    return 0;
+
+  _gtk_flow_lines_get_estimate (priv->lines, &item_width, &item_height);
+  if (width == _gtk_flow_lines_get_width (priv->lines) &&
+      (!priv->homogeneous ||
+       (item_width == priv->homogeneous_width && item_height == priv->homogeneous_height)))
+    return _gtk_flow_lines_get_height (priv->lines);
+
+  gtk_flow_box_virtual_get_item_size (box, &item_width, &item_height);
+  column_spacing = priv->column_spacing;
+  row_spacing = priv->row_spacing;
+
+  min_items = MAX (priv->min_children_per_line, 1);
+  per_line = (width + column_spacing) / MAX (item_width + column_spacing, 1);
+  per_line = MAX (per_line, min_items);
+  if (priv->max_children_per_line > 0)
+    per_line = MIN (per_line, MAX (priv->max_children_per_line, min_items));
+
+  n_lines = (n_items + per_line - 1) / per_line;
+
+  return n_lines * item_height + (n_lines - 1) * row_spacing;
+}
+
+/* Records the size of the item that @child shows. Homogeneous boxes
+ * give every child the size of the largest one; the lines take it over
+ * when they are allocated, so measuring many children breaks them once.
+ */
+static void
+gtk_flow_box_virtual_measure_child (GtkWidget *widget,
+                                    GtkWidget *child)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (widget);
+  gint width, height;
+  gint estimated_width, estimated_height;
+  gboolean changed;
+
+  gtk_widget_get_preferred_width (child, NULL, &width);
+  gtk_widget_get_preferred_height_for_width (child, width, NULL, &height);
+
+  changed = _gtk_flow_lines_set_item_size (priv->lines,
+                                           gtk_flow_box_virtual_get_position (GTK_FLOW_BOX (widget),
+                                                                              GTK_FLOW_BOX_CHILD (child)),
+                                           width, height);
+
+  if (priv->homogeneous)
+    changed = width > priv->homogeneous_width || height > priv->homogeneous_height;
+  else
+    {
+      _gtk_flow_lines_get_estimate (priv->lines, &estimated_width, &estimated_height);
+      if (estimated_width == 0 && estimated_height == 0)
+        _gtk_flow_lines_set_estimate (priv->lines, width, height);
+    }
+
+  /* Also kept when not homogeneous, for when that changes */
+  priv->homogeneous_width = MAX (width, priv->homogeneous_width);
+  priv->homogeneous_height = MAX (height, priv->homogeneous_height);
+
+  if (changed)
+    gtk_widget_queue_resize (widget);
+}
+
+static GtkWidget *
+gtk_flow_box_virtual_create_child (GtkWidget *widget,
+                                   gpointer   item)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (widget);
+  GtkWidget *child, *box_child;
+
+  child = priv->create_widget_func (item, priv->create_widget_func_data);
+  if (g_object_is_floating (child))
+    g_object_ref_sink (child);
+  gtk_widget_show (child);
+
+  if (GTK_IS_FLOW_BOX_CHILD (child))
+    return child;
+
+  box_child = g_object_ref_sink (gtk_flow_box_child_new ());
+  gtk_widget_show (box_child);
+  gtk_container_add (GTK_CONTAINER (box_child), child);
+  g_object_unref (child);
+
+  return box_child;
+}
+
+static void
+gtk_flow_box_virtual_bind_child (GtkWidget *widget,
+                                 GtkWidget *child,
+                                 gpointer   item)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (widget);
+
+  priv->bind_child_func (GTK_FLOW_BOX_CHILD (child), item, priv->create_widget_func_data);
+}
+
+static void
+gtk_flow_box_virtual_insert_child (GtkWidget *widget,
+                                   GtkWidget *child,
+                                   gboolean   prepend)
+{
+  gtk_flow_box_insert (GTK_FLOW_BOX (widget), child, prepend ? 0 : -1);
+}
+
+static void
+gtk_flow_box_virtual_remove_child (GtkWidget *widget,
+                                   GtkWidget *child)
+{
+  /* Not a change of the selection */
+  if (CHILD_PRIV (child)->selected)
+    gtk_flow_box_child_update_selected (GTK_FLOW_BOX_CHILD (child), FALSE);
+
+  gtk_container_remove (GTK_CONTAINER (widget), child);
+}
+
+static void
+gtk_flow_box_virtual_move_child (GtkWidget *widget,
+                                 GtkWidget *child,
+                                 gboolean   to_end)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (widget);
+
+  g_sequence_move (CHILD_PRIV (child)->iter,
+                   to_end ? g_sequence_get_end_iter (priv->children)
+                          : g_sequence_get_begin_iter (priv->children));
+  gtk_flow_box_insert_css_node (GTK_FLOW_BOX (widget), child, CHILD_PRIV (child)->iter);
+}
+
+static void
+gtk_flow_box_virtual_release_child (GtkWidget *widget,
+                                    GtkWidget *child,
+                                    guint      position)
+{
+  GtkFlowBox *box = GTK_FLOW_BOX (widget);
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  GtkFlowBoxChild *box_child = GTK_FLOW_BOX_CHILD (child);
+
+  /* Keep the keyboard focus in the box while the cursor is scrolled away */
+  if (gtk_container_get_focus_child (GTK_CONTAINER (box)) == child)
+    gtk_widget_grab_focus (widget);
+
+  if (box_child == priv->cursor_child)
+    priv->cursor_child = NULL;
+  if (box_child == priv->selected_child)
+    {
+      priv->selected_child = NULL;
+      priv->range.selected_position = position;
+    }
+  if (box_child == priv->active_child)
+    {
+      priv->active_child = NULL;
+      priv->active_child_active = FALSE;
+    }
+  if (box_child == priv->rubberband_first || box_child == priv->rubberband_last)
+    gtk_flow_box_stop_rubberband (box);
+}
+
+static void
+gtk_flow_box_virtual_sync_child (GtkWidget *widget,
+                                 GtkWidget *child,
+                                 guint      position)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (widget);
+  GtkFlowBoxChild *box_child = GTK_FLOW_BOX_CHILD (child);
+  gboolean selected;
+
+  selected = _gtk_bitmask_get (priv->range.selected_positions, position);
+  if (CHILD_PRIV (box_child)->selected != selected)
+    gtk_flow_box_child_update_selected (box_child, selected);
+
+  if ((gint) position == priv->range.selected_position && priv->selected_child == NULL)
+    priv->selected_child = box_child;
+
+  if ((gint) position == priv->range.cursor_position && priv->cursor_child != box_child)
+    {
+      priv->cursor_child = box_child;
+      if (gtk_widget_has_focus (widget))
+        gtk_widget_grab_focus (child);
+    }
+}
+
+/* Moves the window of children to the lines around the visible area */
+static void
+gtk_flow_box_virtual_update (GtkWidget *widget)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (widget);
+  GtkAllocation allocation;
+  guint n_items, first, last;
+  gdouble value, page_size;
+
+  if (priv->bind_child_func == NULL)
+    return;
+
+  n_items = _gtk_flow_lines_get_n_items (priv->lines);
+
+  if (n_items == 0)
+    {
+      first = last = 0;
+    }
+  else if (priv->vadjustment == NULL ||
+           gtk_adjustment_get_page_size (priv->vadjustment) <= 0)
+    {
+      first = MIN (priv->range.first_position, n_items - 1);
+      last = MIN (first + MAX (g_sequence_get_length (priv->children), VIRTUAL_INITIAL_CHILDREN),
+                  n_items);
+    }
+  else
+    {
+      /* One page above and below the visible one */
+      gtk_widget_get_allocation (widget, &allocation);
+      page_size = gtk_adjustment_get_page_size (priv->vadjustment);
+      value = gtk_adjustment_get_value (priv->vadjustment) - allocation.y;
+
+      _gtk_flow_lines_get_line (priv->lines,
+                                _gtk_flow_lines_get_line_at_y (priv->lines, value - page_size),
+                                &first, NULL, NULL, NULL);
+      _gtk_flow_lines_get_line (priv->lines,
+                                _gtk_flow_lines_get_line_at_y (priv->lines, value + 2 * page_size),
+                                NULL, &last, NULL, NULL);
+    }
+
+  _gtk_virtual_range_set_range (&priv->range, first, last);
+}
+
+static const GtkVirtualRangeFuncs virtual_range_funcs = {
+  gtk_flow_box_virtual_create_child,
+  gtk_flow_box_virtual_bind_child,
+  gtk_flow_box_virtual_insert_child,
+  gtk_flow_box_virtual_remove_child,
+  gtk_flow_box_virtual_move_child,
+  gtk_flow_box_virtual_release_child,
+  gtk_flow_box_virtual_sync_child,
+  gtk_flow_box_virtual_measure_child,
+  NULL,
+  gtk_flow_box_virtual_update
+};
+
+static void
+gtk_flow_box_virtual_queue_update (GtkFlowBox *box)
+{
+  _gtk_virtual_range_queue_update (&BOX_PRIV (box)->range);
+}
+
+static void
+gtk_flow_box_virtual_items_changed (GtkFlowBox *box,
+                                    guint       position,
+                                    guint       removed,
+                                    guint       added)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+
+  _gtk_flow_lines_splice (priv->lines, position, removed, added);
+
+  /* Anchor and cursor follow their items */
+  if (priv->selected_child != NULL)
+    priv->range.selected_position = gtk_flow_box_virtual_get_position (box, priv->selected_child);
+  priv->selected_child = NULL;
+
+  if (priv->cursor_child != NULL)
+    priv->range.cursor_position = gtk_flow_box_virtual_get_position (box, priv->cursor_child);
+  priv->cursor_child = NULL;
+
+  _gtk_virtual_range_items_changed (&priv->range, position, removed, added);
+}
+
+/* Returns the position in @line that is closest to the column of @position */
+static guint
+gtk_flow_box_virtual_get_position_in_line (GtkFlowBox *box,
+                                           guint       position,
+                                           gint        line)
+{
+  GtkFlowLines *lines = BOX_PRIV (box)->lines;
+  guint start, end, column;
+
+  _gtk_flow_lines_get_line (lines, _gtk_flow_lines_get_line_of_item (lines, position),
+                            &start, NULL, NULL, NULL);
+  column = position - start;
+
+  line = CLAMP (line, 0, (gint) _gtk_flow_lines_get_n_lines (lines) - 1);
+  _gtk_flow_lines_get_line (lines, line, &start, &end, NULL, NULL);
+
+  return MIN (start + column, end - 1);
+}
+
+static GtkFlowBoxChild *
+gtk_flow_box_virtual_get_cursor_target (GtkFlowBox      *box,
+                                        GtkMovementStep  step,
+                                        gint             count)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  guint n_items;
+  gint target, line, x, y, width, height, page_size;
+
+  n_items = _gtk_flow_lines_get_n_items (priv->lines);
+  if (n_items == 0)
+    return NULL;
+
+  if (priv->range.cursor_position < 0 && step != GTK_MOVEMENT_BUFFER_ENDS)
+    return NULL;
+
+  switch (step)
+    {
+    case GTK_MOVEMENT_VISUAL_POSITIONS:
+      if (gtk_widget_get_direction (GTK_WIDGET (box)) == GTK_TEXT_DIR_RTL)
+        count = - count;
+      target = priv->range.cursor_position + count;
+      break;
+    case GTK_MOVEMENT_BUFFER_ENDS:
+      target = count < 0 ? 0 : n_items - 1;
+      break;
+    case GTK_MOVEMENT_DISPLAY_LINES:
+      line = _gtk_flow_lines_get_line_of_item (priv->lines, priv->range.cursor_position);
+      target = gtk_flow_box_virtual_get_position_in_line (box, priv->range.cursor_position, line + count);
+      break;
+    case GTK_MOVEMENT_PAGES:
+      page_size = 100;
+      if (priv->vadjustment != NULL)
+        page_size = gtk_adjustment_get_page_increment (priv->vadjustment);
+      _gtk_flow_lines_get_item_area (priv->lines, priv->range.cursor_position, &x, &y, &width, &height);
+      line = _gtk_flow_lines_get_line_at_y (priv->lines, y + count * page_size);
+      target = gtk_flow_box_virtual_get_position_in_line (box, priv->range.cursor_position, line);
+      break;
+    default:
+      return NULL;
+    }
+
+  target = CLAMP (target, 0, (gint) n_items - 1);
+  if (target == priv->range.cursor_position)
+    return priv->cursor_child;
+
+  return GTK_FLOW_BOX_CHILD (_gtk_virtual_range_realize_position (&priv->range, target));
+}
+
+static void
+gtk_flow_box_virtual_measure (GtkFlowBox     *box,
+                              GtkOrientation  orientation,
+                              gint            for_size,
+                              gint           *minimum,
+                              gint           *natural)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  gint item_width, item_height, min_items, nat_items;
+  gint min_width, nat_width;
+
+  /* Lines only get as wide as the estimated items */
+  gtk_flow_box_virtual_get_item_size (box, &item_width, &item_height);
+  min_items = MAX (1, priv->min_children_per_line);
+  nat_items = MAX (min_items, priv->max_children_per_line);
+  min_width = min_items * item_width + (min_items - 1) * priv->column_spacing;
+  nat_width = nat_items * item_width + (nat_items - 1) * priv->column_spacing;
+
+  if (orientation == GTK_ORIENTATION_HORIZONTAL)
+    {
+      *minimum = min_width;
+      *natural = nat_width;
+    }
+  else
+    {
+      *minimum = *natural = gtk_flow_box_virtual_get_height_for_width (box, for_size < 0 ? nat_width : for_size);
+    }
+}
+
+static void
+gtk_flow_box_virtual_allocate (GtkFlowBox          *box,
+                               const GtkAllocation *allocation)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  GtkAllocation child_allocation;
+  GSequenceIter *iter;
+  GtkWidget *child;
+  guint position;
+
+  gtk_flow_box_virtual_set_width (box, allocation->width);
+
+  for (iter = g_sequence_get_begin_iter (priv->children), position = priv->range.first_position;
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter), position++)
+    {
+      child = g_sequence_get (iter);
+
+      _gtk_flow_lines_get_item_area (priv->lines, position,
+                                     &child_allocation.x, &child_allocation.y,
+                                     &child_allocation.width, &child_allocation.height);
+      if (gtk_widget_get_direction (GTK_WIDGET (box)) == GTK_TEXT_DIR_RTL)
+        child_allocation.x = allocation->width - child_allocation.x - child_allocation.width;
+      child_allocation.x += allocation->x;
+      child_allocation.y += allocation->y;
+
+      gtk_widget_size_allocate (child, &child_allocation);
+    }
+}
+
+static void
+gtk_flow_box_virtual_clear (GtkFlowBox *box)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+
+  if (priv->bind_child_func == NULL)
+    return;
+
+  _gtk_virtual_range_clear (&priv->range);
+  g_clear_pointer (&priv->lines, _gtk_flow_lines_free);
+
+  priv->bind_child_func = NULL;
+  priv->homogeneous_width = 0;
+  priv->homogeneous_height = 0;
+
+  gtk_widget_set_can_focus (GTK_WIDGET (box), FALSE);
+}
+
 static void
 gtk_flow_box_bound_model_changed (GListModel *list,
                                   guint       position,
@@ -4164,6 +4778,12 @@ gtk_flow_box_bound_model_changed (GListModel *list,
   GtkFlowBoxPrivate *priv = BOX_PRIV (box);
   gint i;
 
+  if (priv->bind_child_func != NULL)
+    {
+      gtk_flow_box_virtual_items_changed (box, position, removed, added);
+      return;
+    }
+
   while (removed--)
     {
       GtkFlowBoxChild *child;
@@ -4303,6 +4923,10 @@ gtk_flow_box_insert (GtkFlowBox *box,
  *
  * Gets the nth child in the @box.
  *
+ * For a model bound with gtk_flow_box_bind_model_virtual(), @idx
+ * is the position in the model, and %NULL is also returned if there
+ * currently is no child for it.
+ *
  * Returns: (transfer none) (nullable): the child widget, which will
  *     always be a #GtkFlowBoxChild or %NULL in case no child widget
  *     with the given index exists.
@@ -4317,8 +4941,15 @@ gtk_flow_box_get_child_at_index (GtkFlowBox *box,
 
   g_return_val_if_fail (GTK_IS_FLOW_BOX (box), NULL);
 
+  if (BOX_PRIV (box)->bind_child_func != NULL)
+    {
+      if (idx < (gint) BOX_PRIV (box)->range.first_position)
+        return NULL;
+      idx -= BOX_PRIV (box)->range.first_position;
+    }
+
   iter = g_sequence_get_iter_at_pos (BOX_PRIV (box)->children, idx);
-  if (iter)
+  if (!g_sequence_iter_is_end (iter))
     return g_sequence_get (iter);
 
   return NULL;
@@ -4393,9 +5024,20 @@ gtk_flow_box_set_vadjustment (GtkFlowBox    *box,
 
   g_object_ref (adjustment);
   if (priv->vadjustment)
-    g_object_unref (priv->vadjustment);
+    {
+      g_signal_handlers_disconnect_by_func (priv->vadjustment,
+                                            gtk_flow_box_virtual_queue_update, box);
+      g_object_unref (priv->vadjustment);
+    }
   priv->vadjustment = adjustment;
   gtk_container_set_focus_vadjustment (GTK_CONTAINER (box), adjustment);
+
+  /* Virtualized models follow the visible area */
+  g_signal_connect_swapped (adjustment, "value-changed",
+                            G_CALLBACK (gtk_flow_box_virtual_queue_update), box);
+  g_signal_connect_swapped (adjustment, "changed",
+                            G_CALLBACK (gtk_flow_box_virtual_queue_update), box);
+  gtk_flow_box_virtual_queue_update (box);
 }
 
 static void
@@ -4406,6 +5048,60 @@ gtk_flow_box_check_model_compat (GtkFlowBox *box)
   if (priv->bound_model &&
       (priv->sort_func || priv->filter_func))
     g_warning ("GtkFlowBox with a model will ignore sort and filter functions");
+
+  if (priv->bind_child_func && priv->orientation == GTK_ORIENTATION_VERTICAL)
+    g_warning ("GtkFlowBox with a virtualized model will lay out its children horizontally");
+}
+
+static void
+gtk_flow_box_do_bind_model (GtkFlowBox                 *box,
+                            GListModel                 *model,
+                            GtkFlowBoxCreateWidgetFunc  create_widget_func,
+                            GtkFlowBoxBindChildFunc     bind_child_func,
+                            gpointer                    user_data,
+                            GDestroyNotify              user_data_free_func)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+
+  if (priv->bound_model)
+    {
+      if (priv->create_widget_func_data_destroy)
+        priv->create_widget_func_data_destroy (priv->create_widget_func_data);
+
+      g_signal_handlers_disconnect_by_func (priv->bound_model, gtk_flow_box_bound_model_changed, box);
+      g_clear_object (&priv->bound_model);
+    }
+
+  gtk_flow_box_forall (GTK_CONTAINER (box), FALSE, (GtkCallback) gtk_widget_destroy, NULL);
+  gtk_flow_box_virtual_clear (box);
+
+  if (model == NULL)
+    return;
+
+  priv->bound_model = g_object_ref (model);
+  priv->create_widget_func = create_widget_func;
+  priv->create_widget_func_data = user_data;
+  priv->create_widget_func_data_destroy = user_data_free_func;
+
+  if (bind_child_func != NULL)
+    {
+      priv->bind_child_func = bind_child_func;
+      priv->lines = _gtk_flow_lines_new ();
+      _gtk_flow_lines_splice (priv->lines, 0, 0, g_list_model_get_n_items (model));
+      _gtk_virtual_range_bind (&priv->range, model);
+
+      /* Holds the focus while the cursor child is scrolled away */
+      gtk_widget_set_can_focus (GTK_WIDGET (box), TRUE);
+    }
+
+  gtk_flow_box_check_model_compat (box);
+
+  g_signal_connect (priv->bound_model, "items-changed", G_CALLBACK (gtk_flow_box_bound_model_changed), box);
+
+  if (bind_child_func != NULL)
+    gtk_flow_box_virtual_update (GTK_WIDGET (box));
+  else
+    gtk_flow_box_bound_model_changed (model, 0, 0, g_list_model_get_n_items (model), box);
 }
 
 /**
@@ -4442,35 +5138,63 @@ gtk_flow_box_bind_model (GtkFlowBox                 *box,
                          gpointer                    user_data,
                          GDestroyNotify              user_data_free_func)
 {
-  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
-
   g_return_if_fail (GTK_IS_FLOW_BOX (box));
   g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
   g_return_if_fail (model == NULL || create_widget_func != NULL);
 
-  if (priv->bound_model)
-    {
-      if (priv->create_widget_func_data_destroy)
-        priv->create_widget_func_data_destroy (priv->create_widget_func_data);
-
-      g_signal_handlers_disconnect_by_func (priv->bound_model, gtk_flow_box_bound_model_changed, box);
-      g_clear_object (&priv->bound_model);
-    }
-
-  gtk_flow_box_forall (GTK_CONTAINER (box), FALSE, (GtkCallback) gtk_widget_destroy, NULL);
-
-  if (model == NULL)
-    return;
-
-  priv->bound_model = g_object_ref (model);
-  priv->create_widget_func = create_widget_func;
-  priv->create_widget_func_data = user_data;
-  priv->create_widget_func_data_destroy = user_data_free_func;
+  gtk_flow_box_do_bind_model (box, model, create_widget_func, NULL,
+                              user_data, user_data_free_func);
+}
 
-  gtk_flow_box_check_model_compat (box);
+/**
+ * gtk_flow_box_bind_model_virtual:
+ * @box: a #GtkFlowBox
+ * @model: (allow-none): the #GListModel to be bound to @box
+ * @create_widget_func: a function that creates widgets for items
+ * @bind_child_func: a function that makes a child show another item
+ * @user_data: user data passed to @create_widget_func and @bind_child_func
+ * @user_data_free_func: function for freeing @user_data
+ *
+ * Binds @model to @box like gtk_flow_box_bind_model(), but only creates
+ * children for the lines in and around the visible part of @box. When
+ * @box is scrolled, children that are no longer needed are handed to
+ * @bind_child_func to show another item instead of creating new ones.
+ * This makes it possible to bind models with a large number of items.
+ *
+ * For this to work, the vertical adjustment of the scrolled window
+ * that @box is in has to be set with gtk_flow_box_set_vadjustment().
+ * The lines are broken from the natural size of the items that had a
+ * child, and the size of the first one for the others; changes to
+ * @model only break the lines around the changed items again. Children
+ * get their natural width and the height of their line. If the content
+ * of a child changes its size, call gtk_flow_box_child_changed().
+ *
+ * The selection and the cursor refer to positions in @model. Functions
+ * that work with children, like gtk_flow_box_get_selected_children(),
+ * only see the children that currently exist; use
+ * gtk_flow_box_get_selected_positions() to get the complete selection.
+ * gtk_flow_box_get_child_at_index() and gtk_flow_box_child_get_index()
+ * use positions in @model.
+ *
+ * Only the horizontal orientation is supported in this mode.
+ *
+ * Since: 3.90
+ */
+void
+gtk_flow_box_bind_model_virtual (GtkFlowBox                 *box,
+                                 GListModel                 *model,
+                                 GtkFlowBoxCreateWidgetFunc  create_widget_func,
+                                 GtkFlowBoxBindChildFunc     bind_child_func,
+                                 gpointer                    user_data,
+                                 GDestroyNotify              user_data_free_func)
+{
+  g_return_if_fail (GTK_IS_FLOW_BOX (box));
+  g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
+  g_return_if_fail (model == NULL || create_widget_func != NULL);
+  g_return_if_fail (model == NULL || bind_child_func != NULL);
 
-  g_signal_connect (priv->bound_model, "items-changed", G_CALLBACK (gtk_flow_box_bound_model_changed), box);
-  gtk_flow_box_bound_model_changed (model, 0, 0, g_list_model_get_n_items (model), box);
+  gtk_flow_box_do_bind_model (box, model, create_widget_func, bind_child_func,
+                              user_data, user_data_free_func);
 }
 
 /* Setters and getters {{{2 */
@@ -4778,6 +5502,53 @@ gtk_flow_box_get_selected_children (GtkFlowBox *box)
   return g_list_reverse (selected);
 }
 
+/**
+ * gtk_flow_box_get_selected_positions:
+ * @box: a #GtkFlowBox
+ * @n_positions: (out): return location for the number of positions
+ *
+ * Gets the positions of all selected items of a model that was bound
+ * with gtk_flow_box_bind_model_virtual(), including the ones that
+ * currently have no child. For other boxes, the indexes of the selected
+ * children are returned.
+ *
+ * Returns: (array length=n_positions) (transfer full) (nullable): the
+ *   positions in ascending order, or %NULL if nothing is selected.
+ *   Free with g_free().
+ *
+ * Since: 3.90
+ */
+guint *
+gtk_flow_box_get_selected_positions (GtkFlowBox *box,
+                                     guint      *n_positions)
+{
+  GtkFlowBoxPrivate *priv;
+  GSequenceIter *iter;
+  GArray *positions;
+  guint i;
+
+  g_return_val_if_fail (GTK_IS_FLOW_BOX (box), NULL);
+  g_return_val_if_fail (n_positions != NULL, NULL);
+
+  priv = BOX_PRIV (box);
+  positions = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  if (priv->bind_child_func != NULL)
+    _gtk_virtual_range_get_selected (&priv->range, positions);
+  else
+    {
+      for (iter = g_sequence_get_begin_iter (priv->children), i = 0;
+           !g_sequence_iter_is_end (iter);
+           iter = g_sequence_iter_next (iter), i++)
+        if (CHILD_PRIV (g_sequence_get (iter))->selected)
+          g_array_append_val (positions, i);
+    }
+
+  *n_positions = positions->len;
+
+  return (guint *) g_array_free (positions, positions->len == 0);
+}
+
 /**
  * gtk_flow_box_select_child:
  * @box: a #GtkFlowBox
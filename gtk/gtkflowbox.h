@@ -114,6 +114,25 @@ struct _GtkFlowBoxChildClass
 typedef GtkWidget * (*GtkFlowBoxCreateWidgetFunc) (gpointer item,
                                                    gpointer  user_data);
 
+/**
+ * GtkFlowBoxBindChildFunc:
+ * @child: the child to update
+ * @item: (type GObject): the item from the model that @child should show
+ * @user_data: (closure): user data
+ *
+ * Called for flow boxes that are bound to a #GListModel with
+ * gtk_flow_box_bind_model_virtual() when a child that was created for
+ * one item is reused for another item.
+ *
+ * @child is the widget returned by the #GtkFlowBoxCreateWidgetFunc, or
+ * the child that was created around it if that was not a #GtkFlowBoxChild.
+ *
+ * Since: 3.90
+ */
+typedef void (*GtkFlowBoxBindChildFunc) (GtkFlowBoxChild *child,
+                                         gpointer         item,
+                                         gpointer         user_data);
+
 GDK_AVAILABLE_IN_3_12
 GType                 gtk_flow_box_child_get_type            (void) G_GNUC_CONST;
 GDK_AVAILABLE_IN_3_12
@@ -138,6 +157,16 @@ void                  gtk_flow_box_bind_model                (GtkFlowBox
                                                               GtkFlowBoxCreateWidgetFunc  create_widget_func,
                                                               gpointer                    user_data,
                                                               GDestroyNotify              user_data_free_func);
+GDK_AVAILABLE_IN_3_90
+void                  gtk_flow_box_bind_model_virtual        (GtkFlowBox                 *box,
+                                                              GListModel                 *model,
+                                                              GtkFlowBoxCreateWidgetFunc  create_widget_func,
+                                                              GtkFlowBoxBindChildFunc     bind_child_func,
+                                                              gpointer                    user_data,
+                                                              GDestroyNotify              user_data_free_func);
+GDK_AVAILABLE_IN_3_90
+guint *               gtk_flow_box_get_selected_positions    (GtkFlowBox                 *box,
+                                                              guint                      *n_positions);
 
 GDK_AVAILABLE_IN_3_12
 void                  gtk_flow_box_set_homogeneous           (GtkFlowBox           *box,
@@ -0,0 +1,481 @@
+/* gtkflowlines.c
+ * Copyright (C) 2017 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkflowlinesprivate.h"
+
+#include <string.h>
+
+/* GtkFlowLines breaks a list of items into lines of a given width, the
+ * way GtkFlowBox does it for virtualized models. Every item has a size;
+ * items that were never measured use the estimate instead, and in
+ * homogeneous mode all items do. Lines are filled greedily: an item
+ * goes on the current line if it fits, or if the line has fewer than
+ * the minimum number of items.
+ *
+ * For every line, the first item, the y and the height are kept. When
+ * items change, the lines are only broken again from the line of the
+ * first changed item until a line starts at the same item as before,
+ * after the changed items. From there on, the old lines are reused,
+ * shifted to their new positions.
+ *
+ * Changing the width or the estimate breaks all lines again; that only
+ * happens the next time the lines are looked at, so setting both costs
+ * one pass over the items.
+ */
+
+typedef struct
+{
+  gint width;
+  gint height;
+} ItemSize;
+
+typedef struct
+{
+  guint start;
+  gint y;
+  gint height;
+} Line;
+
+struct _GtkFlowLines
+{
+  GArray *items;        /* ItemSize, -1 if not measured */
+  GArray *lines;        /* Line */
+
+  gint width;
+  gint column_spacing;
+  gint row_spacing;
+  guint min_per_line;
+  guint max_per_line;
+  gboolean homogeneous;
+
+  gint estimated_width;
+  gint estimated_height;
+
+  guint needs_reflow : 1;
+};
+
+#define ITEM(lines,position) g_array_index ((lines)->items, ItemSize, (position))
+#define LINE(array,i) g_array_index ((array), Line, (i))
+
+static gint
+item_width (GtkFlowLines *lines,
+            guint         position)
+{
+  gint width = ITEM (lines, position).width;
+
+  return width < 0 || lines->homogeneous ? lines->estimated_width : width;
+}
+
+static gint
+item_height (GtkFlowLines *lines,
+             guint         position)
+{
+  gint height = ITEM (lines, position).height;
+
+  return height < 0 || lines->homogeneous ? lines->estimated_height : height;
+}
+
+/* Returns the last line starting at or before @position */
+static guint
+find_line (GArray *array,
+           guint   position)
+{
+  guint lo = 0, hi = array->len;
+
+  while (hi - lo > 1)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (LINE (array, mid).start <= position)
+        lo = mid;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+/* Fills a line starting at @start, returns the first item of the next one */
+static guint
+break_line (GtkFlowLines *lines,
+            guint         start,
+            gint         *height)
+{
+  guint n_items = lines->items->len;
+  guint min_items, max_items;
+  guint end;
+  gint used, needed;
+
+  min_items = MAX (lines->min_per_line, 1);
+  max_items = lines->max_per_line > 0 ? MAX (lines->max_per_line, min_items) : G_MAXUINT;
+
+  used = 0;
+  *height = 0;
+  for (end = start; end < n_items && end - start < max_items; end++)
+    {
+      needed = item_width (lines, end);
+      if (end > start)
+        needed += used + lines->column_spacing;
+
+      if (end - start >= min_items && needed > lines->width)
+        break;
+
+      used = needed;
+      *height = MAX (*height, item_height (lines, end));
+    }
+
+  return end;
+}
+
+/* Breaks the lines again after the items from @position on changed:
+ * @removed items were replaced by @added ones.
+ */
+static void
+reflow (GtkFlowLines *lines,
+        guint         position,
+        guint         removed,
+        guint         added)
+{
+  GArray *old_lines, *new_lines;
+  guint n_items, first, start, old_start, j;
+  gint delta, y, dy;
+  Line line;
+
+  old_lines = lines->lines;
+  n_items = lines->items->len;
+  delta = (gint) added - (gint) removed;
+
+  /* The line before may have ended because the first changed item
+   * did not fit anymore.
+   */
+  first = find_line (old_lines, position);
+  if (first > 0 && first < old_lines->len && LINE (old_lines, first).start == position)
+    first--;
+
+  new_lines = g_array_sized_new (FALSE, FALSE, sizeof (Line), old_lines->len);
+  g_array_append_vals (new_lines, old_lines->data, MIN (first, old_lines->len));
+
+  if (first < old_lines->len)
+    {
+      start = LINE (old_lines, first).start;
+      y = LINE (old_lines, first).y;
+    }
+  else
+    {
+      start = 0;
+      y = 0;
+    }
+
+  while (start < n_items)
+    {
+      line.start = start;
+      line.y = y;
+      start = break_line (lines, start, &line.height);
+      g_array_append_val (new_lines, line);
+      y += line.height + lines->row_spacing;
+
+      if (start < position + added || start >= n_items)
+        continue;
+
+      /* Did the old lines start a line at the same item? */
+      old_start = start - delta;
+      j = find_line (old_lines, old_start);
+      if (j >= old_lines->len || LINE (old_lines, j).start != old_start)
+        continue;
+
+      dy = y - LINE (old_lines, j).y;
+      for (; j < old_lines->len; j++)
+        {
+          line = LINE (old_lines, j);
+          line.start += delta;
+          line.y += dy;
+          g_array_append_val (new_lines, line);
+        }
+      break;
+    }
+
+  g_array_unref (old_lines);
+  lines->lines = new_lines;
+}
+
+static void
+reflow_all (GtkFlowLines *lines)
+{
+  g_array_set_size (lines->lines, 0);
+  reflow (lines, 0, lines->items->len, lines->items->len);
+}
+
+static void
+ensure_lines (GtkFlowLines *lines)
+{
+  if (!lines->needs_reflow)
+    return;
+
+  lines->needs_reflow = FALSE;
+  reflow_all (lines);
+}
+
+GtkFlowLines *
+_gtk_flow_lines_new (void)
+{
+  GtkFlowLines *lines;
+
+  lines = g_slice_new0 (GtkFlowLines);
+  lines->items = g_array_new (FALSE, FALSE, sizeof (ItemSize));
+  lines->lines = g_array_new (FALSE, FALSE, sizeof (Line));
+
+  return lines;
+}
+
+void
+_gtk_flow_lines_free (GtkFlowLines *lines)
+{
+  g_array_unref (lines->items);
+  g_array_unref (lines->lines);
+  g_slice_free (GtkFlowLines, lines);
+}
+
+void
+_gtk_flow_lines_set_params (GtkFlowLines *lines,
+                            gint          width,
+                            gint          column_spacing,
+                            gint          row_spacing,
+                            guint         min_per_line,
+                            guint         max_per_line,
+                            gboolean      homogeneous)
+{
+  if (lines->width == width &&
+      lines->column_spacing == column_spacing &&
+      lines->row_spacing == row_spacing &&
+      lines->min_per_line == min_per_line &&
+      lines->max_per_line == max_per_line &&
+      lines->homogeneous == homogeneous)
+    return;
+
+  lines->width = width;
+  lines->column_spacing = column_spacing;
+  lines->row_spacing = row_spacing;
+  lines->min_per_line = min_per_line;
+  lines->max_per_line = max_per_line;
+  lines->homogeneous = homogeneous;
+  lines->needs_reflow = TRUE;
+}
+
+/* The width the lines are currently broken for */
+gint
+_gtk_flow_lines_get_width (GtkFlowLines *lines)
+{
+  return lines->width;
+}
+
+void
+_gtk_flow_lines_set_estimate (GtkFlowLines *lines,
+                              gint          width,
+                              gint          height)
+{
+  if (lines->estimated_width == width &&
+      lines->estimated_height == height)
+    return;
+
+  lines->estimated_width = width;
+  lines->estimated_height = height;
+  lines->needs_reflow = TRUE;
+}
+
+void
+_gtk_flow_lines_get_estimate (GtkFlowLines *lines,
+                              gint         *width,
+                              gint         *height)
+{
+  if (width)
+    *width = lines->estimated_width;
+  if (height)
+    *height = lines->estimated_height;
+}
+
+guint
+_gtk_flow_lines_get_n_items (GtkFlowLines *lines)
+{
+  return lines->items->len;
+}
+
+void
+_gtk_flow_lines_splice (GtkFlowLines *lines,
+                        guint         position,
+                        guint         removed,
+                        guint         added)
+{
+  guint n_items, i;
+
+  g_return_if_fail (position + removed <= lines->items->len);
+
+  if (removed == 0 && added == 0)
+    return;
+
+  g_array_remove_range (lines->items, position, removed);
+
+  n_items = lines->items->len;
+  g_array_set_size (lines->items, n_items + added);
+  memmove (&ITEM (lines, position + added), &ITEM (lines, position),
+           (n_items - position) * sizeof (ItemSize));
+  for (i = position; i < position + added; i++)
+    {
+      ITEM (lines, i).width = -1;
+      ITEM (lines, i).height = -1;
+    }
+
+  if (!lines->needs_reflow)
+    reflow (lines, position, removed, added);
+}
+
+/* Returns whether the size of the item changed */
+gboolean
+_gtk_flow_lines_set_item_size (GtkFlowLines *lines,
+                               guint         position,
+                               gint          width,
+                               gint          height)
+{
+  g_return_val_if_fail (position < lines->items->len, FALSE);
+
+  if (ITEM (lines, position).width == width &&
+      ITEM (lines, position).height == height)
+    return FALSE;
+
+  ITEM (lines, position).width = width;
+  ITEM (lines, position).height = height;
+
+  if (!lines->homogeneous && !lines->needs_reflow)
+    reflow (lines, position, 1, 1);
+
+  return TRUE;
+}
+
+gboolean
+_gtk_flow_lines_has_item_size (GtkFlowLines *lines,
+                               guint         position)
+{
+  g_return_val_if_fail (position < lines->items->len, FALSE);
+
+  return ITEM (lines, position).width >= 0;
+}
+
+guint
+_gtk_flow_lines_get_n_lines (GtkFlowLines *lines)
+{
+  ensure_lines (lines);
+
+  return lines->lines->len;
+}
+
+gint
+_gtk_flow_lines_get_height (GtkFlowLines *lines)
+{
+  Line *last;
+
+  ensure_lines (lines);
+
+  if (lines->lines->len == 0)
+    return 0;
+
+  last = &LINE (lines->lines, lines->lines->len - 1);
+
+  return last->y + last->height;
+}
+
+/* Returns the line at @y, or the closest one */
+guint
+_gtk_flow_lines_get_line_at_y (GtkFlowLines *lines,
+                               gint          y)
+{
+  guint lo, hi;
+
+  ensure_lines (lines);
+
+  lo = 0;
+  hi = lines->lines->len;
+
+  while (hi - lo > 1)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (LINE (lines->lines, mid).y <= y)
+        lo = mid;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+guint
+_gtk_flow_lines_get_line_of_item (GtkFlowLines *lines,
+                                  guint         position)
+{
+  ensure_lines (lines);
+
+  return find_line (lines->lines, position);
+}
+
+void
+_gtk_flow_lines_get_line (GtkFlowLines *lines,
+                          guint         line,
+                          guint        *start,
+                          guint        *end,
+                          gint         *y,
+                          gint         *height)
+{
+  ensure_lines (lines);
+
+  g_return_if_fail (line < lines->lines->len);
+
+  if (start)
+    *start = LINE (lines->lines, line).start;
+  if (end)
+    *end = line + 1 < lines->lines->len ? LINE (lines->lines, line + 1).start
+                                        : lines->items->len;
+  if (y)
+    *y = LINE (lines->lines, line).y;
+  if (height)
+    *height = LINE (lines->lines, line).height;
+}
+
+/* The item gets the height of its line */
+void
+_gtk_flow_lines_get_item_area (GtkFlowLines *lines,
+                               guint         position,
+                               gint         *x,
+                               gint         *y,
+                               gint         *width,
+                               gint         *height)
+{
+  guint line, i;
+
+  g_return_if_fail (position < lines->items->len);
+
+  ensure_lines (lines);
+  line = find_line (lines->lines, position);
+
+  *x = 0;
+  for (i = LINE (lines->lines, line).start; i < position; i++)
+    *x += item_width (lines, i) + lines->column_spacing;
+
+  *y = LINE (lines->lines, line).y;
+  *width = item_width (lines, position);
+  *height = LINE (lines->lines, line).height;
+}
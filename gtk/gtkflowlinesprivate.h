@@ -0,0 +1,78 @@
+/* gtkflowlinesprivate.h
+ * Copyright (C) 2017 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_FLOW_LINES_PRIVATE_H__
+#define __GTK_FLOW_LINES_PRIVATE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GtkFlowLines GtkFlowLines;
+
+GtkFlowLines *_gtk_flow_lines_new              (void);
+void          _gtk_flow_lines_free             (GtkFlowLines *lines);
+
+void          _gtk_flow_lines_set_params       (GtkFlowLines *lines,
+                                                gint          width,
+                                                gint          column_spacing,
+                                                gint          row_spacing,
+                                                guint         min_per_line,
+                                                guint         max_per_line,
+                                                gboolean      homogeneous);
+gint          _gtk_flow_lines_get_width        (GtkFlowLines *lines);
+void          _gtk_flow_lines_set_estimate     (GtkFlowLines *lines,
+                                                gint          width,
+                                                gint          height);
+void          _gtk_flow_lines_get_estimate     (GtkFlowLines *lines,
+                                                gint         *width,
+                                                gint         *height);
+
+guint         _gtk_flow_lines_get_n_items      (GtkFlowLines *lines);
+void          _gtk_flow_lines_splice           (GtkFlowLines *lines,
+                                                guint         position,
+                                                guint         removed,
+                                                guint         added);
+gboolean      _gtk_flow_lines_set_item_size    (GtkFlowLines *lines,
+                                                guint         position,
+                                                gint          width,
+                                                gint          height);
+gboolean      _gtk_flow_lines_has_item_size    (GtkFlowLines *lines,
+                                                guint         position);
+
+guint         _gtk_flow_lines_get_n_lines      (GtkFlowLines *lines);
+gint          _gtk_flow_lines_get_height       (GtkFlowLines *lines);
+guint         _gtk_flow_lines_get_line_at_y    (GtkFlowLines *lines,
+                                                gint          y);
+guint         _gtk_flow_lines_get_line_of_item (GtkFlowLines *lines,
+                                                guint         position);
+void          _gtk_flow_lines_get_line         (GtkFlowLines *lines,
+                                                guint         line,
+                                                guint        *start,
+                                                guint        *end,
+                                                gint         *y,
+                                                gint         *height);
+void          _gtk_flow_lines_get_item_area    (GtkFlowLines *lines,
+                                                guint         position,
+                                                gint         *x,
+                                                gint         *y,
+                                                gint         *width,
+                                                gint         *height);
+
+G_END_DECLS
+
+#endif /* __GTK_FLOW_LINES_PRIVATE_H__ */
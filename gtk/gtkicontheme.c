@@ -150,7 +150,20 @@ typedef enum
   ICON_SUFFIX_SYMBOLIC_PNG = 1 << 4
 } IconSuffix;
 
-#define INFO_CACHE_LRU_SIZE 32
+/* Default budget of the LRU cache, in bytes */
+#define INFO_CACHE_LRU_BUDGET (4 * 1024 * 1024)
+
+/* Dirs without icon cache are scanned in parallel if there are
+ * at least this many
+ */
+#define SCAN_PARALLEL_THRESHOLD 8
+#define SCAN_MAX_THREADS 8
+
+/* Limit on the names in the negative lookup cache of a theme */
+#define MISSING_ICONS_MAX 4096
+
+/* Threads that decode icons for gtk_icon_theme_prefetch_icons_async() */
+#define PREFETCH_MAX_THREADS 4
 #if 0
 #define DEBUG_CACHE(args) g_print args
 #else
@@ -160,7 +173,12 @@ typedef enum
 struct _GtkIconThemePrivate
 {
   GHashTable *info_cache;
-  GList *info_cache_lru;
+  GQueue info_cache_lru;
+  gsize info_cache_lru_size;
+
+  guint info_cache_hits;
+  guint info_cache_misses;
+  guint info_cache_evictions;
 
   gchar *current_theme;
   gchar **search_path;
@@ -187,6 +205,11 @@ struct _GtkIconThemePrivate
   GList *dir_mtimes;
 
   gulong theme_changed_idle;
+
+  /* Dirs without icon cache found by load_themes(), scanned
+   * together once all themes are loaded
+   */
+  GPtrArray *pending_scans;
 };
 
 typedef struct {
@@ -222,6 +245,13 @@ struct _GtkIconInfo
   IconInfoKey key;
   GtkIconTheme *in_cache;
 
+  /* Link in the LRU cache of in_cache, and the memory it was
+   * accounted with there
+   */
+  GList lru_link;
+  gsize lru_size;
+  guint in_lru : 1;
+
   gchar *filename;
   GFile *icon_file;
   GLoadableIcon *loadable;
@@ -259,6 +289,9 @@ struct _GtkIconInfo
 
   SymbolicPixbufCache *symbolic_pixbuf_cache;
 
+  /* Coverage of the symbolic colors, see icon_info_ensure_symbolic_mask() */
+  GdkPixbuf *symbolic_mask;
+
   gint symbolic_width;
   gint symbolic_height;
 };
@@ -272,6 +305,13 @@ typedef struct
 
   /* In search order */
   GList *dirs;
+
+  /* Names of icons that are in none of the dirs, so repeated
+   * lookups of them do not search all dirs again. Like the dirs,
+   * this lives until a change of the directory mtimes makes us
+   * load the themes again.
+   */
+  GHashTable *missing_icons;
 } IconTheme;
 
 typedef struct
@@ -332,6 +372,9 @@ static gboolean     theme_has_icon            (IconTheme        *theme,
                                                const gchar      *icon_name);
 static void         theme_list_contexts       (IconTheme        *theme,
                                                GHashTable       *contexts);
+static gboolean     scan_directory            (GtkIconThemePrivate *icon_theme,
+                                               IconThemeDir     *dir,
+                                               gchar            *full_dir);
 static void         theme_subdir_load         (GtkIconTheme     *icon_theme,
                                                IconTheme        *theme,
                                                GKeyFile         *theme_file,
@@ -359,6 +402,8 @@ static guint signal_changed = 0;
 
 static GHashTable *icon_theme_builtin_icons;
 
+static gsize info_cache_lru_budget = INFO_CACHE_LRU_BUDGET;
+
 static guint
 icon_info_key_hash (gconstpointer _key)
 {
@@ -491,9 +536,14 @@ static void
 gtk_icon_theme_class_init (GtkIconThemeClass *klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  const gchar *env;
 
   gobject_class->finalize = gtk_icon_theme_finalize;
 
+  env = g_getenv ("GTK_ICON_INFO_CACHE_SIZE");
+  if (env != NULL)
+    info_cache_lru_budget = g_ascii_strtoull (env, NULL, 10) * 1024;
+
   /**
    * GtkIconTheme::changed:
    * @icon_theme: the icon theme
@@ -832,7 +882,7 @@ gtk_icon_theme_finalize (GObject *object)
   priv = icon_theme->priv;
 
   g_hash_table_destroy (priv->info_cache);
-  g_assert (priv->info_cache_lru == NULL);
+  g_assert (priv->info_cache_lru.length == 0);
 
   if (priv->theme_changed_idle)
     g_source_remove (priv->theme_changed_idle);
@@ -1343,6 +1393,123 @@ add_unthemed_icon (GtkIconTheme *icon_theme,
     }
 }
 
+typedef struct
+{
+  GPtrArray *dirs;
+  gint next;
+  GMutex mutex;
+  GCond cond;
+  guint n_pending;
+} DirScan;
+
+static void
+dir_scan_run (DirScan *scan)
+{
+  IconThemeDir *dir;
+  guint i;
+
+  while ((i = (guint) g_atomic_int_add (&scan->next, 1)) < scan->dirs->len)
+    {
+      dir = g_ptr_array_index (scan->dirs, i);
+      scan_directory (NULL, dir, dir->dir);
+    }
+}
+
+static void
+dir_scan_func (gpointer data,
+               gpointer user_data)
+{
+  DirScan *scan = data;
+
+  dir_scan_run (scan);
+
+  g_mutex_lock (&scan->mutex);
+  scan->n_pending--;
+  g_cond_signal (&scan->cond);
+  g_mutex_unlock (&scan->mutex);
+}
+
+static GThreadPool *
+get_dir_scan_pool (void)
+{
+  static GThreadPool *pool = NULL;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *new_pool;
+
+      new_pool = g_thread_pool_new (dir_scan_func, NULL,
+                                    SCAN_MAX_THREADS, FALSE, NULL);
+      g_once_init_leave (&pool, new_pool);
+    }
+
+  return pool;
+}
+
+/* Scans the dirs collected by theme_subdir_load(), and drops
+ * the ones without icons from the themes
+ */
+static void
+scan_pending_dirs (GtkIconTheme *icon_theme)
+{
+  GtkIconThemePrivate *priv = icon_theme->priv;
+  IconThemeDir *dir;
+  IconTheme *theme;
+  GList *l, *d, *next;
+  DirScan scan;
+  guint n_threads, i;
+
+  scan.dirs = priv->pending_scans;
+  scan.next = 0;
+
+  n_threads = MIN (g_get_num_processors (), SCAN_MAX_THREADS);
+  n_threads = MIN (n_threads, scan.dirs->len);
+
+  if (n_threads < 2 || scan.dirs->len < SCAN_PARALLEL_THRESHOLD)
+    dir_scan_run (&scan);
+  else
+    {
+      g_mutex_init (&scan.mutex);
+      g_cond_init (&scan.cond);
+      scan.n_pending = n_threads - 1;
+
+      /* The calling thread scans too */
+      for (i = 1; i < n_threads; i++)
+        g_thread_pool_push (get_dir_scan_pool (), &scan, NULL);
+
+      dir_scan_run (&scan);
+
+      g_mutex_lock (&scan.mutex);
+      while (scan.n_pending > 0)
+        g_cond_wait (&scan.cond, &scan.mutex);
+      g_mutex_unlock (&scan.mutex);
+
+      g_mutex_clear (&scan.mutex);
+      g_cond_clear (&scan.cond);
+    }
+
+  g_ptr_array_unref (priv->pending_scans);
+  priv->pending_scans = NULL;
+
+  for (l = priv->themes; l; l = l->next)
+    {
+      theme = l->data;
+
+      for (d = theme->dirs; d; d = next)
+        {
+          dir = d->data;
+          next = d->next;
+
+          if (dir->cache == NULL &&
+              (dir->icons == NULL || g_hash_table_size (dir->icons) == 0))
+            {
+              theme->dirs = g_list_delete_link (theme->dirs, d);
+              theme_dir_destroy (dir);
+            }
+        }
+    }
+}
+
 static void
 load_themes (GtkIconTheme *icon_theme)
 {
@@ -1358,6 +1525,8 @@ load_themes (GtkIconTheme *icon_theme)
   
   priv = icon_theme->priv;
 
+  priv->pending_scans = g_ptr_array_new ();
+
   if (priv->current_theme)
     insert_theme (icon_theme, priv->current_theme);
 
@@ -1371,6 +1540,8 @@ load_themes (GtkIconTheme *icon_theme)
   insert_theme (icon_theme, FALLBACK_ICON_THEME);
   priv->themes = g_list_reverse (priv->themes);
 
+  scan_pending_dirs (icon_theme);
+
 
   priv->unthemed_icons = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                 g_free, (GDestroyNotify)free_unthemed_icon);
@@ -1476,7 +1647,7 @@ ensure_valid_themes (GtkIconTheme *icon_theme)
   priv->loading_themes = FALSE;
 }
 
-/* The LRU cache is a short list of IconInfos that are kept
+/* The LRU cache is a list of IconInfos that are kept
  * alive even though their IconInfo would otherwise have
  * been freed, so that we can avoid reloading these
  * constantly.
@@ -1484,26 +1655,75 @@ ensure_valid_themes (GtkIconTheme *icon_theme)
  * references the info. So, when we get a cache hit
  * we remove it from the list, and when the proxy
  * pixmap is released we put it on the list.
+ *
+ * The list is limited by the memory the infos hold on to,
+ * mostly their pixbufs, rather than by their number. The
+ * links are embedded in the infos, and the infos are found
+ * through the info_cache hash table, so no operation has
+ * to walk the list.
  */
+static gsize
+pixbuf_get_cache_size (GdkPixbuf *pixbuf)
+{
+  return pixbuf != NULL ? gdk_pixbuf_get_byte_length (pixbuf) : 0;
+}
+
+static gsize
+icon_info_get_cache_size (GtkIconInfo *icon_info)
+{
+  SymbolicPixbufCache *symbolic_cache;
+  gsize size;
+
+  size = sizeof (GtkIconInfo);
+  size += pixbuf_get_cache_size (icon_info->pixbuf);
+  if (icon_info->cache_pixbuf != icon_info->pixbuf)
+    size += pixbuf_get_cache_size (icon_info->cache_pixbuf);
+  if (icon_info->symbolic_mask != icon_info->pixbuf)
+    size += pixbuf_get_cache_size (icon_info->symbolic_mask);
+
+  for (symbolic_cache = icon_info->symbolic_pixbuf_cache;
+       symbolic_cache != NULL;
+       symbolic_cache = symbolic_cache->next)
+    size += sizeof (SymbolicPixbufCache) + pixbuf_get_cache_size (symbolic_cache->pixbuf);
+
+  return size;
+}
+
 static void
-ensure_lru_cache_space (GtkIconTheme *icon_theme)
+unlink_from_lru_cache (GtkIconTheme *icon_theme,
+                       GtkIconInfo  *icon_info)
 {
   GtkIconThemePrivate *priv = icon_theme->priv;
-  GList *l;
 
-  /* Remove last item if LRU full */
-  l = g_list_nth (priv->info_cache_lru, INFO_CACHE_LRU_SIZE - 1);
-  if (l)
+  g_queue_unlink (&priv->info_cache_lru, &icon_info->lru_link);
+  priv->info_cache_lru_size -= icon_info->lru_size;
+  icon_info->in_lru = FALSE;
+}
+
+/* Evicts the least recently used infos until the cache fits
+ * into its budget, never evicting @keep
+ */
+static void
+ensure_lru_cache_space (GtkIconTheme *icon_theme,
+                        GtkIconInfo  *keep)
+{
+  GtkIconThemePrivate *priv = icon_theme->priv;
+  GtkIconInfo *icon_info;
+
+  while (priv->info_cache_lru_size > info_cache_lru_budget &&
+         priv->info_cache_lru.tail != NULL &&
+         priv->info_cache_lru.tail->data != keep)
     {
-      GtkIconInfo *icon_info = l->data;
+      icon_info = priv->info_cache_lru.tail->data;
 
       DEBUG_CACHE (("removing (due to out of space) %p (%s %d 0x%x) from LRU cache (cache size %d)\n",
                     icon_info,
                     g_strjoinv (",", icon_info->key.icon_names),
                     icon_info->key.size, icon_info->key.flags,
-                    g_list_length (priv->info_cache_lru)));
+                    priv->info_cache_lru.length));
 
-      priv->info_cache_lru = g_list_delete_link (priv->info_cache_lru, l);
+      unlink_from_lru_cache (icon_theme, icon_info);
+      priv->info_cache_evictions++;
       g_object_unref (icon_info);
     }
 }
@@ -1518,14 +1738,25 @@ add_to_lru_cache (GtkIconTheme *icon_theme,
                 icon_info,
                 g_strjoinv (",", icon_info->key.icon_names),
                 icon_info->key.size, icon_info->key.flags,
-                g_list_length (priv->info_cache_lru)));
+                priv->info_cache_lru.length));
+
+  g_assert (!icon_info->in_lru);
 
-  g_assert (g_list_find (priv->info_cache_lru, icon_info) == NULL);
+  icon_info->lru_size = icon_info_get_cache_size (icon_info);
 
-  ensure_lru_cache_space (icon_theme);
-  /* prepend new info to LRU */
-  priv->info_cache_lru = g_list_prepend (priv->info_cache_lru,
-                                         g_object_ref (icon_info));
+  /* an info that does not fit by itself is not kept at all */
+  if (icon_info->lru_size > info_cache_lru_budget)
+    {
+      priv->info_cache_evictions++;
+      return;
+    }
+
+  g_queue_push_head_link (&priv->info_cache_lru, &icon_info->lru_link);
+  priv->info_cache_lru_size += icon_info->lru_size;
+  icon_info->in_lru = TRUE;
+  g_object_ref (icon_info);
+
+  ensure_lru_cache_space (icon_theme, icon_info);
 }
 
 static void
@@ -1533,14 +1764,20 @@ ensure_in_lru_cache (GtkIconTheme *icon_theme,
                      GtkIconInfo  *icon_info)
 {
   GtkIconThemePrivate *priv = icon_theme->priv;
-  GList *l;
 
-  l = g_list_find (priv->info_cache_lru, icon_info);
-  if (l)
+  if (icon_info->in_lru)
     {
-      /* Move to front of LRU if already in it */
-      priv->info_cache_lru = g_list_remove_link (priv->info_cache_lru, l);
-      priv->info_cache_lru = g_list_concat (l, priv->info_cache_lru);
+      /* Move to front of LRU if already in it, and account
+       * for the pixbufs it got meanwhile
+       */
+      g_queue_unlink (&priv->info_cache_lru, &icon_info->lru_link);
+      g_queue_push_head_link (&priv->info_cache_lru, &icon_info->lru_link);
+
+      priv->info_cache_lru_size -= icon_info->lru_size;
+      icon_info->lru_size = icon_info_get_cache_size (icon_info);
+      priv->info_cache_lru_size += icon_info->lru_size;
+
+      ensure_lru_cache_space (icon_theme, icon_info);
     }
   else
     add_to_lru_cache (icon_theme, icon_info);
@@ -1551,19 +1788,43 @@ remove_from_lru_cache (GtkIconTheme *icon_theme,
                        GtkIconInfo  *icon_info)
 {
   GtkIconThemePrivate *priv = icon_theme->priv;
-  if (g_list_find (priv->info_cache_lru, icon_info))
+
+  if (icon_info->in_lru)
     {
       DEBUG_CACHE (("removing %p (%s %d 0x%x) from LRU cache (cache size %d)\n",
                     icon_info,
                     g_strjoinv (",", icon_info->key.icon_names),
                     icon_info->key.size, icon_info->key.flags,
-                    g_list_length (priv->info_cache_lru)));
+                    priv->info_cache_lru.length));
 
-      priv->info_cache_lru = g_list_remove (priv->info_cache_lru, icon_info);
+      unlink_from_lru_cache (icon_theme, icon_info);
       g_object_unref (icon_info);
     }
 }
 
+/*
+ * gtk_icon_theme_get_cache_stats:
+ * @icon_theme: a #GtkIconTheme
+ * @stats: (out): return location for the statistics
+ *
+ * Gets statistics about the cache of #GtkIconInfos of @icon_theme,
+ * for the inspector.
+ */
+void
+gtk_icon_theme_get_cache_stats (GtkIconTheme           *icon_theme,
+                                GtkIconThemeCacheStats *stats)
+{
+  GtkIconThemePrivate *priv = icon_theme->priv;
+
+  stats->hits = priv->info_cache_hits;
+  stats->misses = priv->info_cache_misses;
+  stats->evictions = priv->info_cache_evictions;
+  stats->n_cached = g_hash_table_size (priv->info_cache);
+  stats->n_unused = priv->info_cache_lru.length;
+  stats->unused_size = priv->info_cache_lru_size;
+  stats->budget = info_cache_lru_budget;
+}
+
 static SymbolicPixbufCache *
 symbolic_pixbuf_cache_new (GdkPixbuf           *pixbuf,
                            const GdkRGBA       *fg,
@@ -1697,12 +1958,16 @@ real_choose_icon (GtkIconTheme       *icon_theme,
                     icon_info->key.size, icon_info->key.flags,
                     g_hash_table_size (priv->info_cache)));
 
+      priv->info_cache_hits++;
+
       icon_info = g_object_ref (icon_info);
       remove_from_lru_cache (icon_theme, icon_info);
 
       return icon_info;
     }
 
+  priv->info_cache_misses++;
+
   if (flags & GTK_ICON_LOOKUP_NO_SVG)
     allow_svg = FALSE;
   else if (flags & GTK_ICON_LOOKUP_FORCE_SVG)
@@ -2792,6 +3057,8 @@ theme_destroy (IconTheme *theme)
   g_free (theme->example);
 
   g_list_free_full (theme->dirs, (GDestroyNotify) theme_dir_destroy);
+  if (theme->missing_icons)
+    g_hash_table_destroy (theme->missing_icons);
   
   g_free (theme);
 }
@@ -3022,6 +3289,7 @@ theme_lookup_icon (IconTheme   *theme,
   gint min_difference, difference;
   BuiltinIcon *closest_builtin = NULL;
   IconSuffix suffix;
+  gboolean found;
 
   min_difference = G_MAXINT;
   min_dir = NULL;
@@ -3039,6 +3307,14 @@ theme_lookup_icon (IconTheme   *theme,
         return icon_info_new_builtin (closest_builtin);
     }
 
+  if (theme->missing_icons != NULL &&
+      g_hash_table_contains (theme->missing_icons, icon_name))
+    {
+      GTK_NOTE (ICONTHEME, g_message ("icon %s is not in theme %s", icon_name, theme->name));
+      goto missing;
+    }
+
+  found = FALSE;
   dirs = theme->dirs;
 
   l = dirs;
@@ -3048,6 +3324,8 @@ theme_lookup_icon (IconTheme   *theme,
 
       GTK_NOTE (ICONTHEME, g_message ("look up icon dir %s", dir->dir));
       suffix = theme_dir_get_icon_suffix (dir, icon_name, NULL);
+      if (suffix != ICON_SUFFIX_NONE)
+        found = TRUE;
       if (best_suffix (suffix, allow_svg) != ICON_SUFFIX_NONE)
         {
           difference = theme_dir_size_difference (dir, size, scale);
@@ -3111,6 +3389,20 @@ theme_lookup_icon (IconTheme   *theme,
       return icon_info;
     }
 
+  /* Only remember names that no lookup can find here, whatever
+   * the size or the formats it allows
+   */
+  if (!found)
+    {
+      if (theme->missing_icons == NULL)
+        theme->missing_icons = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+      else if (g_hash_table_size (theme->missing_icons) >= MISSING_ICONS_MAX)
+        g_hash_table_remove_all (theme->missing_icons);
+
+      g_hash_table_add (theme->missing_icons, g_strdup (icon_name));
+    }
+
+ missing:
   if (closest_builtin)
     return icon_info_new_builtin (closest_builtin);
   
@@ -3147,6 +3439,10 @@ theme_has_icon (IconTheme   *theme,
 {
   GList *l;
 
+  if (theme->missing_icons != NULL &&
+      g_hash_table_contains (theme->missing_icons, icon_name))
+    return FALSE;
+
   for (l = theme->dirs; l; l = l->next)
     {
       IconThemeDir *dir = l->data;
@@ -3370,9 +3666,11 @@ theme_subdir_load (GtkIconTheme *icon_theme,
             }
           else
             {
+              /* scanned later, together with the others */
               dir->cache = NULL;
               dir->subdir_index = -1;
-              has_icons = scan_directory (icon_theme->priv, dir, full_dir);
+              g_ptr_array_add (icon_theme->priv->pending_scans, dir);
+              has_icons = TRUE;
             }
 
           if (has_icons)
@@ -3423,6 +3721,7 @@ static void
 gtk_icon_info_init (GtkIconInfo *icon_info)
 {
   icon_info->scale = -1.;
+  icon_info->lru_link.data = icon_info;
 }
 
 static GtkIconInfo *
@@ -3475,6 +3774,8 @@ icon_info_dup (GtkIconInfo *icon_info)
 
   if (icon_info->cache_pixbuf)
     dup->cache_pixbuf = g_object_ref (icon_info->cache_pixbuf);
+  if (icon_info->symbolic_mask)
+    dup->symbolic_mask = g_object_ref (icon_info->symbolic_mask);
 
   dup->scale = icon_info->scale;
   dup->unscaled_scale = icon_info->unscaled_scale;
@@ -3555,6 +3856,7 @@ gtk_icon_info_finalize (GObject *object)
   g_clear_object (&icon_info->pixbuf);
   g_clear_object (&icon_info->proxy_pixbuf);
   g_clear_object (&icon_info->cache_pixbuf);
+  g_clear_object (&icon_info->symbolic_mask);
   g_clear_error (&icon_info->load_error);
 
   symbolic_pixbuf_cache_free (icon_info->symbolic_pixbuf_cache);
@@ -4252,6 +4554,304 @@ gtk_icon_info_load_icon_finish (GtkIconInfo   *icon_info,
   return gtk_icon_info_load_icon (icon_info, error);
 }
 
+typedef struct {
+  GtkIconTheme *icon_theme;
+  GTask *task;
+  GtkIconPrefetchFunc icon_func;
+  gpointer user_data;
+  GMainContext *context;
+
+  /* Protects done and idle_queued, which the workers touch */
+  GMutex mutex;
+  GQueue done;
+  guint idle_queued : 1;
+
+  /* Items that were not yet passed to icon_func */
+  guint n_pending;
+} PrefetchBatch;
+
+typedef struct {
+  PrefetchBatch *batch;
+  GtkIconPrefetchRequest request;
+  gchar *icon_name;
+  GtkIconInfo *icon_info;
+  GtkIconInfo *dup;
+} PrefetchItem;
+
+static void
+prefetch_item_free (PrefetchItem *item)
+{
+  g_free (item->icon_name);
+  g_clear_object (&item->icon_info);
+  g_clear_object (&item->dup);
+  g_slice_free (PrefetchItem, item);
+}
+
+static void
+prefetch_batch_free (PrefetchBatch *batch)
+{
+  g_assert (batch->n_pending == 0);
+  g_assert (g_queue_is_empty (&batch->done));
+
+  g_object_unref (batch->icon_theme);
+  g_object_unref (batch->task);
+  g_main_context_unref (batch->context);
+  g_mutex_clear (&batch->mutex);
+  g_slice_free (PrefetchBatch, batch);
+}
+
+static gboolean
+prefetch_batch_deliver (gpointer data)
+{
+  PrefetchBatch *batch = data;
+  GtkIconInfo *icon_info;
+  PrefetchItem *item;
+  GQueue done;
+  GError *error = NULL;
+
+  g_mutex_lock (&batch->mutex);
+  done = batch->done;
+  g_queue_init (&batch->done);
+  batch->idle_queued = FALSE;
+  g_mutex_unlock (&batch->mutex);
+
+  while ((item = g_queue_pop_head (&done)) != NULL)
+    {
+      icon_info = item->icon_info;
+
+      /* Copy the results back, like gtk_icon_info_load_icon_finish() */
+      if (item->dup != NULL && !icon_info_get_pixbuf_ready (icon_info) &&
+          icon_info_get_pixbuf_ready (item->dup))
+        {
+          icon_info->emblems_applied = item->dup->emblems_applied;
+          icon_info->scale = item->dup->scale;
+          g_clear_object (&icon_info->pixbuf);
+          if (item->dup->pixbuf)
+            icon_info->pixbuf = g_object_ref (item->dup->pixbuf);
+          g_clear_error (&icon_info->load_error);
+          if (item->dup->load_error)
+            icon_info->load_error = g_error_copy (item->dup->load_error);
+        }
+
+      /* Keep the decoded icon around until someone looks it up */
+      if (icon_info != NULL && icon_info->in_cache == batch->icon_theme &&
+          icon_info_get_pixbuf_ready (icon_info))
+        ensure_in_lru_cache (batch->icon_theme, icon_info);
+
+      if (batch->icon_func != NULL &&
+          !g_cancellable_is_cancelled (g_task_get_cancellable (batch->task)))
+        batch->icon_func (batch->icon_theme, &item->request, icon_info, batch->user_data);
+
+      prefetch_item_free (item);
+      batch->n_pending--;
+    }
+
+  if (batch->n_pending == 0)
+    {
+      if (g_cancellable_set_error_if_cancelled (g_task_get_cancellable (batch->task), &error))
+        g_task_return_error (batch->task, error);
+      else
+        g_task_return_boolean (batch->task, TRUE);
+
+      prefetch_batch_free (batch);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Called with the batch unlocked, from any thread */
+static void
+prefetch_batch_push_done (PrefetchBatch *batch,
+                          PrefetchItem  *item)
+{
+  GSource *source;
+
+  g_mutex_lock (&batch->mutex);
+
+  g_queue_push_tail (&batch->done, item);
+
+  if (!batch->idle_queued)
+    {
+      batch->idle_queued = TRUE;
+
+      source = g_idle_source_new ();
+      g_source_set_priority (source, G_PRIORITY_DEFAULT);
+      g_source_set_callback (source, prefetch_batch_deliver, batch, NULL);
+      g_source_set_name (source, "[gtk+] prefetch_batch_deliver");
+      g_source_attach (source, batch->context);
+      g_source_unref (source);
+    }
+
+  g_mutex_unlock (&batch->mutex);
+}
+
+static void
+prefetch_func (gpointer data,
+               gpointer user_data)
+{
+  PrefetchItem *item = data;
+
+  if (!g_cancellable_is_cancelled (g_task_get_cancellable (item->batch->task)))
+    (void)icon_info_ensure_scale_and_pixbuf (item->dup);
+
+  prefetch_batch_push_done (item->batch, item);
+}
+
+static GThreadPool *
+get_prefetch_pool (void)
+{
+  static GThreadPool *pool = NULL;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *new_pool;
+
+      new_pool = g_thread_pool_new (prefetch_func, NULL,
+                                    PREFETCH_MAX_THREADS, FALSE, NULL);
+      g_once_init_leave (&pool, new_pool);
+    }
+
+  return pool;
+}
+
+/**
+ * gtk_icon_theme_prefetch_icons_async:
+ * @icon_theme: a #GtkIconTheme
+ * @requests: (array length=n_requests): the icons to prefetch
+ * @n_requests: the number of elements in @requests
+ * @flags: flags modifying the behavior of the icon lookups
+ * @cancellable: (allow-none): optional #GCancellable object, %NULL to ignore
+ * @icon_func: (allow-none): function to call for
+ *     each icon once it is loaded
+ * @callback: (scope async): a #GAsyncReadyCallback to call when all
+ *     icons have been handled
+ * @user_data: (closure): the data to pass to @icon_func and @callback
+ *
+ * Looks up a batch of icons and loads them in worker threads, so that
+ * gtk_icon_info_load_icon() on the results does not block. This is
+ * meant for views that show many icons and want to display placeholders
+ * instead of waiting for the icons to be decoded.
+ *
+ * Each request has its own icon name, size and scale, so one batch can
+ * cover a view with icons of several sizes, or on several monitors.
+ * @requests is copied, it can be freed when this function returns.
+ *
+ * @icon_func is called in the thread-default main context of the caller
+ * for each icon as soon as it is ready, in no particular order. The
+ * loaded icons are kept in the cache of @icon_theme, so that looking
+ * them up again with the same parameters is cheap as well.
+ *
+ * When all icons have been handled, @callback is called and you can
+ * call gtk_icon_theme_prefetch_icons_finish() to get the result.
+ *
+ * Since: 3.90
+ */
+void
+gtk_icon_theme_prefetch_icons_async (GtkIconTheme                 *icon_theme,
+                                     const GtkIconPrefetchRequest *requests,
+                                     guint                         n_requests,
+                                     GtkIconLookupFlags            flags,
+                                     GCancellable                 *cancellable,
+                                     GtkIconPrefetchFunc           icon_func,
+                                     GAsyncReadyCallback           callback,
+                                     gpointer                      user_data)
+{
+  PrefetchBatch *batch;
+  PrefetchItem *item;
+  GTask *task;
+  guint i;
+
+  g_return_if_fail (GTK_IS_ICON_THEME (icon_theme));
+  g_return_if_fail (requests != NULL || n_requests == 0);
+  g_return_if_fail ((flags & GTK_ICON_LOOKUP_NO_SVG) == 0 ||
+                    (flags & GTK_ICON_LOOKUP_FORCE_SVG) == 0);
+
+  for (i = 0; i < n_requests; i++)
+    {
+      g_return_if_fail (requests[i].icon_name != NULL);
+      g_return_if_fail (requests[i].scale >= 1);
+    }
+
+  task = g_task_new (icon_theme, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gtk_icon_theme_prefetch_icons_async);
+
+  if (n_requests == 0)
+    {
+      g_task_return_boolean (task, TRUE);
+      g_object_unref (task);
+      return;
+    }
+
+  batch = g_slice_new0 (PrefetchBatch);
+  batch->icon_theme = g_object_ref (icon_theme);
+  batch->task = task;
+  batch->icon_func = icon_func;
+  batch->user_data = user_data;
+  batch->context = g_main_context_ref_thread_default ();
+  g_mutex_init (&batch->mutex);
+  g_queue_init (&batch->done);
+
+  /* Count all items first, so that the batch is not done early */
+  batch->n_pending = n_requests;
+
+  /* The lookups use the theme data, which is not thread-safe;
+   * only the decoding happens in the workers
+   */
+  for (i = 0; i < n_requests; i++)
+    {
+      item = g_slice_new0 (PrefetchItem);
+      item->batch = batch;
+      item->icon_name = g_strdup (requests[i].icon_name);
+      item->request = requests[i];
+      item->request.icon_name = item->icon_name;
+      item->icon_info = gtk_icon_theme_lookup_icon_for_scale (icon_theme,
+                                                              item->icon_name,
+                                                              item->request.size,
+                                                              item->request.scale,
+                                                              flags);
+
+      if (item->icon_info == NULL ||
+          icon_info_get_pixbuf_ready (item->icon_info) ||
+          g_cancellable_is_cancelled (cancellable))
+        {
+          prefetch_batch_push_done (batch, item);
+        }
+      else
+        {
+          item->dup = icon_info_dup (item->icon_info);
+          g_thread_pool_push (get_prefetch_pool (), item, NULL);
+        }
+    }
+}
+
+/**
+ * gtk_icon_theme_prefetch_icons_finish:
+ * @icon_theme: a #GtkIconTheme
+ * @result: a #GAsyncResult
+ * @error: (allow-none): location to store error information on failure,
+ *     or %NULL.
+ *
+ * Finishes a prefetch started with gtk_icon_theme_prefetch_icons_async().
+ *
+ * Icons that could not be found or loaded are not an error; they are
+ * passed to the @icon_func as usual.
+ *
+ * Returns: %TRUE if all icons were handled, %FALSE if the operation
+ *     was cancelled
+ *
+ * Since: 3.90
+ */
+gboolean
+gtk_icon_theme_prefetch_icons_finish (GtkIconTheme  *icon_theme,
+                                      GAsyncResult  *result,
+                                      GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, icon_theme), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gtk_icon_theme_prefetch_icons_async, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
 static void
 proxy_symbolic_pixbuf_destroy (guchar   *pixels,
                                gpointer  data)
@@ -4302,16 +4902,9 @@ symbolic_cache_get_proxy (SymbolicPixbufCache *symbolic_cache,
   return symbolic_cache->proxy_pixbuf;
 }
 
-static gchar *
-rgba_to_string_noalpha (const GdkRGBA *rgba)
-{
-  GdkRGBA color;
-
-  color = *rgba;
-  color.alpha = 1.0;
-
-  return gdk_rgba_to_string (&color);
-}
+static const GdkRGBA symbolic_success_default = { 0.3046921492332342,0.6015716792553597, 0.023437857633325704, 1.0};
+static const GdkRGBA symbolic_warning_default = {0.9570458533607996, 0.47266346227206835, 0.2421911955443656, 1.0 };
+static const GdkRGBA symbolic_error_default = { 0.796887159533074, 0 ,0, 1.0 };
 
 static void
 rgba_to_pixel(const GdkRGBA  *rgba,
@@ -4333,9 +4926,10 @@ gtk_icon_theme_color_symbolic_pixbuf (GdkPixbuf     *symbolic,
   int width, height, x, y, src_stride, dst_stride;
   guchar *src_data, *dst_data;
   guchar *src_row, *dst_row;
-  int alpha;
+  int alpha, i;
   GdkPixbuf *colored;
   guint8 fg_pixel[4], success_pixel[4], warning_pixel[4], error_pixel[4];
+  int base[3], success_delta[3], warning_delta[3], error_delta[3];
 
   alpha = fg_color->alpha * 255;
 
@@ -4344,6 +4938,18 @@ gtk_icon_theme_color_symbolic_pixbuf (GdkPixbuf     *symbolic,
   rgba_to_pixel (warning_color, warning_pixel);
   rgba_to_pixel (error_color, error_pixel);
 
+  /* The foreground gets what the other colors leave over, so
+   * fg * (255 - c2 - c3 - c4) + success * c2 + ... turns into
+   * fg * 255 + (success - fg) * c2 + ...
+   */
+  for (i = 0; i < 3; i++)
+    {
+      base[i] = fg_pixel[i] * 255;
+      success_delta[i] = success_pixel[i] - fg_pixel[i];
+      warning_delta[i] = warning_pixel[i] - fg_pixel[i];
+      error_delta[i] = error_pixel[i] - fg_pixel[i];
+    }
+
   width = gdk_pixbuf_get_width (symbolic);
   height = gdk_pixbuf_get_height (symbolic);
 
@@ -4355,103 +4961,59 @@ gtk_icon_theme_color_symbolic_pixbuf (GdkPixbuf     *symbolic,
   dst_data = gdk_pixbuf_get_pixels (colored);
   dst_stride = gdk_pixbuf_get_rowstride (colored);
 
+  /* This is run for every color combination, so keep the loop
+   * free of branches to let the compiler vectorize it
+   */
   for (y = 0; y < height; y++)
     {
       src_row = src_data + src_stride * y;
       dst_row = dst_data + dst_stride * y;
       for (x = 0; x < width; x++)
         {
-          guint r, g, b, a;
-          int c1, c2, c3, c4;
-
-          a = src_row[3];
-          dst_row[3] = a * alpha / 255;
-
-          if (a == 0)
-            {
-              dst_row[0] = 0;
-              dst_row[1] = 0;
-              dst_row[2] = 0;
-            }
-          else
-            {
-              c2 = src_row[0];
-              c3 = src_row[1];
-              c4 = src_row[2];
-
-              if (c2 == 0 && c3 == 0 && c4 == 0)
-                {
-                  dst_row[0] = fg_pixel[0];
-                  dst_row[1] = fg_pixel[1];
-                  dst_row[2] = fg_pixel[2];
-                }
-              else
-                {
-                  c1 = 255 - c2 - c3 - c4;
-
-                  r = fg_pixel[0] * c1 + success_pixel[0] * c2 +  warning_pixel[0] * c3 +  error_pixel[0] * c4;
-                  g = fg_pixel[1] * c1 + success_pixel[1] * c2 +  warning_pixel[1] * c3 +  error_pixel[1] * c4;
-                  b = fg_pixel[2] * c1 + success_pixel[2] * c2 +  warning_pixel[2] * c3 +  error_pixel[2] * c4;
-
-                  dst_row[0] = r / 255;
-                  dst_row[1] = g / 255;
-                  dst_row[2] = b / 255;
-                }
-            }
-
-          src_row += 4;
-          dst_row += 4;
+          int c2, c3, c4, a, r, g, b;
+
+          c2 = src_row[4 * x];
+          c3 = src_row[4 * x + 1];
+          c4 = src_row[4 * x + 2];
+          a = src_row[4 * x + 3];
+
+          r = base[0] + success_delta[0] * c2 + warning_delta[0] * c3 + error_delta[0] * c4;
+          g = base[1] + success_delta[1] * c2 + warning_delta[1] * c3 + error_delta[1] * c4;
+          b = base[2] + success_delta[2] * c2 + warning_delta[2] * c3 + error_delta[2] * c4;
+
+          /* Fully transparent pixels are black, as before */
+          dst_row[4 * x] = a == 0 ? 0 : CLAMP (r, 0, 255 * 255) / 255;
+          dst_row[4 * x + 1] = a == 0 ? 0 : CLAMP (g, 0, 255 * 255) / 255;
+          dst_row[4 * x + 2] = a == 0 ? 0 : CLAMP (b, 0, 255 * 255) / 255;
+          dst_row[4 * x + 3] = a * alpha / 255;
         }
     }
 
   return colored;
 }
 
-static GdkPixbuf *
-gtk_icon_info_load_symbolic_png (GtkIconInfo    *icon_info,
-                                 const GdkRGBA  *fg,
-                                 const GdkRGBA  *success_color,
-                                 const GdkRGBA  *warning_color,
-                                 const GdkRGBA  *error_color,
-                                 GError        **error)
-{
-  GdkRGBA fg_default = { 0.7450980392156863, 0.7450980392156863, 0.7450980392156863, 1.0};
-  GdkRGBA success_default = { 0.3046921492332342,0.6015716792553597, 0.023437857633325704, 1.0};
-  GdkRGBA warning_default = {0.9570458533607996, 0.47266346227206835, 0.2421911955443656, 1.0 };
-  GdkRGBA error_default = { 0.796887159533074, 0 ,0, 1.0 };
-
-  if (!icon_info_ensure_scale_and_pixbuf (icon_info))
-    {
-      if (icon_info->load_error)
-        {
-          if (error)
-            *error = g_error_copy (icon_info->load_error);
-        }
-      else
-        {
-          g_set_error_literal (error,
-                               GTK_ICON_THEME_ERROR,
-                               GTK_ICON_THEME_NOT_FOUND,
-                               _("Failed to load icon"));
-        }
+static gchar *
+rgba_to_string_noalpha (const GdkRGBA *rgba)
+{
+  GdkRGBA color;
 
-      return NULL;
-    }
+  color = *rgba;
+  color.alpha = 1.0;
 
-  return gtk_icon_theme_color_symbolic_pixbuf (icon_info->pixbuf,
-                                               fg ? fg : &fg_default,
-                                               success_color ? success_color : &success_default,
-                                               warning_color ? warning_color : &warning_default,
-                                               error_color ? error_color : &error_default);
+  return gdk_rgba_to_string (&color);
 }
 
+/* Renders the SVG of a symbolic icon with the colors given by class,
+ * at the size of the icon
+ */
 static GdkPixbuf *
-gtk_icon_info_load_symbolic_svg (GtkIconInfo    *icon_info,
-                                 const GdkRGBA  *fg,
-                                 const GdkRGBA  *success_color,
-                                 const GdkRGBA  *warning_color,
-                                 const GdkRGBA  *error_color,
-                                 GError        **error)
+render_symbolic_svg (GtkIconInfo    *icon_info,
+                     const gchar    *escaped_file_data,
+                     const GdkRGBA  *fg,
+                     const GdkRGBA  *success_color,
+                     const GdkRGBA  *warning_color,
+                     const GdkRGBA  *error_color,
+                     GError        **error)
 {
   GInputStream *stream;
   GdkPixbuf *pixbuf;
@@ -4462,48 +5024,137 @@ gtk_icon_info_load_symbolic_svg (GtkIconInfo    *icon_info,
   gchar *data;
   gchar *width;
   gchar *height;
-  gchar *file_data, *escaped_file_data;
-  gsize file_len;
-  gint symbolic_size;
-  double alpha;
-  gchar alphastr[G_ASCII_DTOSTR_BUF_SIZE];
-
-  alpha = fg->alpha;
 
   css_fg = rgba_to_string_noalpha (fg);
+  css_success = rgba_to_string_noalpha (success_color);
+  css_warning = rgba_to_string_noalpha (warning_color);
+  css_error = rgba_to_string_noalpha (error_color);
 
-  css_success = css_warning = css_error = NULL;
+  width = g_strdup_printf ("%d", icon_info->symbolic_width);
+  height = g_strdup_printf ("%d", icon_info->symbolic_height);
 
-  if (warning_color)
-    css_warning = rgba_to_string_noalpha (warning_color);
-  else
-    css_warning = g_strdup ("rgb(245,121,62)");
+  data = g_strconcat ("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n"
+                      "<svg version=\"1.1\"\n"
+                      "     xmlns=\"http://www.w3.org/2000/svg\"\n"
+                      "     xmlns:xi=\"http://www.w3.org/2001/XInclude\"\n"
+                      "     width=\"", width, "\"\n"
+                      "     height=\"", height, "\">\n"
+                      "  <style type=\"text/css\">\n"
+                      "    rect,path {\n"
+                      "      fill: ", css_fg," !important;\n"
+                      "    }\n"
+                      "    .warning {\n"
+                      "      fill: ", css_warning, " !important;\n"
+                      "    }\n"
+                      "    .error {\n"
+                      "      fill: ", css_error ," !important;\n"
+                      "    }\n"
+                      "    .success {\n"
+                      "      fill: ", css_success, " !important;\n"
+                      "    }\n"
+                      "  </style>\n"
+                      "  <xi:include href=\"data:text/xml,", escaped_file_data, "\"/>\n"
+                      "</svg>",
+                      NULL);
+  g_free (css_fg);
+  g_free (css_warning);
+  g_free (css_error);
+  g_free (css_success);
+  g_free (width);
+  g_free (height);
 
-  if (error_color)
-    css_error = rgba_to_string_noalpha (error_color);
-  else
-    css_error = g_strdup ("rgb(204,0,0)");
+  stream = g_memory_input_stream_new_from_data (data, -1, g_free);
+  pixbuf = gdk_pixbuf_new_from_stream_at_scale (stream,
+                                                gdk_pixbuf_get_width (icon_info->pixbuf),
+                                                gdk_pixbuf_get_height (icon_info->pixbuf),
+                                                TRUE,
+                                                NULL,
+                                                error);
+  g_object_unref (stream);
 
-  if (success_color)
-    css_success = rgba_to_string_noalpha (success_color);
-  else
-    css_success = g_strdup ("rgb(78,154,6)");
+  return pixbuf;
+}
 
-  if (!g_file_load_contents (icon_info->icon_file, NULL, &file_data, &file_len, NULL, error))
-    return NULL;
+static void
+copy_plane (GdkPixbuf *src,
+            GdkPixbuf *dst,
+            int        from_plane,
+            int        to_plane)
+{
+  guchar *src_data, *dst_data;
+  int width, height, src_stride, dst_stride;
+  int x, y;
+
+  width = MIN (gdk_pixbuf_get_width (src), gdk_pixbuf_get_width (dst));
+  height = MIN (gdk_pixbuf_get_height (src), gdk_pixbuf_get_height (dst));
+
+  src_stride = gdk_pixbuf_get_rowstride (src);
+  src_data = gdk_pixbuf_get_pixels (src);
+
+  dst_data = gdk_pixbuf_get_pixels (dst);
+  dst_stride = gdk_pixbuf_get_rowstride (dst);
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < width; x++)
+      dst_data[dst_stride * y + 4 * x + to_plane] = src_data[src_stride * y + 4 * x + from_plane];
+}
+
+/* The symbolic mask of an icon has the coverage of the success, warning
+ * and error colors in its red, green and blue channels and the coverage
+ * of the icon in its alpha channel; the foreground gets the rest. This
+ * is the format of .symbolic.png files. SVG icons are rendered into it
+ * once per size, the same way gtk-encode-symbolic-svg does, and then
+ * recolored with gtk_icon_theme_color_symbolic_pixbuf() for each color
+ * combination instead of being rendered again.
+ */
+static gboolean
+icon_info_ensure_symbolic_mask (GtkIconInfo  *icon_info,
+                                GError      **error)
+{
+  GdkRGBA red = { 1, 0, 0, 1 }, green = { 0, 1, 0, 1 };
+  GInputStream *stream;
+  GdkPixbuf *pixbuf, *mask;
+  gchar *file_data, *escaped_file_data;
+  gchar *icon_uri;
+  gsize file_len;
+  gint symbolic_size;
+  gboolean is_png;
+  int plane;
+
+  if (icon_info->symbolic_mask)
+    return TRUE;
 
   if (!icon_info_ensure_scale_and_pixbuf (icon_info))
     {
-      g_propagate_error (error, icon_info->load_error);
-      icon_info->load_error = NULL;
-      g_free (css_fg);
-      g_free (css_warning);
-      g_free (css_error);
-      g_free (css_success);
-      g_free (file_data);
-      return NULL;
+      if (icon_info->load_error)
+        {
+          if (error)
+            *error = g_error_copy (icon_info->load_error);
+        }
+      else
+        {
+          g_set_error_literal (error,
+                               GTK_ICON_THEME_ERROR,
+                               GTK_ICON_THEME_NOT_FOUND,
+                               _("Failed to load icon"));
+        }
+
+      return FALSE;
     }
 
+  icon_uri = g_file_get_uri (icon_info->icon_file);
+  is_png = g_str_has_suffix (icon_uri, ".symbolic.png");
+  g_free (icon_uri);
+
+  if (is_png)
+    {
+      icon_info->symbolic_mask = g_object_ref (icon_info->pixbuf);
+      return TRUE;
+    }
+
+  if (!g_file_load_contents (icon_info->icon_file, NULL, &file_data, &file_len, NULL, error))
+    return FALSE;
+
   if (icon_info->symbolic_width == 0 ||
       icon_info->symbolic_height == 0)
     {
@@ -4514,12 +5165,8 @@ gtk_icon_info_load_symbolic_svg (GtkIconInfo    *icon_info,
 
       if (!pixbuf)
         {
-          g_free (css_fg);
-          g_free (css_warning);
-          g_free (css_error);
-          g_free (css_success);
           g_free (file_data);
-          return NULL;
+          return FALSE;
         }
 
       icon_info->symbolic_width = gdk_pixbuf_get_width (pixbuf);
@@ -4540,58 +5187,49 @@ gtk_icon_info_load_symbolic_svg (GtkIconInfo    *icon_info,
                icon_info->dir_size * icon_info->dir_scale)
   );
 
-  width = g_strdup_printf ("%d", icon_info->symbolic_width);
-  height = g_strdup_printf ("%d", icon_info->symbolic_height);
-
   escaped_file_data = g_markup_escape_text (file_data, file_len);
   g_free (file_data);
 
-  g_ascii_dtostr (alphastr, G_ASCII_DTOSTR_BUF_SIZE, CLAMP (alpha, 0, 1));
+  mask = NULL;
+  for (plane = 0; plane < 3; plane++)
+    {
+      /* All colors are solid, so the alpha is the same in each
+       * rendering. The one color that is red in this rendering
+       * gives the coverage of that color in the red channel.
+       */
+      pixbuf = render_symbolic_svg (icon_info, escaped_file_data,
+                                    &green,
+                                    plane == 0 ? &red : &green,
+                                    plane == 1 ? &red : &green,
+                                    plane == 2 ? &red : &green,
+                                    error);
+      if (pixbuf == NULL)
+        {
+          g_clear_object (&mask);
+          g_free (escaped_file_data);
+          return FALSE;
+        }
+
+      if (mask == NULL)
+        {
+          mask = gdk_pixbuf_new (GDK_COLORSPACE_RGB, TRUE, 8,
+                                 gdk_pixbuf_get_width (pixbuf),
+                                 gdk_pixbuf_get_height (pixbuf));
+          gdk_pixbuf_fill (mask, 0);
+          copy_plane (pixbuf, mask, 3, 3);
+        }
+
+      copy_plane (pixbuf, mask, 0, plane);
+      g_object_unref (pixbuf);
+    }
 
-  data = g_strconcat ("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n"
-                      "<svg version=\"1.1\"\n"
-                      "     xmlns=\"http://www.w3.org/2000/svg\"\n"
-                      "     xmlns:xi=\"http://www.w3.org/2001/XInclude\"\n"
-                      "     width=\"", width, "\"\n"
-                      "     height=\"", height, "\">\n"
-                      "  <style type=\"text/css\">\n"
-                      "    rect,path {\n"
-                      "      fill: ", css_fg," !important;\n"
-                      "    }\n"
-                      "    .warning {\n"
-                      "      fill: ", css_warning, " !important;\n"
-                      "    }\n"
-                      "    .error {\n"
-                      "      fill: ", css_error ," !important;\n"
-                      "    }\n"
-                      "    .success {\n"
-                      "      fill: ", css_success, " !important;\n"
-                      "    }\n"
-                      "  </style>\n"
-                      "  <g opacity=\"", alphastr, "\" ><xi:include href=\"data:text/xml,", escaped_file_data, "\"/></g>\n"
-                      "</svg>",
-                      NULL);
   g_free (escaped_file_data);
-  g_free (css_fg);
-  g_free (css_warning);
-  g_free (css_error);
-  g_free (css_success);
-  g_free (width);
-  g_free (height);
 
-  stream = g_memory_input_stream_new_from_data (data, -1, g_free);
-  pixbuf = gdk_pixbuf_new_from_stream_at_scale (stream,
-                                                gdk_pixbuf_get_width (icon_info->pixbuf),
-                                                gdk_pixbuf_get_height (icon_info->pixbuf),
-                                                TRUE,
-                                                NULL,
-                                                error);
-  g_object_unref (stream);
+  icon_info->symbolic_mask = mask;
 
-  return pixbuf;
+  return TRUE;
 }
 
-
 static GdkPixbuf *
 gtk_icon_info_load_symbolic_internal (GtkIconInfo    *icon_info,
 				      const GdkRGBA  *fg,
@@ -4601,9 +5239,8 @@ gtk_icon_info_load_symbolic_internal (GtkIconInfo    *icon_info,
 				      gboolean        use_cache,
 				      GError        **error)
 {
-  GdkPixbuf *pixbuf;
+  GdkPixbuf *pixbuf, *icon;
   SymbolicPixbufCache *symbolic_cache;
-  char *icon_uri;
 
   if (use_cache)
     {
@@ -4618,38 +5255,32 @@ gtk_icon_info_load_symbolic_internal (GtkIconInfo    *icon_info,
    */
   g_return_val_if_fail (fg != NULL, NULL);
 
-  icon_uri = g_file_get_uri (icon_info->icon_file);
-  if (g_str_has_suffix (icon_uri, ".symbolic.png"))
-    pixbuf = gtk_icon_info_load_symbolic_png (icon_info, fg, success_color, warning_color, error_color, error);
-  else
-    pixbuf = gtk_icon_info_load_symbolic_svg (icon_info, fg, success_color, warning_color, error_color, error);
+  if (!icon_info_ensure_symbolic_mask (icon_info, error))
+    return NULL;
 
-  g_free (icon_uri);
+  pixbuf = gtk_icon_theme_color_symbolic_pixbuf (icon_info->symbolic_mask,
+                                                 fg,
+                                                 success_color ? success_color : &symbolic_success_default,
+                                                 warning_color ? warning_color : &symbolic_warning_default,
+                                                 error_color ? error_color : &symbolic_error_default);
 
-  if (pixbuf != NULL)
+  icon = apply_emblems_to_pixbuf (pixbuf, icon_info);
+  if (icon != NULL)
     {
-      GdkPixbuf *icon;
-
-      icon = apply_emblems_to_pixbuf (pixbuf, icon_info);
-      if (icon != NULL)
-        {
-          g_object_unref (pixbuf);
-          pixbuf = icon;
-        }
-
-      if (use_cache)
-        {
-          icon_info->symbolic_pixbuf_cache =
-            symbolic_pixbuf_cache_new (pixbuf, fg, success_color, warning_color, error_color,
-                                       icon_info->symbolic_pixbuf_cache);
-          g_object_unref (pixbuf);
-          return symbolic_cache_get_proxy (icon_info->symbolic_pixbuf_cache, icon_info);
-        }
-      else
-        return pixbuf;
+      g_object_unref (pixbuf);
+      pixbuf = icon;
     }
 
-  return NULL;
+  if (use_cache)
+    {
+      icon_info->symbolic_pixbuf_cache =
+        symbolic_pixbuf_cache_new (pixbuf, fg, success_color, warning_color, error_color,
+                                   icon_info->symbolic_pixbuf_cache);
+      g_object_unref (pixbuf);
+      return symbolic_cache_get_proxy (icon_info->symbolic_pixbuf_cache, icon_info);
+    }
+  else
+    return pixbuf;
 }
 
 /**
@@ -4935,6 +5566,14 @@ gtk_icon_info_load_symbolic_async (GtkIconInfo          *icon_info,
           pixbuf = symbolic_cache_get_proxy (symbolic_cache, icon_info);
           g_task_return_pointer (task, pixbuf, g_object_unref);
         }
+      else if (icon_info->symbolic_mask)
+        {
+          /* Recoloring does not block, no need for a thread */
+          pixbuf = gtk_icon_info_load_symbolic_internal (icon_info,
+                                                         fg, success_color, warning_color, error_color,
+                                                         TRUE, NULL);
+          g_task_return_pointer (task, pixbuf, g_object_unref);
+        }
       else
         {
           if (fg)
@@ -5007,6 +5646,14 @@ gtk_icon_info_load_symbolic_finish (GtkIconInfo   *icon_info,
 
       g_assert (pixbuf != NULL); /* we checked for !had_error above */
 
+      /* Keep the mask, so the next color combination is cheap */
+      if (icon_info->symbolic_mask == NULL && data->dup->symbolic_mask != NULL)
+        {
+          icon_info->symbolic_mask = g_object_ref (data->dup->symbolic_mask);
+          icon_info->symbolic_width = data->dup->symbolic_width;
+          icon_info->symbolic_height = data->dup->symbolic_height;
+        }
+
       symbolic_cache = symbolic_pixbuf_cache_matches (icon_info->symbolic_pixbuf_cache,
                                                       data->fg_set ? &data->fg : NULL,
                                                       data->success_color_set ? &data->success_color : NULL,
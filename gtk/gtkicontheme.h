@@ -160,6 +160,46 @@ typedef enum {
 GDK_AVAILABLE_IN_ALL
 GQuark gtk_icon_theme_error_quark (void);
 
+typedef struct _GtkIconPrefetchRequest GtkIconPrefetchRequest;
+
+/**
+ * GtkIconPrefetchRequest:
+ * @icon_name: the name of the icon to load
+ * @size: desired icon size
+ * @scale: the desired scale
+ * @data: data of the caller, for example the item that shows the icon
+ *
+ * An icon to load with gtk_icon_theme_prefetch_icons_async().
+ *
+ * Since: 3.90
+ */
+struct _GtkIconPrefetchRequest
+{
+  const gchar *icon_name;
+  gint         size;
+  gint         scale;
+  gpointer     data;
+};
+
+/**
+ * GtkIconPrefetchFunc:
+ * @icon_theme: the #GtkIconTheme
+ * @request: a copy of the request that was prefetched
+ * @icon_info: (allow-none): the #GtkIconInfo for @request, or %NULL
+ *     if the icon was not found
+ * @user_data: the user data passed to gtk_icon_theme_prefetch_icons_async()
+ *
+ * The type of the function that is called for each icon by
+ * gtk_icon_theme_prefetch_icons_async() once it has been loaded.
+ * Loading @icon_info with gtk_icon_info_load_icon() does not block.
+ *
+ * Since: 3.90
+ */
+typedef void (* GtkIconPrefetchFunc) (GtkIconTheme                 *icon_theme,
+                                      const GtkIconPrefetchRequest *request,
+                                      GtkIconInfo                  *icon_info,
+                                      gpointer                      user_data);
+
 GDK_AVAILABLE_IN_ALL
 GType         gtk_icon_theme_get_type              (void) G_GNUC_CONST;
 
@@ -259,6 +299,20 @@ GtkIconInfo * gtk_icon_theme_lookup_by_gicon_for_scale (GtkIconTheme
                                                         gint                      scale,
                                                         GtkIconLookupFlags        flags);
 
+GDK_AVAILABLE_IN_3_90
+void          gtk_icon_theme_prefetch_icons_async  (GtkIconTheme                 *icon_theme,
+                                                    const GtkIconPrefetchRequest *requests,
+                                                    guint                         n_requests,
+                                                    GtkIconLookupFlags            flags,
+                                                    GCancellable                 *cancellable,
+                                                    GtkIconPrefetchFunc           icon_func,
+                                                    GAsyncReadyCallback           callback,
+                                                    gpointer                      user_data);
+GDK_AVAILABLE_IN_3_90
+gboolean      gtk_icon_theme_prefetch_icons_finish (GtkIconTheme                *icon_theme,
+                                                    GAsyncResult                *result,
+                                                    GError                     **error);
+
 
 GDK_AVAILABLE_IN_ALL
 GList *       gtk_icon_theme_list_icons            (GtkIconTheme                *icon_theme,
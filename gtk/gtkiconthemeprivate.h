@@ -37,5 +37,21 @@ GdkPixbuf * gtk_icon_theme_color_symbolic_pixbuf (GdkPixbuf     *symbolic,
                                                   const GdkRGBA *warning_color,
                                                   const GdkRGBA *error_color);
 
+typedef struct
+{
+  guint hits;
+  guint misses;
+  guint evictions;
+
+  /* All infos in the cache, and the ones only the cache keeps alive */
+  guint n_cached;
+  guint n_unused;
+  gsize unused_size;
+  gsize budget;
+} GtkIconThemeCacheStats;
+
+void        gtk_icon_theme_get_cache_stats (GtkIconTheme           *icon_theme,
+                                            GtkIconThemeCacheStats *stats);
+
 
 #endif /* __GTK_ICON_THEME_PRIVATE_H__ */
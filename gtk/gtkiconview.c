@@ -86,6 +86,18 @@ struct _GtkIconViewChild
   GdkRectangle  area;
 };
 
+/* A row of the layout. The row context is made from the tallest
+ * item, see _gtk_icon_view_get_row_context().
+ */
+typedef struct _GtkIconViewRow GtkIconViewRow;
+struct _GtkIconViewRow
+{
+  GtkIconViewItem *tallest;
+  gint y;
+  gint height;
+  gint min_height, nat_height;
+};
+
 /* Signals */
 enum
 {
@@ -231,6 +243,11 @@ static gboolean             gtk_icon_view_unselect_all_internal          (GtkIco
 static void                 gtk_icon_view_update_rubberband              (gpointer                data);
 static void                 gtk_icon_view_item_invalidate_size           (GtkIconViewItem        *item);
 static void                 gtk_icon_view_invalidate_sizes               (GtkIconView            *icon_view);
+static void                 gtk_icon_view_queue_layout                   (GtkIconView            *icon_view,
+                                                                          gint                    index);
+static GList *              gtk_icon_view_get_item_link                  (GtkIconView            *icon_view,
+                                                                          gint                    index);
+static void                 row_context_free                             (GtkCellAreaContext     *context);
 static void                 gtk_icon_view_add_move_binding               (GtkBindingSet          *binding_set,
 									  guint                   keyval,
 									  guint                   modmask,
@@ -979,7 +996,9 @@ gtk_icon_view_init (GtkIconView *icon_view)
   icon_view->priv->draw_focus = TRUE;
 
   icon_view->priv->row_contexts = 
-    g_ptr_array_new_with_free_func ((GDestroyNotify)g_object_unref);
+    g_ptr_array_new_with_free_func ((GDestroyNotify)row_context_free);
+  icon_view->priv->rows = g_array_new (FALSE, FALSE, sizeof (GtkIconViewRow));
+  icon_view->priv->sized_width = -1;
 
   gtk_style_context_add_class (gtk_widget_get_style_context (GTK_WIDGET (icon_view)),
                                GTK_STYLE_CLASS_VIEW);
@@ -1008,6 +1027,9 @@ gtk_icon_view_dispose (GObject *object)
 
   if (priv->cell_area_context)
     {
+      g_signal_handler_disconnect (priv->cell_area_context, priv->context_changed_id);
+      priv->context_changed_id = 0;
+
       g_object_unref (priv->cell_area_context);
       priv->cell_area_context = NULL;
     }
@@ -1018,6 +1040,12 @@ gtk_icon_view_dispose (GObject *object)
       priv->row_contexts = NULL;
     }
 
+  if (priv->rows)
+    {
+      g_array_unref (priv->rows);
+      priv->rows = NULL;
+    }
+
   if (priv->cell_area)
     {
       gtk_cell_area_stop_editing (icon_view->priv->cell_area, TRUE);
@@ -1457,6 +1485,172 @@ gtk_icon_view_is_empty (GtkIconView *icon_view)
   return icon_view->priv->items == NULL;
 }
 
+/* Cell sizes are cached in the items. The preferred sizes of all items
+ * go into the cell area context, which only grows until all sizes are
+ * invalidated, so items only need to be measured once: when they are
+ * added, or when their row changed. The heights for the width of the
+ * layout are kept per item, so rewrapping the items into a different
+ * number of columns doesn’t measure anything.
+ */
+static void
+gtk_icon_view_invalidate_rows (GtkIconView *icon_view,
+                               gint         index)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+  guint n_rows;
+
+  priv->valid_items = MIN (priv->valid_items, index);
+
+  /* Called while disposing */
+  if (priv->rows == NULL)
+    return;
+
+  n_rows = priv->layout_columns > 0 ? priv->valid_items / priv->layout_columns : 0;
+
+  if (n_rows < priv->rows->len)
+    g_array_set_size (priv->rows, n_rows);
+  if (n_rows < priv->row_contexts->len)
+    g_ptr_array_set_size (priv->row_contexts, n_rows);
+}
+
+static void
+gtk_icon_view_clear_sizes (GtkIconView *icon_view)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+
+  g_list_foreach (priv->items, (GFunc)gtk_icon_view_item_invalidate_size, NULL);
+
+  if (priv->cell_area_context)
+    {
+      g_signal_handler_block (priv->cell_area_context, priv->context_changed_id);
+      gtk_cell_area_context_reset (priv->cell_area_context);
+      g_signal_handler_unblock (priv->cell_area_context, priv->context_changed_id);
+    }
+
+  priv->sized_width = -1;
+  gtk_icon_view_invalidate_rows (icon_view, 0);
+}
+
+/* The cell area resets the context when its cells change */
+static void
+gtk_icon_view_context_changed (GtkCellAreaContext *context,
+                               GParamSpec         *pspec,
+                               GtkIconView        *icon_view)
+{
+  gint min_width;
+
+  gtk_cell_area_context_get_preferred_width (context, &min_width, NULL);
+  if (min_width == 0)
+    {
+      g_list_foreach (icon_view->priv->items, (GFunc)gtk_icon_view_item_invalidate_size, NULL);
+      icon_view->priv->sized_width = -1;
+      gtk_icon_view_queue_layout (icon_view, 0);
+    }
+}
+
+static void
+gtk_icon_view_ensure_item_sizes (GtkIconView *icon_view)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+  GtkWidget *widget = GTK_WIDGET (icon_view);
+  GtkIconViewItem *item;
+  GList *items;
+  gint old_min, old_nat, min, nat;
+
+  item = priv->items->data;
+  if (item->min_width < 0 && priv->text_cell)
+    {
+      gint old_wrap_width, wrap_width;
+
+      /* The wrap width is guessed from the first item */
+      g_object_get (priv->text_cell, "wrap-width", &old_wrap_width, NULL);
+      _gtk_icon_view_set_cell_data (icon_view, item);
+      adjust_wrap_width (icon_view);
+      g_object_get (priv->text_cell, "wrap-width", &wrap_width, NULL);
+
+      if (wrap_width != old_wrap_width)
+        gtk_icon_view_clear_sizes (icon_view);
+    }
+
+  gtk_cell_area_context_get_preferred_width (priv->cell_area_context, &old_min, &old_nat);
+
+  /* Only items after valid_items can be unmeasured */
+  for (items = gtk_icon_view_get_item_link (icon_view, priv->valid_items); items; items = items->next)
+    {
+      item = items->data;
+
+      if (item->min_width >= 0)
+        continue;
+
+      _gtk_icon_view_set_cell_data (icon_view, item);
+      gtk_cell_area_get_preferred_width (priv->cell_area,
+                                         priv->cell_area_context,
+                                         widget,
+                                         &item->min_width, &item->nat_width);
+      gtk_cell_area_get_preferred_height (priv->cell_area,
+                                          priv->cell_area_context,
+                                          widget,
+                                          NULL, NULL);
+    }
+
+  /* The heights for width depend on how the widths are aligned */
+  gtk_cell_area_context_get_preferred_width (priv->cell_area_context, &min, &nat);
+  if (min != old_min || nat != old_nat)
+    {
+      priv->sized_width = -1;
+      g_ptr_array_set_size (priv->row_contexts, 0);
+    }
+}
+
+static void
+gtk_icon_view_ensure_item_heights (GtkIconView *icon_view,
+                                   gint         width)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+  GtkCellAreaContext *context = NULL;
+  GtkIconViewItem *item;
+  GList *items;
+
+  if (width != priv->sized_width)
+    {
+      for (items = priv->items; items; items = items->next)
+        {
+          item = items->data;
+          item->min_height = item->nat_height = -1;
+        }
+
+      priv->sized_width = width;
+      priv->item_min_height = 0;
+      priv->item_nat_height = 0;
+      gtk_icon_view_invalidate_rows (icon_view, 0);
+    }
+
+  for (items = gtk_icon_view_get_item_link (icon_view, priv->valid_items); items; items = items->next)
+    {
+      item = items->data;
+
+      if (item->min_height >= 0)
+        continue;
+
+      if (context == NULL)
+        context = gtk_cell_area_copy_context (priv->cell_area, priv->cell_area_context);
+
+      _gtk_icon_view_set_cell_data (icon_view, item);
+      gtk_cell_area_get_preferred_height_for_width (priv->cell_area,
+                                                    context,
+                                                    GTK_WIDGET (icon_view),
+                                                    width,
+                                                    &item->min_height,
+                                                    &item->nat_height);
+
+      priv->item_min_height = MAX (priv->item_min_height, item->min_height);
+      priv->item_nat_height = MAX (priv->item_nat_height, item->nat_height);
+    }
+
+  if (context)
+    g_object_unref (context);
+}
+
 static void
 gtk_icon_view_get_preferred_item_size (GtkIconView    *icon_view,
                                        GtkOrientation  orientation,
@@ -1470,51 +1664,54 @@ gtk_icon_view_get_preferred_item_size (GtkIconView    *icon_view,
 
   g_assert (!gtk_icon_view_is_empty (icon_view));
 
-  context = gtk_cell_area_create_context (priv->cell_area);
-
   for_size -= 2 * priv->item_padding;
 
-  if (for_size > 0)
+  gtk_icon_view_ensure_item_sizes (icon_view);
+
+  if (for_size <= 0)
+    {
+      if (orientation == GTK_ORIENTATION_HORIZONTAL)
+        gtk_cell_area_context_get_preferred_width (priv->cell_area_context,
+                                                   minimum, natural);
+      else
+        gtk_cell_area_context_get_preferred_height (priv->cell_area_context,
+                                                    minimum, natural);
+    }
+  else if (orientation == GTK_ORIENTATION_VERTICAL)
+    {
+      gtk_icon_view_ensure_item_heights (icon_view, for_size);
+
+      if (minimum)
+        *minimum = priv->item_min_height;
+      if (natural)
+        *natural = priv->item_nat_height;
+    }
+  else
     {
-      /* This is necessary for the context to work properly */
+      /* Widths for height are not cached */
+      context = gtk_cell_area_create_context (priv->cell_area);
+
       for (items = priv->items; items; items = items->next)
         {
           GtkIconViewItem *item = items->data;
 
           _gtk_icon_view_set_cell_data (icon_view, item);
-          cell_area_get_preferred_size (icon_view, context, 1 - orientation, -1, NULL, NULL);
+          cell_area_get_preferred_size (icon_view, context, GTK_ORIENTATION_VERTICAL, -1, NULL, NULL);
         }
-    }
 
-  for (items = priv->items; items; items = items->next)
-    {
-      GtkIconViewItem *item = items->data;
+      for (items = priv->items; items; items = items->next)
+        {
+          GtkIconViewItem *item = items->data;
 
-      _gtk_icon_view_set_cell_data (icon_view, item);
-      if (items == priv->items)
-        adjust_wrap_width (icon_view);
-      cell_area_get_preferred_size (icon_view, context, orientation, for_size, NULL, NULL);
-    }
+          _gtk_icon_view_set_cell_data (icon_view, item);
+          cell_area_get_preferred_size (icon_view, context, orientation, for_size, NULL, NULL);
+        }
 
-  if (orientation == GTK_ORIENTATION_HORIZONTAL)
-    {
-      if (for_size > 0)
-        gtk_cell_area_context_get_preferred_width_for_height (context,
-                                                              for_size,
-                                                              minimum, natural);
-      else
-        gtk_cell_area_context_get_preferred_width (context,
-                                                   minimum, natural);
-    }
-  else
-    {
-      if (for_size > 0)
-        gtk_cell_area_context_get_preferred_height_for_width (context,
-                                                              for_size,
-                                                              minimum, natural);
-      else
-        gtk_cell_area_context_get_preferred_height (context,
-                                                    minimum, natural);
+      gtk_cell_area_context_get_preferred_width_for_height (context,
+                                                            for_size,
+                                                            minimum, natural);
+
+      g_object_unref (context);
     }
 
   if (orientation == GTK_ORIENTATION_HORIZONTAL && priv->item_width >= 0)
@@ -1529,8 +1726,6 @@ gtk_icon_view_get_preferred_item_size (GtkIconView    *icon_view,
     *minimum = MAX (1, *minimum + 2 * priv->item_padding);
   if (natural)
     *natural = MAX (1, *natural + 2 * priv->item_padding);
-
-  g_object_unref (context);
 }
 
 static void
@@ -1737,7 +1932,10 @@ gtk_icon_view_get_preferred_height_for_width (GtkWidget *widget,
   gtk_icon_view_compute_n_items_for_size (icon_view, GTK_ORIENTATION_HORIZONTAL, width, NULL, NULL, &columns, &column_width);
   n_items = gtk_icon_view_get_n_items (icon_view);
 
-  gtk_icon_view_get_preferred_item_size (icon_view, GTK_ORIENTATION_VERTICAL, column_width, &item_min, &item_nat);
+  /* Measure the items for the width the layout gives them */
+  gtk_icon_view_get_preferred_item_size (icon_view, GTK_ORIENTATION_VERTICAL,
+                                         column_width + 2 * priv->item_padding,
+                                         &item_min, &item_nat);
   *minimum = (item_min + priv->row_spacing) * ((n_items + columns - 1) / columns) - priv->row_spacing;
   *natural = (item_nat + priv->row_spacing) * ((n_items + columns - 1) / columns) - priv->row_spacing;
 
@@ -2195,7 +2393,7 @@ gtk_icon_view_set_cursor (GtkIconView     *icon_view,
     {
       GtkCellAreaContext *context;
 
-      context = g_ptr_array_index (icon_view->priv->row_contexts, item->row);
+      context = _gtk_icon_view_get_row_context (icon_view, item);
       _gtk_icon_view_set_cell_data (icon_view, item);
       gtk_cell_area_activate (icon_view->priv->cell_area, context, 
 			      GTK_WIDGET (icon_view), &item->cell_area, 
@@ -2351,7 +2549,7 @@ gtk_icon_view_button_press (GtkWidget      *widget,
 	    {
 	      GtkCellAreaContext *context;
 
-	      context = g_ptr_array_index (icon_view->priv->row_contexts, item->row);
+	      context = _gtk_icon_view_get_row_context (icon_view, item);
 
 	      _gtk_icon_view_set_cell_data (icon_view, item);
 	      gtk_cell_area_activate (icon_view->priv->cell_area, context,
@@ -2651,7 +2849,7 @@ gtk_icon_view_item_hit_test (GtkIconView      *icon_view,
       MIN (y + height, item_area->y + item_area->height) - MAX (y, item_area->y) <= 0)
     return FALSE;
 
-  context = g_ptr_array_index (icon_view->priv->row_contexts, item->row);
+  context = _gtk_icon_view_get_row_context (icon_view, item);
 
   _gtk_icon_view_set_cell_data (icon_view, item);
   gtk_cell_area_foreach_alloc (icon_view->priv->cell_area, context,
@@ -2719,7 +2917,7 @@ gtk_icon_view_real_activate_cursor_item (GtkIconView *icon_view)
   if (!icon_view->priv->cursor_item)
     return FALSE;
 
-  context = g_ptr_array_index (icon_view->priv->row_contexts, icon_view->priv->cursor_item->row);
+  context = _gtk_icon_view_get_row_context (icon_view, icon_view->priv->cursor_item);
 
   _gtk_icon_view_set_cell_data (icon_view, icon_view->priv->cursor_item);
   gtk_cell_area_activate (icon_view->priv->cell_area, context,
@@ -2913,6 +3111,44 @@ compare_sizes (gconstpointer p1,
        - GPOINTER_TO_INT (((const GtkRequestedSize *) p2)->data);
 }
 
+/* Positions the items of @row, starting at @items. Returns the
+ * first item of the next row.
+ */
+static GList *
+gtk_icon_view_place_row (GtkIconView *icon_view,
+                         gint         row,
+                         GList       *items)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+  GtkIconViewRow *row_data = &g_array_index (priv->rows, GtkIconViewRow, row);
+  gint item_width = priv->layout_item_width;
+  gint col;
+
+  for (col = 0; col < priv->layout_columns && items; col++, items = items->next)
+    {
+      GtkIconViewItem *item = items->data;
+
+      item->cell_area.x = priv->margin + (col * 2 + 1) * priv->item_padding + col * (priv->column_spacing + item_width);
+      item->cell_area.width = item_width;
+      item->cell_area.y = row_data->y;
+      item->cell_area.height = row_data->height;
+      item->row = row;
+      item->col = col;
+      if (priv->layout_rtl)
+        {
+          item->cell_area.x = priv->width - item_width - item->cell_area.x;
+          item->col = priv->layout_columns - 1 - col;
+        }
+    }
+
+  return items;
+}
+
+/* Items before valid_items keep their place, so only the rows from
+ * the first changed item on are laid out again. Appending items only
+ * lays out the last rows, and a different width only rewraps the
+ * items, using their cached sizes.
+ */
 static void
 gtk_icon_view_layout (GtkIconView *icon_view)
 {
@@ -2920,126 +3156,219 @@ gtk_icon_view_layout (GtkIconView *icon_view)
   GtkWidget *widget = GTK_WIDGET (icon_view);
   GList *items;
   gint item_width; /* this doesn't include item_padding */
-  gint n_columns, n_rows, n_items;
-  gint col, row;
+  gint n_columns, n_rows, n_items, allocated_height;
+  gint col, row, y;
   GtkRequestedSize *sizes;
   gboolean rtl;
 
   if (gtk_icon_view_is_empty (icon_view))
-    return;
+    {
+      gtk_icon_view_invalidate_rows (icon_view, 0);
+      return;
+    }
 
   rtl = gtk_widget_get_direction (GTK_WIDGET (icon_view)) == GTK_TEXT_DIR_RTL;
   n_items = gtk_icon_view_get_n_items (icon_view);
+  allocated_height = gtk_widget_get_allocated_height (widget);
 
   gtk_icon_view_compute_n_items_for_size (icon_view, 
                                           GTK_ORIENTATION_HORIZONTAL,
                                           gtk_widget_get_allocated_width (widget),
                                           NULL, NULL,
                                           &n_columns, &item_width);
-  n_rows = (n_items + n_columns - 1) / n_columns;
 
   priv->width = n_columns * (item_width + 2 * priv->item_padding + priv->column_spacing) - priv->column_spacing;
   priv->width += 2 * priv->margin;
   priv->width = MAX (priv->width, gtk_widget_get_allocated_width (widget));
 
-  /* Clear the per row contexts */
-  g_ptr_array_set_size (icon_view->priv->row_contexts, 0);
-
-  gtk_cell_area_context_reset (priv->cell_area_context);
-  /* because layouting is complicated. We designed an API
-   * that is O(N²) and nonsensical.
-   * And we're proud of it. */
-  for (items = priv->items; items; items = items->next)
+  if (n_columns != priv->layout_columns ||
+      item_width != priv->layout_item_width ||
+      priv->width != priv->layout_width ||
+      rtl != priv->layout_rtl ||
+      priv->rows_distributed)
     {
-      _gtk_icon_view_set_cell_data (icon_view, items->data);
-      gtk_cell_area_get_preferred_width (priv->cell_area,
-                                         priv->cell_area_context,
-                                         widget,
-                                         NULL, NULL);
+      gtk_icon_view_invalidate_rows (icon_view, 0);
+      priv->layout_columns = n_columns;
+      priv->layout_item_width = item_width;
+      priv->layout_width = priv->width;
+      priv->layout_rtl = rtl;
     }
 
-  sizes = g_newa (GtkRequestedSize, n_rows);
-  items = priv->items;
-  priv->height = priv->margin;
+  gtk_icon_view_ensure_item_heights (icon_view, item_width);
 
-  /* Collect the heights for all rows */
-  for (row = 0; row < n_rows; row++)
+  row = MIN ((gint) priv->rows->len, priv->valid_items / n_columns);
+  g_array_set_size (priv->rows, row);
+  if ((gint) priv->row_contexts->len > row)
+    g_ptr_array_set_size (priv->row_contexts, row);
+
+  if (row > 0)
     {
-      GtkCellAreaContext *context = gtk_cell_area_copy_context (priv->cell_area, priv->cell_area_context);
-      g_ptr_array_add (priv->row_contexts, context);
+      GtkIconViewRow *last = &g_array_index (priv->rows, GtkIconViewRow, row - 1);
+
+      y = last->y + last->height + 2 * priv->item_padding + priv->row_spacing;
+    }
+  else
+    y = priv->margin + priv->item_padding;
 
-      for (col = 0; col < n_columns && items; col++, items = items->next)
+  /* Collect the heights of the rows, and place them */
+  items = gtk_icon_view_get_item_link (icon_view, row * n_columns);
+  for (; items; row++)
+    {
+      GtkIconViewRow row_data = { NULL, };
+      GList *list;
+
+      for (col = 0, list = items; col < n_columns && list; col++, list = list->next)
         {
-          GtkIconViewItem *item = items->data;
+          GtkIconViewItem *item = list->data;
 
-          _gtk_icon_view_set_cell_data (icon_view, item);
-          gtk_cell_area_get_preferred_height_for_width (priv->cell_area,
-                                                        context,
-                                                        widget,
-                                                        item_width, 
-                                                        NULL, NULL);
+          if (row_data.tallest == NULL || item->min_height > row_data.min_height)
+            {
+              row_data.tallest = item;
+              row_data.min_height = item->min_height;
+            }
+          row_data.nat_height = MAX (row_data.nat_height, item->nat_height);
         }
-      
-      sizes[row].data = GINT_TO_POINTER (row);
-      gtk_cell_area_context_get_preferred_height_for_width (context,
-                                                            item_width,
-                                                            &sizes[row].minimum_size,
-                                                            &sizes[row].natural_size);
-      priv->height += sizes[row].minimum_size + 2 * priv->item_padding + priv->row_spacing;
-    }
 
-  priv->height -= priv->row_spacing;
-  priv->height += priv->margin;
-  priv->height = MIN (priv->height, gtk_widget_get_allocated_height (widget));
+      row_data.y = y;
+      row_data.height = row_data.min_height;
+      g_array_append_val (priv->rows, row_data);
 
-  gtk_distribute_natural_allocation (gtk_widget_get_allocated_height (widget) - priv->height,
-                                     n_rows,
-                                     sizes);
+      items = gtk_icon_view_place_row (icon_view, row, items);
+      y += row_data.height + 2 * priv->item_padding + priv->row_spacing;
+    }
 
-  /* Actually allocate the rows */
-  g_qsort_with_data (sizes, n_rows, sizeof (GtkRequestedSize), compare_sizes, NULL);
-  
-  items = priv->items;
-  priv->height = priv->margin;
+  n_rows = priv->rows->len;
+  priv->height = y - priv->item_padding - priv->row_spacing + priv->margin;
 
-  for (row = 0; row < n_rows; row++)
+  /* Space left in the allocation goes to the rows, up to their
+   * natural heights. This moves all of them.
+   */
+  priv->rows_distributed = priv->height < allocated_height;
+  if (priv->rows_distributed)
     {
-      GtkCellAreaContext *context = g_ptr_array_index (priv->row_contexts, row);
-      gtk_cell_area_context_allocate (context, item_width, sizes[row].minimum_size);
+      sizes = g_newa (GtkRequestedSize, n_rows);
+
+      for (row = 0; row < n_rows; row++)
+        {
+          GtkIconViewRow *row_data = &g_array_index (priv->rows, GtkIconViewRow, row);
 
-      priv->height += priv->item_padding;
+          sizes[row].data = GINT_TO_POINTER (row);
+          sizes[row].minimum_size = row_data->min_height;
+          sizes[row].natural_size = row_data->nat_height;
+        }
+
+      gtk_distribute_natural_allocation (allocated_height - priv->height,
+                                         n_rows,
+                                         sizes);
+      g_qsort_with_data (sizes, n_rows, sizeof (GtkRequestedSize), compare_sizes, NULL);
+
+      g_ptr_array_set_size (priv->row_contexts, 0);
+
+      items = priv->items;
+      y = priv->margin + priv->item_padding;
 
-      for (col = 0; col < n_columns && items; col++, items = items->next)
+      for (row = 0; row < n_rows; row++)
         {
-          GtkIconViewItem *item = items->data;
+          GtkIconViewRow *row_data = &g_array_index (priv->rows, GtkIconViewRow, row);
 
-          item->cell_area.x = priv->margin + (col * 2 + 1) * priv->item_padding + col * (priv->column_spacing + item_width);
-          item->cell_area.width = item_width;
-          item->cell_area.y = priv->height;
-          item->cell_area.height = sizes[row].minimum_size;
-          item->row = row;
-          item->col = col;
-          if (rtl)
-            {
-              item->cell_area.x = priv->width - item_width - item->cell_area.x;
-              item->col = n_columns - 1 - col;
-            }
+          row_data->y = y;
+          row_data->height = sizes[row].minimum_size;
+
+          items = gtk_icon_view_place_row (icon_view, row, items);
+          y += row_data->height + 2 * priv->item_padding + priv->row_spacing;
         }
 
-      priv->height += sizes[row].minimum_size + priv->item_padding + priv->row_spacing;
+      priv->height = y - priv->item_padding - priv->row_spacing + priv->margin;
+    }
+
+  priv->height = MAX (priv->height, allocated_height);
+  priv->valid_items = n_items;
+}
+
+/* The context of a row is made lazily, from its tallest item */
+GtkCellAreaContext *
+_gtk_icon_view_get_row_context (GtkIconView     *icon_view,
+                                GtkIconViewItem *item)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+  GtkCellAreaContext *context;
+  GtkIconViewRow *row;
+
+  /* Rows after a change are only back after the next layout */
+  if (item->row < 0 || (guint) item->row >= priv->rows->len)
+    return priv->cell_area_context;
+
+  if (priv->row_contexts->len < priv->rows->len)
+    g_ptr_array_set_size (priv->row_contexts, priv->rows->len);
+
+  context = g_ptr_array_index (priv->row_contexts, item->row);
+  if (context == NULL)
+    {
+      row = &g_array_index (priv->rows, GtkIconViewRow, item->row);
+
+      context = gtk_cell_area_copy_context (priv->cell_area, priv->cell_area_context);
+      _gtk_icon_view_set_cell_data (icon_view, row->tallest);
+      gtk_cell_area_get_preferred_height_for_width (priv->cell_area,
+                                                    context,
+                                                    GTK_WIDGET (icon_view),
+                                                    priv->layout_item_width,
+                                                    NULL, NULL);
+      gtk_cell_area_context_allocate (context, priv->layout_item_width, row->height);
+      g_ptr_array_index (priv->row_contexts, item->row) = context;
+
+      /* Callers may have set the cell data already */
+      if (row->tallest != item)
+        _gtk_icon_view_set_cell_data (icon_view, item);
     }
 
-  priv->height -= priv->row_spacing;
-  priv->height += priv->margin;
-  priv->height = MAX (priv->height, gtk_widget_get_allocated_height (widget));
+  return context;
+}
+
+static void
+row_context_free (GtkCellAreaContext *context)
+{
+  if (context)
+    g_object_unref (context);
+}
+
+static GList *
+gtk_icon_view_get_item_link (GtkIconView *icon_view,
+                             gint         index)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+  GList *list;
+  gint last;
+
+  if (priv->last_item == NULL)
+    return NULL;
+
+  last = ((GtkIconViewItem *) priv->last_item->data)->index;
+  if (index > last)
+    return NULL;
+
+  /* Walk from the closer end, appending is common */
+  if (index < last - index)
+    return g_list_nth (priv->items, index);
+
+  for (list = priv->last_item; last > index; last--)
+    list = list->prev;
+
+  return list;
+}
+
+static void
+gtk_icon_view_queue_layout (GtkIconView *icon_view,
+                            gint         index)
+{
+  gtk_icon_view_invalidate_rows (icon_view, index);
+  gtk_widget_queue_resize (GTK_WIDGET (icon_view));
 }
 
 static void
 gtk_icon_view_invalidate_sizes (GtkIconView *icon_view)
 {
   /* Clear all item sizes */
-  g_list_foreach (icon_view->priv->items,
-		  (GFunc)gtk_icon_view_item_invalidate_size, NULL);
+  gtk_icon_view_clear_sizes (icon_view);
 
   /* Re-layout the items */
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
@@ -3050,6 +3379,8 @@ gtk_icon_view_item_invalidate_size (GtkIconViewItem *item)
 {
   item->cell_area.width = -1;
   item->cell_area.height = -1;
+  item->min_width = item->nat_width = -1;
+  item->min_height = item->nat_height = -1;
 }
 
 static void
@@ -3115,7 +3446,7 @@ gtk_icon_view_paint_item (GtkIconView     *icon_view,
   cell_area.width  = item->cell_area.width;
   cell_area.height = item->cell_area.height;
 
-  context = g_ptr_array_index (priv->row_contexts, item->row);
+  context = _gtk_icon_view_get_row_context (icon_view, item);
   gtk_cell_area_render (priv->cell_area, context,
                         widget, cr, &cell_area, &cell_area, flags,
                         draw_focus);
@@ -3256,8 +3587,7 @@ gtk_icon_view_item_new (void)
 
   item = g_slice_new0 (GtkIconViewItem);
 
-  item->cell_area.width  = -1;
-  item->cell_area.height = -1;
+  gtk_icon_view_item_invalidate_size (item);
   
   return item;
 }
@@ -3297,7 +3627,7 @@ _gtk_icon_view_get_item_at_coords (GtkIconView          *icon_view,
 	      GtkCellRenderer *cell = NULL;
 	      GtkCellAreaContext *context;
 
-	      context = g_ptr_array_index (icon_view->priv->row_contexts, item->row);
+	      context = _gtk_icon_view_get_row_context (icon_view, item);
 	      _gtk_icon_view_set_cell_data (icon_view, item);
 
 	      if (x >= item_area->x && x <= item_area->x + item_area->width &&
@@ -3370,6 +3700,7 @@ _gtk_icon_view_unselect_item (GtkIconView      *icon_view,
 static void
 verify_items (GtkIconView *icon_view)
 {
+#ifdef G_ENABLE_CONSISTENCY_CHECKS
   GList *items;
   int i = 0;
 
@@ -3383,6 +3714,10 @@ verify_items (GtkIconView *icon_view)
 
       i++;
     }
+
+  if (g_list_last (icon_view->priv->items) != icon_view->priv->last_item)
+    g_error ("Last item does not match the end of the list");
+#endif
 }
 
 static void
@@ -3392,6 +3727,8 @@ gtk_icon_view_row_changed (GtkTreeModel *model,
                            gpointer      data)
 {
   GtkIconView *icon_view = GTK_ICON_VIEW (data);
+  GList *list;
+  gint index;
 
   /* ignore changes in branches */
   if (gtk_tree_path_get_depth (path) > 1)
@@ -3404,15 +3741,16 @@ gtk_icon_view_row_changed (GtkTreeModel *model,
   if (icon_view->priv->cell_area)
     gtk_cell_area_stop_editing (icon_view->priv->cell_area, TRUE);
 
-  /* Here we can use a "grow-only" strategy for optimization
-   * and only invalidate a single item and queue a relayout
-   * instead of invalidating the whole thing.
-   *
-   * For now GtkIconView still cant deal with huge models
-   * so just invalidate the whole thing when the model
-   * changes.
+  /* Using a "grow-only" strategy, only the changed item is
+   * measured again, and the items from its row on are laid out
+   * again.
    */
-  gtk_icon_view_invalidate_sizes (icon_view);
+  index = gtk_tree_path_get_indices (path)[0];
+  list = gtk_icon_view_get_item_link (icon_view, index);
+  if (list)
+    gtk_icon_view_item_invalidate_size (list->data);
+
+  gtk_icon_view_queue_layout (icon_view, index);
 
   verify_items (icon_view);
 }
@@ -3424,9 +3762,10 @@ gtk_icon_view_row_inserted (GtkTreeModel *model,
 			    gpointer      data)
 {
   GtkIconView *icon_view = GTK_ICON_VIEW (data);
+  GtkIconViewPrivate *priv = icon_view->priv;
   gint index;
   GtkIconViewItem *item;
-  GList *list;
+  GList *list, *sibling;
 
   /* ignore changes in branches */
   if (gtk_tree_path_get_depth (path) > 1)
@@ -3438,15 +3777,16 @@ gtk_icon_view_row_inserted (GtkTreeModel *model,
 
   item->index = index;
 
-  /* FIXME: We can be more efficient here,
-     we can store a tail pointer and use that when
-     appending (which is a rather common operation)
-  */
-  icon_view->priv->items = g_list_insert (icon_view->priv->items,
-					 item, index);
-  
-  list = g_list_nth (icon_view->priv->items, index + 1);
-  for (; list; list = list->next)
+  /* Appending uses the tail pointer instead of walking the list */
+  sibling = gtk_icon_view_get_item_link (icon_view, index);
+  if (sibling)
+    priv->items = g_list_insert_before (priv->items, sibling, item);
+  else if (priv->last_item)
+    priv->last_item = g_list_append (priv->last_item, item)->next;
+  else
+    priv->items = priv->last_item = g_list_append (NULL, item);
+
+  for (list = sibling; list; list = list->next)
     {
       item = list->data;
 
@@ -3455,7 +3795,7 @@ gtk_icon_view_row_inserted (GtkTreeModel *model,
     
   verify_items (icon_view);
 
-  gtk_widget_queue_resize (GTK_WIDGET (icon_view));
+  gtk_icon_view_queue_layout (icon_view, index);
 }
 
 static void
@@ -3475,7 +3815,7 @@ gtk_icon_view_row_deleted (GtkTreeModel *model,
 
   index = gtk_tree_path_get_indices(path)[0];
 
-  list = g_list_nth (icon_view->priv->items, index);
+  list = gtk_icon_view_get_item_link (icon_view, index);
   item = list->data;
 
   if (icon_view->priv->cell_area)
@@ -3492,6 +3832,9 @@ gtk_icon_view_row_deleted (GtkTreeModel *model,
 
   if (item->selected)
     emit = TRUE;
+
+  if (list == icon_view->priv->last_item)
+    icon_view->priv->last_item = list->prev;
   
   gtk_icon_view_item_free (item);
 
@@ -3504,9 +3847,13 @@ gtk_icon_view_row_deleted (GtkTreeModel *model,
   
   icon_view->priv->items = g_list_delete_link (icon_view->priv->items, list);
 
+  /* The first item guesses the wrap width */
+  if (index == 0 && icon_view->priv->items)
+    gtk_icon_view_item_invalidate_size (icon_view->priv->items->data);
+
   verify_items (icon_view);  
   
-  gtk_widget_queue_resize (GTK_WIDGET (icon_view));
+  gtk_icon_view_queue_layout (icon_view, index);
 
   if (emit)
     g_signal_emit (icon_view, icon_view_signals[SELECTION_CHANGED], 0);
@@ -3553,8 +3900,15 @@ gtk_icon_view_rows_reordered (GtkTreeModel *model,
   g_free (item_array);
   g_list_free (icon_view->priv->items);
   icon_view->priv->items = items;
+  icon_view->priv->last_item = g_list_last (items);
 
-  gtk_widget_queue_resize (GTK_WIDGET (icon_view));
+  /* The cached sizes stay valid, but the first item guesses the
+   * wrap width
+   */
+  if (items)
+    gtk_icon_view_item_invalidate_size (items->data);
+
+  gtk_icon_view_queue_layout (icon_view, 0);
 
   verify_items (icon_view);  
 }
@@ -3584,6 +3938,7 @@ gtk_icon_view_build_items (GtkIconView *icon_view)
       
     } while (gtk_tree_model_iter_next (icon_view->priv->model, &iter));
 
+  icon_view->priv->last_item = items;
   icon_view->priv->items = g_list_reverse (items);
 }
 
@@ -4266,6 +4621,9 @@ gtk_icon_view_ensure_cell_area (GtkIconView *icon_view,
     gtk_orientable_set_orientation (GTK_ORIENTABLE (priv->cell_area), priv->item_orientation);
 
   priv->cell_area_context = gtk_cell_area_create_context (priv->cell_area);
+  priv->context_changed_id =
+    g_signal_connect (priv->cell_area_context, "notify::minimum-width",
+                      G_CALLBACK (gtk_icon_view_context_changed), icon_view);
 
   priv->add_editable_id =
     g_signal_connect (priv->cell_area, "add-editable",
@@ -4519,7 +4877,7 @@ gtk_icon_view_get_cell_rect (GtkIconView     *icon_view,
     {
       GtkCellAreaContext *context;
 
-      context = g_ptr_array_index (icon_view->priv->row_contexts, item->row);
+      context = _gtk_icon_view_get_row_context (icon_view, item);
       _gtk_icon_view_set_cell_data (icon_view, item);
       gtk_cell_area_get_cell_allocation (icon_view->priv->cell_area, context,
 					 GTK_WIDGET (icon_view),
@@ -5000,12 +5358,15 @@ gtk_icon_view_set_model (GtkIconView *icon_view,
       
       g_list_free_full (icon_view->priv->items, (GDestroyNotify) gtk_icon_view_item_free);
       icon_view->priv->items = NULL;
+      icon_view->priv->last_item = NULL;
       icon_view->priv->anchor_item = NULL;
       icon_view->priv->cursor_item = NULL;
       icon_view->priv->last_single_clicked = NULL;
       icon_view->priv->last_prelight = NULL;
       icon_view->priv->width = 0;
       icon_view->priv->height = 0;
+
+      gtk_icon_view_clear_sizes (icon_view);
     }
 
   icon_view->priv->model = model;
@@ -30,6 +30,12 @@ struct _GtkIconViewItem
   
   gint row, col;
 
+  /* Cached cell sizes, -1 if not measured. The heights are
+   * for the cell width in GtkIconViewPrivate.sized_width.
+   */
+  gint min_width, nat_width;
+  gint min_height, nat_height;
+
   guint selected : 1;
   guint selected_before_rubberbanding : 1;
 
@@ -45,9 +51,20 @@ struct _GtkIconViewPrivate
   gulong              context_changed_id;
 
   GPtrArray          *row_contexts;
+  GArray             *rows;
 
   gint width, height;
 
+  /* Layout state, see gtk_icon_view_layout() */
+  gint valid_items;
+  gint sized_width;
+  gint item_min_height, item_nat_height;
+  gint layout_columns;
+  gint layout_item_width;
+  gint layout_width;
+  guint layout_rtl : 1;
+  guint rows_distributed : 1;
+
   GtkSelectionMode selection_mode;
 
   GdkWindow *bin_window;
@@ -57,6 +74,7 @@ struct _GtkIconViewPrivate
   GtkTreeModel *model;
 
   GList *items;
+  GList *last_item;
 
   GtkAdjustment *hadjustment;
   GtkAdjustment *vadjustment;
@@ -134,6 +152,8 @@ struct _GtkIconViewPrivate
 
 void                 _gtk_icon_view_set_cell_data                  (GtkIconView            *icon_view,
                                                                     GtkIconViewItem        *item);
+GtkCellAreaContext * _gtk_icon_view_get_row_context                (GtkIconView            *icon_view,
+                                                                    GtkIconViewItem        *item);
 void                 _gtk_icon_view_set_cursor_item                (GtkIconView            *icon_view,
                                                                     GtkIconViewItem        *item,
                                                                     GtkCellRenderer        *cursor_cell);
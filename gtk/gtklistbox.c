@@ -18,6 +18,8 @@
 #include "config.h"
 
 #include "gtkadjustmentprivate.h"
+#include "gtkbitmaskprivate.h"
+#include "gtkvirtualrangeprivate.h"
 #include "gtkcssnodeprivate.h"
 #include "gtklistbox.h"
 #include "gtkwidget.h"
@@ -120,6 +122,10 @@ typedef struct
   GtkListBoxCreateWidgetFunc create_widget_func;
   gpointer create_widget_func_data;
   GDestroyNotify create_widget_func_data_destroy;
+
+  /* Virtualized models, see gtk_list_box_bind_model_virtual() */
+  GtkListBoxBindRowFunc bind_row_func;
+  GtkVirtualRange range;
 } GtkListBoxPrivate;
 
 typedef struct
@@ -169,6 +175,9 @@ enum {
 #define BOX_PRIV(box) ((GtkListBoxPrivate*)gtk_list_box_get_instance_private ((GtkListBox*)(box)))
 #define ROW_PRIV(row) ((GtkListBoxRowPrivate*)gtk_list_box_row_get_instance_private ((GtkListBoxRow*)(row)))
 
+/* Rows to create for a virtualized model before the visible range is known */
+#define VIRTUAL_INITIAL_ROWS 32
+
 static void     gtk_list_box_buildable_interface_init     (GtkBuildableIface *iface);
 
 G_DEFINE_TYPE_WITH_CODE (GtkListBox, gtk_list_box, GTK_TYPE_CONTAINER,
@@ -288,6 +297,20 @@ static void                 gtk_list_box_bound_model_changed            (GListMo
 
 static void                 gtk_list_box_check_model_compat             (GtkListBox          *box);
 
+static guint                gtk_list_box_virtual_get_position           (GtkListBox          *box,
+                                                                         GtkListBoxRow       *row);
+static void                 gtk_list_box_virtual_get_row_extents        (GtkListBox          *box,
+                                                                         GtkListBoxRow       *row,
+                                                                         gint                *y,
+                                                                         gint                *height);
+static GtkListBoxRow *      gtk_list_box_virtual_get_cursor_target      (GtkListBox          *box,
+                                                                         GtkMovementStep      step,
+                                                                         gint                 count);
+static void                 gtk_list_box_virtual_queue_update           (GtkListBox          *box);
+static void                 gtk_list_box_virtual_clear                  (GtkListBox          *box);
+
+static const GtkVirtualRangeFuncs virtual_range_funcs;
+
 static void     gtk_list_box_measure    (GtkCssGadget        *gadget,
                                           GtkOrientation       orientation,
                                           gint                 for_size,
@@ -387,6 +410,9 @@ gtk_list_box_finalize (GObject *obj)
   if (priv->update_header_func_target_destroy_notify != NULL)
     priv->update_header_func_target_destroy_notify (priv->update_header_func_target);
 
+  if (priv->adjustment)
+    g_signal_handlers_disconnect_by_func (priv->adjustment,
+                                          gtk_list_box_virtual_queue_update, obj);
   g_clear_object (&priv->adjustment);
   g_clear_object (&priv->drag_highlighted_row);
   g_clear_object (&priv->multipress_gesture);
@@ -403,6 +429,8 @@ gtk_list_box_finalize (GObject *obj)
       g_clear_object (&priv->bound_model);
     }
 
+  _gtk_virtual_range_clear (&priv->range);
+
   g_clear_object (&priv->gadget);
 
   G_OBJECT_CLASS (gtk_list_box_parent_class)->finalize (obj);
@@ -644,6 +672,8 @@ gtk_list_box_init (GtkListBox *box)
   priv->activate_single_click = TRUE;
 
   priv->children = g_sequence_new (NULL);
+  _gtk_virtual_range_init (&priv->range, widget, &virtual_range_funcs,
+                           priv->children, VIRTUAL_INITIAL_ROWS);
   priv->header_hash = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, NULL);
 
   priv->multipress_gesture = gtk_gesture_multi_press_new (widget);
@@ -700,6 +730,10 @@ gtk_list_box_get_selected_row (GtkListBox *box)
  * If @_index is negative or larger than the number of items in the
  * list, %NULL is returned.
  *
+ * For a model bound with gtk_list_box_bind_model_virtual(), @index_
+ * is the position in the model, and %NULL is also returned if there
+ * currently is no row for it.
+ *
  * Returns: (transfer none) (nullable): the child #GtkWidget or %NULL
  *
  * Since: 3.10
@@ -712,6 +746,13 @@ gtk_list_box_get_row_at_index (GtkListBox *box,
 
   g_return_val_if_fail (GTK_IS_LIST_BOX (box), NULL);
 
+  if (BOX_PRIV (box)->bind_row_func != NULL)
+    {
+      if (index_ < (gint) BOX_PRIV (box)->range.first_position)
+        return NULL;
+      index_ -= BOX_PRIV (box)->range.first_position;
+    }
+
   iter = g_sequence_get_iter_at_pos (BOX_PRIV (box)->children, index_);
   if (!g_sequence_iter_is_end (iter))
     return g_sequence_get (iter);
@@ -1012,8 +1053,23 @@ gtk_list_box_set_adjustment (GtkListBox    *box,
   if (adjustment)
     g_object_ref_sink (adjustment);
   if (priv->adjustment)
-    g_object_unref (priv->adjustment);
+    {
+      g_signal_handlers_disconnect_by_func (priv->adjustment,
+                                            gtk_list_box_virtual_queue_update, box);
+      g_object_unref (priv->adjustment);
+    }
   priv->adjustment = adjustment;
+
+  /* Virtualized models follow the visible area */
+  if (adjustment)
+    {
+      g_signal_connect_swapped (adjustment, "value-changed",
+                                G_CALLBACK (gtk_list_box_virtual_queue_update), box);
+      g_signal_connect_swapped (adjustment, "changed",
+                                G_CALLBACK (gtk_list_box_virtual_queue_update), box);
+    }
+
+  gtk_list_box_virtual_queue_update (box);
 }
 
 /**
@@ -1211,6 +1267,9 @@ gtk_list_box_set_header_func (GtkListBox                 *box,
   priv->update_header_func = update_header;
   priv->update_header_func_target = user_data;
   priv->update_header_func_target_destroy_notify = destroy;
+
+  gtk_list_box_check_model_compat (box);
+
   gtk_list_box_invalidate_headers (box);
 }
 
@@ -1499,6 +1558,14 @@ ensure_row_visible (GtkListBox    *box,
   if (!priv->adjustment)
     return;
 
+  if (priv->bind_row_func != NULL)
+    {
+      /* The row may just have been bound and not be allocated yet */
+      gtk_list_box_virtual_get_row_extents (box, row, &y, &height);
+      gtk_adjustment_clamp_page (priv->adjustment, y, y + height);
+      return;
+    }
+
   gtk_widget_get_allocation (GTK_WIDGET (row), &allocation);
   y = allocation.y;
   height = allocation.height;
@@ -1521,6 +1588,8 @@ gtk_list_box_update_cursor (GtkListBox    *box,
                             gboolean grab_focus)
 {
   BOX_PRIV (box)->cursor_row = row;
+  if (BOX_PRIV (box)->bind_row_func != NULL && row != NULL)
+    BOX_PRIV (box)->range.cursor_position = gtk_list_box_virtual_get_position (box, row);
   ensure_row_visible (box, row);
   if (grab_focus)
     gtk_widget_grab_focus (GTK_WIDGET (row));
@@ -1546,22 +1615,39 @@ row_is_visible (GtkListBoxRow *row)
   return ROW_PRIV (row)->visible;
 }
 
+static void
+gtk_list_box_row_update_selected (GtkListBoxRow *row,
+                                  gboolean       selected)
+{
+  ROW_PRIV (row)->selected = selected;
+  if (selected)
+    gtk_widget_set_state_flags (GTK_WIDGET (row),
+                                GTK_STATE_FLAG_SELECTED, FALSE);
+  else
+    gtk_widget_unset_state_flags (GTK_WIDGET (row),
+                                  GTK_STATE_FLAG_SELECTED);
+}
+
 static gboolean
 gtk_list_box_row_set_selected (GtkListBoxRow *row,
                                gboolean       selected)
 {
+  GtkListBox *box;
+
   if (!ROW_PRIV (row)->selectable)
     return FALSE;
 
   if (ROW_PRIV (row)->selected != selected)
     {
-      ROW_PRIV (row)->selected = selected;
-      if (selected)
-        gtk_widget_set_state_flags (GTK_WIDGET (row),
-                                    GTK_STATE_FLAG_SELECTED, FALSE);
-      else
-        gtk_widget_unset_state_flags (GTK_WIDGET (row),
-                                      GTK_STATE_FLAG_SELECTED);
+      gtk_list_box_row_update_selected (row, selected);
+
+      /* Virtualized rows only show the selection of their position */
+      box = gtk_list_box_row_get_box (row);
+      if (box != NULL && BOX_PRIV (box)->bind_row_func != NULL)
+        BOX_PRIV (box)->range.selected_positions =
+          _gtk_bitmask_set (BOX_PRIV (box)->range.selected_positions,
+                            gtk_list_box_virtual_get_position (box, row),
+                            selected);
 
       return TRUE;
     }
@@ -1588,6 +1674,15 @@ gtk_list_box_unselect_all_internal (GtkListBox *box)
     }
 
   BOX_PRIV (box)->selected_row = NULL;
+  BOX_PRIV (box)->range.selected_position = -1;
+
+  if (BOX_PRIV (box)->bind_row_func != NULL &&
+      !_gtk_bitmask_is_empty (BOX_PRIV (box)->range.selected_positions))
+    {
+      _gtk_bitmask_free (BOX_PRIV (box)->range.selected_positions);
+      BOX_PRIV (box)->range.selected_positions = _gtk_bitmask_new ();
+      dirty = TRUE;
+    }
 
   return dirty;
 }
@@ -1641,6 +1736,19 @@ gtk_list_box_select_all_between (GtkListBox    *box,
 {
   GSequenceIter *iter, *iter1, *iter2;
 
+  if (BOX_PRIV (box)->bind_row_func != NULL)
+    {
+      if (BOX_PRIV (box)->range.n_items == 0)
+        return;
+
+      _gtk_virtual_range_select_range (&BOX_PRIV (box)->range,
+                                       row1 ? gtk_list_box_virtual_get_position (box, row1) : 0,
+                                       row2 ? gtk_list_box_virtual_get_position (box, row2)
+                                            : BOX_PRIV (box)->range.n_items - 1,
+                                       modify);
+      return;
+    }
+
   if (row1)
     iter1 = ROW_PRIV (row1)->iter;
   else
@@ -1719,12 +1827,19 @@ gtk_list_box_update_selection_full (GtkListBox    *box,
       if (extend)
         {
           GtkListBoxRow *selected_row;
+          gint selected_position;
 
           selected_row = priv->selected_row;
+          selected_position = priv->range.selected_position;
 
           gtk_list_box_unselect_all_internal (box);
 
-          if (selected_row == NULL)
+          /* The row of the anchor may have been recycled */
+          if (selected_row == NULL && selected_position >= 0 && priv->bind_row_func != NULL)
+            _gtk_virtual_range_select_range (&priv->range, selected_position,
+                                             gtk_list_box_virtual_get_position (box, row),
+                                             FALSE);
+          else if (selected_row == NULL)
             {
               gtk_list_box_row_set_selected (row, TRUE);
               priv->selected_row = row;
@@ -2092,11 +2207,15 @@ gtk_list_box_focus (GtkWidget        *widget,
         case GTK_DIR_UP:
         case GTK_DIR_TAB_BACKWARD:
           next_focus_row = priv->selected_row;
+          if (next_focus_row == NULL && priv->bind_row_func != NULL)
+            next_focus_row = priv->cursor_row;
           if (next_focus_row == NULL)
             next_focus_row = gtk_list_box_get_last_focusable (box);
           break;
         default:
           next_focus_row = priv->selected_row;
+          if (next_focus_row == NULL && priv->bind_row_func != NULL)
+            next_focus_row = priv->cursor_row;
           if (next_focus_row == NULL)
             next_focus_row = gtk_list_box_get_first_focusable (box);
           break;
@@ -2362,6 +2481,10 @@ gtk_list_box_update_header (GtkListBox    *box,
   if (iter == NULL || g_sequence_iter_is_end (iter))
     return;
 
+  /* Only a window of the rows exists, see gtk_list_box_check_model_compat() */
+  if (priv->bind_row_func != NULL)
+    return;
+
   row = g_sequence_get (iter);
   g_object_ref (row);
 
@@ -2710,6 +2833,12 @@ gtk_list_box_measure (GtkCssGadget   *gadget,
           *minimum += row_min;
         }
 
+      /* Make room for the items that have no row */
+      if (priv->bind_row_func != NULL)
+        *minimum += priv->range.top +
+                    (priv->range.n_items - priv->range.first_position - g_sequence_get_length (priv->children)) *
+                    priv->range.estimated_size;
+
       /* We always allocate the minimum height, since handling expanding rows
        * is way too costly, and unlikely to be used, as lists are generally put
        * inside a scrolling window anyway.
@@ -2783,6 +2912,9 @@ gtk_list_box_allocate (GtkCssGadget        *gadget,
       child_allocation.y += child_min;
     }
 
+  if (priv->bind_row_func != NULL)
+    child_allocation.y += priv->range.top;
+
   for (iter = g_sequence_get_begin_iter (priv->children);
        !g_sequence_iter_is_end (iter);
        iter = g_sequence_iter_next (iter))
@@ -3026,7 +3158,16 @@ gtk_list_box_move_cursor (GtkListBox      *box,
   int height;
 
   row = NULL;
-  switch (step)
+  if (priv->bind_row_func != NULL)
+    {
+      if (step != GTK_MOVEMENT_BUFFER_ENDS &&
+          step != GTK_MOVEMENT_DISPLAY_LINES &&
+          step != GTK_MOVEMENT_PAGES)
+        return;
+
+      row = gtk_list_box_virtual_get_cursor_target (box, step, count);
+    }
+  else switch (step)
     {
     case GTK_MOVEMENT_BUFFER_ENDS:
       if (count < 0)
@@ -3503,6 +3644,9 @@ gtk_list_box_row_set_header (GtkListBoxRow *row,
  *
  * Gets the current index of the @row in its #GtkListBox container.
  *
+ * For a model bound with gtk_list_box_bind_model_virtual(), this is
+ * the position of the item that @row currently shows.
+ *
  * Returns: the index of the @row, or -1 if the @row is not in a listbox
  *
  * Since: 3.10
@@ -3517,7 +3661,14 @@ gtk_list_box_row_get_index (GtkListBoxRow *row)
   priv = ROW_PRIV (row);
 
   if (priv->iter != NULL)
-    return g_sequence_iter_get_position (priv->iter);
+    {
+      GtkListBox *box = gtk_list_box_row_get_box (row);
+
+      if (box != NULL && BOX_PRIV (box)->bind_row_func != NULL)
+        return gtk_list_box_virtual_get_position (box, row);
+
+      return g_sequence_iter_get_position (priv->iter);
+    }
 
   return -1;
 }
@@ -3845,6 +3996,383 @@ gtk_list_box_buildable_interface_init (GtkBuildableIface *iface)
   iface->add_child = gtk_list_box_buildable_add_child;
 }
 
+/* Virtualized models
+ *
+ * With gtk_list_box_bind_model_virtual(), rows only exist for a window
+ * of the model around the visible area, kept by GtkVirtualRange. The
+ * space of the items without a row is estimated from the heights of
+ * the rows, and range.top is the y of the first row.
+ */
+
+static guint
+gtk_list_box_virtual_get_position (GtkListBox    *box,
+                                   GtkListBoxRow *row)
+{
+  return _gtk_virtual_range_get_position (&BOX_PRIV (box)->range, ROW_PRIV (row)->iter);
+}
+
+static gint
+gtk_list_box_virtual_get_row_height (GtkListBox    *box,
+                                     GtkListBoxRow *row)
+{
+  if (ROW_PRIV (row)->height > 0)
+    return ROW_PRIV (row)->height;
+
+  return BOX_PRIV (box)->range.estimated_size;
+}
+
+static void
+gtk_list_box_virtual_get_row_extents (GtkListBox    *box,
+                                      GtkListBoxRow *row,
+                                      gint          *y,
+                                      gint          *height)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+  GSequenceIter *iter;
+
+  *y = priv->range.top;
+  for (iter = g_sequence_get_begin_iter (priv->children);
+       iter != ROW_PRIV (row)->iter;
+       iter = g_sequence_iter_next (iter))
+    *y += gtk_list_box_virtual_get_row_height (box, g_sequence_get (iter));
+
+  *height = gtk_list_box_virtual_get_row_height (box, row);
+}
+
+/* Returns the position of the item at @y in the current layout */
+static guint
+gtk_list_box_virtual_get_position_at_y (GtkListBox *box,
+                                        gint        y)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+  GSequenceIter *iter;
+  guint position;
+  gint row_y, height;
+
+  if (y < priv->range.top)
+    {
+      if (y < 0 || priv->range.first_position == 0)
+        return 0;
+      return MIN ((guint) (y / priv->range.estimated_size), priv->range.first_position - 1);
+    }
+
+  row_y = priv->range.top;
+  position = priv->range.first_position;
+  for (iter = g_sequence_get_begin_iter (priv->children);
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter))
+    {
+      height = gtk_list_box_virtual_get_row_height (box, g_sequence_get (iter));
+      if (y < row_y + height)
+        return position;
+
+      row_y += height;
+      position++;
+    }
+
+  position += (y - row_y) / priv->range.estimated_size;
+
+  return MIN (position, MAX (priv->range.n_items, 1) - 1);
+}
+
+static GtkWidget *
+gtk_list_box_virtual_create_row (GtkWidget *widget,
+                                 gpointer   item)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (widget);
+  GtkWidget *child, *row;
+
+  child = priv->create_widget_func (item, priv->create_widget_func_data);
+  if (g_object_is_floating (child))
+    g_object_ref_sink (child);
+  gtk_widget_show (child);
+
+  if (GTK_IS_LIST_BOX_ROW (child))
+    return child;
+
+  row = g_object_ref_sink (gtk_list_box_row_new ());
+  gtk_widget_show (row);
+  gtk_container_add (GTK_CONTAINER (row), child);
+  g_object_unref (child);
+
+  return row;
+}
+
+static void
+gtk_list_box_virtual_bind_row (GtkWidget *widget,
+                               GtkWidget *row,
+                               gpointer   item)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (widget);
+
+  priv->bind_row_func (GTK_LIST_BOX_ROW (row), item, priv->create_widget_func_data);
+}
+
+static void
+gtk_list_box_virtual_insert_row (GtkWidget *widget,
+                                 GtkWidget *row,
+                                 gboolean   prepend)
+{
+  gtk_list_box_insert (GTK_LIST_BOX (widget), row, prepend ? 0 : -1);
+}
+
+static void
+gtk_list_box_virtual_remove_row (GtkWidget *widget,
+                                 GtkWidget *row)
+{
+  /* Not a change of the selection */
+  if (ROW_PRIV (row)->selected)
+    gtk_list_box_row_update_selected (GTK_LIST_BOX_ROW (row), FALSE);
+
+  gtk_container_remove (GTK_CONTAINER (widget), row);
+}
+
+static void
+gtk_list_box_virtual_move_row (GtkWidget *widget,
+                               GtkWidget *row,
+                               gboolean   to_end)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (widget);
+
+  g_sequence_move (ROW_PRIV (row)->iter,
+                   to_end ? g_sequence_get_end_iter (priv->children)
+                          : g_sequence_get_begin_iter (priv->children));
+  gtk_list_box_insert_css_node (GTK_LIST_BOX (widget), row, ROW_PRIV (row)->iter);
+}
+
+static void
+gtk_list_box_virtual_release_row (GtkWidget *widget,
+                                  GtkWidget *child,
+                                  guint      position)
+{
+  GtkListBox *box = GTK_LIST_BOX (widget);
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+  GtkListBoxRow *row = GTK_LIST_BOX_ROW (child);
+
+  /* Keep the keyboard focus in the box while the cursor is scrolled away */
+  if (gtk_container_get_focus_child (GTK_CONTAINER (box)) == child)
+    gtk_widget_grab_focus (widget);
+
+  if (row == priv->cursor_row)
+    priv->cursor_row = NULL;
+  if (row == priv->selected_row)
+    {
+      priv->selected_row = NULL;
+      priv->range.selected_position = position;
+    }
+  if (row == priv->prelight_row)
+    {
+      gtk_widget_unset_state_flags (child, GTK_STATE_FLAG_PRELIGHT);
+      priv->prelight_row = NULL;
+    }
+  if (row == priv->active_row)
+    {
+      gtk_widget_unset_state_flags (child, GTK_STATE_FLAG_ACTIVE);
+      priv->active_row = NULL;
+    }
+  if (row == priv->drag_highlighted_row)
+    gtk_list_box_drag_unhighlight_row (box);
+}
+
+static void
+gtk_list_box_virtual_sync_row (GtkWidget *widget,
+                               GtkWidget *child,
+                               guint      position)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (widget);
+  GtkListBoxRow *row = GTK_LIST_BOX_ROW (child);
+  gboolean selected;
+
+  selected = ROW_PRIV (row)->selectable &&
+             _gtk_bitmask_get (priv->range.selected_positions, position);
+  if (ROW_PRIV (row)->selected != selected)
+    gtk_list_box_row_update_selected (row, selected);
+
+  if ((gint) position == priv->range.selected_position && priv->selected_row == NULL)
+    priv->selected_row = row;
+
+  if ((gint) position == priv->range.cursor_position && priv->cursor_row != row)
+    {
+      priv->cursor_row = row;
+      if (gtk_widget_has_focus (widget))
+        gtk_widget_grab_focus (child);
+    }
+}
+
+/* Until rows were allocated, the first one gives the estimate */
+static void
+gtk_list_box_virtual_measure_row (GtkWidget *widget,
+                                  GtkWidget *row)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (widget);
+
+  if (priv->range.estimated_size == 0)
+    {
+      gtk_widget_get_preferred_height (row, &priv->range.estimated_size, NULL);
+      priv->range.estimated_size = MAX (priv->range.estimated_size, 1);
+    }
+}
+
+static gint
+gtk_list_box_virtual_get_row_size (GtkWidget *widget,
+                                   GtkWidget *row)
+{
+  return gtk_list_box_virtual_get_row_height (GTK_LIST_BOX (widget), GTK_LIST_BOX_ROW (row));
+}
+
+/* Moves the window of rows to the visible area */
+static void
+gtk_list_box_virtual_update (GtkWidget *widget)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (widget);
+  GSequenceIter *iter;
+  GtkListBoxRow *row;
+  GtkAllocation allocation;
+  gint64 sum;
+  guint count;
+  guint first, last;
+  gdouble value, page_size;
+
+  if (priv->bind_row_func == NULL)
+    return;
+
+  /* Estimate unbound items like the allocated rows */
+  sum = 0;
+  count = 0;
+  for (iter = g_sequence_get_begin_iter (priv->children);
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter))
+    {
+      row = g_sequence_get (iter);
+      if (ROW_PRIV (row)->height > 0)
+        {
+          sum += ROW_PRIV (row)->height;
+          count++;
+        }
+    }
+  if (count > 0)
+    priv->range.estimated_size = MAX (sum / count, 1);
+
+  if (priv->range.n_items == 0)
+    {
+      first = last = 0;
+    }
+  else if (priv->adjustment == NULL ||
+           gtk_adjustment_get_page_size (priv->adjustment) <= 0 ||
+           priv->range.estimated_size == 0)
+    {
+      first = MIN (priv->range.first_position, priv->range.n_items - 1);
+      last = MIN (first + MAX (g_sequence_get_length (priv->children), VIRTUAL_INITIAL_ROWS),
+                  priv->range.n_items);
+    }
+  else
+    {
+      /* One page above and below the visible one */
+      gtk_widget_get_allocation (widget, &allocation);
+      page_size = gtk_adjustment_get_page_size (priv->adjustment);
+      value = gtk_adjustment_get_value (priv->adjustment) - allocation.y;
+
+      first = gtk_list_box_virtual_get_position_at_y (GTK_LIST_BOX (widget), value - page_size);
+      last = gtk_list_box_virtual_get_position_at_y (GTK_LIST_BOX (widget), value + 2 * page_size) + 1;
+    }
+
+  _gtk_virtual_range_set_range (&priv->range, first, last);
+}
+
+static const GtkVirtualRangeFuncs virtual_range_funcs = {
+  gtk_list_box_virtual_create_row,
+  gtk_list_box_virtual_bind_row,
+  gtk_list_box_virtual_insert_row,
+  gtk_list_box_virtual_remove_row,
+  gtk_list_box_virtual_move_row,
+  gtk_list_box_virtual_release_row,
+  gtk_list_box_virtual_sync_row,
+  gtk_list_box_virtual_measure_row,
+  gtk_list_box_virtual_get_row_size,
+  gtk_list_box_virtual_update
+};
+
+static void
+gtk_list_box_virtual_queue_update (GtkListBox *box)
+{
+  _gtk_virtual_range_queue_update (&BOX_PRIV (box)->range);
+}
+
+static void
+gtk_list_box_virtual_items_changed (GtkListBox *box,
+                                    guint       position,
+                                    guint       removed,
+                                    guint       added)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+
+  /* Anchor and cursor follow their items */
+  if (priv->selected_row != NULL)
+    priv->range.selected_position = gtk_list_box_virtual_get_position (box, priv->selected_row);
+  priv->selected_row = NULL;
+
+  if (priv->cursor_row != NULL)
+    priv->range.cursor_position = gtk_list_box_virtual_get_position (box, priv->cursor_row);
+  priv->cursor_row = NULL;
+
+  _gtk_virtual_range_items_changed (&priv->range, position, removed, added);
+}
+
+static GtkListBoxRow *
+gtk_list_box_virtual_get_cursor_target (GtkListBox      *box,
+                                        GtkMovementStep  step,
+                                        gint             count)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+  gint target, page_size;
+
+  if (priv->range.n_items == 0)
+    return NULL;
+
+  switch (step)
+    {
+    case GTK_MOVEMENT_BUFFER_ENDS:
+      target = count < 0 ? 0 : priv->range.n_items - 1;
+      break;
+    case GTK_MOVEMENT_DISPLAY_LINES:
+      if (priv->range.cursor_position < 0)
+        return NULL;
+      target = priv->range.cursor_position + count;
+      break;
+    case GTK_MOVEMENT_PAGES:
+      if (priv->range.cursor_position < 0)
+        return NULL;
+      page_size = 100;
+      if (priv->adjustment != NULL)
+        page_size = gtk_adjustment_get_page_increment (priv->adjustment);
+      target = priv->range.cursor_position +
+               count * MAX (page_size / MAX (priv->range.estimated_size, 1), 1);
+      break;
+    default:
+      return NULL;
+    }
+
+  target = CLAMP (target, 0, (gint) priv->range.n_items - 1);
+  if (target == priv->range.cursor_position)
+    return priv->cursor_row;
+
+  return GTK_LIST_BOX_ROW (_gtk_virtual_range_realize_position (&priv->range, target));
+}
+
+static void
+gtk_list_box_virtual_clear (GtkListBox *box)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+
+  if (priv->bind_row_func == NULL)
+    return;
+
+  _gtk_virtual_range_clear (&priv->range);
+  priv->bind_row_func = NULL;
+
+  gtk_widget_set_can_focus (GTK_WIDGET (box), FALSE);
+}
+
 static void
 gtk_list_box_bound_model_changed (GListModel *list,
                                   guint       position,
@@ -3856,6 +4384,12 @@ gtk_list_box_bound_model_changed (GListModel *list,
   GtkListBoxPrivate *priv = BOX_PRIV (user_data);
   guint i;
 
+  if (priv->bind_row_func != NULL)
+    {
+      gtk_list_box_virtual_items_changed (box, position, removed, added);
+      return;
+    }
+
   while (removed--)
     {
       GtkListBoxRow *row;
@@ -3898,6 +4432,58 @@ gtk_list_box_check_model_compat (GtkListBox *box)
   if (priv->bound_model &&
       (priv->sort_func || priv->filter_func))
     g_warning ("GtkListBox with a model will ignore sort and filter functions");
+
+  if (priv->bind_row_func && priv->update_header_func)
+    g_warning ("GtkListBox with a virtualized model will ignore the header function");
+}
+
+static void
+gtk_list_box_do_bind_model (GtkListBox                 *box,
+                            GListModel                 *model,
+                            GtkListBoxCreateWidgetFunc  create_widget_func,
+                            GtkListBoxBindRowFunc       bind_row_func,
+                            gpointer                    user_data,
+                            GDestroyNotify              user_data_free_func)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+
+  if (priv->bound_model)
+    {
+      if (priv->create_widget_func_data_destroy)
+        priv->create_widget_func_data_destroy (priv->create_widget_func_data);
+
+      g_signal_handlers_disconnect_by_func (priv->bound_model, gtk_list_box_bound_model_changed, box);
+      g_clear_object (&priv->bound_model);
+    }
+
+  gtk_list_box_forall (GTK_CONTAINER (box), FALSE, (GtkCallback) gtk_widget_destroy, NULL);
+  gtk_list_box_virtual_clear (box);
+
+  if (model == NULL)
+    return;
+
+  priv->bound_model = g_object_ref (model);
+  priv->create_widget_func = create_widget_func;
+  priv->create_widget_func_data = user_data;
+  priv->create_widget_func_data_destroy = user_data_free_func;
+
+  if (bind_row_func != NULL)
+    {
+      priv->bind_row_func = bind_row_func;
+      _gtk_virtual_range_bind (&priv->range, model);
+
+      /* Holds the focus while the cursor row is scrolled away */
+      gtk_widget_set_can_focus (GTK_WIDGET (box), TRUE);
+    }
+
+  gtk_list_box_check_model_compat (box);
+
+  g_signal_connect (priv->bound_model, "items-changed", G_CALLBACK (gtk_list_box_bound_model_changed), box);
+
+  if (bind_row_func != NULL)
+    gtk_list_box_virtual_update (GTK_WIDGET (box));
+  else
+    gtk_list_box_bound_model_changed (model, 0, 0, g_list_model_get_n_items (model), box);
 }
 
 /**
@@ -3935,33 +4521,106 @@ gtk_list_box_bind_model (GtkListBox                 *box,
                          gpointer                    user_data,
                          GDestroyNotify              user_data_free_func)
 {
-  GtkListBoxPrivate *priv = BOX_PRIV (box);
+  g_return_if_fail (GTK_IS_LIST_BOX (box));
+  g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
+  g_return_if_fail (model == NULL || create_widget_func != NULL);
+
+  gtk_list_box_do_bind_model (box, model, create_widget_func, NULL,
+                              user_data, user_data_free_func);
+}
 
+/**
+ * gtk_list_box_bind_model_virtual:
+ * @box: a #GtkListBox
+ * @model: (nullable): the #GListModel to be bound to @box
+ * @create_widget_func: (nullable): a function that creates widgets for items
+ *   or %NULL in case you also passed %NULL as @model
+ * @bind_row_func: (nullable): a function that makes a row show another item
+ *   or %NULL in case you also passed %NULL as @model
+ * @user_data: user data passed to @create_widget_func and @bind_row_func
+ * @user_data_free_func: function for freeing @user_data
+ *
+ * Binds @model to @box like gtk_list_box_bind_model(), but only creates
+ * rows for the items in and around the visible part of @box. When @box
+ * is scrolled, rows that are no longer needed are handed to @bind_row_func
+ * to show another item instead of creating new ones. This makes it
+ * possible to bind models with a large number of items.
+ *
+ * For this to work, @box must be scrolled by its adjustment, usually by
+ * putting it into a #GtkScrolledWindow. The space taken by the items that
+ * have no row is estimated from the average height of the rows, so rows
+ * should be of similar height.
+ *
+ * The selection and the cursor refer to positions in @model. Functions
+ * that work with rows, like gtk_list_box_get_selected_rows(), only see
+ * the rows that currently exist; use gtk_list_box_get_selected_positions()
+ * to get the complete selection. gtk_list_box_get_row_at_index() and
+ * gtk_list_box_row_get_index() use positions in @model.
+ *
+ * Row headers are not supported in this mode.
+ *
+ * Since: 3.90
+ */
+void
+gtk_list_box_bind_model_virtual (GtkListBox                 *box,
+                                 GListModel                 *model,
+                                 GtkListBoxCreateWidgetFunc  create_widget_func,
+                                 GtkListBoxBindRowFunc       bind_row_func,
+                                 gpointer                    user_data,
+                                 GDestroyNotify              user_data_free_func)
+{
   g_return_if_fail (GTK_IS_LIST_BOX (box));
   g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
   g_return_if_fail (model == NULL || create_widget_func != NULL);
+  g_return_if_fail (model == NULL || bind_row_func != NULL);
 
-  if (priv->bound_model)
-    {
-      if (priv->create_widget_func_data_destroy)
-        priv->create_widget_func_data_destroy (priv->create_widget_func_data);
+  gtk_list_box_do_bind_model (box, model, create_widget_func, bind_row_func,
+                              user_data, user_data_free_func);
+}
 
-      g_signal_handlers_disconnect_by_func (priv->bound_model, gtk_list_box_bound_model_changed, box);
-      g_clear_object (&priv->bound_model);
-    }
+/**
+ * gtk_list_box_get_selected_positions:
+ * @box: a #GtkListBox
+ * @n_positions: (out): return location for the number of positions
+ *
+ * Gets the positions of all selected items of a model that was bound
+ * with gtk_list_box_bind_model_virtual(), including the ones that
+ * currently have no row. For other boxes, the indexes of the selected
+ * rows are returned.
+ *
+ * Returns: (array length=n_positions) (transfer full) (nullable): the
+ *   positions in ascending order, or %NULL if nothing is selected.
+ *   Free with g_free().
+ *
+ * Since: 3.90
+ */
+guint *
+gtk_list_box_get_selected_positions (GtkListBox *box,
+                                     guint      *n_positions)
+{
+  GtkListBoxPrivate *priv;
+  GSequenceIter *iter;
+  GArray *positions;
+  guint i;
 
-  gtk_list_box_forall (GTK_CONTAINER (box), FALSE, (GtkCallback) gtk_widget_destroy, NULL);
+  g_return_val_if_fail (GTK_IS_LIST_BOX (box), NULL);
+  g_return_val_if_fail (n_positions != NULL, NULL);
 
-  if (model == NULL)
-    return;
+  priv = BOX_PRIV (box);
+  positions = g_array_new (FALSE, FALSE, sizeof (guint));
 
-  priv->bound_model = g_object_ref (model);
-  priv->create_widget_func = create_widget_func;
-  priv->create_widget_func_data = user_data;
-  priv->create_widget_func_data_destroy = user_data_free_func;
+  if (priv->bind_row_func != NULL)
+    _gtk_virtual_range_get_selected (&priv->range, positions);
+  else
+    {
+      for (iter = g_sequence_get_begin_iter (priv->children), i = 0;
+           !g_sequence_iter_is_end (iter);
+           iter = g_sequence_iter_next (iter), i++)
+        if (ROW_PRIV (g_sequence_get (iter))->selected)
+          g_array_append_val (positions, i);
+    }
 
-  gtk_list_box_check_model_compat (box);
+  *n_positions = positions->len;
 
-  g_signal_connect (priv->bound_model, "items-changed", G_CALLBACK (gtk_list_box_bound_model_changed), box);
-  gtk_list_box_bound_model_changed (model, 0, 0, g_list_model_get_n_items (model), box);
+  return (guint *) g_array_free (positions, positions->len == 0);
 }
@@ -189,6 +189,25 @@ typedef void (*GtkListBoxUpdateHeaderFunc) (GtkListBoxRow *row,
 typedef GtkWidget * (*GtkListBoxCreateWidgetFunc) (gpointer item,
                                                    gpointer user_data);
 
+/**
+ * GtkListBoxBindRowFunc:
+ * @row: the row to update
+ * @item: (type GObject): the item from the model that @row should show
+ * @user_data: (closure): user data
+ *
+ * Called for list boxes that are bound to a #GListModel with
+ * gtk_list_box_bind_model_virtual() when a row that was created for one
+ * item is reused for another item.
+ *
+ * @row is the widget returned by the #GtkListBoxCreateWidgetFunc, or the
+ * row that was created around it if that was not a #GtkListBoxRow.
+ *
+ * Since: 3.90
+ */
+typedef void (*GtkListBoxBindRowFunc) (GtkListBoxRow *row,
+                                       gpointer       item,
+                                       gpointer       user_data);
+
 GDK_AVAILABLE_IN_3_10
 GType      gtk_list_box_row_get_type      (void) G_GNUC_CONST;
 GDK_AVAILABLE_IN_3_10
@@ -312,6 +331,16 @@ void           gtk_list_box_bind_model                   (GtkListBox
                                                           GtkListBoxCreateWidgetFunc    create_widget_func,
                                                           gpointer                      user_data,
                                                           GDestroyNotify                user_data_free_func);
+GDK_AVAILABLE_IN_3_90
+void           gtk_list_box_bind_model_virtual           (GtkListBox                   *box,
+                                                          GListModel                   *model,
+                                                          GtkListBoxCreateWidgetFunc    create_widget_func,
+                                                          GtkListBoxBindRowFunc         bind_row_func,
+                                                          gpointer                      user_data,
+                                                          GDestroyNotify                user_data_free_func);
+GDK_AVAILABLE_IN_3_90
+guint *        gtk_list_box_get_selected_positions       (GtkListBox                   *box,
+                                                          guint                        *n_positions);
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GtkListBox, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GtkListBoxRow, g_object_unref)
@@ -2314,6 +2314,100 @@ gtk_list_store_insert_with_valuesv (GtkListStore *list_store,
   gtk_tree_path_free (path);
 }
 
+/**
+ * gtk_list_store_insert_rows_with_valuesv:
+ * @list_store: A #GtkListStore
+ * @position: position to insert the first new row, or -1 for last
+ * @n_rows: the number of rows to insert
+ * @columns: (array length=n_values): an array of column numbers
+ * @values: (array): an array of @n_rows times @n_values GValues, holding
+ *     the values for the first row, then the second row, and so on
+ * @n_values: the length of the @columns array
+ *
+ * Inserts @n_rows consecutive rows at @position and fills them with
+ * the given values, like calling gtk_list_store_insert_with_valuesv()
+ * for each row.
+ *
+ * Instead of one #GtkTreeModel::row-inserted signal per row, a
+ * single #GtkTreeModel::rows-inserted signal is emitted, which lets
+ * views add all rows in one go. To replace the contents of the store,
+ * call gtk_list_store_clear() first.
+ *
+ * If the store is sorted, the rows are inserted one by one at
+ * their sorted positions, and @position is ignored.
+ *
+ * Since: 3.90
+ */
+void
+gtk_list_store_insert_rows_with_valuesv (GtkListStore *list_store,
+                                         gint          position,
+                                         gint          n_rows,
+                                         gint         *columns,
+                                         GValue       *values,
+                                         gint          n_values)
+{
+  GtkListStorePrivate *priv;
+  GtkTreePath *path;
+  GSequence *rows;
+  GSequenceIter *first;
+  GtkTreeIter iter;
+  gint length, i;
+  gboolean changed = FALSE;
+  gboolean maybe_need_sort = FALSE;
+
+  g_return_if_fail (GTK_IS_LIST_STORE (list_store));
+  g_return_if_fail (n_rows >= 0);
+  g_return_if_fail (n_values == 0 || (columns != NULL && values != NULL));
+
+  priv = list_store->priv;
+
+  if (n_rows == 0)
+    return;
+
+  if (GTK_LIST_STORE_IS_SORTED (list_store))
+    {
+      for (i = 0; i < n_rows; i++)
+        gtk_list_store_insert_with_valuesv (list_store, NULL, -1,
+                                            columns, values + i * n_values, n_values);
+      return;
+    }
+
+  priv->columns_dirty = TRUE;
+
+  length = g_sequence_get_length (priv->seq);
+  if (position > length || position < 0)
+    position = length;
+
+  /* Fill the rows in a sequence of their own, then move them
+   * into place in one go.
+   */
+  rows = g_sequence_new (NULL);
+  iter.stamp = priv->stamp;
+
+  for (i = 0; i < n_rows; i++)
+    {
+      iter.user_data = g_sequence_append (rows, NULL);
+      gtk_list_store_set_vector_internal (list_store, &iter,
+                                          &changed, &maybe_need_sort,
+                                          columns, values + i * n_values, n_values);
+    }
+
+  first = g_sequence_get_begin_iter (rows);
+  g_sequence_move_range (g_sequence_get_iter_at_pos (priv->seq, position),
+                         first,
+                         g_sequence_get_end_iter (rows));
+  g_sequence_free (rows);
+
+  priv->length += n_rows;
+
+  iter.user_data = first;
+  g_assert (iter_is_valid (&iter, list_store));
+
+  path = gtk_tree_path_new_from_indices (position, -1);
+  gtk_tree_model_rows_inserted (GTK_TREE_MODEL (list_store), path, &iter, n_rows);
+  gtk_tree_path_free (path);
+}
+
 /* GtkBuildable custom tag implementation
  *
  * <columns>
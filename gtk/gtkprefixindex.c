@@ -0,0 +1,361 @@
+/* gtkprefixindex.c
+ * Copyright (C) 2017 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkprefixindexprivate.h"
+
+#include <string.h>
+
+/* GtkPrefixIndex answers "which rows of a list start with this text"
+ * for typeahead search. For every row, it keeps the string of that row
+ * normalized and case-folded the same way as the default search equal
+ * function of GtkTreeView does it. Next to that, it keeps the positions
+ * of all rows that have a string, sorted by string (and position, for
+ * equal strings). All rows starting with a given prefix are then a
+ * contiguous range of that array that is found with two binary searches.
+ *
+ * Appending rows does not sort; the order is sorted lazily before the
+ * first lookup, so that building an index is O(n log n).
+ */
+
+struct _GtkPrefixIndex
+{
+  GPtrArray *keys;      /* position -> folded string, or NULL */
+  GArray *order;        /* positions with a string, see above */
+  gboolean sorted;
+};
+
+#define KEY(index,position) ((const gchar *) g_ptr_array_index ((index)->keys, (position)))
+#define ORDER(index,i) g_array_index ((index)->order, guint, (i))
+
+static gint
+compare_positions (gconstpointer a,
+                   gconstpointer b,
+                   gpointer      data)
+{
+  GtkPrefixIndex *index = data;
+  guint pos_a = *(const guint *) a;
+  guint pos_b = *(const guint *) b;
+  gint result;
+
+  result = strcmp (KEY (index, pos_a), KEY (index, pos_b));
+  if (result != 0)
+    return result;
+
+  return pos_a < pos_b ? -1 : (pos_a > pos_b ? 1 : 0);
+}
+
+static gint
+compare_uints (gconstpointer a,
+               gconstpointer b,
+               gpointer      data)
+{
+  guint ua = *(const guint *) a;
+  guint ub = *(const guint *) b;
+
+  return ua < ub ? -1 : (ua > ub ? 1 : 0);
+}
+
+static void
+ensure_sorted (GtkPrefixIndex *index)
+{
+  if (index->sorted)
+    return;
+
+  g_qsort_with_data (index->order->data, index->order->len, sizeof (guint),
+                     compare_positions, index);
+  index->sorted = TRUE;
+}
+
+/* Returns the first i in order that does not sort before @position */
+static guint
+order_search (GtkPrefixIndex *index,
+              guint           position)
+{
+  guint lo = 0, hi = index->order->len;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (compare_positions (&ORDER (index, mid), &position, index) < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+static void
+order_add (GtkPrefixIndex *index,
+           guint           position)
+{
+  if (KEY (index, position) == NULL)
+    return;
+
+  if (index->sorted)
+    g_array_insert_val (index->order, order_search (index, position), position);
+  else
+    g_array_append_val (index->order, position);
+}
+
+static void
+order_remove (GtkPrefixIndex *index,
+              guint           position)
+{
+  guint i;
+
+  if (KEY (index, position) == NULL)
+    return;
+
+  if (index->sorted)
+    {
+      i = order_search (index, position);
+      g_assert (i < index->order->len && ORDER (index, i) == position);
+      g_array_remove_index (index->order, i);
+    }
+  else
+    {
+      for (i = 0; i < index->order->len; i++)
+        {
+          if (ORDER (index, i) == position)
+            {
+              g_array_remove_index_fast (index->order, i);
+              break;
+            }
+        }
+    }
+}
+
+GtkPrefixIndex *
+_gtk_prefix_index_new (void)
+{
+  GtkPrefixIndex *index;
+
+  index = g_slice_new (GtkPrefixIndex);
+  index->keys = g_ptr_array_new_with_free_func (g_free);
+  index->order = g_array_new (FALSE, FALSE, sizeof (guint));
+  index->sorted = TRUE;
+
+  return index;
+}
+
+void
+_gtk_prefix_index_free (GtkPrefixIndex *index)
+{
+  g_ptr_array_unref (index->keys);
+  g_array_unref (index->order);
+  g_slice_free (GtkPrefixIndex, index);
+}
+
+/* Normalizes and case-folds @string, like gtk_tree_view_search_equal_func() */
+gchar *
+_gtk_prefix_index_fold (const gchar *string)
+{
+  gchar *normalized, *folded;
+
+  if (string == NULL)
+    return NULL;
+
+  normalized = g_utf8_normalize (string, -1, G_NORMALIZE_ALL);
+  if (normalized == NULL)
+    return NULL;
+
+  folded = g_utf8_casefold (normalized, -1);
+  g_free (normalized);
+
+  return folded;
+}
+
+guint
+_gtk_prefix_index_get_n_rows (GtkPrefixIndex *index)
+{
+  return index->keys->len;
+}
+
+void
+_gtk_prefix_index_append (GtkPrefixIndex *index,
+                          const gchar    *string)
+{
+  gchar *key = _gtk_prefix_index_fold (string);
+
+  g_ptr_array_add (index->keys, key);
+  if (key != NULL)
+    {
+      guint position = index->keys->len - 1;
+
+      g_array_append_val (index->order, position);
+      index->sorted = FALSE;
+    }
+}
+
+void
+_gtk_prefix_index_insert (GtkPrefixIndex *index,
+                          guint           position,
+                          const gchar    *string)
+{
+  guint i;
+
+  g_return_if_fail (position <= index->keys->len);
+
+  /* Shifting keeps the order sorted, rows with equal strings keep
+   * their relative positions.
+   */
+  for (i = 0; i < index->order->len; i++)
+    if (ORDER (index, i) >= position)
+      ORDER (index, i)++;
+
+  g_ptr_array_insert (index->keys, position, _gtk_prefix_index_fold (string));
+  order_add (index, position);
+}
+
+void
+_gtk_prefix_index_remove (GtkPrefixIndex *index,
+                          guint           position)
+{
+  guint i;
+
+  g_return_if_fail (position < index->keys->len);
+
+  order_remove (index, position);
+  g_ptr_array_remove_index (index->keys, position);
+
+  for (i = 0; i < index->order->len; i++)
+    if (ORDER (index, i) > position)
+      ORDER (index, i)--;
+}
+
+void
+_gtk_prefix_index_set (GtkPrefixIndex *index,
+                       guint           position,
+                       const gchar    *string)
+{
+  gchar *key;
+
+  g_return_if_fail (position < index->keys->len);
+
+  key = _gtk_prefix_index_fold (string);
+  if (g_strcmp0 (key, KEY (index, position)) == 0)
+    {
+      g_free (key);
+      return;
+    }
+
+  order_remove (index, position);
+  g_free (index->keys->pdata[position]);
+  index->keys->pdata[position] = key;
+  order_add (index, position);
+}
+
+/* @new_order is as in GtkTreeModel::rows-reordered */
+void
+_gtk_prefix_index_reorder (GtkPrefixIndex *index,
+                           gint           *new_order,
+                           guint           length)
+{
+  gpointer *keys;
+  guint *inverse;
+  guint i;
+
+  g_return_if_fail (length == index->keys->len);
+
+  keys = g_memdup (index->keys->pdata, length * sizeof (gpointer));
+  inverse = g_new (guint, length);
+
+  for (i = 0; i < length; i++)
+    {
+      index->keys->pdata[i] = keys[new_order[i]];
+      inverse[new_order[i]] = i;
+    }
+
+  for (i = 0; i < index->order->len; i++)
+    ORDER (index, i) = inverse[ORDER (index, i)];
+
+  /* Rows with equal strings may have swapped */
+  index->sorted = FALSE;
+
+  g_free (inverse);
+  g_free (keys);
+}
+
+/**
+ * _gtk_prefix_index_lookup:
+ * @index: a #GtkPrefixIndex
+ * @prefix: the text to look for
+ * @n_matches: (out): return location for the number of matches
+ *
+ * Finds all rows whose string starts with @prefix, ignoring case.
+ *
+ * Returns: a newly allocated array of the positions of the matching
+ *   rows, in ascending order, or %NULL if there are none
+ */
+guint *
+_gtk_prefix_index_lookup (GtkPrefixIndex *index,
+                          const gchar    *prefix,
+                          guint          *n_matches)
+{
+  gchar *key;
+  gsize len;
+  guint lo, hi, first, mid;
+  guint *matches;
+
+  *n_matches = 0;
+
+  key = _gtk_prefix_index_fold (prefix);
+  if (key == NULL)
+    return NULL;
+
+  ensure_sorted (index);
+  len = strlen (key);
+
+  /* First string that does not sort before the prefix */
+  lo = 0;
+  hi = index->order->len;
+  while (lo < hi)
+    {
+      mid = lo + (hi - lo) / 2;
+      if (strncmp (KEY (index, ORDER (index, mid)), key, len) < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+  first = lo;
+
+  /* First string after the ones starting with the prefix */
+  hi = index->order->len;
+  while (lo < hi)
+    {
+      mid = lo + (hi - lo) / 2;
+      if (strncmp (KEY (index, ORDER (index, mid)), key, len) <= 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  g_free (key);
+
+  if (lo == first)
+    return NULL;
+
+  *n_matches = lo - first;
+  matches = g_memdup (&ORDER (index, first), *n_matches * sizeof (guint));
+  g_qsort_with_data (matches, *n_matches, sizeof (guint), compare_uints, NULL);
+
+  return matches;
+}
@@ -0,0 +1,54 @@
+/* gtkprefixindexprivate.h
+ * Copyright (C) 2017 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_PREFIX_INDEX_PRIVATE_H__
+#define __GTK_PREFIX_INDEX_PRIVATE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GtkPrefixIndex GtkPrefixIndex;
+
+GtkPrefixIndex *_gtk_prefix_index_new        (void);
+void            _gtk_prefix_index_free       (GtkPrefixIndex *index);
+
+gchar          *_gtk_prefix_index_fold       (const gchar    *string);
+
+guint           _gtk_prefix_index_get_n_rows (GtkPrefixIndex *index);
+
+void            _gtk_prefix_index_append     (GtkPrefixIndex *index,
+                                              const gchar    *string);
+void            _gtk_prefix_index_insert     (GtkPrefixIndex *index,
+                                              guint           position,
+                                              const gchar    *string);
+void            _gtk_prefix_index_remove     (GtkPrefixIndex *index,
+                                              guint           position);
+void            _gtk_prefix_index_set        (GtkPrefixIndex *index,
+                                              guint           position,
+                                              const gchar    *string);
+void            _gtk_prefix_index_reorder    (GtkPrefixIndex *index,
+                                              gint           *new_order,
+                                              guint           length);
+
+guint          *_gtk_prefix_index_lookup     (GtkPrefixIndex *index,
+                                              const gchar    *prefix,
+                                              guint          *n_matches);
+
+G_END_DECLS
+
+#endif /* __GTK_PREFIX_INDEX_PRIVATE_H__ */
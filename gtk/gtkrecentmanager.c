@@ -98,6 +98,9 @@
 #include <glib.h>
 #include <glib/gstdio.h>
 #include <gio/gio.h>
+#ifdef G_OS_UNIX
+#include <fcntl.h>
+#endif
 
 #include "gtkrecentmanager.h"
 #include "gtkintl.h"
@@ -176,6 +179,19 @@ struct _GtkRecentManagerPrivate
 
   guint changed_timeout;
   guint changed_age;
+
+  /* see the comment at the journal functions */
+  guint use_journal   : 1;
+  guint journal_valid : 1;
+  guint needs_export  : 1;
+  guint needs_reload  : 1;
+
+  gchar *journal_filename;
+  gchar *journal_stamp;
+  goffset journal_offset;
+  guint export_timeout;
+
+  GFileMonitor *journal_monitor;
 };
 
 enum
@@ -205,13 +221,20 @@ static void     gtk_recent_manager_monitor_changed     (GFileMonitor      *monit
                                                         GFile             *other_file,
                                                         GFileMonitorEvent  event_type,
                                                         gpointer           user_data);
+static void     gtk_recent_manager_journal_changed     (GFileMonitor      *monitor,
+                                                        GFile             *file,
+                                                        GFile             *other_file,
+                                                        GFileMonitorEvent  event_type,
+                                                        gpointer           user_data);
 static void     gtk_recent_manager_changed             (GtkRecentManager  *manager);
 static void     gtk_recent_manager_real_changed        (GtkRecentManager  *manager);
 static void     gtk_recent_manager_set_filename        (GtkRecentManager  *manager,
                                                         const gchar       *filename);
-static void     gtk_recent_manager_clamp_to_age        (GtkRecentManager  *manager,
+static gboolean gtk_recent_manager_clamp_to_age        (GtkRecentManager  *manager,
                                                         gint               age);
 static void     gtk_recent_manager_enabled_changed     (GtkRecentManager  *manager);
+static void     gtk_recent_manager_export              (GtkRecentManager  *manager);
+static gboolean journal_file_changed                   (GtkRecentManager  *manager);
 
 
 static void     build_recent_items_list                (GtkRecentManager  *manager);
@@ -336,6 +359,10 @@ gtk_recent_manager_init (GtkRecentManager *manager)
   priv->size = 0;
   priv->filename = NULL;
 
+#ifdef G_OS_UNIX
+  priv->use_journal = g_getenv ("GTK_RECENT_FILES_JOURNAL") != NULL;
+#endif
+
   settings = gtk_settings_get_default ();
   if (settings)
     g_signal_connect_swapped (settings, "notify::gtk-recent-files-enabled",
@@ -390,6 +417,8 @@ gtk_recent_manager_finalize (GObject *object)
   GtkRecentManagerPrivate *priv = manager->priv;
 
   g_free (priv->filename);
+  g_free (priv->journal_filename);
+  g_free (priv->journal_stamp);
 
   if (priv->recent_items != NULL)
     g_bookmark_file_free (priv->recent_items);
@@ -412,6 +441,15 @@ gtk_recent_manager_dispose (GObject *gobject)
       priv->monitor = NULL;
     }
 
+  if (priv->journal_monitor != NULL)
+    {
+      g_signal_handlers_disconnect_by_func (priv->journal_monitor,
+                                            G_CALLBACK (gtk_recent_manager_journal_changed),
+                                            manager);
+      g_object_unref (priv->journal_monitor);
+      priv->journal_monitor = NULL;
+    }
+
   if (priv->changed_timeout != 0)
     {
       g_source_remove (priv->changed_timeout);
@@ -426,6 +464,20 @@ gtk_recent_manager_dispose (GObject *gobject)
       g_object_unref (manager);
     }
 
+  /* write the journaled changes for the processes without the journal;
+   * if the file changed, reloading it merges them
+   */
+  if (priv->export_timeout != 0)
+    {
+      g_source_remove (priv->export_timeout);
+      priv->export_timeout = 0;
+
+      if (journal_file_changed (manager))
+        build_recent_items_list (manager);
+      else
+        gtk_recent_manager_export (manager);
+    }
+
   G_OBJECT_CLASS (gtk_recent_manager_parent_class)->dispose (gobject);
 }
 
@@ -436,6 +488,767 @@ gtk_recent_manager_enabled_changed (GtkRecentManager *manager)
   gtk_recent_manager_changed (manager);
 }
 
+/* The journal
+ *
+ * With GTK_RECENT_FILES_JOURNAL set, changes are not written by dumping
+ * the whole xbel file.  Instead, each change appends a record with the
+ * new state of the changed items to a journal next to the xbel file,
+ * with a single write.  Other processes watch the journal and apply the
+ * records they have not seen yet, without parsing the xbel file again.
+ *
+ * The first line of the journal identifies the xbel file the records
+ * apply to.  When the journal grows too large, or a change cannot be
+ * journaled, the xbel file is written and the journal is started anew
+ * for it.  Processes that do not use the journal only see the xbel file,
+ * so it is also written a few seconds after a burst of journaled changes.
+ * When one of those processes writes the xbel file, the journal no longer
+ * matches it; the next process to reload the file applies all of the
+ * records on top of it, and writes it again.  Journaled changes to an item
+ * win over changes from processes without the journal then.
+ *
+ * Records carry the whole state of an item instead of the change, so
+ * applying one twice is harmless:
+ *
+ *   S uri title description mime-type added modified visited private
+ *     n-groups group... n-apps (name exec count stamp)...
+ *   R uri
+ *   P
+ *
+ * for setting, removing and purging items.  Fields are separated by
+ * tabs; strings are escaped and prefixed with '=', and empty if unset.
+ */
+
+#define JOURNAL_SUFFIX   ".journal"
+#define JOURNAL_MAGIC    "GtkRecentJournal1"
+#define JOURNAL_MAX_SIZE (256 * 1024)
+
+/* seconds after a journaled change until the xbel file is written */
+#define JOURNAL_EXPORT_DELAY 2
+
+static void
+journal_append_string (GString     *record,
+                       const gchar *value)
+{
+  gchar *escaped;
+
+  g_string_append_c (record, '\t');
+  if (value == NULL)
+    return;
+
+  escaped = g_strescape (value, NULL);
+  g_string_append_c (record, '=');
+  g_string_append (record, escaped);
+  g_free (escaped);
+}
+
+static void
+journal_append_int (GString *record,
+                    gint64   value)
+{
+  g_string_append_printf (record, "\t%" G_GINT64_FORMAT, value);
+}
+
+static void
+journal_append_item (GString       *record,
+                     GBookmarkFile *items,
+                     const gchar   *uri)
+{
+  gchar **groups, **apps;
+  gsize n_groups, n_apps, i;
+  gchar *value;
+
+  if (items == NULL || !g_bookmark_file_has_item (items, uri))
+    {
+      g_string_append_c (record, 'R');
+      journal_append_string (record, uri);
+      g_string_append_c (record, '\n');
+      return;
+    }
+
+  g_string_append_c (record, 'S');
+  journal_append_string (record, uri);
+
+  value = g_bookmark_file_get_title (items, uri, NULL);
+  journal_append_string (record, value);
+  g_free (value);
+  value = g_bookmark_file_get_description (items, uri, NULL);
+  journal_append_string (record, value);
+  g_free (value);
+  value = g_bookmark_file_get_mime_type (items, uri, NULL);
+  journal_append_string (record, value);
+  g_free (value);
+
+  journal_append_int (record, g_bookmark_file_get_added (items, uri, NULL));
+  journal_append_int (record, g_bookmark_file_get_modified (items, uri, NULL));
+  journal_append_int (record, g_bookmark_file_get_visited (items, uri, NULL));
+  journal_append_int (record, g_bookmark_file_get_is_private (items, uri, NULL));
+
+  groups = g_bookmark_file_get_groups (items, uri, &n_groups, NULL);
+  journal_append_int (record, n_groups);
+  for (i = 0; i < n_groups; i++)
+    journal_append_string (record, groups[i]);
+  g_strfreev (groups);
+
+  apps = g_bookmark_file_get_applications (items, uri, &n_apps, NULL);
+  journal_append_int (record, n_apps);
+  for (i = 0; i < n_apps; i++)
+    {
+      gchar *exec = NULL;
+      guint count = 0;
+      time_t stamp = 0;
+
+      g_bookmark_file_get_app_info (items, uri, apps[i], &exec, &count, &stamp, NULL);
+      journal_append_string (record, apps[i]);
+      journal_append_string (record, exec);
+      journal_append_int (record, count);
+      journal_append_int (record, stamp);
+      g_free (exec);
+    }
+  g_strfreev (apps);
+
+  g_string_append_c (record, '\n');
+}
+
+static void
+journal_update_size (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  gint size;
+
+  size = priv->recent_items ? g_bookmark_file_get_size (priv->recent_items) : 0;
+  if (priv->size != size)
+    {
+      priv->size = size;
+
+      g_object_notify (G_OBJECT (manager), "size");
+    }
+}
+
+#ifdef G_OS_UNIX
+
+/* Returns the unescaped string, or %NULL if unset */
+static gchar *
+journal_get_string (gchar **fields,
+                    guint   i)
+{
+  if (fields[i][0] != '=')
+    return NULL;
+
+  return g_strcompress (fields[i] + 1);
+}
+
+static gint64
+journal_get_int (gchar **fields,
+                 guint   i)
+{
+  return g_ascii_strtoll (fields[i], NULL, 10);
+}
+
+static void
+journal_apply_item (GBookmarkFile  *items,
+                    gchar         **fields,
+                    guint           n_fields)
+{
+  gchar *uri, *value, *exec;
+  guint n_groups, n_apps, i, j;
+
+  /* check the counts before changing anything */
+  if (n_fields < 11)
+    return;
+  n_groups = journal_get_int (fields, 9);
+  if (n_groups > n_fields - 11)
+    return;
+  n_apps = journal_get_int (fields, 10 + n_groups);
+  if (n_apps > (n_fields - 11 - n_groups) / 4 ||
+      n_fields != 11 + n_groups + 4 * n_apps)
+    return;
+
+  uri = journal_get_string (fields, 1);
+  if (uri == NULL)
+    return;
+
+  g_bookmark_file_remove_item (items, uri, NULL);
+
+  value = journal_get_string (fields, 2);
+  if (value)
+    g_bookmark_file_set_title (items, uri, value);
+  g_free (value);
+  value = journal_get_string (fields, 3);
+  if (value)
+    g_bookmark_file_set_description (items, uri, value);
+  g_free (value);
+  value = journal_get_string (fields, 4);
+  if (value)
+    g_bookmark_file_set_mime_type (items, uri, value);
+  g_free (value);
+
+  g_bookmark_file_set_is_private (items, uri, journal_get_int (fields, 8) != 0);
+
+  for (i = 0; i < n_groups; i++)
+    {
+      value = journal_get_string (fields, 10 + i);
+      if (value)
+        g_bookmark_file_add_group (items, uri, value);
+      g_free (value);
+    }
+
+  for (i = 0, j = 11 + n_groups; i < n_apps; i++, j += 4)
+    {
+      value = journal_get_string (fields, j);
+      exec = journal_get_string (fields, j + 1);
+      if (value && exec)
+        g_bookmark_file_set_app_info (items, uri, value, exec,
+                                      journal_get_int (fields, j + 2),
+                                      journal_get_int (fields, j + 3),
+                                      NULL);
+      g_free (value);
+      g_free (exec);
+    }
+
+  /* last, as the setters above update the modification time */
+  g_bookmark_file_set_added (items, uri, journal_get_int (fields, 5));
+  g_bookmark_file_set_visited (items, uri, journal_get_int (fields, 7));
+  g_bookmark_file_set_modified (items, uri, journal_get_int (fields, 6));
+
+  g_free (uri);
+}
+
+static void
+journal_apply_record (GtkRecentManager *manager,
+                      const gchar      *line)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  gchar **fields;
+  gchar *uri;
+  guint n_fields;
+
+  if (!priv->recent_items)
+    priv->recent_items = g_bookmark_file_new ();
+
+  fields = g_strsplit (line, "\t", -1);
+  n_fields = g_strv_length (fields);
+
+  if (n_fields == 0)
+    ;
+  else if (strcmp (fields[0], "S") == 0)
+    journal_apply_item (priv->recent_items, fields, n_fields);
+  else if (strcmp (fields[0], "R") == 0 && n_fields == 2)
+    {
+      uri = journal_get_string (fields, 1);
+      if (uri)
+        g_bookmark_file_remove_item (priv->recent_items, uri, NULL);
+      g_free (uri);
+    }
+  else if (strcmp (fields[0], "P") == 0)
+    {
+      g_bookmark_file_free (priv->recent_items);
+      priv->recent_items = g_bookmark_file_new ();
+    }
+
+  g_strfreev (fields);
+}
+
+static void
+journal_lock (gint   fd,
+              gshort type)
+{
+  struct flock lock = { 0, };
+
+  lock.l_type = type;
+  lock.l_whence = SEEK_SET;
+
+  while (fcntl (fd, F_SETLKW, &lock) < 0 && errno == EINTR)
+    ;
+}
+
+static gchar *
+journal_get_stamp (const gchar *filename)
+{
+  GStatBuf buf;
+
+  if (g_stat (filename, &buf) < 0)
+    return g_strdup (JOURNAL_MAGIC " -");
+
+  return g_strdup_printf (JOURNAL_MAGIC " %" G_GUINT64_FORMAT " %" G_GINT64_FORMAT " %" G_GINT64_FORMAT,
+                          (guint64) buf.st_ino,
+                          (gint64) buf.st_size,
+                          (gint64) buf.st_mtime);
+}
+
+/* Returns the first line, without the newline */
+static gchar *
+journal_read_header (gint fd)
+{
+  gchar buf[512];
+  gssize n;
+  gchar *end;
+
+  n = pread (fd, buf, sizeof (buf) - 1, 0);
+  if (n <= 0)
+    return NULL;
+
+  buf[n] = '\0';
+  end = strchr (buf, '\n');
+  if (end == NULL)
+    return NULL;
+
+  return g_strndup (buf, end - buf);
+}
+
+/* Whether the journal with @header is for the xbel file we loaded.
+ *
+ * A process exporting only journaled changes writes the stamp of the
+ * journal and the length it had after the new stamp; if we applied all
+ * of those records, the new xbel file has nothing we do not have, and
+ * we follow the new journal instead of loading the file again.
+ */
+static gboolean
+journal_check_header (GtkRecentManager *manager,
+                      const gchar      *header)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  gchar *stamp, *followed;
+  gboolean valid;
+  gsize len;
+
+  if (header == NULL || priv->journal_stamp == NULL)
+    return FALSE;
+
+  len = strlen (priv->journal_stamp);
+  if (strncmp (header, priv->journal_stamp, len) == 0 &&
+      (header[len] == '\0' || header[len] == '\t'))
+    return TRUE;
+
+  if (!priv->journal_valid)
+    return FALSE;
+
+  stamp = journal_get_stamp (priv->filename);
+  followed = g_strdup_printf ("%s\t%s\t%" G_GINT64_FORMAT,
+                              stamp, priv->journal_stamp,
+                              (gint64) priv->journal_offset);
+  valid = strcmp (header, followed) == 0;
+  if (valid)
+    {
+      g_free (priv->journal_stamp);
+      priv->journal_stamp = stamp;
+      priv->journal_offset = strlen (header) + 1;
+    }
+  else
+    g_free (stamp);
+  g_free (followed);
+
+  return valid;
+}
+
+/* Applies the records after the ones we have seen, if the journal is
+ * for the xbel file we loaded.  If it is for another xbel file and
+ * @merge is %TRUE, all of its records are applied instead.  @fd must
+ * be locked.
+ */
+static gboolean
+journal_read_records (GtkRecentManager *manager,
+                      gint              fd,
+                      gboolean          merge)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GString *data;
+  gchar buf[4096];
+  gchar *header, *start, *end;
+  gboolean applied;
+  goffset offset;
+  gssize n;
+
+  header = journal_read_header (fd);
+  if (journal_check_header (manager, header))
+    {
+      if (priv->journal_offset == 0)
+        priv->journal_offset = strlen (header) + 1;
+      priv->journal_valid = TRUE;
+      offset = priv->journal_offset;
+    }
+  else
+    {
+      priv->journal_valid = FALSE;
+      priv->journal_offset = 0;
+
+      if (!merge || header == NULL || !g_str_has_prefix (header, JOURNAL_MAGIC " "))
+        {
+          g_free (header);
+          return FALSE;
+        }
+
+      offset = strlen (header) + 1;
+    }
+  g_free (header);
+
+  data = g_string_new (NULL);
+  if (lseek (fd, offset, SEEK_SET) >= 0)
+    {
+      while ((n = read (fd, buf, sizeof (buf))) != 0)
+        {
+          if (n < 0 && errno == EINTR)
+            continue;
+          if (n < 0)
+            break;
+          g_string_append_len (data, buf, n);
+        }
+    }
+
+  /* a record without its newline is still being written */
+  applied = FALSE;
+  start = data->str;
+  while ((end = memchr (start, '\n', data->str + data->len - start)) != NULL)
+    {
+      *end = '\0';
+      journal_apply_record (manager, start);
+      applied = TRUE;
+      start = end + 1;
+    }
+
+  if (priv->journal_valid)
+    priv->journal_offset += start - data->str;
+  g_string_free (data, TRUE);
+
+  return applied;
+}
+
+/* Catches up with the changes from other processes; see
+ * journal_read_records() for @merge.
+ */
+static gboolean
+journal_load (GtkRecentManager *manager,
+              gboolean          merge)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  gboolean applied;
+  gint fd;
+
+  if (!priv->use_journal || priv->journal_filename == NULL)
+    return FALSE;
+
+  fd = g_open (priv->journal_filename, O_RDONLY | O_CLOEXEC, 0);
+  if (fd < 0)
+    {
+      priv->journal_valid = FALSE;
+      priv->journal_offset = 0;
+      return FALSE;
+    }
+
+  journal_lock (fd, F_RDLCK);
+  applied = journal_read_records (manager, fd, merge);
+  close (fd);
+
+  if (applied)
+    journal_update_size (manager);
+
+  return applied;
+}
+
+/* Called before loading the xbel file; the journal must be read
+ * from the start afterwards.
+ */
+static void
+journal_set_stamp (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+
+  if (!priv->use_journal || priv->filename == NULL)
+    return;
+
+  g_free (priv->journal_stamp);
+  priv->journal_stamp = journal_get_stamp (priv->filename);
+  priv->journal_valid = FALSE;
+  priv->journal_offset = 0;
+}
+
+/* Whether the xbel file was written since we loaded or wrote it */
+static gboolean
+journal_file_changed (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  gchar *stamp;
+  gboolean changed;
+
+  if (!priv->use_journal || priv->filename == NULL)
+    return FALSE;
+
+  stamp = journal_get_stamp (priv->filename);
+  changed = g_strcmp0 (stamp, priv->journal_stamp) != 0;
+  g_free (stamp);
+
+  return changed;
+}
+
+static gboolean
+journal_append (GtkRecentManager *manager,
+                GString          *records)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  gchar *header;
+  gboolean valid;
+  goffset end;
+  gssize n;
+  gsize written;
+  gint fd;
+
+  if (!priv->journal_valid)
+    return FALSE;
+
+  fd = g_open (priv->journal_filename, O_RDWR | O_APPEND | O_CLOEXEC, 0);
+  if (fd < 0)
+    return FALSE;
+
+  journal_lock (fd, F_WRLCK);
+
+  header = journal_read_header (fd);
+  valid = journal_check_header (manager, header);
+  g_free (header);
+
+  end = lseek (fd, 0, SEEK_END);
+  written = 0;
+  while (valid && written < records->len)
+    {
+      n = write (fd, records->str + written, records->len - written);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n < 0)
+        valid = FALSE;
+      else
+        written += n;
+    }
+
+  /* our own records are applied already; if somebody else's came
+   * first, we read them all again later
+   */
+  if (valid && end == priv->journal_offset)
+    priv->journal_offset += records->len;
+
+  close (fd);
+
+  return valid;
+}
+
+/* Locks the journal while the xbel file is written, after applying
+ * the records from other processes, so their changes end up in it;
+ * this includes the records of a journal for another xbel file.
+ */
+static gint
+journal_begin_export (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  gint fd;
+
+  if (!priv->use_journal || priv->journal_filename == NULL)
+    return -1;
+
+  fd = g_open (priv->journal_filename, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (fd < 0)
+    return -1;
+
+  journal_lock (fd, F_WRLCK);
+  if (journal_read_records (manager, fd, TRUE))
+    journal_update_size (manager);
+
+  return fd;
+}
+
+/* Starts the journal anew for the xbel file that was just written.
+ * If it has only the journaled changes, the others can follow the new
+ * journal; see journal_check_header().
+ */
+static void
+journal_end_export (GtkRecentManager *manager,
+                    gint              fd,
+                    gboolean          written,
+                    gboolean          journaled)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  gchar *stamp, *header;
+
+  if (fd < 0)
+    return;
+
+  /* keep the records of the others, and try again next time */
+  if (!written)
+    {
+      priv->needs_export = TRUE;
+      close (fd);
+      return;
+    }
+
+  stamp = journal_get_stamp (priv->filename);
+  if (journaled && priv->journal_valid)
+    header = g_strdup_printf ("%s\t%s\t%" G_GINT64_FORMAT "\n",
+                              stamp, priv->journal_stamp,
+                              (gint64) priv->journal_offset);
+  else
+    header = g_strconcat (stamp, "\n", NULL);
+  g_free (priv->journal_stamp);
+  priv->journal_stamp = stamp;
+
+  priv->journal_valid = FALSE;
+  priv->journal_offset = 0;
+  if (ftruncate (fd, 0) == 0 &&
+      pwrite (fd, header, strlen (header), 0) == (gssize) strlen (header))
+    {
+      priv->journal_valid = TRUE;
+      priv->journal_offset = strlen (header);
+    }
+
+  g_free (header);
+  close (fd);
+}
+
+#else /* !G_OS_UNIX */
+
+static gboolean
+journal_load (GtkRecentManager *manager,
+              gboolean          merge)
+{
+  return FALSE;
+}
+
+static void
+journal_set_stamp (GtkRecentManager *manager)
+{
+}
+
+static gboolean
+journal_file_changed (GtkRecentManager *manager)
+{
+  return FALSE;
+}
+
+static gboolean
+journal_append (GtkRecentManager *manager,
+                GString          *records)
+{
+  return FALSE;
+}
+
+static gint
+journal_begin_export (GtkRecentManager *manager)
+{
+  return -1;
+}
+
+static void
+journal_end_export (GtkRecentManager *manager,
+                    gint              fd,
+                    gboolean          written,
+                    gboolean          journaled)
+{
+}
+
+#endif /* G_OS_UNIX */
+
+/* Journals the current state of @uri, and of @new_uri if not %NULL.
+ * If that is not possible, the xbel file is written instead.
+ */
+static void
+journal_log_items (GtkRecentManager *manager,
+                   const gchar      *uri,
+                   const gchar      *new_uri)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GString *records;
+
+  if (!priv->use_journal)
+    return;
+
+  records = g_string_new (NULL);
+  journal_append_item (records, priv->recent_items, uri);
+  if (new_uri)
+    journal_append_item (records, priv->recent_items, new_uri);
+
+  if (!journal_append (manager, records))
+    priv->needs_export = TRUE;
+
+  g_string_free (records, TRUE);
+}
+
+static void
+journal_log_purge (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GString *records;
+
+  if (!priv->use_journal)
+    return;
+
+  records = g_string_new ("P\n");
+  if (!journal_append (manager, records))
+    priv->needs_export = TRUE;
+
+  g_string_free (records, TRUE);
+}
+
+/* Writes the xbel file, and starts the journal anew for it */
+static void
+gtk_recent_manager_export (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GError *write_error;
+  gboolean journaled;
+  gint journal_fd;
+
+  if (priv->export_timeout != 0)
+    {
+      g_source_remove (priv->export_timeout);
+      priv->export_timeout = 0;
+    }
+
+  journaled = !priv->needs_export;
+  journal_fd = journal_begin_export (manager);
+  priv->needs_export = FALSE;
+
+  write_error = NULL;
+  g_bookmark_file_to_file (priv->recent_items, priv->filename, &write_error);
+  if (write_error)
+    {
+      gchar *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
+      g_warning ("Attempting to store changes into '%s', but failed: %s",
+                 utf8 ? utf8 : "(invalid filename)",
+                 write_error->message);
+      g_free (utf8);
+    }
+
+  if (g_chmod (priv->filename, 0600) < 0)
+    {
+      gchar *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
+      g_warning ("Attempting to set the permissions of '%s', but failed: %s",
+                 utf8 ? utf8 : "(invalid filename)",
+                 g_strerror (errno));
+      g_free (utf8);
+    }
+
+  journal_end_export (manager, journal_fd, write_error == NULL, journaled);
+  g_clear_error (&write_error);
+}
+
+static gboolean
+export_journaled_changes (gpointer data)
+{
+  GtkRecentManager *manager = data;
+  gboolean applied;
+
+  manager->priv->export_timeout = 0;
+
+  /* somebody else wrote the file; unless we can follow its journal,
+   * reloading it merges ours
+   */
+  applied = journal_load (manager, FALSE);
+  if (journal_file_changed (manager))
+    manager->priv->needs_reload = TRUE;
+  else
+    gtk_recent_manager_export (manager);
+
+  if (applied || manager->priv->needs_reload)
+    gtk_recent_manager_changed (manager);
+
+  return FALSE;
+}
+
 static void
 gtk_recent_manager_real_changed (GtkRecentManager *manager)
 {
@@ -445,8 +1258,6 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
 
   if (priv->is_dirty)
     {
-      GError *write_error;
-
       /* we are marked as dirty, so we dump the content of our
        * recently used items list
        */
@@ -481,35 +1292,35 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
               g_bookmark_file_free (priv->recent_items);
               priv->recent_items = g_bookmark_file_new ();
               priv->size = 0;
+              priv->needs_export = TRUE;
             }
           else if (age > 0)
-            gtk_recent_manager_clamp_to_age (manager, age);
-        }
-
-      if (priv->filename != NULL)
-        {
-          write_error = NULL;
-          g_bookmark_file_to_file (priv->recent_items, priv->filename, &write_error);
-          if (write_error)
             {
-              gchar *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
-              g_warning ("Attempting to store changes into '%s', but failed: %s",
-                         utf8 ? utf8 : "(invalid filename)",
-                         write_error->message);
-              g_free (utf8);
-              g_error_free (write_error);
+              if (gtk_recent_manager_clamp_to_age (manager, age))
+                priv->needs_export = TRUE;
             }
+        }
 
-          if (g_chmod (priv->filename, 0600) < 0)
-            {
-              gchar *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
-              g_warning ("Attempting to set the permissions of '%s', but failed: %s",
-                         utf8 ? utf8 : "(invalid filename)",
-                         g_strerror (errno));
-              g_free (utf8);
-            }
+      if (priv->filename == NULL)
+        ;
+      else if (!priv->use_journal || priv->needs_export ||
+               !priv->journal_valid || priv->journal_offset >= JOURNAL_MAX_SIZE)
+        gtk_recent_manager_export (manager);
+      else if (priv->export_timeout == 0)
+        {
+          /* journaled changes are on disk already; the others see
+           * them once the burst of changes is written to the file
+           */
+          priv->export_timeout = gdk_threads_add_timeout_seconds (JOURNAL_EXPORT_DELAY,
+                                                                  export_journaled_changes,
+                                                                  manager);
+          g_source_set_name_by_id (priv->export_timeout, "[gtk+] export_journaled_changes");
         }
 
+      /* we do not reload our own journaled changes */
+      if (priv->use_journal)
+        journal_update_size (manager);
+
       /* mark us as clean */
       priv->is_dirty = FALSE;
     }
@@ -517,9 +1328,11 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
     {
       /* we are not marked as dirty, so we have been called
        * because the recently used resources file has been
-       * changed (and not from us).
+       * changed (and not from us). changes that came through the
+       * journal have been applied already.
        */
-      build_recent_items_list (manager);
+      if (!priv->use_journal || priv->needs_reload)
+        build_recent_items_list (manager);
     }
 
   g_object_thaw_notify (G_OBJECT (manager));
@@ -533,15 +1346,53 @@ gtk_recent_manager_monitor_changed (GFileMonitor      *monitor,
                                     gpointer           user_data)
 {
   GtkRecentManager *manager = user_data;
+  GtkRecentManagerPrivate *priv = manager->priv;
+  gboolean applied;
 
   switch (event_type)
     {
     case G_FILE_MONITOR_EVENT_CHANGED:
     case G_FILE_MONITOR_EVENT_CREATED:
     case G_FILE_MONITOR_EVENT_DELETED:
-      gdk_threads_enter ();
-      gtk_recent_manager_changed (manager);
-      gdk_threads_leave ();
+      /* files written by a process using the journal from the records
+       * we applied already are not loaded again
+       */
+      applied = journal_load (manager, FALSE);
+      if (!priv->use_journal || journal_file_changed (manager))
+        priv->needs_reload = TRUE;
+
+      if (applied || priv->needs_reload)
+        {
+          gdk_threads_enter ();
+          gtk_recent_manager_changed (manager);
+          gdk_threads_leave ();
+        }
+      break;
+
+    default:
+      break;
+    }
+}
+
+static void
+gtk_recent_manager_journal_changed (GFileMonitor      *monitor,
+                                    GFile             *file,
+                                    GFile             *other_file,
+                                    GFileMonitorEvent  event_type,
+                                    gpointer           user_data)
+{
+  GtkRecentManager *manager = user_data;
+
+  switch (event_type)
+    {
+    case G_FILE_MONITOR_EVENT_CHANGED:
+    case G_FILE_MONITOR_EVENT_CREATED:
+      if (journal_load (manager, FALSE))
+        {
+          gdk_threads_enter ();
+          gtk_recent_manager_changed (manager);
+          gdk_threads_leave ();
+        }
       break;
 
     default:
@@ -601,6 +1452,18 @@ gtk_recent_manager_set_filename (GtkRecentManager *manager,
           priv->monitor = NULL;
         }
 
+      if (priv->journal_monitor)
+        {
+          g_signal_handlers_disconnect_by_func (priv->journal_monitor,
+                                                G_CALLBACK (gtk_recent_manager_journal_changed),
+                                                manager);
+          g_object_unref (priv->journal_monitor);
+          priv->journal_monitor = NULL;
+        }
+
+      g_free (priv->journal_filename);
+      priv->journal_filename = NULL;
+
       if (!filename || *filename == '\0')
         return;
       else
@@ -637,6 +1500,20 @@ gtk_recent_manager_set_filename (GtkRecentManager *manager,
                           manager);
 
       g_object_unref (file);
+
+      if (priv->use_journal)
+        {
+          priv->journal_filename = g_strconcat (priv->filename, JOURNAL_SUFFIX, NULL);
+
+          /* without a monitor, the journal is still read before changes */
+          file = g_file_new_for_path (priv->journal_filename);
+          priv->journal_monitor = g_file_monitor_file (file, G_FILE_MONITOR_NONE, NULL, NULL);
+          if (priv->journal_monitor)
+            g_signal_connect (priv->journal_monitor, "changed",
+                              G_CALLBACK (gtk_recent_manager_journal_changed),
+                              manager);
+          g_object_unref (file);
+        }
     }
 
   build_recent_items_list (manager);
@@ -660,8 +1537,12 @@ build_recent_items_list (GtkRecentManager *manager)
       priv->size = 0;
     }
 
+  priv->needs_reload = FALSE;
+
   if (priv->filename != NULL)
     {
+      journal_set_stamp (manager);
+
       /* the file exists, and it's valid (we hope); if not, destroy the container
        * object and hope for a better result when the next "changed" signal is
        * fired.
@@ -701,6 +1582,12 @@ build_recent_items_list (GtkRecentManager *manager)
               g_object_notify (G_OBJECT (manager), "size");
             }
         }
+
+      /* the journal has the changes since the file was written; if
+       * somebody without the journal wrote it, they are merged into it
+       */
+      if (journal_load (manager, TRUE) && !priv->journal_valid)
+        gtk_recent_manager_export (manager);
     }
 
   priv->is_dirty = FALSE;
@@ -961,6 +1848,8 @@ gtk_recent_manager_add_full (GtkRecentManager    *manager,
 
   priv = manager->priv;
 
+  journal_load (manager, FALSE);
+
   if (!priv->recent_items)
     {
       priv->recent_items = g_bookmark_file_new ();
@@ -994,6 +1883,8 @@ gtk_recent_manager_add_full (GtkRecentManager    *manager,
   g_bookmark_file_set_is_private (priv->recent_items, uri,
                                   data->is_private);
 
+  journal_log_items (manager, uri, NULL);
+
   /* mark us as dirty, so that when emitting the "changed" signal we
    * will dump our changes
    */
@@ -1031,6 +1922,8 @@ gtk_recent_manager_remove_item (GtkRecentManager  *manager,
 
   priv = manager->priv;
 
+  journal_load (manager, FALSE);
+
   if (!priv->recent_items)
     {
       priv->recent_items = g_bookmark_file_new ();
@@ -1057,6 +1950,8 @@ gtk_recent_manager_remove_item (GtkRecentManager  *manager,
       return FALSE;
     }
 
+  journal_log_items (manager, uri, NULL);
+
   priv->is_dirty = TRUE;
   gtk_recent_manager_changed (manager);
 
@@ -1246,6 +2141,8 @@ gtk_recent_manager_move_item (GtkRecentManager  *recent_manager,
 
   priv = recent_manager->priv;
 
+  journal_load (recent_manager, FALSE);
+
   if (!priv->recent_items)
     {
       g_set_error (error, GTK_RECENT_MANAGER_ERROR,
@@ -1279,6 +2176,8 @@ gtk_recent_manager_move_item (GtkRecentManager  *recent_manager,
       return FALSE;
     }
 
+  journal_log_items (recent_manager, uri, new_uri);
+
   priv->is_dirty = TRUE;
   gtk_recent_manager_changed (recent_manager);
 
@@ -1341,6 +2240,8 @@ purge_recent_items_list (GtkRecentManager  *manager,
   priv->recent_items = g_bookmark_file_new ();
   priv->size = 0;
 
+  journal_log_purge (manager);
+
   /* emit the changed signal, to ensure that the purge is written */
   priv->is_dirty = TRUE;
   gtk_recent_manager_changed (manager);
@@ -1368,6 +2269,9 @@ gtk_recent_manager_purge_items (GtkRecentManager  *manager,
   g_return_val_if_fail (GTK_IS_RECENT_MANAGER (manager), -1);
 
   priv = manager->priv;
+
+  journal_load (manager, FALSE);
+
   if (!priv->recent_items)
     return 0;
 
@@ -1424,17 +2328,18 @@ gtk_recent_manager_changed (GtkRecentManager *manager)
     }
 }
 
-static void
+static gboolean
 gtk_recent_manager_clamp_to_age (GtkRecentManager *manager,
                                  gint              age)
 {
   GtkRecentManagerPrivate *priv = manager->priv;
+  gboolean removed = FALSE;
   gchar **uris;
   gsize n_uris, i;
   time_t now;
 
   if (G_UNLIKELY (!priv->recent_items))
-    return;
+    return FALSE;
 
   now = time (NULL);
 
@@ -1449,10 +2354,12 @@ gtk_recent_manager_clamp_to_age (GtkRecentManager *manager,
       modified = g_bookmark_file_get_modified (priv->recent_items, uri, NULL);
       item_age = (gint) ((now - modified) / (60 * 60 * 24));
       if (item_age > age)
-        g_bookmark_file_remove_item (priv->recent_items, uri, NULL);
+        removed |= g_bookmark_file_remove_item (priv->recent_items, uri, NULL);
     }
 
   g_strfreev (uris);
+
+  return removed;
 }
 
 /*****************
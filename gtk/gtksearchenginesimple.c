@@ -26,22 +26,35 @@
 #include <gdk/gdk.h>
 
 #include "gtksearchenginesimple.h"
+#include "gtkfilecrawlerprivate.h"
 #include "gtkfilesystem.h"
 #include "gtkprivate.h"
 
 #include <string.h>
 
-#define BATCH_SIZE 500
+/* Enough to decide about a match, or whether to descend */
+#define MATCH_ATTRIBUTES \
+  G_FILE_ATTRIBUTE_STANDARD_NAME "," \
+  G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME "," \
+  G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
+  G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN
+
+#define HIT_ATTRIBUTES \
+  MATCH_ATTRIBUTES "," \
+  G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP "," \
+  G_FILE_ATTRIBUTE_STANDARD_SIZE "," \
+  G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE "," \
+  G_FILE_ATTRIBUTE_STANDARD_TARGET_URI "," \
+  G_FILE_ATTRIBUTE_TIME_MODIFIED "," \
+  G_FILE_ATTRIBUTE_TIME_ACCESS "," \
+  G_FILE_ATTRIBUTE_ACCESS_CAN_RENAME "," \
+  G_FILE_ATTRIBUTE_ACCESS_CAN_TRASH "," \
+  G_FILE_ATTRIBUTE_ACCESS_CAN_DELETE
 
 typedef struct
 {
   GtkSearchEngineSimple *engine;
-  GCancellable *cancellable;
-
-  GQueue *directories;
-
-  gint n_processed_files;
-  GList *hits;
+  GtkFileCrawler *crawler;
 
   GtkQuery *query;
   gboolean recursive;
@@ -79,7 +92,7 @@ gtk_search_engine_simple_dispose (GObject *object)
 
   if (simple->active_search)
     {
-      g_cancellable_cancel (simple->active_search->cancellable);
+      _gtk_file_crawler_cancel (simple->active_search->crawler);
       simple->active_search = NULL;
     }
 
@@ -88,14 +101,11 @@ gtk_search_engine_simple_dispose (GObject *object)
   G_OBJECT_CLASS (_gtk_search_engine_simple_parent_class)->dispose (object);
 }
 
-static void
-queue_if_local (SearchThreadData *data,
-                GFile            *file)
+static gboolean
+is_local (GFile *file)
 {
-  if (file &&
-      !_gtk_file_consider_as_remote (file) &&
-      !g_file_has_uri_scheme (file, "recent"))
-    g_queue_push_tail (data->directories, g_object_ref (file));
+  return !_gtk_file_consider_as_remote (file) &&
+         !g_file_has_uri_scheme (file, "recent");
 }
 
 static SearchThreadData *
@@ -107,84 +117,43 @@ search_thread_data_new (GtkSearchEngineSimple *engine,
   data = g_new0 (SearchThreadData, 1);
 
   data->engine = g_object_ref (engine);
-  data->directories = g_queue_new ();
   data->query = g_object_ref (query);
   data->recursive = _gtk_search_engine_get_recursive (GTK_SEARCH_ENGINE (engine));
-  queue_if_local (data, gtk_query_get_location (query));
-
-  data->cancellable = g_cancellable_new ();
 
   return data;
 }
 
 static void
-search_thread_data_free (SearchThreadData *data)
+search_thread_data_free (gpointer user_data)
 {
-  g_queue_foreach (data->directories, (GFunc)g_object_unref, NULL);
-  g_queue_free (data->directories);
-  g_object_unref (data->cancellable);
+  SearchThreadData *data = user_data;
+
   g_object_unref (data->query);
   g_object_unref (data->engine);
 
   g_free (data);
 }
 
-static gboolean
-search_thread_done_idle (gpointer user_data)
-{
-  SearchThreadData *data;
-
-  data = user_data;
-
-  if (!g_cancellable_is_cancelled (data->cancellable))
-    _gtk_search_engine_finished (GTK_SEARCH_ENGINE (data->engine));
-
-  data->engine->active_search = NULL;
-  search_thread_data_free (data);
-
-  return FALSE;
-}
-
-typedef struct
-{
-  GList *hits;
-  SearchThreadData *thread_data;
-} Batch;
-
-static gboolean
-search_thread_add_hits_idle (gpointer user_data)
+static void
+search_hits_added (GList    *hits,
+                   gpointer  user_data)
 {
-  Batch *batch = user_data;
-
-  if (!g_cancellable_is_cancelled (batch->thread_data->cancellable))
-    _gtk_search_engine_hits_added (GTK_SEARCH_ENGINE (batch->thread_data->engine), batch->hits);
+  SearchThreadData *data = user_data;
 
-  g_list_free_full (batch->hits, (GDestroyNotify)_gtk_search_hit_free);
-  g_free (batch);
-
-  return FALSE;
+  _gtk_search_engine_hits_added (GTK_SEARCH_ENGINE (data->engine), hits);
 }
 
 static void
-send_batch (SearchThreadData *data)
+search_done (gboolean cancelled,
+             gpointer user_data)
 {
-  Batch *batch;
-
-  data->n_processed_files = 0;
-
-  if (data->hits)
-    {
-      guint id;
+  SearchThreadData *data = user_data;
 
-      batch = g_new (Batch, 1);
-      batch->hits = data->hits;
-      batch->thread_data = data;
-
-      id = gdk_threads_add_idle (search_thread_add_hits_idle, batch);
-      g_source_set_name_by_id (id, "[gtk+] search_thread_add_hits_idle");
-    }
+  if (!cancelled)
+    _gtk_search_engine_finished (GTK_SEARCH_ENGINE (data->engine));
 
-  data->hits = NULL;
+  if (data->engine->active_search == data)
+    data->engine->active_search = NULL;
 }
 
 static gboolean
@@ -206,98 +175,69 @@ is_indexed (GtkSearchEngineSimple *engine,
   return FALSE;
 }
 
-static void
-visit_directory (GFile *dir, SearchThreadData *data)
+/* Runs in the crawler threads. Only hits get the full info. */
+static gpointer
+search_match (GFile        *file,
+              GFileInfo    *info,
+              GCancellable *cancellable,
+              gpointer      user_data)
 {
-  GFileEnumerator *enumerator;
-  GFileInfo *info;
-  GFile *child;
+  SearchThreadData *data = user_data;
   const gchar *display_name;
+  GtkSearchHit *hit;
+  GFileInfo *hit_info;
 
-  enumerator = g_file_enumerate_children (dir,
-                                          G_FILE_ATTRIBUTE_STANDARD_NAME ","
-                                          G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME ","
-                                          G_FILE_ATTRIBUTE_STANDARD_TYPE ","
-                                          G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN ","
-                                          G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP ","
-                                          G_FILE_ATTRIBUTE_STANDARD_SIZE ","
-                                          G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE ","
-                                          G_FILE_ATTRIBUTE_STANDARD_TARGET_URI ","
-                                          G_FILE_ATTRIBUTE_TIME_MODIFIED ","
-                                          G_FILE_ATTRIBUTE_TIME_ACCESS ","
-                                          G_FILE_ATTRIBUTE_ACCESS_CAN_RENAME ","
-                                          G_FILE_ATTRIBUTE_ACCESS_CAN_TRASH ","
-                                          G_FILE_ATTRIBUTE_ACCESS_CAN_DELETE,
-                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
-                                          data->cancellable, NULL);
-  if (enumerator == NULL)
-    return;
-
-  while (g_file_enumerator_iterate (enumerator, &info, &child, data->cancellable, NULL))
-    {
-      if (info == NULL)
-        break;
-
-      display_name = g_file_info_get_display_name (info);
-      if (display_name == NULL)
-        continue;
+  display_name = g_file_info_get_display_name (info);
+  if (display_name == NULL)
+    return NULL;
 
-      if (g_file_info_get_is_hidden (info))
-        continue;
+  if (g_file_info_get_is_hidden (info))
+    return NULL;
 
-      if (gtk_query_matches_string (data->query, display_name))
-        {
-          GtkSearchHit *hit;
+  if (!gtk_query_matches_string (data->query, display_name))
+    return NULL;
 
-          hit = g_new (GtkSearchHit, 1);
-          hit->file = g_object_ref (child);
-          hit->info = g_object_ref (info);
-          data->hits = g_list_prepend (data->hits, hit);
-        }
+  hit_info = g_file_query_info (file, HIT_ATTRIBUTES,
+                                G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                cancellable, NULL);
+  if (hit_info == NULL)
+    return NULL;
 
-      data->n_processed_files++;
-      if (data->n_processed_files > BATCH_SIZE)
-        send_batch (data);
+  hit = g_new (GtkSearchHit, 1);
+  hit->file = g_object_ref (file);
+  hit->info = hit_info;
 
-      if (data->recursive &&
-          g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY &&
-          !is_indexed (data->engine, child))
-        queue_if_local (data, child);
-    }
-
-  g_object_unref (enumerator);
+  return hit;
 }
 
-static gpointer
-search_thread_func (gpointer user_data)
+static gboolean
+search_descend (GFile     *dir,
+                GFileInfo *info,
+                gpointer   user_data)
 {
-  SearchThreadData *data;
-  GFile *dir;
-  guint id;
-
-  data = user_data;
-
-  while (!g_cancellable_is_cancelled (data->cancellable) &&
-         (dir = g_queue_pop_head (data->directories)) != NULL)
-    {
-      visit_directory (dir, data);
-      g_object_unref (dir);
-    }
-
-  if (!g_cancellable_is_cancelled (data->cancellable))
-    send_batch (data);
+  SearchThreadData *data = user_data;
 
-  id = gdk_threads_add_idle (search_thread_done_idle, data);
-  g_source_set_name_by_id (id, "[gtk+] search_thread_done_idle");
-
-  return NULL;
+  return data->recursive &&
+         g_file_info_get_display_name (info) != NULL &&
+         !g_file_info_get_is_hidden (info) &&
+         !is_indexed (data->engine, dir) &&
+         is_local (dir);
 }
 
+static const GtkFileCrawlerFuncs search_funcs = {
+  search_match,
+  search_descend,
+  search_hits_added,
+  search_done,
+  (GDestroyNotify) _gtk_search_hit_free
+};
+
 static void
 gtk_search_engine_simple_start (GtkSearchEngine *engine)
 {
   GtkSearchEngineSimple *simple;
   SearchThreadData *data;
+  GFile *location;
 
   simple = GTK_SEARCH_ENGINE_SIMPLE (engine);
 
@@ -307,9 +247,17 @@ gtk_search_engine_simple_start (GtkSearchEngine *engine)
   if (simple->query == NULL)
     return;
 
-  data = search_thread_data_new (simple, simple->query);
+  /* Split the query into words here, not in the crawler threads */
+  gtk_query_matches_string (simple->query, "");
+
+  location = gtk_query_get_location (simple->query);
+  if (location && !is_local (location))
+    location = NULL;
 
-  g_thread_unref (g_thread_new ("file-search", search_thread_func, data));
+  data = search_thread_data_new (simple, simple->query);
+  data->crawler = _gtk_file_crawler_start (location, MATCH_ATTRIBUTES, 0,
+                                           &search_funcs,
+                                           data, search_thread_data_free);
 
   simple->active_search = data;
 }
@@ -323,7 +271,7 @@ gtk_search_engine_simple_stop (GtkSearchEngine *engine)
 
   if (simple->active_search != NULL)
     {
-      g_cancellable_cancel (simple->active_search->cancellable);
+      _gtk_file_crawler_cancel (simple->active_search->crawler);
       simple->active_search = NULL;
     }
 }
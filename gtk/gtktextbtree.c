@@ -1260,6 +1260,287 @@ _gtk_text_btree_insert (GtkTextIter *iter,
   }
 }
 
+/* Whether the tree is empty and only contains marks, so that it can
+ * be rebuilt from scratch by _gtk_text_btree_load().
+ */
+static gboolean
+gtk_text_btree_can_load (GtkTextBTree *tree,
+                         GtkTextLine  *first_line)
+{
+  GtkTextLineSegment *seg;
+  GSList *list;
+
+  if (tree->root_node->num_lines != 2 ||
+      tree->root_node->num_chars != 2)
+    return FALSE;
+
+  for (seg = first_line->segments; seg != NULL; seg = seg->next)
+    {
+      if (seg->type != &gtk_text_char_type &&
+          seg->type != &gtk_text_left_mark_type &&
+          seg->type != &gtk_text_right_mark_type)
+        return FALSE;
+    }
+
+  for (list = tree->tag_infos; list != NULL; list = list->next)
+    {
+      GtkTextTagInfo *info = list->data;
+
+      if (info->tag_root != NULL)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Frees the nodes of a tree, but not its lines */
+static void
+gtk_text_btree_node_free_skeleton (GtkTextBTree     *tree,
+                                   GtkTextBTreeNode *node)
+{
+  if (node->level == 0)
+    {
+      node->children.line = NULL;
+    }
+  else
+    {
+      GtkTextBTreeNode *child;
+
+      while (node->children.node != NULL)
+        {
+          child = node->children.node;
+          node->children.node = child->next;
+          gtk_text_btree_node_free_skeleton (tree, child);
+        }
+    }
+
+  gtk_text_btree_node_free_empty (tree, node);
+}
+
+/* Builds one level of the tree on top of @n_children lines (for level 0)
+ * or nodes, distributing them evenly so that every node ends up with
+ * between MIN_CHILDREN and MAX_CHILDREN children. Returns the first of
+ * the new nodes and their number in @n_nodes.
+ */
+static GtkTextBTreeNode *
+gtk_text_btree_build_level (GtkTextBTree *tree,
+                            gpointer      children,
+                            gint          n_children,
+                            gint          level,
+                            gint         *n_nodes)
+{
+  GtkTextBTreeNode *first_node = NULL;
+  GtkTextBTreeNode **node_tail = &first_node;
+  GtkTextLine *line = children;
+  GtkTextBTreeNode *child = children;
+  gint i, j;
+
+  *n_nodes = (n_children + MAX_CHILDREN - 1) / MAX_CHILDREN;
+
+  for (i = 0; i < *n_nodes; i++)
+    {
+      GtkTextBTreeNode *node;
+      gint count;
+
+      count = n_children / *n_nodes + (i < n_children % *n_nodes ? 1 : 0);
+
+      node = gtk_text_btree_node_new ();
+      node->parent = NULL;
+      node->next = NULL;
+      node->summary = NULL;
+      node->level = level;
+
+      if (level == 0)
+        {
+          GtkTextLine *last = line;
+
+          node->children.line = line;
+          for (j = 1; j < count; j++)
+            last = last->next;
+          line = last->next;
+          last->next = NULL;
+        }
+      else
+        {
+          GtkTextBTreeNode *last = child;
+
+          node->children.node = child;
+          for (j = 1; j < count; j++)
+            last = last->next;
+          child = last->next;
+          last->next = NULL;
+        }
+
+      recompute_node_counts (tree, node);
+
+      *node_tail = node;
+      node_tail = &node->next;
+    }
+
+  return first_node;
+}
+
+/**
+ * _gtk_text_btree_load:
+ * @tree: a #GtkTextBTree
+ * @text: UTF-8 text
+ * @len: length of @text in bytes, or -1 if nul-terminated
+ *
+ * Fills an empty tree with @text. Rather than splitting and
+ * rebalancing as text is inserted, the lines and the nodes above
+ * them are built bottom-up in a single pass. Marks end up where
+ * _gtk_text_btree_insert() at the start of the buffer would have
+ * put them.
+ *
+ * If the tree is not empty, this falls back to inserting @text at
+ * the start of the buffer.
+ **/
+void
+_gtk_text_btree_load (GtkTextBTree *tree,
+                      const gchar  *text,
+                      gint          len)
+{
+  GtkTextLine *first_line, *last_line, *line;
+  GtkTextLine *new_lines = NULL;
+  GtkTextLine **line_tail = &new_lines;
+  GtkTextLineSegment *seg, *next;
+  GtkTextLineSegment *left_marks = NULL, *rest = NULL;
+  GtkTextLineSegment **left_tail = &left_marks;
+  GtkTextLineSegment **rest_tail = &rest;
+  GtkTextBTreeNode *root;
+  GtkTextIter start, end;
+  gint sol, eol, delim, rem;
+  gint n_lines, level;
+
+  g_return_if_fail (tree != NULL);
+  g_return_if_fail (text != NULL);
+
+  if (len < 0)
+    len = strlen (text);
+
+  if (len == 0)
+    return;
+
+  first_line = _gtk_text_btree_get_line (tree, 0, NULL);
+
+  if (!gtk_text_btree_can_load (tree, first_line))
+    {
+      _gtk_text_btree_get_iter_at_line_char (tree, &start, 0, 0);
+      _gtk_text_btree_insert (&start, text, len);
+      return;
+    }
+
+  last_line = _gtk_text_line_next (first_line);
+
+  /* Chop the text up into lines. The part after the last paragraph
+   * delimiter goes into the existing first line, which becomes the
+   * last line of the new contents.
+   */
+  eol = 0;
+  rem = 0;
+  n_lines = 0;
+  while (eol < len)
+    {
+      sol = eol;
+
+      pango_find_paragraph_boundary (text + sol, len - sol, &delim, &eol);
+
+      delim += sol;
+      eol += sol;
+
+      if (delim == eol)
+        break;
+
+      line = gtk_text_line_new ();
+      line->segments = _gtk_char_segment_new (text + sol, eol - sol);
+
+      *line_tail = line;
+      line_tail = &line->next;
+      n_lines++;
+
+      rem = eol;
+    }
+
+  /* Left gravity marks stay at the start of the buffer, everything
+   * else ends up after the loaded text.
+   */
+  seg = first_line->segments;
+  while (seg != NULL)
+    {
+      next = seg->next;
+      seg->next = NULL;
+
+      if (seg->type == &gtk_text_left_mark_type)
+        {
+          *left_tail = seg;
+          left_tail = &seg->next;
+        }
+      else
+        {
+          *rest_tail = seg;
+          rest_tail = &seg->next;
+        }
+
+      seg = next;
+    }
+
+  if (rem < len)
+    {
+      seg = _gtk_char_segment_new (text + rem, len - rem);
+      seg->next = rest;
+      rest = seg;
+    }
+
+  first_line->segments = rest;
+
+  if (new_lines != NULL)
+    {
+      *left_tail = new_lines->segments;
+      new_lines->segments = left_marks;
+
+      for (seg = left_marks; seg != NULL && seg != *left_tail; seg = seg->next)
+        seg->body.mark.line = new_lines;
+    }
+  else
+    {
+      *left_tail = first_line->segments;
+      first_line->segments = left_marks;
+    }
+
+  cleanup_line (first_line);
+
+  *line_tail = first_line;
+  first_line->next = last_line;
+  last_line->next = NULL;
+  n_lines += 2;
+
+  /* Replace the old nodes with new ones, built level by level */
+  gtk_text_btree_node_free_skeleton (tree, tree->root_node);
+
+  root = gtk_text_btree_build_level (tree, new_lines ? new_lines : first_line,
+                                     n_lines, 0, &n_lines);
+  for (level = 1; n_lines > 1; level++)
+    root = gtk_text_btree_build_level (tree, root, n_lines, level, &n_lines);
+
+  tree->root_node = root;
+
+  chars_changed (tree);
+  segments_changed (tree);
+
+#ifdef G_ENABLE_DEBUG
+  if (GTK_DEBUG_CHECK (TEXT))
+    _gtk_text_btree_check (tree);
+#endif
+
+  _gtk_text_btree_get_iter_at_line_char (tree, &start, 0, 0);
+  _gtk_text_btree_get_end_iter (tree, &end);
+
+  DV (g_print ("invalidating due to loading text (%s)\n", G_STRLOC));
+  _gtk_text_btree_invalidate_region (tree, &start, &end, FALSE);
+
+  gtk_text_btree_resolve_bidi (&start, &end);
+}
+
 static void
 insert_pixbuf_or_widget_segment (GtkTextIter        *iter,
                                  GtkTextLineSegment *seg)
@@ -1583,7 +1864,10 @@ _gtk_text_btree_add_view (GtkTextBTree *tree,
   line_data->next = NULL;
   line_data->width = 0;
   line_data->height = 0;
+  line_data->top_ink = 0;
+  line_data->bottom_ink = 0;
   line_data->valid = TRUE;
+  line_data->measured_async = FALSE;
 
   _gtk_text_line_add_data (last_line, line_data);
 }
@@ -1765,11 +2049,16 @@ queue_tag_redisplay (GtkTextBTree      *tree,
   /* We don't need to do anything if the tag doesn't affect display */
 }
 
-void
-_gtk_text_btree_tag (const GtkTextIter *start_orig,
-                     const GtkTextIter *end_orig,
-                     GtkTextTag        *tag,
-                     gboolean           add)
+/* Adds or removes the toggles of @tag for the ordered, non-empty
+ * range from @start to @end. Redisplay is left to the caller.
+ */
+static void
+gtk_text_btree_tag_range (GtkTextBTree      *tree,
+                          GtkTextTagInfo    *info,
+                          GtkTextTag        *tag,
+                          const GtkTextIter *start,
+                          const GtkTextIter *end,
+                          gboolean           add)
 {
   GtkTextLineSegment *seg, *prev;
   GtkTextLine *cleanupline;
@@ -1777,49 +2066,17 @@ _gtk_text_btree_tag (const GtkTextIter *start_orig,
   GtkTextLine *start_line;
   GtkTextLine *end_line;
   GtkTextIter iter;
-  GtkTextIter start, end;
-  GtkTextBTree *tree;
   IterStack *stack;
-  GtkTextTagInfo *info;
-
-  g_return_if_fail (start_orig != NULL);
-  g_return_if_fail (end_orig != NULL);
-  g_return_if_fail (GTK_IS_TEXT_TAG (tag));
-  g_return_if_fail (_gtk_text_iter_get_btree (start_orig) ==
-                    _gtk_text_iter_get_btree (end_orig));
-  g_return_if_fail (tag->priv->table == _gtk_text_iter_get_btree (start_orig)->table);
-  
-#if 0
-  printf ("%s tag %s from %d to %d\n",
-          add ? "Adding" : "Removing",
-          tag->name,
-          gtk_text_buffer_get_offset (start_orig),
-          gtk_text_buffer_get_offset (end_orig));
-#endif
-
-  if (gtk_text_iter_equal (start_orig, end_orig))
-    return;
-
-  start = *start_orig;
-  end = *end_orig;
-
-  gtk_text_iter_order (&start, &end);
-
-  tree = _gtk_text_iter_get_btree (&start);
-
-  queue_tag_redisplay (tree, tag, &start, &end);
-
-  info = gtk_text_btree_get_tag_info (tree, tag);
 
-  start_line = _gtk_text_iter_get_text_line (&start);
-  end_line = _gtk_text_iter_get_text_line (&end);
+  start_line = _gtk_text_iter_get_text_line (start);
+  end_line = _gtk_text_iter_get_text_line (end);
 
   /* Find all tag toggles in the region; we are going to delete them.
      We need to find them in advance, because
      forward_find_tag_toggle () won't work once we start playing around
      with the tree. */
   stack = iter_stack_new ();
-  iter = start;
+  iter = *start;
 
   /* forward_to_tag_toggle() skips a toggle at the start iterator,
    * which is deliberate - we don't want to delete a toggle at the
@@ -1827,7 +2084,7 @@ _gtk_text_btree_tag (const GtkTextIter *start_orig,
    */
   while (gtk_text_iter_forward_to_tag_toggle (&iter, tag))
     {
-      if (gtk_text_iter_compare (&iter, &end) >= 0)
+      if (gtk_text_iter_compare (&iter, end) >= 0)
         break;
       else
         iter_stack_push (stack, &iter);
@@ -1842,7 +2099,7 @@ _gtk_text_btree_tag (const GtkTextIter *start_orig,
    * there.
    */
 
-  toggled_on = gtk_text_iter_has_tag (&start, tag);
+  toggled_on = gtk_text_iter_has_tag (start, tag);
   if ( (add && !toggled_on) ||
        (!add && toggled_on) )
     {
@@ -1850,7 +2107,7 @@ _gtk_text_btree_tag (const GtkTextIter *start_orig,
          cleanup_line () will remove it if so. */
       seg = _gtk_toggle_segment_new (info, add);
 
-      prev = gtk_text_line_segment_split (&start);
+      prev = gtk_text_line_segment_split (start);
       if (prev == NULL)
         {
           seg->next = start_line->segments;
@@ -1985,7 +2242,7 @@ _gtk_text_btree_tag (const GtkTextIter *start_orig,
 
       seg = _gtk_toggle_segment_new (info, !add);
 
-      prev = gtk_text_line_segment_split (&end);
+      prev = gtk_text_line_segment_split (end);
       if (prev == NULL)
         {
           seg->next = end_line->segments;
@@ -2015,6 +2272,48 @@ _gtk_text_btree_tag (const GtkTextIter *start_orig,
     }
 
   segments_changed (tree);
+}
+
+void
+_gtk_text_btree_tag (const GtkTextIter *start_orig,
+                     const GtkTextIter *end_orig,
+                     GtkTextTag        *tag,
+                     gboolean           add)
+{
+  GtkTextIter start, end;
+  GtkTextBTree *tree;
+  GtkTextTagInfo *info;
+
+  g_return_if_fail (start_orig != NULL);
+  g_return_if_fail (end_orig != NULL);
+  g_return_if_fail (GTK_IS_TEXT_TAG (tag));
+  g_return_if_fail (_gtk_text_iter_get_btree (start_orig) ==
+                    _gtk_text_iter_get_btree (end_orig));
+  g_return_if_fail (tag->priv->table == _gtk_text_iter_get_btree (start_orig)->table);
+  
+#if 0
+  printf ("%s tag %s from %d to %d\n",
+          add ? "Adding" : "Removing",
+          tag->name,
+          gtk_text_buffer_get_offset (start_orig),
+          gtk_text_buffer_get_offset (end_orig));
+#endif
+
+  if (gtk_text_iter_equal (start_orig, end_orig))
+    return;
+
+  start = *start_orig;
+  end = *end_orig;
+
+  gtk_text_iter_order (&start, &end);
+
+  tree = _gtk_text_iter_get_btree (&start);
+
+  queue_tag_redisplay (tree, tag, &start, &end);
+
+  info = gtk_text_btree_get_tag_info (tree, tag);
+
+  gtk_text_btree_tag_range (tree, info, tag, &start, &end, add);
 
   queue_tag_redisplay (tree, tag, &start, &end);
 
@@ -2024,6 +2323,136 @@ _gtk_text_btree_tag (const GtkTextIter *start_orig,
 #endif
 }
 
+static int
+compare_tag_ranges (gconstpointer a,
+                    gconstpointer b)
+{
+  const GtkTextTagRange *range_a = a;
+  const GtkTextTagRange *range_b = b;
+
+  if (range_a->tag != range_b->tag)
+    return range_a->tag->priv->priority < range_b->tag->priv->priority ? -1 : 1;
+
+  return gtk_text_iter_compare (&range_a->start, &range_b->start);
+}
+
+/**
+ * _gtk_text_btree_tag_ranges:
+ * @tree: a #GtkTextBTree
+ * @ranges: the ranges to tag, reordered and merged in place
+ * @n_ranges: the number of ranges
+ * @add: whether to add or remove the tags
+ *
+ * Like _gtk_text_btree_tag() for each of @ranges. The ranges are
+ * sorted by tag and position, and overlapping or adjacent ranges of
+ * the same tag are merged, so that each toggle is only touched once.
+ * All views are invalidated or redrawn once, for the span of all
+ * ranges, instead of once per range.
+ **/
+void
+_gtk_text_btree_tag_ranges (GtkTextBTree    *tree,
+                            GtkTextTagRange *ranges,
+                            guint            n_ranges,
+                            gboolean         add)
+{
+  GtkTextIter span_start, span_end;
+  GtkTextTagInfo *info = NULL;
+  GtkTextTag *tag = NULL;
+  gboolean affects_size = FALSE;
+  gboolean affects_appearance = FALSE;
+  gboolean have_span = FALSE;
+  guint i, n_merged;
+
+  g_return_if_fail (tree != NULL);
+  g_return_if_fail (ranges != NULL || n_ranges == 0);
+
+  if (n_ranges == 0)
+    return;
+
+  for (i = 0; i < n_ranges; i++)
+    {
+      g_return_if_fail (GTK_IS_TEXT_TAG (ranges[i].tag));
+      g_return_if_fail (ranges[i].tag->priv->table == tree->table);
+      g_return_if_fail (_gtk_text_iter_get_btree (&ranges[i].start) == tree);
+      g_return_if_fail (_gtk_text_iter_get_btree (&ranges[i].end) == tree);
+
+      gtk_text_iter_order (&ranges[i].start, &ranges[i].end);
+    }
+
+  qsort (ranges, n_ranges, sizeof (GtkTextTagRange), compare_tag_ranges);
+
+  /* Merge overlapping and adjacent ranges of the same tag */
+  n_merged = 0;
+  for (i = 1; i < n_ranges; i++)
+    {
+      GtkTextTagRange *merged = &ranges[n_merged];
+
+      if (ranges[i].tag == merged->tag &&
+          gtk_text_iter_compare (&ranges[i].start, &merged->end) <= 0)
+        {
+          if (gtk_text_iter_compare (&ranges[i].end, &merged->end) > 0)
+            merged->end = ranges[i].end;
+        }
+      else
+        {
+          ranges[++n_merged] = ranges[i];
+        }
+    }
+  n_ranges = n_merged + 1;
+
+  for (i = 0; i < n_ranges; i++)
+    {
+      if (gtk_text_iter_equal (&ranges[i].start, &ranges[i].end))
+        continue;
+
+      if (!have_span || gtk_text_iter_compare (&ranges[i].start, &span_start) < 0)
+        span_start = ranges[i].start;
+      if (!have_span || gtk_text_iter_compare (&ranges[i].end, &span_end) > 0)
+        span_end = ranges[i].end;
+      have_span = TRUE;
+
+      if (_gtk_text_tag_affects_size (ranges[i].tag))
+        affects_size = TRUE;
+      else if (_gtk_text_tag_affects_nonsize_appearance (ranges[i].tag))
+        affects_appearance = TRUE;
+    }
+
+  if (!have_span)
+    return;
+
+  if (affects_size)
+    {
+      DV (g_print ("invalidating due to size-affecting tags (%s)\n", G_STRLOC));
+      _gtk_text_btree_invalidate_region (tree, &span_start, &span_end, FALSE);
+    }
+  else if (affects_appearance)
+    redisplay_region (tree, &span_start, &span_end, FALSE);
+
+  for (i = 0; i < n_ranges; i++)
+    {
+      if (gtk_text_iter_equal (&ranges[i].start, &ranges[i].end))
+        continue;
+
+      if (ranges[i].tag != tag)
+        {
+          tag = ranges[i].tag;
+          info = gtk_text_btree_get_tag_info (tree, tag);
+        }
+
+      gtk_text_btree_tag_range (tree, info, tag,
+                                &ranges[i].start, &ranges[i].end, add);
+    }
+
+  if (affects_size)
+    _gtk_text_btree_invalidate_region (tree, &span_start, &span_end, FALSE);
+  else if (affects_appearance)
+    redisplay_region (tree, &span_start, &span_end, FALSE);
+
+#ifdef G_ENABLE_DEBUG
+  if (GTK_DEBUG_CHECK (TEXT))
+    _gtk_text_btree_check (tree);
+#endif
+}
 
 /*
  * "Getters"
@@ -3623,6 +4052,7 @@ _gtk_text_line_data_new (GtkTextLayout *layout,
   line_data->top_ink = 0;
   line_data->bottom_ink = 0;
   line_data->valid = FALSE;
+  line_data->measured_async = FALSE;
 
   return line_data;
 }
@@ -3713,6 +4143,7 @@ _gtk_text_line_invalidate_wrap (GtkTextLine *line,
   g_return_if_fail (ld != NULL);
   
   ld->valid = FALSE;
+  ld->measured_async = FALSE;
   gtk_text_btree_node_invalidate_upward (line->parent, ld->view_id);
 }
 
@@ -3752,85 +4183,41 @@ _gtk_text_line_byte_count (GtkTextLine *line)
 gint
 _gtk_text_line_char_index (GtkTextLine *target_line)
 {
-  GSList *node_stack = NULL;
-  GtkTextBTreeNode *iter;
+  GtkTextBTreeNode *node, *parent, *node2;
   GtkTextLine *line;
   gint num_chars;
 
-  /* Push all our parent nodes onto a stack */
-  iter = target_line->parent;
+  /* Since we don't store char counts in lines, only in segments, we
+   * have to iterate over the lines preceding ours in its level-0 node,
+   * adding up segment char counts.
+   */
+  node = target_line->parent;
 
-  g_assert (iter != NULL);
+  g_assert (node != NULL);
 
-  while (iter != NULL)
+  num_chars = 0;
+  for (line = node->children.line; line != target_line; line = line->next)
     {
-      node_stack = g_slist_prepend (node_stack, iter);
+      g_assert (line != NULL);
 
-      iter = iter->parent;
+      num_chars += _gtk_text_line_char_count (line);
     }
 
-  /* Check that we have the root node on top of the stack. */
-  g_assert (node_stack != NULL &&
-            node_stack->data != NULL &&
-            ((GtkTextBTreeNode*)node_stack->data)->parent == NULL);
-
-  /* Add up chars in all nodes before the nodes in our stack.
+  /* Then work up through the levels of the tree, using the cached
+   * char counts of the nodes preceding the current one. This is
+   * O(log n) and doesn't need to allocate.
    */
-
-  num_chars = 0;
-  iter = node_stack->data;
-  while (iter != NULL)
+  for (parent = node->parent; parent != NULL;
+       node = parent, parent = parent->parent)
     {
-      GtkTextBTreeNode *child_iter;
-      GtkTextBTreeNode *next_node;
-
-      next_node = node_stack->next ?
-        node_stack->next->data : NULL;
-      node_stack = g_slist_remove (node_stack, node_stack->data);
-
-      if (iter->level == 0)
+      for (node2 = parent->children.node; node2 != node; node2 = node2->next)
         {
-          /* stack should be empty when we're on the last node */
-          g_assert (node_stack == NULL);
-          break; /* Our children are now lines */
-        }
-
-      g_assert (next_node != NULL);
-      g_assert (iter != NULL);
-      g_assert (next_node->parent == iter);
+          g_assert (node2 != NULL);
 
-      /* Add up chars before us in the tree */
-      child_iter = iter->children.node;
-      while (child_iter != next_node)
-        {
-          g_assert (child_iter != NULL);
-
-          num_chars += child_iter->num_chars;
-
-          child_iter = child_iter->next;
+          num_chars += node2->num_chars;
         }
-
-      iter = next_node;
-    }
-
-  g_assert (iter != NULL);
-  g_assert (iter == target_line->parent);
-
-  /* Since we don't store char counts in lines, only in segments, we
-     have to iterate over the lines adding up segment char counts
-     until we find our line.  */
-  line = iter->children.line;
-  while (line != target_line)
-    {
-      g_assert (line != NULL);
-
-      num_chars += _gtk_text_line_char_count (line);
-
-      line = line->next;
     }
 
-  g_assert (line == target_line);
-
   return num_chars;
 }
 
@@ -5449,7 +5836,7 @@ _gtk_text_btree_validate_line (GtkTextBTree     *tree,
   g_return_if_fail (view != NULL);
   
   ld = _gtk_text_line_get_data (line, view_id);
-  if (!ld || !ld->valid)
+  if (!ld || !ld->valid || ld->measured_async)
     {
       ld = gtk_text_layout_wrap (view->layout, line, ld);
       
@@ -5457,6 +5844,79 @@ _gtk_text_btree_validate_line (GtkTextBTree     *tree,
     }
 }
 
+/**
+ * _gtk_text_btree_find_first_invalid_line:
+ * @tree: a #GtkTextBTree
+ * @view_id: view ID for the view
+ *
+ * Finds the first line that needs validation for the given view.
+ *
+ * Returns: the first invalid line, or %NULL if the tree is valid
+ **/
+GtkTextLine *
+_gtk_text_btree_find_first_invalid_line (GtkTextBTree *tree,
+                                         gpointer      view_id)
+{
+  GtkTextBTreeNode *node;
+  GtkTextLine *line;
+  NodeData *nd;
+
+  g_return_val_if_fail (tree != NULL, NULL);
+
+  node = tree->root_node;
+  nd = node_data_find (node->node_data, view_id);
+  if (nd && nd->valid)
+    return NULL;
+
+  while (node->level > 0)
+    {
+      GtkTextBTreeNode *child;
+
+      for (child = node->children.node; child != NULL; child = child->next)
+        {
+          nd = node_data_find (child->node_data, view_id);
+          if (!nd || !nd->valid)
+            break;
+        }
+
+      if (child == NULL)
+        return NULL;
+
+      node = child;
+    }
+
+  for (line = node->children.line; line != NULL; line = line->next)
+    {
+      GtkTextLineData *ld = _gtk_text_line_get_data (line, view_id);
+
+      if (!ld || !ld->valid)
+        return line;
+    }
+
+  return NULL;
+}
+
+/**
+ * _gtk_text_btree_line_size_changed:
+ * @tree: a #GtkTextBTree
+ * @line: a line whose line data for @view_id changed
+ * @view_id: view ID for the view
+ *
+ * Recompute the size and validity of the view data of the nodes
+ * above @line after its line data was updated outside of the
+ * regular validation functions.
+ **/
+void
+_gtk_text_btree_line_size_changed (GtkTextBTree *tree,
+                                   GtkTextLine  *line,
+                                   gpointer      view_id)
+{
+  g_return_if_fail (tree != NULL);
+  g_return_if_fail (line != NULL);
+
+  gtk_text_btree_node_check_valid_upward (line->parent, view_id);
+}
+
 static void
 gtk_text_btree_node_remove_view (BTreeView *view, GtkTextBTreeNode *node, gpointer view_id)
 {
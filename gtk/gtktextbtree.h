@@ -68,6 +68,9 @@ void _gtk_text_btree_delete        (GtkTextIter *start,
 void _gtk_text_btree_insert        (GtkTextIter *iter,
                                     const gchar *text,
                                     gint         len);
+void _gtk_text_btree_load          (GtkTextBTree *tree,
+                                    const gchar  *text,
+                                    gint          len);
 void _gtk_text_btree_insert_pixbuf (GtkTextIter *iter,
                                     GdkPixbuf   *pixbuf);
 
@@ -107,6 +110,11 @@ gboolean     _gtk_text_btree_validate          (GtkTextBTree      *tree,
 void         _gtk_text_btree_validate_line     (GtkTextBTree      *tree,
                                                 GtkTextLine       *line,
                                                 gpointer           view_id);
+GtkTextLine *_gtk_text_btree_find_first_invalid_line (GtkTextBTree *tree,
+                                                      gpointer      view_id);
+void         _gtk_text_btree_line_size_changed (GtkTextBTree      *tree,
+                                                GtkTextLine       *line,
+                                                gpointer           view_id);
 
 /* Tag */
 
@@ -114,6 +122,10 @@ void _gtk_text_btree_tag (const GtkTextIter *start,
                           const GtkTextIter *end,
                           GtkTextTag        *tag,
                           gboolean           apply);
+void _gtk_text_btree_tag_ranges (GtkTextBTree    *tree,
+                                 GtkTextTagRange *ranges,
+                                 guint            n_ranges,
+                                 gboolean         apply);
 
 /* "Getters" */
 
@@ -223,7 +235,12 @@ struct _GtkTextLineData {
   gint top_ink : 16;
   gint bottom_ink : 16;
   signed int width : 24;
-  guint valid : 8;		/* Actually a boolean */
+  guint valid : 1;
+  /* Set if the size was measured off the main thread; such lines
+   * count as valid for idle validation, but are wrapped again before
+   * they are displayed.
+   */
+  guint measured_async : 1;
 };
 
 /*
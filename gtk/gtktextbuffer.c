@@ -897,6 +897,148 @@ gtk_text_buffer_set_text (GtkTextBuffer *buffer,
 
  
 
+static gboolean
+gtk_text_buffer_load_text (GtkTextBuffer  *buffer,
+                           const gchar    *text,
+                           gsize           len,
+                           GError        **error)
+{
+  GtkTextIter start, end;
+  const gchar *invalid;
+
+  if (len > G_MAXINT)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE,
+                           _("The text is too large"));
+      return FALSE;
+    }
+
+  if (!g_utf8_validate (text, len, &invalid))
+    {
+      g_set_error (error, G_CONVERT_ERROR, G_CONVERT_ERROR_ILLEGAL_SEQUENCE,
+                   _("Invalid UTF-8 at byte offset %d"),
+                   (gint) (invalid - text));
+      return FALSE;
+    }
+
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+
+  gtk_text_buffer_delete (buffer, &start, &end);
+
+  if (len > 0)
+    {
+      _gtk_text_btree_load (get_btree (buffer), text, len);
+
+      g_signal_emit (buffer, signals[CHANGED], 0);
+      g_object_notify_by_pspec (G_OBJECT (buffer), text_buffer_props[PROP_CURSOR_POSITION]);
+    }
+
+  return TRUE;
+}
+
+/**
+ * gtk_text_buffer_load_from_stream:
+ * @buffer: a #GtkTextBuffer
+ * @stream: a #GInputStream providing UTF-8 text
+ * @cancellable: (allow-none): a #GCancellable
+ * @error: return location for a #GError
+ *
+ * Replaces the contents of @buffer with the text read from @stream.
+ *
+ * Unlike gtk_text_buffer_set_text(), this does not emit the
+ * #GtkTextBuffer::insert-text signal. The new text is loaded in
+ * a single pass, and only #GtkTextBuffer::changed is emitted, once.
+ * This makes loading large documents much faster.
+ *
+ * If the stream does not contain valid UTF-8 or reading fails,
+ * @buffer is left unchanged and %FALSE is returned.
+ *
+ * Returns: %TRUE if the text was loaded
+ *
+ * Since: 3.90
+ **/
+gboolean
+gtk_text_buffer_load_from_stream (GtkTextBuffer  *buffer,
+                                  GInputStream   *stream,
+                                  GCancellable   *cancellable,
+                                  GError        **error)
+{
+  GOutputStream *output;
+  GBytes *bytes;
+  gboolean retval;
+
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (G_IS_INPUT_STREAM (stream), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  output = g_memory_output_stream_new_resizable ();
+
+  if (g_output_stream_splice (output, stream,
+                              G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+                              cancellable, error) < 0)
+    {
+      g_object_unref (output);
+      return FALSE;
+    }
+
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (output));
+  g_object_unref (output);
+
+  retval = gtk_text_buffer_load_text (buffer,
+                                      g_bytes_get_data (bytes, NULL),
+                                      g_bytes_get_size (bytes),
+                                      error);
+  g_bytes_unref (bytes);
+
+  return retval;
+}
+
+/**
+ * gtk_text_buffer_load_from_file:
+ * @buffer: a #GtkTextBuffer
+ * @filename: (type filename): the name of a file containing UTF-8 text
+ * @error: return location for a #GError
+ *
+ * Replaces the contents of @buffer with the contents of @filename.
+ * The file is mapped into memory rather than read, see
+ * gtk_text_buffer_load_from_stream() for details.
+ *
+ * Returns: %TRUE if the file was loaded
+ *
+ * Since: 3.90
+ **/
+gboolean
+gtk_text_buffer_load_from_file (GtkTextBuffer  *buffer,
+                                const gchar    *filename,
+                                GError        **error)
+{
+  GMappedFile *file;
+  gboolean retval;
+
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (filename != NULL, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  file = g_mapped_file_new (filename, FALSE, error);
+  if (file == NULL)
+    return FALSE;
+
+  /* Empty files can't be mapped, g_mapped_file_get_contents()
+   * returns NULL for them.
+   */
+  if (g_mapped_file_get_length (file) == 0)
+    retval = gtk_text_buffer_load_text (buffer, "", 0, error);
+  else
+    retval = gtk_text_buffer_load_text (buffer,
+                                        g_mapped_file_get_contents (file),
+                                        g_mapped_file_get_length (file),
+                                        error);
+  g_mapped_file_unref (file);
+
+  return retval;
+}
+
+
 /*
  * Insertion
  */
@@ -2747,6 +2889,78 @@ gtk_text_buffer_remove_tag_by_name (GtkTextBuffer     *buffer,
   gtk_text_buffer_emit_tag (buffer, tag, FALSE, start, end);
 }
 
+static void
+gtk_text_buffer_tag_ranges (GtkTextBuffer         *buffer,
+                            const GtkTextTagRange *ranges,
+                            guint                  n_ranges,
+                            gboolean               apply)
+{
+  GtkTextTagRange *copy;
+
+  if (n_ranges == 0)
+    return;
+
+  /* The ranges get sorted and merged */
+  copy = g_memdup (ranges, n_ranges * sizeof (GtkTextTagRange));
+
+  _gtk_text_btree_tag_ranges (get_btree (buffer), copy, n_ranges, apply);
+
+  g_free (copy);
+}
+
+/**
+ * gtk_text_buffer_apply_tag_ranges:
+ * @buffer: a #GtkTextBuffer
+ * @ranges: (array length=n_ranges): the ranges to tag
+ * @n_ranges: the number of ranges
+ *
+ * Applies the tags of all @ranges in one go. This is much faster than
+ * calling gtk_text_buffer_apply_tag() for each range when there are
+ * many of them, e.g. for syntax highlighting: toggles are added in
+ * buffer order, overlapping ranges of the same tag are merged, and
+ * views are only updated once.
+ *
+ * Unlike gtk_text_buffer_apply_tag(), this does not emit the
+ * #GtkTextBuffer::apply-tag signal.
+ *
+ * Since: 3.90
+ **/
+void
+gtk_text_buffer_apply_tag_ranges (GtkTextBuffer         *buffer,
+                                  const GtkTextTagRange *ranges,
+                                  guint                  n_ranges)
+{
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (ranges != NULL || n_ranges == 0);
+
+  gtk_text_buffer_tag_ranges (buffer, ranges, n_ranges, TRUE);
+}
+
+/**
+ * gtk_text_buffer_remove_tag_ranges:
+ * @buffer: a #GtkTextBuffer
+ * @ranges: (array length=n_ranges): the ranges to untag
+ * @n_ranges: the number of ranges
+ *
+ * Removes the tags of all @ranges in one go, see
+ * gtk_text_buffer_apply_tag_ranges().
+ *
+ * Unlike gtk_text_buffer_remove_tag(), this does not emit the
+ * #GtkTextBuffer::remove-tag signal.
+ *
+ * Since: 3.90
+ **/
+void
+gtk_text_buffer_remove_tag_ranges (GtkTextBuffer         *buffer,
+                                   const GtkTextTagRange *ranges,
+                                   guint                  n_ranges)
+{
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (ranges != NULL || n_ranges == 0);
+
+  gtk_text_buffer_tag_ranges (buffer, ranges, n_ranges, FALSE);
+}
+
 static gint
 pointer_cmp (gconstpointer a,
              gconstpointer b)
@@ -4311,11 +4525,16 @@ gtk_text_buffer_get_paste_target_list (GtkTextBuffer *buffer)
  * Logical attribute cache
  */
 
-#define ATTR_CACHE_SIZE 2
+/* Number of lines whose attributes we keep around. Iterating over a
+ * buffer by words or sentences touches each line a few times in a row,
+ * and going back and forth between nearby lines is common too.
+ */
+#define ATTR_CACHE_SIZE 64
 
 typedef struct _CacheEntry CacheEntry;
 struct _CacheEntry
 {
+  GList link;
   gint line;
   gint char_len;
   PangoLogAttr *attrs;
@@ -4324,16 +4543,35 @@ struct _CacheEntry
 struct _GtkTextLogAttrCache
 {
   gint chars_changed_stamp;
-  CacheEntry entries[ATTR_CACHE_SIZE];
+  GHashTable *entries;  /* line number -> CacheEntry */
+  GQueue lru;           /* most recently used first */
 };
 
 static void
-free_log_attr_cache (GtkTextLogAttrCache *cache)
+cache_entry_free (gpointer data)
+{
+  CacheEntry *entry = data;
+
+  g_free (entry->attrs);
+  g_slice_free (CacheEntry, entry);
+}
+
+static GtkTextLogAttrCache *
+new_log_attr_cache (void)
 {
-  gint i;
+  GtkTextLogAttrCache *cache;
+
+  cache = g_slice_new0 (GtkTextLogAttrCache);
+  cache->entries = g_hash_table_new_full (NULL, NULL, NULL, cache_entry_free);
+  g_queue_init (&cache->lru);
 
-  for (i = 0; i < ATTR_CACHE_SIZE; i++)
-    g_free (cache->entries[i].attrs);
+  return cache;
+}
+
+static void
+free_log_attr_cache (GtkTextLogAttrCache *cache)
+{
+  g_hash_table_destroy (cache->entries);
 
   g_slice_free (GtkTextLogAttrCache, cache);
 }
@@ -4341,13 +4579,8 @@ free_log_attr_cache (GtkTextLogAttrCache *cache)
 static void
 clear_log_attr_cache (GtkTextLogAttrCache *cache)
 {
-  gint i;
-
-  for (i = 0; i < ATTR_CACHE_SIZE; i++)
-    {
-      g_free (cache->entries[i].attrs);
-      cache->entries[i].attrs = NULL;
-    }
+  g_hash_table_remove_all (cache->entries);
+  g_queue_init (&cache->lru);
 }
 
 static PangoLogAttr*
@@ -4399,8 +4632,9 @@ _gtk_text_buffer_get_line_log_attrs (GtkTextBuffer     *buffer,
   GtkTextBufferPrivate *priv;
   gint line;
   GtkTextLogAttrCache *cache;
-  gint i;
-  
+  CacheEntry *entry;
+  gint stamp;
+
   g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), NULL);
   g_return_val_if_fail (anywhere_in_line != NULL, NULL);
 
@@ -4409,47 +4643,59 @@ _gtk_text_buffer_get_line_log_attrs (GtkTextBuffer     *buffer,
   /* FIXME we also need to recompute log attrs if the language tag at
    * the start of a paragraph changes
    */
-  
+
+  stamp = _gtk_text_btree_get_chars_changed_stamp (get_btree (buffer));
+
   if (priv->log_attr_cache == NULL)
     {
-      priv->log_attr_cache = g_slice_new0 (GtkTextLogAttrCache);
-      priv->log_attr_cache->chars_changed_stamp =
-        _gtk_text_btree_get_chars_changed_stamp (get_btree (buffer));
+      priv->log_attr_cache = new_log_attr_cache ();
+      priv->log_attr_cache->chars_changed_stamp = stamp;
     }
-  else if (priv->log_attr_cache->chars_changed_stamp !=
-           _gtk_text_btree_get_chars_changed_stamp (get_btree (buffer)))
+  else if (priv->log_attr_cache->chars_changed_stamp != stamp)
     {
       clear_log_attr_cache (priv->log_attr_cache);
+      priv->log_attr_cache->chars_changed_stamp = stamp;
     }
-  
+
   cache = priv->log_attr_cache;
   line = gtk_text_iter_get_line (anywhere_in_line);
 
-  for (i = 0; i < ATTR_CACHE_SIZE; i++)
+  entry = g_hash_table_lookup (cache->entries, GINT_TO_POINTER (line));
+  if (entry != NULL)
     {
-      if (cache->entries[i].attrs != NULL &&
-          cache->entries[i].line == line)
+      /* Move to the front */
+      if (cache->lru.head != &entry->link)
         {
-          if (char_len != NULL)
-            *char_len = cache->entries[i].char_len;
-          return cache->entries[i].attrs;
+          g_queue_unlink (&cache->lru, &entry->link);
+          g_queue_push_head_link (&cache->lru, &entry->link);
         }
+
+      if (char_len != NULL)
+        *char_len = entry->char_len;
+      return entry->attrs;
     }
 
-  /* Not in cache; open up the first cache entry */
-  g_free (cache->entries[ATTR_CACHE_SIZE-1].attrs);
+  /* Not in cache; drop the least recently used entry if we are full */
+  if (cache->lru.length >= ATTR_CACHE_SIZE)
+    {
+      GList *last = g_queue_pop_tail_link (&cache->lru);
+      CacheEntry *old = last->data;
+
+      g_hash_table_remove (cache->entries, GINT_TO_POINTER (old->line));
+    }
 
-  memmove (cache->entries + 1, cache->entries,
-           sizeof (CacheEntry) * (ATTR_CACHE_SIZE - 1));
+  entry = g_slice_new0 (CacheEntry);
+  entry->link.data = entry;
+  entry->line = line;
+  entry->attrs = compute_log_attrs (anywhere_in_line, &entry->char_len);
 
-  cache->entries[0].line = line;
-  cache->entries[0].attrs = compute_log_attrs (anywhere_in_line,
-                                               &cache->entries[0].char_len);
+  g_queue_push_head_link (&cache->lru, &entry->link);
+  g_hash_table_insert (cache->entries, GINT_TO_POINTER (line), entry);
 
   if (char_len != NULL)
-    *char_len = cache->entries[0].char_len;
+    *char_len = entry->char_len;
 
-  return cache->entries[0].attrs;
+  return entry->attrs;
 }
 
 void
@@ -74,6 +74,7 @@ typedef struct _GtkTextBTree GtkTextBTree;
 
 typedef struct _GtkTextBufferPrivate GtkTextBufferPrivate;
 typedef struct _GtkTextBufferClass GtkTextBufferClass;
+typedef struct _GtkTextTagRange GtkTextTagRange;
 
 struct _GtkTextBuffer
 {
@@ -185,6 +186,17 @@ void gtk_text_buffer_set_text          (GtkTextBuffer *buffer,
                                         const gchar   *text,
                                         gint           len);
 
+/* Delete whole buffer, then load new contents in one go */
+GDK_AVAILABLE_IN_3_90
+gboolean gtk_text_buffer_load_from_stream (GtkTextBuffer  *buffer,
+                                           GInputStream   *stream,
+                                           GCancellable   *cancellable,
+                                           GError        **error);
+GDK_AVAILABLE_IN_3_90
+gboolean gtk_text_buffer_load_from_file   (GtkTextBuffer  *buffer,
+                                           const gchar    *filename,
+                                           GError        **error);
+
 /* Insert into the buffer */
 GDK_AVAILABLE_IN_ALL
 void gtk_text_buffer_insert            (GtkTextBuffer *buffer,
@@ -359,6 +371,32 @@ void gtk_text_buffer_remove_all_tags       (GtkTextBuffer     *buffer,
                                             const GtkTextIter *start,
                                             const GtkTextIter *end);
 
+/**
+ * GtkTextTagRange:
+ * @tag: a #GtkTextTag
+ * @start: one bound of the range
+ * @end: other bound of the range
+ *
+ * A range of text to tag with @tag, see gtk_text_buffer_apply_tag_ranges().
+ *
+ * Since: 3.90
+ */
+struct _GtkTextTagRange
+{
+  GtkTextTag *tag;
+  GtkTextIter start;
+  GtkTextIter end;
+};
+
+GDK_AVAILABLE_IN_3_90
+void gtk_text_buffer_apply_tag_ranges      (GtkTextBuffer         *buffer,
+                                            const GtkTextTagRange *ranges,
+                                            guint                  n_ranges);
+GDK_AVAILABLE_IN_3_90
+void gtk_text_buffer_remove_tag_ranges     (GtkTextBuffer         *buffer,
+                                            const GtkTextTagRange *ranges,
+                                            guint                  n_ranges);
+
 
 /* You can either ignore the return value, or use it to
  * set the attributes of the tag. tag_name can be NULL
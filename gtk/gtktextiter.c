@@ -28,6 +28,7 @@
 #include "gtktextbtree.h"
 #include "gtktextbufferprivate.h"
 #include "gtktextiterprivate.h"
+#include "gtktexttagprivate.h"
 #include "gtkintl.h"
 #include "gtkdebug.h"
 
@@ -4906,6 +4907,370 @@ strbreakup (const char *string,
   return str_array;
 }
 
+/* The state of a forward search, set up once and reused for every
+ * line, and for every match when looking for all of them.
+ */
+typedef struct
+{
+  gchar **lines;                /* The search string split into lines */
+  gsize needle_len;             /* Length of lines[0] */
+  GString *line_text;           /* Scratch space for a line’s text */
+
+  guint visible_only : 1;
+  guint slice : 1;
+  guint case_insensitive : 1;
+
+  /* Whether lines can be searched by looking directly at their
+   * segments. This is the case for single-line search strings,
+   * as long as no text may be invisible.
+   */
+  guint scan_segments : 1;
+  guint ascii_needle : 1;
+} TextSearch;
+
+static void
+check_invisible_tag (GtkTextTag *tag,
+                     gpointer    data)
+{
+  gboolean *affects_visibility = data;
+
+  if (tag->priv->invisible_set)
+    *affects_visibility = TRUE;
+}
+
+static void
+text_search_init (TextSearch         *search,
+                  const GtkTextIter  *iter,
+                  const gchar        *str,
+                  GtkTextSearchFlags  flags)
+{
+  gint n_lines;
+  const gchar *p;
+
+  search->visible_only = (flags & GTK_TEXT_SEARCH_VISIBLE_ONLY) != 0;
+  search->slice = (flags & GTK_TEXT_SEARCH_TEXT_ONLY) == 0;
+  search->case_insensitive = (flags & GTK_TEXT_SEARCH_CASE_INSENSITIVE) != 0;
+
+  /* locate all lines */
+
+  search->lines = strbreakup (str, "\n", -1, &n_lines, search->case_insensitive);
+  search->needle_len = n_lines > 0 ? strlen (search->lines[0]) : 0;
+  search->line_text = NULL;
+
+  search->scan_segments = n_lines == 1;
+
+  if (search->scan_segments && search->visible_only)
+    {
+      GtkTextTagTable *table;
+      gboolean affects_visibility = FALSE;
+
+      table = gtk_text_buffer_get_tag_table (gtk_text_iter_get_buffer (iter));
+      gtk_text_tag_table_foreach (table, check_invisible_tag, &affects_visibility);
+
+      search->scan_segments = !affects_visibility;
+    }
+
+  search->ascii_needle = TRUE;
+  for (p = search->lines[0]; p && *p; p++)
+    {
+      if ((guchar) *p >= 0x80)
+        {
+          search->ascii_needle = FALSE;
+          break;
+        }
+    }
+}
+
+static void
+text_search_clear (TextSearch *search)
+{
+  g_strfreev (search->lines);
+
+  if (search->line_text)
+    g_string_free (search->line_text, TRUE);
+}
+
+/* memmem() is a GNU extension. The memchr() and memcmp() of most C
+ * libraries are vectorized, which makes this fast for all but very
+ * repetitive text.
+ */
+static const gchar *
+find_bytes (const gchar *haystack,
+            gsize        haystack_len,
+            const gchar *needle,
+            gsize        needle_len)
+{
+  const gchar *p, *last;
+
+  if (needle_len > haystack_len)
+    return NULL;
+
+  p = haystack;
+  last = haystack + (haystack_len - needle_len);
+
+  while (p <= last)
+    {
+      p = memchr (p, needle[0], last - p + 1);
+      if (p == NULL)
+        return NULL;
+
+      if (memcmp (p + 1, needle + 1, needle_len - 1) == 0)
+        return p;
+
+      p++;
+    }
+
+  return NULL;
+}
+
+/* Case insensitive search for an ASCII @needle, which must already
+ * be lowercase. @haystack must be ASCII as well, otherwise casefolding
+ * and normalization may turn other characters into ASCII ones.
+ */
+static const gchar *
+ascii_find_bytes_nocase (const gchar *haystack,
+                         gsize        haystack_len,
+                         const gchar *needle,
+                         gsize        needle_len)
+{
+  const gchar *p, *last;
+
+  if (needle_len > haystack_len)
+    return NULL;
+
+  last = haystack + (haystack_len - needle_len);
+
+  for (p = haystack; p <= last; p++)
+    {
+      if (g_ascii_tolower (*p) == needle[0] &&
+          g_ascii_strncasecmp (p + 1, needle + 1, needle_len - 1) == 0)
+        return p;
+    }
+
+  return NULL;
+}
+
+static gboolean
+is_ascii (const gchar *text,
+          gsize        len)
+{
+  gsize i;
+
+  for (i = 0; i < len; i++)
+    {
+      if ((guchar) text[i] >= 0x80)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Searches the line of @iter, from @iter on, for a single-line search
+ * string by looking at the segments of the line.
+ */
+static gboolean
+text_search_line (TextSearch        *search,
+                  const GtkTextIter *iter,
+                  GtkTextIter       *match_start,
+                  GtkTextIter       *match_end)
+{
+  GtkTextLine *line;
+  GtkTextLineSegment *seg;
+  GtkTextLineSegment *char_seg = NULL;
+  const gchar *text;
+  const gchar *found;
+  gboolean single_segment = TRUE;
+  gboolean has_nontext = FALSE;
+  gint start_index;
+  gint len;
+
+  line = _gtk_text_iter_get_text_line (iter);
+  start_index = gtk_text_iter_get_line_index (iter);
+
+  for (seg = line->segments; seg != NULL; seg = seg->next)
+    {
+      if (seg->byte_count == 0)
+        continue;
+
+      if (seg->type != &gtk_text_char_type)
+        has_nontext = TRUE;
+
+      if (char_seg == NULL && seg->type == &gtk_text_char_type)
+        char_seg = seg;
+      else
+        single_segment = FALSE;
+    }
+
+  /* Pixbufs and child widgets are not part of the text */
+  if (has_nontext && !search->slice)
+    return lines_match (iter, (const gchar **) search->lines,
+                        search->visible_only, search->slice,
+                        search->case_insensitive,
+                        match_start, match_end);
+
+  /* Most lines consist of a single char segment, which can be searched
+   * in place. Otherwise, collect the bytes of the line. Either way, the
+   * offsets in the text are line indexes, since pixbufs and child
+   * widgets take up the bytes of the 0xFFFC character.
+   */
+  if (single_segment && char_seg != NULL && !search->case_insensitive)
+    {
+      text = char_seg->body.chars;
+      len = char_seg->byte_count;
+    }
+  else
+    {
+      if (search->line_text == NULL)
+        search->line_text = g_string_new (NULL);
+
+      g_string_truncate (search->line_text, 0);
+
+      for (seg = line->segments; seg != NULL; seg = seg->next)
+        {
+          if (seg->type == &gtk_text_char_type)
+            g_string_append_len (search->line_text, seg->body.chars, seg->byte_count);
+          else if (seg->byte_count > 0)
+            g_string_append_len (search->line_text, _gtk_text_unknown_char_utf8,
+                                 GTK_TEXT_UNKNOWN_CHAR_UTF8_LEN);
+        }
+
+      text = search->line_text->str;
+      len = search->line_text->len;
+    }
+
+  /* The newline at the end of the last line is not part of the buffer */
+  if (_gtk_text_line_contains_end_iter (line, _gtk_text_iter_get_btree (iter)))
+    len -= 1;
+
+  if (start_index >= len)
+    return FALSE;
+
+  if (!search->case_insensitive)
+    {
+      found = find_bytes (text + start_index, len - start_index,
+                          search->lines[0], search->needle_len);
+    }
+  else if (search->ascii_needle && is_ascii (text + start_index, len - start_index))
+    {
+      found = ascii_find_bytes_nocase (text + start_index, len - start_index,
+                                       search->lines[0], search->needle_len);
+    }
+  else
+    {
+      if (len < search->line_text->len)
+        g_string_truncate (search->line_text, len);
+
+      found = utf8_strcasestr (text + start_index, search->lines[0]);
+
+      if (found == NULL)
+        return FALSE;
+
+      *match_start = *iter;
+      gtk_text_iter_set_line_index (match_start, found - text);
+
+      *match_end = *match_start;
+      forward_chars_with_skipping (match_end, g_utf8_strlen (search->lines[0], -1),
+                                   search->visible_only, !search->slice, TRUE);
+
+      return TRUE;
+    }
+
+  if (found == NULL)
+    return FALSE;
+
+  *match_start = *iter;
+  gtk_text_iter_set_line_index (match_start, found - text);
+
+  *match_end = *iter;
+  gtk_text_iter_set_line_index (match_end, found - text + search->needle_len);
+
+  return TRUE;
+}
+
+static gboolean
+text_search_forward (TextSearch        *search,
+                     const GtkTextIter *iter,
+                     GtkTextIter       *match_start,
+                     GtkTextIter       *match_end,
+                     const GtkTextIter *limit)
+{
+  GtkTextIter match, end;
+  GtkTextIter line_iter;
+  gboolean retval = FALSE;
+
+  line_iter = *iter;
+
+  do
+    {
+      gboolean found;
+
+      if (limit &&
+          gtk_text_iter_compare (&line_iter, limit) >= 0)
+        break;
+
+      /* Multi-line search strings still get the text of each line,
+       * which has an inefficient worst-case, where gtk_text_iter_get_text()
+       * is called repeatedly on a single line.
+       */
+      if (search->scan_segments)
+        found = text_search_line (search, &line_iter, &match, &end);
+      else
+        found = lines_match (&line_iter, (const gchar**)search->lines,
+                             search->visible_only, search->slice,
+                             search->case_insensitive, &match, &end);
+
+      if (found)
+        {
+          if (limit == NULL ||
+              (limit &&
+               gtk_text_iter_compare (&end, limit) <= 0))
+            {
+              retval = TRUE;
+              
+              if (match_start)
+                *match_start = match;
+              
+              if (match_end)
+                *match_end = end;
+            }
+          
+          break;
+        }
+    }
+  while (gtk_text_iter_forward_line (&line_iter));
+
+  return retval;
+}
+
+/* Handles searching for the empty string. If we can move one char,
+ * the empty string matches there.
+ */
+static gboolean
+forward_search_empty (const GtkTextIter *iter,
+                      GtkTextIter       *match_start,
+                      GtkTextIter       *match_end,
+                      const GtkTextIter *limit)
+{
+  GtkTextIter match;
+
+  match = *iter;
+
+  if (gtk_text_iter_forward_char (&match))
+    {
+      if (limit &&
+          gtk_text_iter_equal (&match, limit))
+        return FALSE;
+
+      if (match_start)
+        *match_start = match;
+      if (match_end)
+        *match_end = match;
+      return TRUE;
+    }
+  else
+    return FALSE;
+}
+
 /**
  * gtk_text_iter_forward_search:
  * @iter: start of search
@@ -4935,13 +5300,8 @@ gtk_text_iter_forward_search (const GtkTextIter *iter,
                               GtkTextIter       *match_end,
                               const GtkTextIter *limit)
 {
-  gchar **lines = NULL;
-  GtkTextIter match;
-  gboolean retval = FALSE;
-  GtkTextIter search;
-  gboolean visible_only;
-  gboolean slice;
-  gboolean case_insensitive;
+  TextSearch search;
+  gboolean retval;
 
   g_return_val_if_fail (iter != NULL, FALSE);
   g_return_val_if_fail (str != NULL, FALSE);
@@ -4951,72 +5311,96 @@ gtk_text_iter_forward_search (const GtkTextIter *iter,
     return FALSE;
   
   if (*str == '\0')
-    {
-      /* If we can move one char, return the empty string there */
-      match = *iter;
-      
-      if (gtk_text_iter_forward_char (&match))
-        {
-          if (limit &&
-              gtk_text_iter_equal (&match, limit))
-            return FALSE;
-          
-          if (match_start)
-            *match_start = match;
-          if (match_end)
-            *match_end = match;
-          return TRUE;
-        }
-      else
-        return FALSE;
-    }
+    return forward_search_empty (iter, match_start, match_end, limit);
 
-  visible_only = (flags & GTK_TEXT_SEARCH_VISIBLE_ONLY) != 0;
-  slice = (flags & GTK_TEXT_SEARCH_TEXT_ONLY) == 0;
-  case_insensitive = (flags & GTK_TEXT_SEARCH_CASE_INSENSITIVE) != 0;
+  text_search_init (&search, iter, str, flags);
 
-  /* locate all lines */
+  retval = text_search_forward (&search, iter, match_start, match_end, limit);
 
-  lines = strbreakup (str, "\n", -1, NULL, case_insensitive);
+  text_search_clear (&search);
 
-  search = *iter;
+  return retval;
+}
 
-  do
+/**
+ * GtkTextSearchFunc:
+ * @match_start: the start of the match
+ * @match_end: the end of the match
+ * @user_data: user data passed to gtk_text_iter_forward_search_all()
+ *
+ * A function called for each match found by
+ * gtk_text_iter_forward_search_all().
+ *
+ * Returns: %TRUE to stop searching, %FALSE to continue
+ *
+ * Since: 3.90
+ */
+
+/**
+ * gtk_text_iter_forward_search_all:
+ * @iter: start of search
+ * @str: a search string
+ * @flags: flags affecting how the search is done
+ * @limit: (allow-none): location of last possible match end, or %NULL for the end of the buffer
+ * @func: (scope call) (allow-none): function to call for each match
+ * @user_data: user data to pass to @func
+ *
+ * Finds all non-overlapping matches of @str after @iter, as
+ * gtk_text_iter_forward_search() would find them one after the
+ * other, and calls @func for each of them. This is much faster than
+ * restarting the search after each match, e.g. for highlighting
+ * all occurrences of a string.
+ *
+ * The buffer must not be modified from @func.
+ *
+ * Returns: the number of matches found
+ *
+ * Since: 3.90
+ **/
+gint
+gtk_text_iter_forward_search_all (const GtkTextIter *iter,
+                                  const gchar       *str,
+                                  GtkTextSearchFlags flags,
+                                  const GtkTextIter *limit,
+                                  GtkTextSearchFunc  func,
+                                  gpointer           user_data)
+{
+  TextSearch search;
+  GtkTextIter start, match_start, match_end;
+  gint n_matches = 0;
+
+  g_return_val_if_fail (iter != NULL, 0);
+  g_return_val_if_fail (str != NULL, 0);
+
+  if (*str != '\0')
+    text_search_init (&search, iter, str, flags);
+
+  start = *iter;
+
+  while (!limit || gtk_text_iter_compare (&start, limit) < 0)
     {
-      /* This loop has an inefficient worst-case, where
-       * gtk_text_iter_get_text() is called repeatedly on
-       * a single line.
-       */
-      GtkTextIter end;
+      gboolean found;
 
-      if (limit &&
-          gtk_text_iter_compare (&search, limit) >= 0)
+      if (*str == '\0')
+        found = forward_search_empty (&start, &match_start, &match_end, limit);
+      else
+        found = text_search_forward (&search, &start, &match_start, &match_end, limit);
+
+      if (!found)
         break;
-      
-      if (lines_match (&search, (const gchar**)lines,
-                       visible_only, slice, case_insensitive, &match, &end))
-        {
-          if (limit == NULL ||
-              (limit &&
-               gtk_text_iter_compare (&end, limit) <= 0))
-            {
-              retval = TRUE;
-              
-              if (match_start)
-                *match_start = match;
-              
-              if (match_end)
-                *match_end = end;
-            }
-          
-          break;
-        }
+
+      n_matches++;
+
+      if (func && func (&match_start, &match_end, user_data))
+        break;
+
+      start = match_end;
     }
-  while (gtk_text_iter_forward_line (&search));
 
-  g_strfreev ((gchar**)lines);
+  if (*str != '\0')
+    text_search_clear (&search);
 
-  return retval;
+  return n_matches;
 }
 
 static gboolean
@@ -384,6 +384,18 @@ gboolean gtk_text_iter_forward_search  (const GtkTextIter *iter,
                                         GtkTextIter       *match_end,
                                         const GtkTextIter *limit);
 
+typedef gboolean (* GtkTextSearchFunc) (const GtkTextIter *match_start,
+                                        const GtkTextIter *match_end,
+                                        gpointer           user_data);
+
+GDK_AVAILABLE_IN_3_90
+gint     gtk_text_iter_forward_search_all (const GtkTextIter *iter,
+                                           const gchar       *str,
+                                           GtkTextSearchFlags flags,
+                                           const GtkTextIter *limit,
+                                           GtkTextSearchFunc  func,
+                                           gpointer           user_data);
+
 GDK_AVAILABLE_IN_ALL
 gboolean gtk_text_iter_backward_search (const GtkTextIter *iter,
                                         const gchar       *str,
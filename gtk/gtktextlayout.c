@@ -86,12 +86,30 @@
 #include "gtktextutil.h"
 #include "gtkintl.h"
 
+#include <pango/pangocairo.h>
 #include <stdlib.h>
 #include <string.h>
 
 #define GTK_TEXT_LAYOUT_GET_PRIVATE(o)  ((GtkTextLayoutPrivate *) gtk_text_layout_get_instance_private ((o)))
 
+/* Number of line displays kept around by the layout. This should
+ * comfortably cover a screenful of lines, so that redrawing or moving
+ * the cursor around unchanged text does not recreate PangoLayouts.
+ */
+#define LINE_DISPLAY_CACHE_SIZE 256
+
+/* Asynchronous validation is only worth it for large buffers. Lines
+ * are measured in batches of up to ASYNC_VALIDATION_BATCH_LINES, split
+ * into chunks of ASYNC_VALIDATION_CHUNK_LINES per worker task.
+ */
+#define ASYNC_VALIDATION_MIN_LINES   5000
+#define ASYNC_VALIDATION_BATCH_LINES 16384
+#define ASYNC_VALIDATION_SCAN_LINES  (4 * ASYNC_VALIDATION_BATCH_LINES)
+#define ASYNC_VALIDATION_CHUNK_LINES 1024
+
 typedef struct _GtkTextLayoutPrivate GtkTextLayoutPrivate;
+typedef struct _LineDisplayCacheEntry LineDisplayCacheEntry;
+typedef struct _AsyncValidation AsyncValidation;
 
 struct _GtkTextLayoutPrivate
 {
@@ -99,6 +117,40 @@ struct _GtkTextLayoutPrivate
      direction only influences the direction of the cursor line.
   */
   GtkTextLine *cursor_line;
+
+  /* LRU cache of line displays. Getting the same few lines many
+   * times in a row is the most common case, e.g. when drawing,
+   * scrolling or moving the cursor. The queue is ordered from most
+   * to least recently used; the hash table maps GtkTextLine to its
+   * entry.
+   */
+  GHashTable *display_cache;
+  GQueue display_cache_lru;
+
+  /* Incremented whenever everything is invalidated, e.g. when the
+   * default style, the contexts or the screen width change.
+   */
+  guint generation;
+
+  /* Sum and count of the line heights measured so far, used to
+   * estimate the height of lines that have not been measured yet.
+   */
+  gint64 measured_height;
+  gint n_measured_lines;
+
+  guint async_validation : 1;
+  AsyncValidation *async_batch;
+};
+
+struct _LineDisplayCacheEntry
+{
+  GtkTextLineDisplay *display;
+  GList link;
+
+  /* Whether the line was the cursor line when the display was
+   * created; this affects the base direction of neutral lines.
+   */
+  guint cursor_line : 1;
 };
 
 static GtkTextLineData *gtk_text_layout_real_wrap (GtkTextLayout *layout,
@@ -129,6 +181,32 @@ static void gtk_text_layout_emit_changed           (GtkTextLayout     *layout,
 
 static void gtk_text_layout_invalidate_all (GtkTextLayout *layout);
 
+static void line_display_cache_clear (GtkTextLayout *layout);
+
+static void async_validation_cancel (GtkTextLayout *layout);
+static void async_validation_start  (GtkTextLayout *layout);
+static gint estimate_line_height    (GtkTextLayout *layout);
+
+static gint strip_paragraph_delimiter (const gchar       *text,
+                                       gint               len);
+static void set_para_layout_values    (PangoLayout       *pango_layout,
+                                       PangoDirection     base_dir,
+                                       GtkTextAttributes *style,
+                                       gint               layout_width);
+static void add_generic_attrs         (GtkTextLayout      *layout,
+                                       GtkTextAppearance  *appearance,
+                                       gint                byte_count,
+                                       PangoAttrList      *attrs,
+                                       gint                start,
+                                       gboolean            size_only,
+                                       gboolean            is_text);
+static void add_text_attrs            (GtkTextLayout      *layout,
+                                       GtkTextAttributes  *style,
+                                       gint                byte_count,
+                                       PangoAttrList      *attrs,
+                                       gint                start,
+                                       gboolean            size_only);
+
 static PangoAttribute *gtk_text_attr_appearance_new (const GtkTextAppearance *appearance);
 
 static void gtk_text_layout_mark_set_handler    (GtkTextBuffer     *buffer,
@@ -186,6 +264,8 @@ gtk_text_layout_dispose (GObject *object)
 
   gtk_text_layout_set_buffer (layout, NULL);
 
+  async_validation_cancel (layout);
+
   if (layout->default_style != NULL)
     {
       gtk_text_attributes_unref (layout->default_style);
@@ -195,12 +275,7 @@ gtk_text_layout_dispose (GObject *object)
   g_clear_object (&layout->ltr_context);
   g_clear_object (&layout->rtl_context);
 
-  if (layout->one_display_cache)
-    {
-      GtkTextLineDisplay *tmp_display = layout->one_display_cache;
-      layout->one_display_cache = NULL;
-      gtk_text_layout_free_line_display (layout, tmp_display);
-    }
+  line_display_cache_clear (layout);
 
   if (layout->preedit_attrs != NULL)
     {
@@ -218,6 +293,8 @@ gtk_text_layout_finalize (GObject *object)
 
   layout = GTK_TEXT_LAYOUT (object);
 
+  g_hash_table_destroy (GTK_TEXT_LAYOUT_GET_PRIVATE (layout)->display_cache);
+
   g_free (layout->preedit_string);
 
   G_OBJECT_CLASS (gtk_text_layout_parent_class)->finalize (object);
@@ -278,7 +355,12 @@ gtk_text_layout_class_init (GtkTextLayoutClass *klass)
 static void
 gtk_text_layout_init (GtkTextLayout *text_layout)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (text_layout);
+
   text_layout->cursor_visible = TRUE;
+
+  priv->display_cache = g_hash_table_new (NULL, NULL);
+  g_queue_init (&priv->display_cache_lru);
 }
 
 GtkTextLayout*
@@ -312,6 +394,8 @@ gtk_text_layout_set_buffer (GtkTextLayout *layout,
     return;
 
   free_style_cache (layout);
+  line_display_cache_clear (layout);
+  async_validation_cancel (layout);
 
   if (layout->buffer)
     {
@@ -637,20 +721,32 @@ text_layout_changed (GtkTextLayout *layout,
                      gint           new_height,
                      gboolean       cursors_only)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLine **lines;
+  guint n_lines, i;
+  GList *l;
+
+  /* Check if the range intersects any of our cached line displays,
+   * and invalidate the cached lines if so. Collect the lines first,
+   * since invalidating modifies the cache.
    */
-  if (layout->one_display_cache)
+  n_lines = 0;
+  lines = g_newa (GtkTextLine *, priv->display_cache_lru.length);
+  for (l = priv->display_cache_lru.head; l != NULL; l = l->next)
     {
-      GtkTextLine *line = layout->one_display_cache->line;
+      LineDisplayCacheEntry *entry = l->data;
+      GtkTextLine *line = entry->display->line;
       gint cache_y = _gtk_text_btree_find_line_top (_gtk_text_buffer_get_btree (layout->buffer),
 						    line, layout);
-      gint cache_height = layout->one_display_cache->height;
+      gint cache_height = entry->display->height;
 
       if (cache_y + cache_height > y && cache_y < y + old_height)
-	gtk_text_layout_invalidate_cache (layout, line, cursors_only);
+        lines[n_lines++] = line;
     }
 
+  for (i = 0; i < n_lines; i++)
+    gtk_text_layout_invalidate_cache (layout, lines[i], cursors_only);
+
   gtk_text_layout_emit_changed (layout, y, old_height, new_height);
 }
 
@@ -804,25 +900,140 @@ gtk_text_layout_wrap_loop_end (GtkTextLayout *layout)
 static void
 gtk_text_layout_invalidate_all (GtkTextLayout *layout)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
   GtkTextIter start;
   GtkTextIter end;
 
   if (layout->buffer == NULL)
     return;
 
+  line_display_cache_clear (layout);
+  async_validation_cancel (layout);
+
+  priv->generation++;
+  priv->measured_height = 0;
+  priv->n_measured_lines = 0;
+
   gtk_text_buffer_get_bounds (layout->buffer, &start, &end);
 
   gtk_text_layout_invalidate (layout, &start, &end);
 }
 
+/*
+ * Line display cache
+ */
+
+static gboolean
+line_display_is_cached (GtkTextLayout      *layout,
+                        GtkTextLineDisplay *display)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  LineDisplayCacheEntry *entry;
+
+  entry = g_hash_table_lookup (priv->display_cache, display->line);
+
+  return entry != NULL && entry->display == display;
+}
+
+static void
+line_display_cache_remove (GtkTextLayout         *layout,
+                           LineDisplayCacheEntry *entry)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLineDisplay *display = entry->display;
+
+  g_hash_table_remove (priv->display_cache, display->line);
+  g_queue_unlink (&priv->display_cache_lru, &entry->link);
+  g_slice_free (LineDisplayCacheEntry, entry);
+
+  gtk_text_layout_free_line_display (layout, display);
+}
+
+static void
+line_display_cache_clear (GtkTextLayout *layout)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  while (priv->display_cache_lru.head)
+    line_display_cache_remove (layout, priv->display_cache_lru.head->data);
+}
+
+/* Looks up a cached display for @line that is usable for
+ * @size_only, marking it as most recently used. Returns %NULL
+ * and drops the stale entry if the cached display can't be used.
+ */
+static GtkTextLineDisplay *
+line_display_cache_lookup (GtkTextLayout *layout,
+                           GtkTextLine   *line,
+                           gboolean       size_only)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  LineDisplayCacheEntry *entry;
+
+  entry = g_hash_table_lookup (priv->display_cache, line);
+  if (entry == NULL)
+    return NULL;
+
+  if ((!size_only && entry->display->size_only) ||
+      entry->cursor_line != (line == priv->cursor_line))
+    {
+      line_display_cache_remove (layout, entry);
+      return NULL;
+    }
+
+  if (priv->display_cache_lru.head != &entry->link)
+    {
+      g_queue_unlink (&priv->display_cache_lru, &entry->link);
+      g_queue_push_head_link (&priv->display_cache_lru, &entry->link);
+    }
+
+  return entry->display;
+}
+
+static void
+line_display_cache_insert (GtkTextLayout      *layout,
+                           GtkTextLineDisplay *display)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  LineDisplayCacheEntry *entry;
+
+  entry = g_hash_table_lookup (priv->display_cache, display->line);
+  if (entry != NULL)
+    line_display_cache_remove (layout, entry);
+
+  if (priv->display_cache_lru.length >= LINE_DISPLAY_CACHE_SIZE)
+    line_display_cache_remove (layout, priv->display_cache_lru.tail->data);
+
+  entry = g_slice_new0 (LineDisplayCacheEntry);
+  entry->display = display;
+  entry->link.data = entry;
+  entry->cursor_line = display->line == priv->cursor_line;
+
+  g_hash_table_insert (priv->display_cache, display->line, entry);
+
+  /* Size-only displays are mostly created while validating lines
+   * that are not on screen; queue them as least recently used so
+   * that validating a large buffer doesn't push the displays of
+   * the visible lines out of the cache.
+   */
+  if (display->size_only)
+    g_queue_push_tail_link (&priv->display_cache_lru, &entry->link);
+  else
+    g_queue_push_head_link (&priv->display_cache_lru, &entry->link);
+}
+
 static void
 gtk_text_layout_invalidate_cache (GtkTextLayout *layout,
                                   GtkTextLine   *line,
 				  gboolean       cursors_only)
 {
-  if (layout->one_display_cache && line == layout->one_display_cache->line)
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  LineDisplayCacheEntry *entry;
+
+  entry = g_hash_table_lookup (priv->display_cache, line);
+  if (entry != NULL)
     {
-      GtkTextLineDisplay *display = layout->one_display_cache;
+      GtkTextLineDisplay *display = entry->display;
 
       if (cursors_only)
 	{
@@ -834,8 +1045,7 @@ gtk_text_layout_invalidate_cache (GtkTextLayout *layout,
 	}
       else
 	{
-	  layout->one_display_cache = NULL;
-	  gtk_text_layout_free_line_display (layout, display);
+	  line_display_cache_remove (layout, entry);
 	}
     }
 }
@@ -884,8 +1094,12 @@ gtk_text_layout_real_invalidate (GtkTextLayout *layout,
                                  const GtkTextIter *start,
                                  const GtkTextIter *end)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextBTree *tree;
   GtkTextLine *line;
   GtkTextLine *last_line;
+  GtkTextLine *estimated_line = NULL;
+  gint estimated_height = 0;
 
   g_return_if_fail (GTK_IS_TEXT_LAYOUT (layout));
   g_return_if_fail (layout->wrap_loop_count == 0);
@@ -902,14 +1116,40 @@ gtk_text_layout_real_invalidate (GtkTextLayout *layout,
   gtk_text_view_index_spew (end_index, "invalidate end");
 #endif
 
+  tree = _gtk_text_buffer_get_btree (layout->buffer);
   last_line = _gtk_text_iter_get_text_line (end);
   line = _gtk_text_iter_get_text_line (start);
 
+  /* With asynchronous validation, lines of large buffers that have
+   * never been measured get an estimated height right away, so that
+   * the scroll range is plausible long before validation reaches them.
+   * Small buffers are validated exactly soon enough.
+   */
+  if (priv->async_validation &&
+      _gtk_text_btree_line_count (tree) >= ASYNC_VALIDATION_MIN_LINES)
+    estimated_height = estimate_line_height (layout);
+
+  /* Results of measurements in flight may be stale now */
+  async_validation_cancel (layout);
+
   while (TRUE)
     {
       GtkTextLineData *line_data = _gtk_text_line_get_data (line, layout);
 
       gtk_text_layout_invalidate_cache (layout, line, FALSE);
+
+      if (line_data == NULL && estimated_height > 0 &&
+          !_gtk_text_line_is_last (line, tree))
+        {
+          /* Update the node sizes once per node, not once per line */
+          if (estimated_line && estimated_line->parent != line->parent)
+            _gtk_text_btree_line_size_changed (tree, estimated_line, layout);
+
+          line_data = _gtk_text_line_data_new (layout, line);
+          line_data->height = estimated_height;
+          _gtk_text_line_add_data (line, line_data);
+          estimated_line = line;
+        }
       
       if (line_data)
         _gtk_text_line_invalidate_wrap (line, line_data);
@@ -920,6 +1160,9 @@ gtk_text_layout_real_invalidate (GtkTextLayout *layout,
       line = _gtk_text_line_next_excluding_last (line);
     }
 
+  if (estimated_line)
+    _gtk_text_btree_line_size_changed (tree, estimated_line, layout);
+
   gtk_text_layout_invalidated (layout);
 }
 
@@ -928,32 +1171,32 @@ gtk_text_layout_real_invalidate_cursors (GtkTextLayout     *layout,
 					 const GtkTextIter *start,
 					 const GtkTextIter *end)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
-   */
-  if (layout->one_display_cache)
-    {
-      GtkTextIter line_start, line_end;
-      GtkTextLine *line = layout->one_display_cache->line;
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  gint start_line, end_line;
+  GList *l;
 
-      gtk_text_layout_get_iter_at_line (layout, &line_start, line, 0);
+  if (gtk_text_iter_compare (start, end) > 0)
+    {
+      const GtkTextIter *tmp = start;
+      start = end;
+      end = tmp;
+    }
 
-      line_end = line_start;
-      if (!gtk_text_iter_ends_line (&line_end))
-	gtk_text_iter_forward_to_line_end (&line_end);
+  start_line = gtk_text_iter_get_line (start);
+  end_line = gtk_text_iter_get_line (end);
 
-      if (gtk_text_iter_compare (start, end) > 0)
-	{
-	  const GtkTextIter *tmp = start;
-	  start = end;
-	  end = tmp;
-	}
+  /* Check if the range intersects any of our cached line displays,
+   * and invalidate the cursors of the cached lines if so. This
+   * doesn't remove entries, so we can do it while iterating.
+   */
+  for (l = priv->display_cache_lru.head; l != NULL; l = l->next)
+    {
+      LineDisplayCacheEntry *entry = l->data;
+      GtkTextLine *line = entry->display->line;
+      gint line_number = _gtk_text_line_get_number (line);
 
-      if (gtk_text_iter_compare (&line_start, end) <= 0 &&
-	  gtk_text_iter_compare (start, &line_end) <= 0)
-	{
-	  gtk_text_layout_invalidate_cache (layout, line, TRUE);
-	}
+      if (line_number >= start_line && line_number <= end_line)
+	gtk_text_layout_invalidate_cache (layout, line, TRUE);
     }
 
   gtk_text_layout_invalidated (layout);
@@ -1038,7 +1281,7 @@ gtk_text_layout_validate_yrange (GtkTextLayout *layout,
   while (line && seen < -y0)
     {
       GtkTextLineData *line_data = _gtk_text_line_get_data (line, layout);
-      if (!line_data || !line_data->valid)
+      if (!line_data || !line_data->valid || line_data->measured_async)
         {
           gint old_height, new_height;
           gint top_ink, bottom_ink;
@@ -1079,7 +1322,7 @@ gtk_text_layout_validate_yrange (GtkTextLayout *layout,
   while (line && seen < y1)
     {
       GtkTextLineData *line_data = _gtk_text_line_get_data (line, layout);
-      if (!line_data || !line_data->valid)
+      if (!line_data || !line_data->valid || line_data->measured_async)
         {
           gint old_height, new_height;
           gint top_ink, bottom_ink;
@@ -1145,10 +1388,17 @@ void
 gtk_text_layout_validate (GtkTextLayout *layout,
                           gint           max_pixels)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
   gint y, old_height, new_height;
 
   g_return_if_fail (GTK_IS_TEXT_LAYOUT (layout));
 
+  /* While worker threads are measuring lines, validating here would
+   * only duplicate their work.
+   */
+  if (priv->async_batch)
+    return;
+
   while (max_pixels > 0 &&
          _gtk_text_btree_validate (_gtk_text_buffer_get_btree (layout->buffer),
                                    layout,  max_pixels,
@@ -1159,6 +1409,569 @@ gtk_text_layout_validate (GtkTextLayout *layout,
       update_layout_size (layout);
       gtk_text_layout_emit_changed (layout, y, old_height, new_height);
     }
+
+  if (priv->async_validation)
+    async_validation_start (layout);
+}
+
+/*
+ * Asynchronous validation
+ *
+ * Measuring lines is by far the most expensive part of validating a
+ * large buffer. In asynchronous validation mode, the text of lines
+ * that only use the default style is copied and measured by worker
+ * threads, each with its own PangoContext. The results are merged
+ * into the btree on the main thread, unless the buffer or the layout
+ * changed in the meantime. Lines measured this way are wrapped again
+ * on the main thread before they are displayed.
+ */
+
+typedef struct _AsyncLine AsyncLine;
+typedef struct _AsyncValidationChunk AsyncValidationChunk;
+
+struct _AsyncLine
+{
+  GtkTextLine *line;           /* Only dereferenced on the main thread */
+  gchar *text;
+  gint text_len;               /* Without the paragraph delimiter */
+  gint attr_len;
+  PangoDirection base_dir;
+
+  /* Results */
+  gint width;
+  gint height;
+  gint top_ink;
+  gint bottom_ink;
+};
+
+struct _AsyncValidation
+{
+  GCancellable *cancellable;
+  guint chars_changed_stamp;
+  guint segments_changed_stamp;
+  guint generation;
+  gint n_pending;
+
+  /* Read-only while tasks are running */
+  GtkTextAttributes *style;
+  PangoFontDescription *font_desc;
+  PangoLanguage *language;
+  cairo_font_options_t *font_options;
+  gdouble resolution;
+  PangoMatrix matrix;
+  guint has_matrix : 1;
+  gint layout_width;
+  gint h_padding;
+
+  GArray *lines;
+};
+
+struct _AsyncValidationChunk
+{
+  AsyncValidation *batch;
+  guint start;
+  guint end;
+};
+
+static void
+async_line_clear (gpointer data)
+{
+  AsyncLine *async_line = data;
+
+  g_free (async_line->text);
+}
+
+static void
+async_validation_free (AsyncValidation *batch)
+{
+  g_object_unref (batch->cancellable);
+  gtk_text_attributes_unref (batch->style);
+  if (batch->font_desc)
+    pango_font_description_free (batch->font_desc);
+  if (batch->font_options)
+    cairo_font_options_destroy (batch->font_options);
+  g_array_unref (batch->lines);
+
+  g_slice_free (AsyncValidation, batch);
+}
+
+static void
+async_validation_chunk_free (gpointer data)
+{
+  g_slice_free (AsyncValidationChunk, data);
+}
+
+static void
+async_validation_cancel (GtkTextLayout *layout)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  /* The batch is freed once its last task returns */
+  if (priv->async_batch)
+    {
+      g_cancellable_cancel (priv->async_batch->cancellable);
+      priv->async_batch = NULL;
+    }
+}
+
+static gint
+estimate_line_height (GtkTextLayout *layout)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  PangoFontMetrics *metrics;
+  gint height;
+
+  if (priv->n_measured_lines > 0)
+    return MAX (1, priv->measured_height / priv->n_measured_lines);
+
+  if (layout->ltr_context == NULL ||
+      layout->default_style == NULL ||
+      layout->default_style->font == NULL)
+    return 0;
+
+  metrics = pango_context_get_metrics (layout->ltr_context,
+                                       layout->default_style->font,
+                                       NULL);
+  height = PANGO_PIXELS (pango_font_metrics_get_ascent (metrics) +
+                         pango_font_metrics_get_descent (metrics));
+  pango_font_metrics_unref (metrics);
+
+  return height +
+         layout->default_style->pixels_above_lines +
+         layout->default_style->pixels_below_lines;
+}
+
+/* Whether the line can be measured off the main thread, i.e. it
+ * consists only of text in the default style.
+ */
+static gboolean
+line_is_async_measurable (GtkTextLayout *layout,
+                          GtkTextLine   *line)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLineSegment *seg;
+  GtkTextTag **tags;
+  GtkTextIter iter;
+  gint n_tags;
+
+  /* The cursor line depends on the keyboard direction and preedit */
+  if (line == priv->cursor_line)
+    return FALSE;
+
+  for (seg = line->segments; seg != NULL; seg = seg->next)
+    {
+      if (seg->type != &gtk_text_char_type &&
+          seg->type != &gtk_text_right_mark_type &&
+          seg->type != &gtk_text_left_mark_type)
+        return FALSE;
+    }
+
+  gtk_text_layout_get_iter_at_line (layout, &iter, line, 0);
+  tags = _gtk_text_btree_get_tags (&iter, &n_tags);
+  g_free (tags);
+
+  return n_tags == 0;
+}
+
+static void
+async_line_init (AsyncLine   *async_line,
+                 GtkTextLine *line)
+{
+  GtkTextLineSegment *seg;
+  gint len = 0;
+
+  async_line->line = line;
+  async_line->text = g_malloc (_gtk_text_line_byte_count (line));
+
+  for (seg = line->segments; seg != NULL; seg = seg->next)
+    {
+      if (seg->type == &gtk_text_char_type)
+        {
+          memcpy (async_line->text + len, seg->body.chars, seg->byte_count);
+          len += seg->byte_count;
+        }
+    }
+
+  async_line->attr_len = len;
+  async_line->text_len = strip_paragraph_delimiter (async_line->text, len);
+
+  async_line->base_dir = line->dir_propagated_forward;
+  if (async_line->base_dir == PANGO_DIRECTION_NEUTRAL)
+    async_line->base_dir = line->dir_propagated_back;
+}
+
+static PangoContext *
+get_thread_pango_context (void)
+{
+  static GPrivate context_key = G_PRIVATE_INIT (g_object_unref);
+  PangoContext *context;
+
+  context = g_private_get (&context_key);
+  if (context == NULL)
+    {
+      /* The default cairo font map is per-thread */
+      context = pango_font_map_create_context (pango_cairo_font_map_get_default ());
+      g_private_set (&context_key, context);
+    }
+
+  return context;
+}
+
+static void
+async_line_measure (AsyncValidation *batch,
+                    PangoContext    *context,
+                    AsyncLine       *async_line)
+{
+  GtkTextAttributes *style = batch->style;
+  PangoDirection base_dir = async_line->base_dir;
+  PangoLayout *pango_layout;
+  PangoAttrList *attrs;
+  PangoRectangle extents, ink_rect, logical_rect;
+
+  if (base_dir == PANGO_DIRECTION_NEUTRAL)
+    base_dir = (style->direction == GTK_TEXT_DIR_RTL) ? PANGO_DIRECTION_RTL : PANGO_DIRECTION_LTR;
+  else if (base_dir != PANGO_DIRECTION_RTL)
+    base_dir = PANGO_DIRECTION_LTR;
+
+  pango_context_set_base_dir (context, base_dir);
+  pango_layout = pango_layout_new (context);
+
+  set_para_layout_values (pango_layout, base_dir, style, batch->layout_width);
+
+  attrs = pango_attr_list_new ();
+  add_generic_attrs (NULL, &style->appearance, async_line->attr_len,
+                     attrs, 0, TRUE, TRUE);
+  add_text_attrs (NULL, style, async_line->attr_len, attrs, 0, TRUE);
+
+  pango_layout_set_text (pango_layout, async_line->text, async_line->text_len);
+  pango_layout_set_attributes (pango_layout, attrs);
+  pango_attr_list_unref (attrs);
+
+  pango_layout_get_extents (pango_layout, NULL, &extents);
+  pango_layout_get_pixel_extents (pango_layout, &ink_rect, &logical_rect);
+
+  async_line->width = PIXEL_BOUND (extents.width) +
+                      style->left_margin + style->right_margin +
+                      batch->h_padding;
+  async_line->height = style->pixels_above_lines + style->pixels_below_lines +
+                       PANGO_PIXELS (extents.height);
+  async_line->top_ink = MAX (0, logical_rect.x - ink_rect.x);
+  async_line->bottom_ink = MAX (0, logical_rect.x + logical_rect.width - ink_rect.x - ink_rect.width);
+
+  g_object_unref (pango_layout);
+}
+
+static void
+async_validation_thread (GTask        *task,
+                         gpointer      source_object,
+                         gpointer      task_data,
+                         GCancellable *cancellable)
+{
+  AsyncValidationChunk *chunk = task_data;
+  AsyncValidation *batch = chunk->batch;
+  PangoContext *context;
+  guint i;
+
+  context = get_thread_pango_context ();
+  pango_context_set_font_description (context, batch->font_desc);
+  pango_context_set_language (context, batch->language);
+  pango_context_set_matrix (context, batch->has_matrix ? &batch->matrix : NULL);
+  pango_cairo_context_set_font_options (context, batch->font_options);
+  pango_cairo_context_set_resolution (context, batch->resolution);
+
+  for (i = chunk->start; i < chunk->end; i++)
+    {
+      if (g_cancellable_is_cancelled (cancellable))
+        break;
+
+      async_line_measure (batch, context,
+                          &g_array_index (batch->lines, AsyncLine, i));
+    }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+async_validation_merge (GtkTextLayout   *layout,
+                        AsyncValidation *batch)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextBTree *tree = _gtk_text_buffer_get_btree (layout->buffer);
+  GtkTextLine *line, *last_line, *changed_line = NULL;
+  gint y, old_height = 0, new_height = 0;
+  guint i = 0;
+
+  line = g_array_index (batch->lines, AsyncLine, 0).line;
+  last_line = g_array_index (batch->lines, AsyncLine, batch->lines->len - 1).line;
+
+  y = _gtk_text_btree_find_line_top (tree, line, layout);
+
+  /* The batch lines are in buffer order, but lines that could not be
+   * measured asynchronously may be in between; they keep their height.
+   */
+  while (TRUE)
+    {
+      GtkTextLineData *line_data = _gtk_text_line_get_data (line, layout);
+      AsyncLine *async_line = &g_array_index (batch->lines, AsyncLine, i);
+
+      old_height += line_data ? line_data->height : 0;
+
+      if (line == async_line->line)
+        {
+          /* Skip lines that were validated on the main thread meanwhile */
+          if (line_data == NULL || !line_data->valid)
+            {
+              if (changed_line && changed_line->parent != line->parent)
+                _gtk_text_btree_line_size_changed (tree, changed_line, layout);
+
+              if (line_data == NULL)
+                {
+                  line_data = _gtk_text_line_data_new (layout, line);
+                  _gtk_text_line_add_data (line, line_data);
+                }
+
+              line_data->width = async_line->width;
+              line_data->height = async_line->height;
+              line_data->top_ink = async_line->top_ink;
+              line_data->bottom_ink = async_line->bottom_ink;
+              line_data->valid = TRUE;
+              line_data->measured_async = TRUE;
+
+              priv->measured_height += line_data->height;
+              priv->n_measured_lines++;
+
+              changed_line = line;
+            }
+
+          i++;
+        }
+
+      new_height += line_data ? line_data->height : 0;
+
+      if (line == last_line)
+        break;
+
+      line = _gtk_text_line_next_excluding_last (line);
+    }
+
+  if (changed_line == NULL)
+    return;
+
+  _gtk_text_btree_line_size_changed (tree, changed_line, layout);
+
+  update_layout_size (layout);
+  gtk_text_layout_emit_changed (layout, y, old_height, new_height);
+}
+
+static void
+async_validation_done (GObject      *source_object,
+                       GAsyncResult *result,
+                       gpointer      user_data)
+{
+  GtkTextLayout *layout = GTK_TEXT_LAYOUT (source_object);
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  AsyncValidation *batch = user_data;
+  GtkTextBTree *tree;
+
+  g_task_propagate_boolean (G_TASK (result), NULL);
+
+  if (--batch->n_pending > 0)
+    return;
+
+  if (g_cancellable_is_cancelled (batch->cancellable))
+    {
+      async_validation_free (batch);
+      return;
+    }
+
+  g_assert (priv->async_batch == batch);
+  priv->async_batch = NULL;
+
+  tree = _gtk_text_buffer_get_btree (layout->buffer);
+
+  /* The line pointers in the batch are only safe to use if no
+   * lines have been added or removed in the meantime.
+   */
+  if (batch->chars_changed_stamp == _gtk_text_btree_get_chars_changed_stamp (tree) &&
+      batch->segments_changed_stamp == _gtk_text_btree_get_segments_changed_stamp (tree) &&
+      batch->generation == priv->generation)
+    async_validation_merge (layout, batch);
+
+  async_validation_free (batch);
+
+  /* Let the view continue validating */
+  if (!gtk_text_layout_is_valid (layout))
+    gtk_text_layout_invalidated (layout);
+}
+
+static void
+async_validation_start (GtkTextLayout *layout)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextBTree *tree;
+  AsyncValidation *batch;
+  GtkTextLine *line;
+  guint scanned, i;
+
+  if (priv->async_batch != NULL ||
+      layout->buffer == NULL ||
+      layout->default_style == NULL ||
+      layout->ltr_context == NULL ||
+      layout->wrap_loop_count > 0)
+    return;
+
+  /* Custom font maps can't be used from other threads */
+  if (pango_context_get_font_map (layout->ltr_context) != pango_cairo_font_map_get_default () ||
+      pango_context_get_font_map (layout->rtl_context) != pango_cairo_font_map_get_default ())
+    return;
+
+  tree = _gtk_text_buffer_get_btree (layout->buffer);
+  if (_gtk_text_btree_line_count (tree) < ASYNC_VALIDATION_MIN_LINES)
+    return;
+
+  line = _gtk_text_btree_find_first_invalid_line (tree, layout);
+  if (line == NULL)
+    return;
+
+  batch = g_slice_new0 (AsyncValidation);
+  batch->lines = g_array_new (FALSE, FALSE, sizeof (AsyncLine));
+  g_array_set_clear_func (batch->lines, async_line_clear);
+
+  for (scanned = 0;
+       line != NULL &&
+       scanned < ASYNC_VALIDATION_SCAN_LINES &&
+       batch->lines->len < ASYNC_VALIDATION_BATCH_LINES;
+       scanned++, line = _gtk_text_line_next_excluding_last (line))
+    {
+      GtkTextLineData *line_data = _gtk_text_line_get_data (line, layout);
+      AsyncLine async_line = { NULL, };
+
+      if (_gtk_text_line_is_last (line, tree))
+        break;
+
+      if (line_data && line_data->valid)
+        continue;
+
+      if (!line_is_async_measurable (layout, line))
+        continue;
+
+      async_line_init (&async_line, line);
+      g_array_append_val (batch->lines, async_line);
+    }
+
+  if (batch->lines->len == 0)
+    {
+      g_array_unref (batch->lines);
+      g_slice_free (AsyncValidation, batch);
+      return;
+    }
+
+  batch->cancellable = g_cancellable_new ();
+  batch->chars_changed_stamp = _gtk_text_btree_get_chars_changed_stamp (tree);
+  batch->segments_changed_stamp = _gtk_text_btree_get_segments_changed_stamp (tree);
+  batch->generation = priv->generation;
+
+  batch->style = gtk_text_attributes_copy (layout->default_style);
+  batch->font_desc = pango_font_description_copy (pango_context_get_font_description (layout->ltr_context));
+  batch->language = pango_context_get_language (layout->ltr_context);
+  if (pango_cairo_context_get_font_options (layout->ltr_context))
+    batch->font_options = cairo_font_options_copy (pango_cairo_context_get_font_options (layout->ltr_context));
+  batch->resolution = pango_cairo_context_get_resolution (layout->ltr_context);
+  if (pango_context_get_matrix (layout->ltr_context))
+    {
+      batch->matrix = *pango_context_get_matrix (layout->ltr_context);
+      batch->has_matrix = TRUE;
+    }
+  batch->h_padding = layout->left_padding + layout->right_padding;
+  batch->layout_width = layout->screen_width -
+                        batch->style->left_margin - batch->style->right_margin -
+                        batch->h_padding;
+
+  priv->async_batch = batch;
+
+  for (i = 0; i < batch->lines->len; i += ASYNC_VALIDATION_CHUNK_LINES)
+    {
+      AsyncValidationChunk *chunk;
+      GTask *task;
+
+      chunk = g_slice_new (AsyncValidationChunk);
+      chunk->batch = batch;
+      chunk->start = i;
+      chunk->end = MIN (i + ASYNC_VALIDATION_CHUNK_LINES, batch->lines->len);
+
+      task = g_task_new (layout, batch->cancellable, async_validation_done, batch);
+      g_task_set_task_data (task, chunk, async_validation_chunk_free);
+      g_task_set_return_on_cancel (task, FALSE);
+      g_task_run_in_thread (task, async_validation_thread);
+      g_object_unref (task);
+
+      batch->n_pending++;
+    }
+}
+
+/**
+ * gtk_text_layout_set_async_validation:
+ * @layout: a #GtkTextLayout
+ * @async_validation: whether to measure lines in worker threads
+ *
+ * Sets whether gtk_text_layout_validate() measures lines of large
+ * buffers in worker threads. In this mode, lines of large buffers that
+ * have not been measured yet get a height estimated from the average
+ * line height as soon as they are invalidated, so that the size of the
+ * layout is plausible before validation has finished.
+ */
+void
+gtk_text_layout_set_async_validation (GtkTextLayout *layout,
+                                      gboolean       async_validation)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  g_return_if_fail (GTK_IS_TEXT_LAYOUT (layout));
+
+  async_validation = async_validation != FALSE;
+
+  if (priv->async_validation == async_validation)
+    return;
+
+  priv->async_validation = async_validation;
+
+  if (!async_validation)
+    async_validation_cancel (layout);
+}
+
+/**
+ * gtk_text_layout_get_async_validation:
+ * @layout: a #GtkTextLayout
+ *
+ * Returns whether lines are measured in worker threads. See
+ * gtk_text_layout_set_async_validation().
+ *
+ * Returns: %TRUE if asynchronous validation is enabled
+ */
+gboolean
+gtk_text_layout_get_async_validation (GtkTextLayout *layout)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_LAYOUT (layout), FALSE);
+
+  return GTK_TEXT_LAYOUT_GET_PRIVATE (layout)->async_validation;
+}
+
+/**
+ * gtk_text_layout_is_validating_async:
+ * @layout: a #GtkTextLayout
+ *
+ * Returns whether worker threads are currently measuring lines.
+ * The ::invalidated signal is emitted when they are done and parts
+ * of the layout still need validation.
+ *
+ * Returns: %TRUE if lines are being measured asynchronously
+ */
+gboolean
+gtk_text_layout_is_validating_async (GtkTextLayout *layout)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_LAYOUT (layout), FALSE);
+
+  return GTK_TEXT_LAYOUT_GET_PRIVATE (layout)->async_batch != NULL;
 }
 
 static GtkTextLineData*
@@ -1167,6 +1980,7 @@ gtk_text_layout_real_wrap (GtkTextLayout   *layout,
                            /* may be NULL */
                            GtkTextLineData *line_data)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
   GtkTextLineDisplay *display;
   PangoRectangle ink_rect, logical_rect;
 
@@ -1183,6 +1997,11 @@ gtk_text_layout_real_wrap (GtkTextLayout   *layout,
   line_data->width = display->width;
   line_data->height = display->height;
   line_data->valid = TRUE;
+  line_data->measured_async = FALSE;
+
+  priv->measured_height += display->height;
+  priv->n_measured_lines++;
+
   pango_layout_get_pixel_extents (display->layout, &ink_rect, &logical_rect);
   line_data->top_ink = MAX (0, logical_rect.x - ink_rect.x);
   line_data->bottom_ink = MAX (0, logical_rect.x + logical_rect.width - ink_rect.x - ink_rect.width);
@@ -1323,42 +2142,47 @@ totally_invisible_line (GtkTextLayout *layout,
   return TRUE;
 }
 
-static void
-set_para_values (GtkTextLayout      *layout,
-                 PangoDirection      base_dir,
-                 GtkTextAttributes  *style,
-                 GtkTextLineDisplay *display)
+/* Returns the length of @text without its trailing paragraph delimiter */
+static gint
+strip_paragraph_delimiter (const gchar *text,
+                           gint         len)
 {
-  PangoAlignment pango_align = PANGO_ALIGN_LEFT;
-  PangoWrapMode pango_wrap = PANGO_WRAP_WORD;
-  gint h_margin;
-  gint h_padding;
+  /* Only one character has type G_UNICODE_PARAGRAPH_SEPARATOR in
+   * Unicode 3.0; update this if that changes.
+   */
+#define PARAGRAPH_SEPARATOR 0x2029
+  gunichar ch = 0;
 
-  switch (base_dir)
+  if (len > 0)
     {
-    /* If no base direction was found, then use the style direction */
-    case PANGO_DIRECTION_NEUTRAL :
-      display->direction = style->direction;
+      const char *prev = g_utf8_prev_char (text + len);
+      ch = g_utf8_get_char (prev);
+      if (ch == PARAGRAPH_SEPARATOR || ch == '\r' || ch == '\n')
+        len = prev - text; /* chop off */
 
-      /* Override the base direction */
-      if (display->direction == GTK_TEXT_DIR_RTL)
-        base_dir = PANGO_DIRECTION_RTL;
-      else
-        base_dir = PANGO_DIRECTION_LTR;
-      
-      break;
-    case PANGO_DIRECTION_RTL :
-      display->direction = GTK_TEXT_DIR_RTL;
-      break;
-    default:
-      display->direction = GTK_TEXT_DIR_LTR;
-      break;
+      if (ch == '\n' && len > 0)
+        {
+          /* Possibly chop a CR as well */
+          prev = g_utf8_prev_char (text + len);
+          if (*prev == '\r')
+            --len;
+        }
     }
-  
-  if (display->direction == GTK_TEXT_DIR_RTL)
-    display->layout = pango_layout_new (layout->rtl_context);
-  else
-    display->layout = pango_layout_new (layout->ltr_context);
+
+  return len;
+}
+
+/* Sets up the paragraph level properties of @pango_layout. This does
+ * not touch the GtkTextLayout, so it is also used by worker threads.
+ */
+static void
+set_para_layout_values (PangoLayout       *pango_layout,
+                        PangoDirection     base_dir,
+                        GtkTextAttributes *style,
+                        gint               layout_width)
+{
+  PangoAlignment pango_align = PANGO_ALIGN_LEFT;
+  PangoWrapMode pango_wrap = PANGO_WRAP_WORD;
 
   switch (style->justification)
     {
@@ -1373,29 +2197,21 @@ set_para_values (GtkTextLayout      *layout,
       break;
     case GTK_JUSTIFY_FILL:
       pango_align = (base_dir == PANGO_DIRECTION_LTR) ? PANGO_ALIGN_LEFT : PANGO_ALIGN_RIGHT;
-      pango_layout_set_justify (display->layout, TRUE);
+      pango_layout_set_justify (pango_layout, TRUE);
       break;
     default:
       g_assert_not_reached ();
       break;
     }
 
-  pango_layout_set_alignment (display->layout, pango_align);
-  pango_layout_set_spacing (display->layout,
+  pango_layout_set_alignment (pango_layout, pango_align);
+  pango_layout_set_spacing (pango_layout,
                             style->pixels_inside_wrap * PANGO_SCALE);
 
   if (style->tabs)
-    pango_layout_set_tabs (display->layout, style->tabs);
-
-  display->top_margin = style->pixels_above_lines;
-  display->height = style->pixels_above_lines + style->pixels_below_lines;
-  display->bottom_margin = style->pixels_below_lines;
-  display->left_margin = style->left_margin;
-  display->right_margin = style->right_margin;
-  
-  display->x_offset = display->left_margin;
+    pango_layout_set_tabs (pango_layout, style->tabs);
 
-  pango_layout_set_indent (display->layout,
+  pango_layout_set_indent (pango_layout,
                            style->indent * PANGO_SCALE);
 
   switch (style->wrap_mode)
@@ -1415,15 +2231,62 @@ set_para_values (GtkTextLayout      *layout,
       break;
     }
 
-  h_margin = display->left_margin + display->right_margin;
-  h_padding = layout->left_padding + layout->right_padding;
-
   if (style->wrap_mode != GTK_WRAP_NONE)
     {
-      int layout_width = (layout->screen_width - h_margin - h_padding);
-      pango_layout_set_width (display->layout, layout_width * PANGO_SCALE);
-      pango_layout_set_wrap (display->layout, pango_wrap);
+      pango_layout_set_width (pango_layout, layout_width * PANGO_SCALE);
+      pango_layout_set_wrap (pango_layout, pango_wrap);
     }
+}
+
+static void
+set_para_values (GtkTextLayout      *layout,
+                 PangoDirection      base_dir,
+                 GtkTextAttributes  *style,
+                 GtkTextLineDisplay *display)
+{
+  gint h_margin;
+  gint h_padding;
+
+  switch (base_dir)
+    {
+    /* If no base direction was found, then use the style direction */
+    case PANGO_DIRECTION_NEUTRAL :
+      display->direction = style->direction;
+
+      /* Override the base direction */
+      if (display->direction == GTK_TEXT_DIR_RTL)
+        base_dir = PANGO_DIRECTION_RTL;
+      else
+        base_dir = PANGO_DIRECTION_LTR;
+      
+      break;
+    case PANGO_DIRECTION_RTL :
+      display->direction = GTK_TEXT_DIR_RTL;
+      break;
+    default:
+      display->direction = GTK_TEXT_DIR_LTR;
+      break;
+    }
+  
+  if (display->direction == GTK_TEXT_DIR_RTL)
+    display->layout = pango_layout_new (layout->rtl_context);
+  else
+    display->layout = pango_layout_new (layout->ltr_context);
+
+  display->top_margin = style->pixels_above_lines;
+  display->height = style->pixels_above_lines + style->pixels_below_lines;
+  display->bottom_margin = style->pixels_below_lines;
+  display->left_margin = style->left_margin;
+  display->right_margin = style->right_margin;
+  
+  display->x_offset = display->left_margin;
+
+  h_margin = display->left_margin + display->right_margin;
+  h_padding = layout->left_padding + layout->right_padding;
+
+  set_para_layout_values (display->layout, base_dir, style,
+                          layout->screen_width - h_margin - h_padding);
+
   display->total_width = MAX (layout->screen_width, layout->width) - h_margin - h_padding;
   
 G_GNUC_BEGIN_IGNORE_DEPRECATIONS
@@ -2271,24 +3134,15 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   
   g_return_val_if_fail (line != NULL, NULL);
 
-  if (layout->one_display_cache)
+  display = line_display_cache_lookup (layout, line, size_only);
+  if (display)
     {
-      if (line == layout->one_display_cache->line &&
-          (size_only || !layout->one_display_cache->size_only))
-	{
-	  if (!size_only)
-            update_text_display_cursors (layout, line, layout->one_display_cache);
-	  return layout->one_display_cache;
-	}
-      else
-        {
-          GtkTextLineDisplay *tmp_display = layout->one_display_cache;
-          layout->one_display_cache = NULL;
-          gtk_text_layout_free_line_display (layout, tmp_display);
-        }
+      if (!size_only)
+        update_text_display_cursors (layout, line, display);
+      return display;
     }
 
-  DV (g_print ("creating one line display cache (%s)\n", G_STRLOC));
+  DV (g_print ("creating line display cache entry (%s)\n", G_STRLOC));
 
   display = g_slice_new0 (GtkTextLineDisplay);
 
@@ -2533,30 +3387,7 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
     }
   
   /* Pango doesn't want the trailing paragraph delimiters */
-
-  {
-    /* Only one character has type G_UNICODE_PARAGRAPH_SEPARATOR in
-     * Unicode 3.0; update this if that changes.
-     */
-#define PARAGRAPH_SEPARATOR 0x2029
-    gunichar ch = 0;
-
-    if (layout_byte_offset > 0)
-      {
-        const char *prev = g_utf8_prev_char (text + layout_byte_offset);
-        ch = g_utf8_get_char (prev);
-        if (ch == PARAGRAPH_SEPARATOR || ch == '\r' || ch == '\n')
-          layout_byte_offset = prev - text; /* chop off */
-
-        if (ch == '\n' && layout_byte_offset > 0)
-          {
-            /* Possibly chop a CR as well */
-            prev = g_utf8_prev_char (text + layout_byte_offset);
-            if (*prev == '\r')
-              --layout_byte_offset;
-          }
-      }
-  }
+  layout_byte_offset = strip_paragraph_delimiter (text, layout_byte_offset);
   
   pango_layout_set_text (display->layout, text, layout_byte_offset);
   pango_layout_set_attributes (display->layout, attrs);
@@ -2613,7 +3444,7 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   if (tags != NULL)
     g_ptr_array_free (tags, TRUE);
 
-  layout->one_display_cache = display;
+  line_display_cache_insert (layout, display);
 
   if (saw_widget)
     allocate_child_widgets (layout, display);
@@ -2625,7 +3456,7 @@ void
 gtk_text_layout_free_line_display (GtkTextLayout      *layout,
                                    GtkTextLineDisplay *display)
 {
-  if (display != layout->one_display_cache)
+  if (!line_display_is_cached (layout, display))
     {
       if (display->layout)
         g_object_unref (display->layout);
@@ -147,11 +147,6 @@ struct _GtkTextLayout
    * over long runs with the same style. */
   GtkTextAttributes *one_style_cache;
 
-  /* A cache of one line display. Getting the same line
-   * many times in a row is the most common case.
-   */
-  GtkTextLineDisplay *one_display_cache;
-
   /* Whether we are allowed to wrap right now */
   gint wrap_loop_count;
   
@@ -379,6 +374,14 @@ GDK_AVAILABLE_IN_ALL
 void     gtk_text_layout_validate        (GtkTextLayout *layout,
                                           gint           max_pixels);
 
+GDK_AVAILABLE_IN_ALL
+void     gtk_text_layout_set_async_validation (GtkTextLayout *layout,
+                                               gboolean       async_validation);
+GDK_AVAILABLE_IN_ALL
+gboolean gtk_text_layout_get_async_validation (GtkTextLayout *layout);
+GDK_AVAILABLE_IN_ALL
+gboolean gtk_text_layout_is_validating_async  (GtkTextLayout *layout);
+
 /* This function should return the passed-in line data,
  * OR remove the existing line data from the line, and
  * return a NEW line data after adding it to the line.
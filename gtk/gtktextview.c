@@ -4477,7 +4477,11 @@ incremental_validate_callback (gpointer data)
 
   gtk_text_view_update_adjustments (text_view);
   
-  if (gtk_text_layout_is_valid (text_view->priv->layout))
+  /* While lines are measured asynchronously, the layout emits
+   * ::invalidated again once it needs more validation.
+   */
+  if (gtk_text_layout_is_valid (text_view->priv->layout) ||
+      gtk_text_layout_is_validating_async (text_view->priv->layout))
     {
       text_view->priv->incremental_validate_idle = 0;
       result = FALSE;
@@ -7944,6 +7948,7 @@ gtk_text_view_ensure_layout (GtkTextView *text_view)
       DV(g_print(G_STRLOC"\n"));
       
       priv->layout = gtk_text_layout_new ();
+      gtk_text_layout_set_async_validation (priv->layout, TRUE);
 
       g_signal_connect (priv->layout,
 			"invalidated",
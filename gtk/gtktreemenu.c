@@ -105,6 +105,8 @@ static void       gtk_tree_menu_set_area                      (GtkTreeMenu
                                                                GtkCellArea          *area);
 static GtkWidget *gtk_tree_menu_get_path_item                 (GtkTreeMenu          *menu,
                                                                GtkTreePath          *path);
+static gboolean   gtk_tree_menu_shows_path                    (GtkTreeMenu          *menu,
+                                                               GtkTreePath          *path);
 static gboolean   gtk_tree_menu_path_in_menu                  (GtkTreeMenu          *menu,
                                                                GtkTreePath          *path,
                                                                gboolean             *header_item);
@@ -709,6 +711,52 @@ gtk_tree_menu_get_path_item (GtkTreeMenu          *menu,
   return item;
 }
 
+/* Unlike gtk_tree_menu_get_path_item(), only finds an item
+ * whose row is @search, not one whose row is gone
+ */
+static gboolean
+gtk_tree_menu_shows_path (GtkTreeMenu *menu,
+                          GtkTreePath *search)
+{
+  GList       *children, *l;
+  gboolean     found = FALSE;
+
+  children = gtk_container_get_children (GTK_CONTAINER (menu));
+
+  for (l = children; !found && l != NULL; l = l->next)
+    {
+      GtkWidget   *child = l->data;
+      GtkTreePath *path  = NULL;
+
+      if (GTK_IS_SEPARATOR_MENU_ITEM (child))
+        {
+          GtkTreeRowReference *row =
+            g_object_get_qdata (G_OBJECT (child), tree_menu_path_quark);
+
+          if (row)
+            path = gtk_tree_row_reference_get_path (row);
+        }
+      else
+        {
+          GtkWidget *view = gtk_bin_get_child (GTK_BIN (child));
+
+          /* It's always a cellview */
+          if (GTK_IS_CELL_VIEW (view))
+            path = gtk_cell_view_get_displayed_row (GTK_CELL_VIEW (view));
+        }
+
+      if (path)
+        {
+          found = gtk_tree_path_compare (search, path) == 0;
+          gtk_tree_path_free (path);
+        }
+    }
+
+  g_list_free (children);
+
+  return found;
+}
+
 static gboolean
 gtk_tree_menu_path_in_menu (GtkTreeMenu  *menu,
                             GtkTreePath  *path,
@@ -855,6 +903,13 @@ row_inserted_cb (GtkTreeModel     *model,
   /* If the iter should be in this menu then go ahead and insert it */
   if (gtk_tree_menu_path_in_menu (menu, path, NULL))
     {
+      /* When a run of rows is announced with ::rows-inserted, they are
+       * all in the model before the first one is announced, so a menu
+       * (re)built meanwhile shows the later ones already.
+       */
+      if (gtk_tree_menu_shows_path (menu, path))
+        return;
+
       if (priv->wrap_width > 0)
         rebuild_menu (menu);
       else
@@ -240,6 +240,8 @@
     }G_STMT_END
 
 #define ROW_REF_DATA_STRING "gtk-tree-row-refs"
+/* The path the default rows-inserted handler emits row-inserted for */
+#define ROWS_INSERTED_PATH_STRING "gtk-tree-model-rows-inserted-path"
 
 enum {
   ROW_CHANGED,
@@ -247,6 +249,7 @@ enum {
   ROW_HAS_CHILD_TOGGLED,
   ROW_DELETED,
   ROWS_REORDERED,
+  ROWS_INSERTED,
   LAST_SIGNAL
 };
 
@@ -286,9 +289,14 @@ static void      rows_reordered_marshal     (GClosure          *closure,
                                              gpointer           invocation_hint,
                                              gpointer           marshal_data);
 
+static void      gtk_tree_model_real_rows_inserted (GtkTreeModel *tree_model,
+                                                    GtkTreePath  *path,
+                                                    GtkTreeIter  *iter,
+                                                    gint          n_rows);
+
 static void      gtk_tree_row_ref_inserted  (RowRefList        *refs,
                                              GtkTreePath       *path,
-                                             GtkTreeIter       *iter);
+                                             gint               n_rows);
 static void      gtk_tree_row_ref_deleted   (RowRefList        *refs,
                                              GtkTreePath       *path);
 static void      gtk_tree_row_ref_reordered (RowRefList        *refs,
@@ -337,6 +345,7 @@ gtk_tree_model_base_init (gpointer g_class)
       GType row_inserted_params[2];
       GType row_deleted_params[1];
       GType rows_reordered_params[3];
+      GType rows_inserted_params[3];
 
       row_inserted_params[0] = GTK_TYPE_TREE_PATH | G_SIGNAL_TYPE_STATIC_SCOPE;
       row_inserted_params[1] = GTK_TYPE_TREE_ITER;
@@ -347,6 +356,10 @@ gtk_tree_model_base_init (gpointer g_class)
       rows_reordered_params[1] = GTK_TYPE_TREE_ITER;
       rows_reordered_params[2] = G_TYPE_POINTER;
 
+      rows_inserted_params[0] = GTK_TYPE_TREE_PATH | G_SIGNAL_TYPE_STATIC_SCOPE;
+      rows_inserted_params[1] = GTK_TYPE_TREE_ITER;
+      rows_inserted_params[2] = G_TYPE_INT;
+
       /**
        * GtkTreeModel::row-changed:
        * @tree_model: the #GtkTreeModel on which the signal is emitted
@@ -479,10 +492,86 @@ gtk_tree_model_base_init (gpointer g_class)
                        _gtk_marshal_VOID__BOXED_BOXED_POINTER,
                        G_TYPE_NONE, 3,
                        rows_reordered_params);
+
+      /**
+       * GtkTreeModel::rows-inserted:
+       * @tree_model: the #GtkTreeModel on which the signal is emitted
+       * @path: a #GtkTreePath-struct identifying the first new row
+       * @iter: a valid #GtkTreeIter-struct pointing to the first new row
+       * @n_rows: the number of consecutive rows that were inserted
+       *
+       * This signal is emitted when @n_rows consecutive sibling rows
+       * have been inserted in the model at once.
+       *
+       * The default handler emits #GtkTreeModel::row-inserted for each
+       * of the new rows, in order. Unlike with rows inserted one at a
+       * time, all of the new rows are already in the model during those
+       * emissions: a handler of #GtkTreeModel::row-inserted that reads
+       * the model beyond the row it is told about, for example to build
+       * a list of the children of the new row's parent, will see rows
+       * that have not been announced yet, and must not add them again
+       * when they are. Row references already point to the rows'
+       * final positions when this signal is emitted.
+       *
+       * Views that can add all rows in one go can connect to this
+       * signal, and ignore #GtkTreeModel::row-inserted until the
+       * default handler has run.
+       *
+       * Since: 3.90
+       */
+      closure = g_cclosure_new (G_CALLBACK (gtk_tree_model_real_rows_inserted), NULL, NULL);
+      tree_model_signals[ROWS_INSERTED] =
+        g_signal_newv (I_("rows-inserted"),
+                       GTK_TYPE_TREE_MODEL,
+                       G_SIGNAL_RUN_LAST,
+                       closure,
+                       NULL, NULL,
+                       _gtk_marshal_VOID__BOXED_BOXED_INT,
+                       G_TYPE_NONE, 3,
+                       rows_inserted_params);
+
       initialized = TRUE;
     }
 }
 
+static void
+gtk_tree_model_real_rows_inserted (GtkTreeModel *tree_model,
+                                   GtkTreePath  *path,
+                                   GtkTreeIter  *iter,
+                                   gint          n_rows)
+{
+  GtkTreePath *row_path;
+  GtkTreeIter row_iter;
+  gpointer outer_path;
+  gint i;
+
+  row_path = gtk_tree_path_copy (path);
+  row_iter = *iter;
+
+  /* gtk_tree_model_rows_inserted() moved the row references for
+   * all of the rows already, tell row_inserted_marshal() not to
+   * move them again.
+   */
+  outer_path = g_object_get_data (G_OBJECT (tree_model), ROWS_INSERTED_PATH_STRING);
+  g_object_set_data (G_OBJECT (tree_model), ROWS_INSERTED_PATH_STRING, row_path);
+
+  for (i = 0; i < n_rows; i++)
+    {
+      if (i > 0)
+        {
+          gtk_tree_path_next (row_path);
+          if (!gtk_tree_model_iter_next (tree_model, &row_iter))
+            break;
+        }
+
+      g_signal_emit (tree_model, tree_model_signals[ROW_INSERTED], 0, row_path, &row_iter);
+    }
+
+  g_object_set_data (G_OBJECT (tree_model), ROWS_INSERTED_PATH_STRING, outer_path);
+
+  gtk_tree_path_free (row_path);
+}
+
 static void
 row_inserted_marshal (GClosure          *closure,
                       GValue /* out */  *return_value,
@@ -501,9 +590,12 @@ row_inserted_marshal (GClosure          *closure,
   GtkTreePath *path = (GtkTreePath *)g_value_get_boxed (param_values + 1);
   GtkTreeIter *iter = (GtkTreeIter *)g_value_get_boxed (param_values + 2);
 
-  /* first, we need to update internal row references */
-  gtk_tree_row_ref_inserted ((RowRefList *)g_object_get_data (model, ROW_REF_DATA_STRING),
-                             path, iter);
+  /* first, we need to update internal row references, unless
+   * gtk_tree_model_rows_inserted() did already
+   */
+  if (path != g_object_get_data (model, ROWS_INSERTED_PATH_STRING))
+    gtk_tree_row_ref_inserted ((RowRefList *)g_object_get_data (model, ROW_REF_DATA_STRING),
+                               path, 1);
 
   /* fetch the interface ->row_inserted implementation */
   iface = GTK_TREE_MODEL_GET_IFACE (model);
@@ -1855,6 +1947,47 @@ gtk_tree_model_row_inserted (GtkTreeModel *tree_model,
   g_signal_emit (tree_model, tree_model_signals[ROW_INSERTED], 0, path, iter);
 }
 
+/**
+ * gtk_tree_model_rows_inserted:
+ * @tree_model: a #GtkTreeModel
+ * @path: a #GtkTreePath-struct pointing to the first inserted row
+ * @iter: a valid #GtkTreeIter-struct pointing to the first inserted row
+ * @n_rows: the number of consecutive sibling rows that were inserted
+ *
+ * Emits the #GtkTreeModel::rows-inserted signal on @tree_model.
+ *
+ * Models can call this instead of gtk_tree_model_row_inserted()
+ * after inserting several consecutive rows at once. All rows must
+ * have been inserted before calling this. See
+ * #GtkTreeModel::rows-inserted for what handlers of
+ * #GtkTreeModel::row-inserted see then.
+ *
+ * Since: 3.90
+ */
+void
+gtk_tree_model_rows_inserted (GtkTreeModel *tree_model,
+                              GtkTreePath  *path,
+                              GtkTreeIter  *iter,
+                              gint          n_rows)
+{
+  g_return_if_fail (GTK_IS_TREE_MODEL (tree_model));
+  g_return_if_fail (path != NULL);
+  g_return_if_fail (iter != NULL);
+  g_return_if_fail (n_rows >= 0);
+
+  if (n_rows == 0)
+    return;
+
+  /* Row references are moved for all of the rows before any handler
+   * runs, so references made meanwhile are not moved again by the
+   * row-inserted emissions of the default handler.
+   */
+  gtk_tree_row_ref_inserted ((RowRefList *)g_object_get_data (G_OBJECT (tree_model), ROW_REF_DATA_STRING),
+                             path, n_rows);
+
+  g_signal_emit (tree_model, tree_model_signals[ROWS_INSERTED], 0, path, iter, n_rows);
+}
+
 /**
  * gtk_tree_model_row_has_child_toggled:
  * @tree_model: a #GtkTreeModel
@@ -2086,7 +2219,7 @@ release_row_references (gpointer data)
 static void
 gtk_tree_row_ref_inserted (RowRefList  *refs,
                            GtkTreePath *path,
-                           GtkTreeIter *iter)
+                           gint         n_rows)
 {
   GSList *tmp_list;
 
@@ -2128,7 +2261,7 @@ gtk_tree_row_ref_inserted (RowRefList  *refs,
             goto done;
 
           if (path->indices[path->depth-1] <= reference->path->indices[path->depth-1])
-            reference->path->indices[path->depth-1] += 1;
+            reference->path->indices[path->depth-1] += n_rows;
         }
     done:
       tmp_list = tmp_list->next;
@@ -2531,7 +2664,7 @@ gtk_tree_row_reference_inserted (GObject     *proxy,
 {
   g_return_if_fail (G_IS_OBJECT (proxy));
 
-  gtk_tree_row_ref_inserted ((RowRefList *)g_object_get_data (proxy, ROW_REF_DATA_STRING), path, NULL);
+  gtk_tree_row_ref_inserted ((RowRefList *)g_object_get_data (proxy, ROW_REF_DATA_STRING), path, 1);
 }
 
 /**
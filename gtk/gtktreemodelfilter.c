@@ -18,6 +18,7 @@
 
 #include "config.h"
 #include "gtktreemodelfilter.h"
+#include "gtkcolumnstoreprivate.h"
 #include "gtkintl.h"
 #include "gtktreednd.h"
 #include "gtkprivate.h"
@@ -287,10 +288,13 @@ struct _GtkTreeModelFilterPrivate
 
   guint in_row_deleted       : 1;
   guint virtual_root_deleted : 1;
+  guint in_rows_inserted     : 1;
 
   /* signal ids */
   gulong changed_id;
   gulong inserted_id;
+  gulong rows_inserted_id;
+  gulong rows_inserted_after_id;
   gulong has_child_toggled_id;
   gulong deleted_id;
   gulong reordered_id;
@@ -347,6 +351,16 @@ static void         gtk_tree_model_filter_row_inserted                    (GtkTr
                                                                            GtkTreePath            *c_path,
                                                                            GtkTreeIter            *c_iter,
                                                                            gpointer                data);
+static void         gtk_tree_model_filter_rows_inserted                   (GtkTreeModel           *c_model,
+                                                                           GtkTreePath            *c_path,
+                                                                           GtkTreeIter            *c_iter,
+                                                                           gint                    n_rows,
+                                                                           gpointer                data);
+static void         gtk_tree_model_filter_rows_inserted_after             (GtkTreeModel           *c_model,
+                                                                           GtkTreePath            *c_path,
+                                                                           GtkTreeIter            *c_iter,
+                                                                           gint                    n_rows,
+                                                                           gpointer                data);
 static void         gtk_tree_model_filter_row_has_child_toggled           (GtkTreeModel           *c_model,
                                                                            GtkTreePath            *c_path,
                                                                            GtkTreeIter            *c_iter,
@@ -1251,6 +1265,13 @@ gtk_tree_model_filter_real_visible (GtkTreeModelFilter *filter,
    {
      GValue val = G_VALUE_INIT;
 
+     /* Column stores let us read the boolean without a GValue */
+     if (GTK_IS_COLUMN_STORE (child_model) &&
+         gtk_tree_model_get_column_type (child_model, filter->priv->visible_column) == G_TYPE_BOOLEAN)
+       return _gtk_column_store_get_boolean (GTK_COLUMN_STORE (child_model),
+                                             child_iter,
+                                             filter->priv->visible_column);
+
      gtk_tree_model_get_value (child_model, child_iter,
                                filter->priv->visible_column, &val);
 
@@ -2290,6 +2311,79 @@ done:
     gtk_tree_path_free (c_path);
 }
 
+/* The default handler of rows-inserted emits row-inserted for each
+ * new row, after all of them have been added to the child model. That
+ * is fine while the level of the rows exists: each emission moves the
+ * following elts up by one, as if the rows were inserted one by one.
+ * But if the level has to be built, building it reads all new rows at
+ * once, and the remaining emissions would add them a second time. In
+ * that case, we handle the first row and ignore the others.
+ */
+static void
+gtk_tree_model_filter_rows_inserted (GtkTreeModel *c_model,
+                                     GtkTreePath  *c_path,
+                                     GtkTreeIter  *c_iter,
+                                     gint          n_rows,
+                                     gpointer      data)
+{
+  GtkTreeModelFilter *filter = GTK_TREE_MODEL_FILTER (data);
+  GtkTreePath *real_path;
+  FilterLevel *parent_level;
+  FilterLevel *level;
+  FilterElt *elt;
+
+  if (filter->priv->virtual_root)
+    {
+      /* Rows that are not ours only move the virtual root,
+       * which needs every emission
+       */
+      real_path = gtk_tree_model_filter_remove_root (c_path,
+                                                     filter->priv->virtual_root);
+      if (!real_path)
+        return;
+    }
+  else
+    real_path = gtk_tree_path_copy (c_path);
+
+  if (gtk_tree_path_get_depth (real_path) - 1 >= 1)
+    {
+      gtk_tree_path_up (real_path);
+
+      if (find_elt_with_offset (filter, real_path, &parent_level, &elt))
+        level = elt->children;
+      else
+        level = NULL;
+    }
+  else
+    level = FILTER_LEVEL (filter->priv->root);
+
+  gtk_tree_path_free (real_path);
+
+  if (level)
+    return;
+
+  gtk_tree_model_filter_row_inserted (c_model, c_path, c_iter, data);
+
+  filter->priv->in_rows_inserted = TRUE;
+  g_signal_handler_block (c_model, filter->priv->inserted_id);
+}
+
+static void
+gtk_tree_model_filter_rows_inserted_after (GtkTreeModel *c_model,
+                                           GtkTreePath  *c_path,
+                                           GtkTreeIter  *c_iter,
+                                           gint          n_rows,
+                                           gpointer      data)
+{
+  GtkTreeModelFilter *filter = GTK_TREE_MODEL_FILTER (data);
+
+  if (!filter->priv->in_rows_inserted)
+    return;
+
+  filter->priv->in_rows_inserted = FALSE;
+  g_signal_handler_unblock (c_model, filter->priv->inserted_id);
+}
+
 static void
 gtk_tree_model_filter_row_has_child_toggled (GtkTreeModel *c_model,
                                              GtkTreePath  *c_path,
@@ -3639,6 +3733,10 @@ gtk_tree_model_filter_set_model (GtkTreeModelFilter *filter,
                                    filter->priv->changed_id);
       g_signal_handler_disconnect (filter->priv->child_model,
                                    filter->priv->inserted_id);
+      g_signal_handler_disconnect (filter->priv->child_model,
+                                   filter->priv->rows_inserted_id);
+      g_signal_handler_disconnect (filter->priv->child_model,
+                                   filter->priv->rows_inserted_after_id);
       g_signal_handler_disconnect (filter->priv->child_model,
                                    filter->priv->has_child_toggled_id);
       g_signal_handler_disconnect (filter->priv->child_model,
@@ -3671,6 +3769,14 @@ gtk_tree_model_filter_set_model (GtkTreeModelFilter *filter,
         g_signal_connect (child_model, "row-inserted",
                           G_CALLBACK (gtk_tree_model_filter_row_inserted),
                           filter);
+      filter->priv->rows_inserted_id =
+        g_signal_connect (child_model, "rows-inserted",
+                          G_CALLBACK (gtk_tree_model_filter_rows_inserted),
+                          filter);
+      filter->priv->rows_inserted_after_id =
+        g_signal_connect_after (child_model, "rows-inserted",
+                                G_CALLBACK (gtk_tree_model_filter_rows_inserted_after),
+                                filter);
       filter->priv->has_child_toggled_id =
         g_signal_connect (child_model, "row-has-child-toggled",
                           G_CALLBACK (gtk_tree_model_filter_row_has_child_toggled),
@@ -4266,6 +4372,355 @@ gtk_tree_model_filter_refilter (GtkTreeModelFilter *filter)
                           filter);
 }
 
+/* Batched refiltering of flat models.  Visibility is evaluated for all
+ * rows up front into a bitset (possibly on worker threads), which is then
+ * diffed against the current state so that only rows whose visibility
+ * actually changed are touched.
+ */
+#define REFILTER_PARALLEL_THRESHOLD 4096
+#define REFILTER_MAX_THREADS 8
+
+#define BITSET_GET(bits,i) (((bits)[(i) / 32] >> ((i) % 32)) & 1)
+#define BITSET_SET(bits,i) ((bits)[(i) / 32] |= 1u << ((i) % 32))
+
+typedef struct
+{
+  GtkTreeModelFilter *filter;
+  GtkTreeIter *iters;
+  guint32 *visible;
+  guint start;
+  guint end;
+
+  GMutex *mutex;
+  GCond *cond;
+  guint *n_pending;
+} RefilterChunk;
+
+static void
+refilter_chunk_evaluate (RefilterChunk *chunk)
+{
+  guint i;
+
+  for (i = chunk->start; i < chunk->end; i++)
+    if (gtk_tree_model_filter_visible (chunk->filter, &chunk->iters[i]))
+      BITSET_SET (chunk->visible, i);
+}
+
+static void
+refilter_chunk_func (gpointer data,
+                     gpointer user_data)
+{
+  RefilterChunk *chunk = data;
+
+  refilter_chunk_evaluate (chunk);
+
+  g_mutex_lock (chunk->mutex);
+  (*chunk->n_pending)--;
+  g_cond_signal (chunk->cond);
+  g_mutex_unlock (chunk->mutex);
+}
+
+static GThreadPool *
+get_refilter_pool (void)
+{
+  static GThreadPool *pool = NULL;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *new_pool;
+
+      new_pool = g_thread_pool_new (refilter_chunk_func, NULL,
+                                    REFILTER_MAX_THREADS, FALSE, NULL);
+      g_once_init_leave (&pool, new_pool);
+    }
+
+  return pool;
+}
+
+/* Returns a newly allocated bitset with one bit per entry of @iters */
+static guint32 *
+gtk_tree_model_filter_evaluate_visible (GtkTreeModelFilter *filter,
+                                        GtkTreeIter        *iters,
+                                        guint               n_iters,
+                                        gboolean            thread_safe)
+{
+  RefilterChunk *chunks;
+  GMutex mutex;
+  GCond cond;
+  guint32 *visible;
+  guint n_threads, n_chunks, chunk_size, n_pending, i;
+
+  visible = g_new0 (guint32, (n_iters + 31) / 32);
+
+  n_threads = MIN (g_get_num_processors (), REFILTER_MAX_THREADS);
+
+  if (!thread_safe || n_threads < 2 || n_iters < REFILTER_PARALLEL_THRESHOLD)
+    {
+      RefilterChunk chunk;
+
+      chunk.filter = filter;
+      chunk.iters = iters;
+      chunk.visible = visible;
+      chunk.start = 0;
+      chunk.end = n_iters;
+
+      refilter_chunk_evaluate (&chunk);
+      return visible;
+    }
+
+  /* Chunks are multiples of 32 rows, so no two threads write to the
+   * same word of the bitset.
+   */
+  chunk_size = ((n_iters + n_threads - 1) / n_threads + 31) & ~31u;
+  n_chunks = (n_iters + chunk_size - 1) / chunk_size;
+  chunks = g_new (RefilterChunk, n_chunks);
+
+  g_mutex_init (&mutex);
+  g_cond_init (&cond);
+  n_pending = n_chunks - 1;
+
+  for (i = 0; i < n_chunks; i++)
+    {
+      chunks[i].filter = filter;
+      chunks[i].iters = iters;
+      chunks[i].visible = visible;
+      chunks[i].start = i * chunk_size;
+      chunks[i].end = MIN (n_iters, (i + 1) * chunk_size);
+      chunks[i].mutex = &mutex;
+      chunks[i].cond = &cond;
+      chunks[i].n_pending = &n_pending;
+    }
+
+  /* The calling thread evaluates the first chunk itself */
+  for (i = 1; i < n_chunks; i++)
+    g_thread_pool_push (get_refilter_pool (), &chunks[i], NULL);
+
+  refilter_chunk_evaluate (&chunks[0]);
+
+  g_mutex_lock (&mutex);
+  while (n_pending > 0)
+    g_cond_wait (&cond, &mutex);
+  g_mutex_unlock (&mutex);
+
+  g_mutex_clear (&mutex);
+  g_cond_clear (&cond);
+  g_free (chunks);
+
+  return visible;
+}
+
+static FilterElt *
+gtk_tree_model_filter_show_elt_at_offset (GtkTreeModelFilter *filter,
+                                          FilterLevel        *level,
+                                          GtkTreeIter        *c_iter,
+                                          gint                offset)
+{
+  FilterElt *elt;
+  gint index;
+
+  elt = lookup_elt_with_offset (level->seq, offset, NULL);
+  if (!elt)
+    elt = gtk_tree_model_filter_insert_elt_in_level (filter, c_iter, level,
+                                                     offset, &index);
+
+  elt->visible_siter = g_sequence_insert_sorted (level->visible_seq, elt,
+                                                 filter_elt_cmp, NULL);
+
+  return elt;
+}
+
+/**
+ * gtk_tree_model_filter_refilter_with_flags:
+ * @filter: A #GtkTreeModelFilter.
+ * @flags: flags describing how the filter criteria changed
+ *
+ * Re-evaluates the visibility of the rows in the child model, like
+ * gtk_tree_model_filter_refilter().
+ *
+ * For flat child models (with the %GTK_TREE_MODEL_LIST_ONLY flag),
+ * visibility is evaluated for all rows in one pass and only rows whose
+ * visibility changed are inserted or deleted; no ::row-changed signals
+ * are emitted for rows that stay visible.  Rows that become visible next
+ * to each other are announced together with ::rows-inserted.  With
+ * %GTK_TREE_MODEL_FILTER_REFILTER_STRICTER, only the currently visible
+ * rows are evaluated, which makes narrowing down a search as it is typed
+ * proportional to the number of remaining rows.  With
+ * %GTK_TREE_MODEL_FILTER_REFILTER_THREAD_SAFE, large models are evaluated
+ * on several threads.
+ *
+ * For other child models, this is equivalent to
+ * gtk_tree_model_filter_refilter().
+ *
+ * Since: 3.90
+ */
+void
+gtk_tree_model_filter_refilter_with_flags (GtkTreeModelFilter              *filter,
+                                           GtkTreeModelFilterRefilterFlags  flags)
+{
+  GtkTreeModelFilterPrivate *priv;
+  FilterLevel *level;
+  FilterElt **elts = NULL;
+  GtkTreeIter *iters;
+  GSequenceIter *siter;
+  GPtrArray *to_hide;
+  GArray *to_show, *run_lengths;
+  gboolean new_run;
+  guint32 *visible;
+  guint n_iters, i, j;
+
+  g_return_if_fail (GTK_IS_TREE_MODEL_FILTER (filter));
+
+  priv = filter->priv;
+  level = FILTER_LEVEL (priv->root);
+
+  if (level == NULL || priv->virtual_root != NULL ||
+      !(gtk_tree_model_get_flags (priv->child_model) & GTK_TREE_MODEL_LIST_ONLY))
+    {
+      gtk_tree_model_filter_refilter (filter);
+      return;
+    }
+
+  /* Collect the child iters of the rows to evaluate */
+  if (flags & GTK_TREE_MODEL_FILTER_REFILTER_STRICTER)
+    {
+      n_iters = g_sequence_get_length (level->visible_seq);
+      iters = g_new (GtkTreeIter, n_iters);
+      elts = g_new (FilterElt *, n_iters);
+
+      siter = g_sequence_get_begin_iter (level->visible_seq);
+      for (i = 0; i < n_iters; i++, siter = g_sequence_iter_next (siter))
+        {
+          elts[i] = g_sequence_get (siter);
+
+          if (GTK_TREE_MODEL_FILTER_CACHE_CHILD_ITERS (filter))
+            iters[i] = elts[i]->iter;
+          else
+            gtk_tree_model_iter_nth_child (priv->child_model, &iters[i],
+                                           NULL, elts[i]->offset);
+        }
+    }
+  else
+    {
+      GtkTreeIter c_iter;
+
+      n_iters = gtk_tree_model_iter_n_children (priv->child_model, NULL);
+      iters = g_new (GtkTreeIter, n_iters);
+
+      i = 0;
+      if (gtk_tree_model_get_iter_first (priv->child_model, &c_iter))
+        {
+          do
+            iters[i++] = c_iter;
+          while (i < n_iters &&
+                 gtk_tree_model_iter_next (priv->child_model, &c_iter));
+        }
+
+      n_iters = i;
+    }
+
+  visible = gtk_tree_model_filter_evaluate_visible (filter, iters, n_iters,
+                                                    (flags & GTK_TREE_MODEL_FILTER_REFILTER_THREAD_SAFE) != 0);
+
+  /* Diff against the current state before changing anything, since the
+   * sequences are modified while the changes are applied.
+   */
+  to_hide = g_ptr_array_new ();
+  to_show = g_array_new (FALSE, FALSE, sizeof (guint));
+  run_lengths = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  if (elts)
+    {
+      for (i = 0; i < n_iters; i++)
+        if (!BITSET_GET (visible, i))
+          g_ptr_array_add (to_hide, elts[i]);
+    }
+  else
+    {
+      /* Rows to show are consecutive in the filter unless a row that
+       * stays visible is between them.
+       */
+      new_run = TRUE;
+      siter = g_sequence_get_begin_iter (level->visible_seq);
+      for (i = 0; i < n_iters; i++)
+        {
+          FilterElt *elt = NULL;
+          gboolean shown = FALSE;
+
+          if (!g_sequence_iter_is_end (siter))
+            elt = GET_ELT (siter);
+
+          if (elt && elt->offset == (gint) i)
+            {
+              shown = TRUE;
+              siter = g_sequence_iter_next (siter);
+            }
+
+          if (shown && !BITSET_GET (visible, i))
+            g_ptr_array_add (to_hide, elt);
+          else if (shown)
+            new_run = TRUE;
+          else if (BITSET_GET (visible, i))
+            {
+              g_array_append_val (to_show, i);
+
+              if (new_run)
+                {
+                  j = 0;
+                  g_array_append_val (run_lengths, j);
+                  new_run = FALSE;
+                }
+              g_array_index (run_lengths, guint, run_lengths->len - 1)++;
+            }
+        }
+    }
+
+  for (i = 0; i < to_hide->len; i++)
+    gtk_tree_model_filter_remove_elt_from_level (filter, level,
+                                                 g_ptr_array_index (to_hide, i));
+
+  if (to_show->len > 0)
+    {
+      GtkTreeIter iter;
+      GtkTreePath *path;
+      FilterElt *elt;
+      guint run, n_run, offset;
+
+      gtk_tree_model_filter_increment_stamp (filter);
+
+      /* All rows of a run are in the level before it is announced */
+      for (run = 0, i = 0; run < run_lengths->len; run++)
+        {
+          n_run = g_array_index (run_lengths, guint, run);
+
+          offset = g_array_index (to_show, guint, i);
+          elt = gtk_tree_model_filter_show_elt_at_offset (filter, level,
+                                                          &iters[offset], offset);
+          for (j = 1; j < n_run; j++)
+            {
+              offset = g_array_index (to_show, guint, i + j);
+              gtk_tree_model_filter_show_elt_at_offset (filter, level,
+                                                        &iters[offset], offset);
+            }
+          i += n_run;
+
+          iter.stamp = priv->stamp;
+          iter.user_data = level;
+          iter.user_data2 = elt;
+
+          path = gtk_tree_model_get_path (GTK_TREE_MODEL (filter), &iter);
+          gtk_tree_model_rows_inserted (GTK_TREE_MODEL (filter), path, &iter, n_run);
+          gtk_tree_path_free (path);
+        }
+    }
+
+  g_array_free (run_lengths, TRUE);
+  g_array_free (to_show, TRUE);
+  g_ptr_array_free (to_hide, TRUE);
+  g_free (visible);
+  g_free (elts);
+  g_free (iters);
+}
+
 /**
  * gtk_tree_model_filter_clear_cache:
  * @filter: A #GtkTreeModelFilter.
@@ -72,6 +72,28 @@ typedef void (* GtkTreeModelFilterModifyFunc) (GtkTreeModel *model,
                                                gint          column,
                                                gpointer      data);
 
+/**
+ * GtkTreeModelFilterRefilterFlags:
+ * @GTK_TREE_MODEL_FILTER_REFILTER_NONE: No flags; every row of the child
+ *   model is re-evaluated
+ * @GTK_TREE_MODEL_FILTER_REFILTER_STRICTER: The filter criteria only got
+ *   stricter, so rows that are hidden stay hidden and only the currently
+ *   visible rows need to be re-evaluated
+ * @GTK_TREE_MODEL_FILTER_REFILTER_THREAD_SAFE: The visible function (or
+ *   the visible column lookup) and the read-only methods of the child
+ *   model may be called from worker threads while the refilter is running
+ *
+ * Flags passed to gtk_tree_model_filter_refilter_with_flags().
+ *
+ * Since: 3.90
+ */
+typedef enum
+{
+  GTK_TREE_MODEL_FILTER_REFILTER_NONE        = 0,
+  GTK_TREE_MODEL_FILTER_REFILTER_STRICTER    = 1 << 0,
+  GTK_TREE_MODEL_FILTER_REFILTER_THREAD_SAFE = 1 << 1
+} GtkTreeModelFilterRefilterFlags;
+
 typedef struct _GtkTreeModelFilter          GtkTreeModelFilter;
 typedef struct _GtkTreeModelFilterClass     GtkTreeModelFilterClass;
 typedef struct _GtkTreeModelFilterPrivate   GtkTreeModelFilterPrivate;
@@ -148,6 +170,9 @@ GtkTreePath  *gtk_tree_model_filter_convert_path_to_child_path (GtkTreeModelFilt
 /* extras */
 GDK_AVAILABLE_IN_ALL
 void          gtk_tree_model_filter_refilter                   (GtkTreeModelFilter           *filter);
+GDK_AVAILABLE_IN_3_90
+void          gtk_tree_model_filter_refilter_with_flags        (GtkTreeModelFilter             *filter,
+                                                                GtkTreeModelFilterRefilterFlags flags);
 GDK_AVAILABLE_IN_ALL
 void          gtk_tree_model_filter_clear_cache                (GtkTreeModelFilter           *filter);
 
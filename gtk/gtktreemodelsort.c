@@ -273,9 +273,13 @@ struct _GtkTreeModelSortPrivate
   gpointer default_sort_data;
   GDestroyNotify default_sort_destroy;
 
+  guint in_rows_inserted : 1;
+
   /* signal ids */
   gulong changed_id;
   gulong inserted_id;
+  gulong rows_inserted_id;
+  gulong rows_inserted_after_id;
   gulong has_child_toggled_id;
   gulong deleted_id;
   gulong reordered_id;
@@ -327,6 +331,16 @@ static void gtk_tree_model_sort_row_inserted          (GtkTreeModel          *mo
 						       GtkTreePath           *path,
 						       GtkTreeIter           *iter,
 						       gpointer               data);
+static void gtk_tree_model_sort_rows_inserted         (GtkTreeModel          *model,
+						       GtkTreePath           *path,
+						       GtkTreeIter           *iter,
+						       gint                   n_rows,
+						       gpointer               data);
+static void gtk_tree_model_sort_rows_inserted_after   (GtkTreeModel          *model,
+						       GtkTreePath           *path,
+						       GtkTreeIter           *iter,
+						       gint                   n_rows,
+						       gpointer               data);
 static void gtk_tree_model_sort_row_has_child_toggled (GtkTreeModel          *model,
 						       GtkTreePath           *path,
 						       GtkTreeIter           *iter,
@@ -995,6 +1009,72 @@ gtk_tree_model_sort_row_inserted (GtkTreeModel          *s_model,
   return;
 }
 
+/* The default handler of rows-inserted emits row-inserted for each
+ * new row, after all of them have been added to the child model. That
+ * works like inserting the rows one by one, unless the root level has
+ * to be built: building it reads all new rows at once, so we announce
+ * them and ignore the row-inserted emissions.
+ */
+static void
+gtk_tree_model_sort_rows_inserted (GtkTreeModel *s_model,
+				   GtkTreePath  *s_path,
+				   GtkTreeIter  *s_iter,
+				   gint          n_rows,
+				   gpointer      data)
+{
+  GtkTreeModelSort *tree_model_sort = GTK_TREE_MODEL_SORT (data);
+  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
+  GtkTreePath *row_s_path;
+  GtkTreePath *path;
+  GtkTreeIter iter;
+  gint i;
+
+  if (priv->root)
+    return;
+
+  /* This builds the root level, and emits row-inserted for the first row */
+  gtk_tree_model_sort_row_inserted (s_model, s_path, s_iter, data);
+
+  row_s_path = gtk_tree_path_copy (s_path);
+  for (i = 1; i < n_rows; i++)
+    {
+      gtk_tree_path_next (row_s_path);
+
+      path = gtk_real_tree_model_sort_convert_child_path_to_path (tree_model_sort,
+								  row_s_path,
+								  FALSE);
+      if (!path)
+	continue;
+
+      gtk_tree_model_sort_increment_stamp (tree_model_sort);
+
+      gtk_tree_model_get_iter (GTK_TREE_MODEL (data), &iter, path);
+      gtk_tree_model_row_inserted (GTK_TREE_MODEL (data), path, &iter);
+      gtk_tree_path_free (path);
+    }
+  gtk_tree_path_free (row_s_path);
+
+  priv->in_rows_inserted = TRUE;
+  g_signal_handler_block (s_model, priv->inserted_id);
+}
+
+static void
+gtk_tree_model_sort_rows_inserted_after (GtkTreeModel *s_model,
+					 GtkTreePath  *s_path,
+					 GtkTreeIter  *s_iter,
+					 gint          n_rows,
+					 gpointer      data)
+{
+  GtkTreeModelSort *tree_model_sort = GTK_TREE_MODEL_SORT (data);
+  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
+
+  if (!priv->in_rows_inserted)
+    return;
+
+  priv->in_rows_inserted = FALSE;
+  g_signal_handler_unblock (s_model, priv->inserted_id);
+}
+
 static void
 gtk_tree_model_sort_row_has_child_toggled (GtkTreeModel *s_model,
 					   GtkTreePath  *s_path,
@@ -1892,6 +1972,390 @@ gtk_tree_model_sort_offset_compare_func (gconstpointer a,
   return retval;
 }
 
+/* Sorting by keys
+ *
+ * When sorting on a column with the default comparison, each row's
+ * value is fetched once into a typed key, instead of twice per
+ * comparison through GValues. The keys don't touch the child model,
+ * so big levels are sorted in chunks on a thread pool and merged.
+ */
+#define SORT_KEYS_PARALLEL_THRESHOLD 65536
+#define SORT_KEYS_MAX_THREADS 8
+
+typedef enum {
+  SORT_KEY_INT,
+  SORT_KEY_UINT,
+  SORT_KEY_DOUBLE,
+  SORT_KEY_STRING
+} SortKeyType;
+
+typedef struct
+{
+  SortElt *elt;
+  union {
+    gint64   v_int;
+    guint64  v_uint;
+    gdouble  v_double;
+    gchar   *v_string;  /* collation key */
+  } key;
+} SortKey;
+
+typedef struct
+{
+  SortKeyType type;
+  gboolean descending;
+} SortKeyInfo;
+
+typedef struct
+{
+  SortKey *keys;
+  guint n_keys;
+  SortKeyInfo *info;
+
+  GMutex *mutex;
+  GCond *cond;
+  guint *pending;
+} SortKeyChunk;
+
+static gint
+sort_key_compare (gconstpointer a,
+                  gconstpointer b,
+                  gpointer      user_data)
+{
+  const SortKey *ka = a;
+  const SortKey *kb = b;
+  SortKeyInfo *info = user_data;
+  gint retval;
+
+  switch (info->type)
+    {
+    case SORT_KEY_INT:
+      retval = ka->key.v_int < kb->key.v_int ? -1 : ka->key.v_int > kb->key.v_int;
+      break;
+    case SORT_KEY_UINT:
+      retval = ka->key.v_uint < kb->key.v_uint ? -1 : ka->key.v_uint > kb->key.v_uint;
+      break;
+    case SORT_KEY_DOUBLE:
+      retval = ka->key.v_double < kb->key.v_double ? -1 : ka->key.v_double > kb->key.v_double;
+      break;
+    case SORT_KEY_STRING:
+      retval = strcmp (ka->key.v_string, kb->key.v_string);
+      break;
+    default:
+      g_assert_not_reached ();
+      retval = 0;
+      break;
+    }
+
+  if (info->descending)
+    retval = -retval;
+
+  /* Keep equal rows in their old order, like g_sequence_sort() */
+  if (retval == 0)
+    retval = ka->elt->old_index < kb->elt->old_index ? -1 : 1;
+
+  return retval;
+}
+
+static void
+sort_key_chunk_func (gpointer data,
+                     gpointer user_data)
+{
+  SortKeyChunk *chunk = data;
+
+  g_qsort_with_data (chunk->keys, chunk->n_keys, sizeof (SortKey),
+                     sort_key_compare, chunk->info);
+
+  g_mutex_lock (chunk->mutex);
+  (*chunk->pending)--;
+  g_cond_signal (chunk->cond);
+  g_mutex_unlock (chunk->mutex);
+}
+
+static GThreadPool *
+get_sort_key_pool (void)
+{
+  static GThreadPool *pool = NULL;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *new_pool;
+
+      new_pool = g_thread_pool_new (sort_key_chunk_func, NULL,
+                                    SORT_KEYS_MAX_THREADS, FALSE, NULL);
+      g_once_init_leave (&pool, new_pool);
+    }
+
+  return pool;
+}
+
+static void
+sort_keys_merge (const SortKey *src,
+                 SortKey       *dest,
+                 guint          start,
+                 guint          middle,
+                 guint          end,
+                 SortKeyInfo   *info)
+{
+  guint i = start, j = middle, k = start;
+
+  while (i < middle && j < end)
+    {
+      if (sort_key_compare (&src[j], &src[i], info) < 0)
+        dest[k++] = src[j++];
+      else
+        dest[k++] = src[i++];
+    }
+
+  memcpy (dest + k, src + i, (middle - i) * sizeof (SortKey));
+  k += middle - i;
+  memcpy (dest + k, src + j, (end - j) * sizeof (SortKey));
+}
+
+static void
+sort_keys_parallel (SortKey     *keys,
+                    guint        n_keys,
+                    guint        n_chunks,
+                    SortKeyInfo *info)
+{
+  SortKeyChunk *chunks;
+  SortKey *tmp, *src, *dest, *swap;
+  guint *bounds;
+  guint pending;
+  GMutex mutex;
+  GCond cond;
+  guint i, n_merged;
+
+  chunks = g_new (SortKeyChunk, n_chunks);
+  bounds = g_new (guint, n_chunks + 1);
+
+  g_mutex_init (&mutex);
+  g_cond_init (&cond);
+  pending = n_chunks;
+
+  for (i = 0; i < n_chunks; i++)
+    {
+      bounds[i] = (guint64) n_keys * i / n_chunks;
+      bounds[i + 1] = (guint64) n_keys * (i + 1) / n_chunks;
+
+      chunks[i].keys = keys + bounds[i];
+      chunks[i].n_keys = bounds[i + 1] - bounds[i];
+      chunks[i].info = info;
+      chunks[i].mutex = &mutex;
+      chunks[i].cond = &cond;
+      chunks[i].pending = &pending;
+
+      g_thread_pool_push (get_sort_key_pool (), &chunks[i], NULL);
+    }
+
+  g_mutex_lock (&mutex);
+  while (pending > 0)
+    g_cond_wait (&cond, &mutex);
+  g_mutex_unlock (&mutex);
+
+  g_mutex_clear (&mutex);
+  g_cond_clear (&cond);
+  g_free (chunks);
+
+  /* Merge neighbouring runs until only one is left */
+  tmp = g_new (SortKey, n_keys);
+  src = keys;
+  dest = tmp;
+
+  while (n_chunks > 1)
+    {
+      n_merged = 0;
+      for (i = 0; i < n_chunks; i += 2)
+        {
+          if (i + 1 < n_chunks)
+            sort_keys_merge (src, dest, bounds[i], bounds[i + 1], bounds[i + 2], info);
+          else
+            memcpy (dest + bounds[i], src + bounds[i],
+                    (bounds[i + 1] - bounds[i]) * sizeof (SortKey));
+
+          bounds[n_merged++] = bounds[i];
+        }
+      bounds[n_merged] = n_keys;
+      n_chunks = n_merged;
+
+      swap = src;
+      src = dest;
+      dest = swap;
+    }
+
+  if (src != keys)
+    memcpy (keys, src, n_keys * sizeof (SortKey));
+
+  g_free (tmp);
+  g_free (bounds);
+}
+
+static gboolean
+gtk_tree_model_sort_get_key_type (GType        type,
+                                  SortKeyType *key_type)
+{
+  switch (G_TYPE_FUNDAMENTAL (type))
+    {
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_CHAR:
+    case G_TYPE_INT:
+    case G_TYPE_LONG:
+    case G_TYPE_INT64:
+    case G_TYPE_ENUM:
+      *key_type = SORT_KEY_INT;
+      return TRUE;
+    case G_TYPE_UCHAR:
+    case G_TYPE_UINT:
+    case G_TYPE_ULONG:
+    case G_TYPE_UINT64:
+    case G_TYPE_FLAGS:
+      *key_type = SORT_KEY_UINT;
+      return TRUE;
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+      *key_type = SORT_KEY_DOUBLE;
+      return TRUE;
+    case G_TYPE_STRING:
+      *key_type = SORT_KEY_STRING;
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+static void
+sort_key_set_value (SortKey      *key,
+                    const GValue *value)
+{
+  const gchar *str;
+
+  switch (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (value)))
+    {
+    case G_TYPE_BOOLEAN:
+      key->key.v_int = g_value_get_boolean (value);
+      break;
+    case G_TYPE_CHAR:
+      key->key.v_int = g_value_get_schar (value);
+      break;
+    case G_TYPE_INT:
+      key->key.v_int = g_value_get_int (value);
+      break;
+    case G_TYPE_LONG:
+      key->key.v_int = g_value_get_long (value);
+      break;
+    case G_TYPE_INT64:
+      key->key.v_int = g_value_get_int64 (value);
+      break;
+    case G_TYPE_ENUM:
+      key->key.v_int = g_value_get_enum (value);
+      break;
+    case G_TYPE_UCHAR:
+      key->key.v_uint = g_value_get_uchar (value);
+      break;
+    case G_TYPE_UINT:
+      key->key.v_uint = g_value_get_uint (value);
+      break;
+    case G_TYPE_ULONG:
+      key->key.v_uint = g_value_get_ulong (value);
+      break;
+    case G_TYPE_UINT64:
+      key->key.v_uint = g_value_get_uint64 (value);
+      break;
+    case G_TYPE_FLAGS:
+      key->key.v_uint = g_value_get_flags (value);
+      break;
+    case G_TYPE_FLOAT:
+      key->key.v_double = g_value_get_float (value);
+      break;
+    case G_TYPE_DOUBLE:
+      key->key.v_double = g_value_get_double (value);
+      break;
+    case G_TYPE_STRING:
+      str = g_value_get_string (value);
+      key->key.v_string = g_utf8_collate_key (str ? str : "", -1);
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+}
+
+/* Sorts @level with precomputed keys if it is sorted on a column
+ * with the default comparison. Returns %FALSE if it isn't.
+ */
+static gboolean
+gtk_tree_model_sort_sort_level_by_keys (GtkTreeModelSort *tree_model_sort,
+                                        SortLevel        *level,
+                                        SortData         *data)
+{
+  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
+  GSequenceIter *siter, *end_siter;
+  SortKeyInfo info;
+  SortKey *keys;
+  GtkTreeIter child_iter;
+  GValue value = G_VALUE_INIT;
+  gint column;
+  guint i, n_keys, n_chunks;
+
+  if (data->sort_func != _gtk_tree_data_list_compare_func)
+    return FALSE;
+
+  column = GPOINTER_TO_INT (data->sort_data);
+  if (column < 0 || column >= gtk_tree_model_get_n_columns (priv->child_model))
+    return FALSE;
+
+  if (!gtk_tree_model_sort_get_key_type (gtk_tree_model_get_column_type (priv->child_model, column),
+                                         &info.type))
+    return FALSE;
+
+  info.descending = priv->order == GTK_SORT_DESCENDING;
+
+  n_keys = g_sequence_get_length (level->seq);
+  keys = g_new (SortKey, n_keys);
+
+  i = 0;
+  end_siter = g_sequence_get_end_iter (level->seq);
+  for (siter = g_sequence_get_begin_iter (level->seq);
+       siter != end_siter;
+       siter = g_sequence_iter_next (siter))
+    {
+      SortElt *elt = g_sequence_get (siter);
+
+      if (GTK_TREE_MODEL_SORT_CACHE_CHILD_ITERS (tree_model_sort))
+        child_iter = elt->iter;
+      else
+        {
+          data->parent_path_indices[data->parent_path_depth - 1] = elt->offset;
+          gtk_tree_model_get_iter (priv->child_model, &child_iter, data->parent_path);
+        }
+
+      gtk_tree_model_get_value (priv->child_model, &child_iter, column, &value);
+      keys[i].elt = elt;
+      sort_key_set_value (&keys[i], &value);
+      g_value_unset (&value);
+      i++;
+    }
+
+  n_chunks = MIN (g_get_num_processors (), SORT_KEYS_MAX_THREADS);
+  if (n_keys >= SORT_KEYS_PARALLEL_THRESHOLD && n_chunks > 1)
+    sort_keys_parallel (keys, n_keys, n_chunks, &info);
+  else
+    g_qsort_with_data (keys, n_keys, sizeof (SortKey), sort_key_compare, &info);
+
+  /* Moving every row to the end in turn leaves them sorted */
+  for (i = 0; i < n_keys; i++)
+    {
+      g_sequence_move (keys[i].elt->siter, end_siter);
+
+      if (info.type == SORT_KEY_STRING)
+        g_free (keys[i].key.v_string);
+    }
+
+  g_free (keys);
+
+  return TRUE;
+}
+
 static void
 gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
 				SortLevel        *level,
@@ -1940,7 +2404,7 @@ gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
   if (data.sort_func == NO_SORT_FUNC)
     g_sequence_sort (level->seq, gtk_tree_model_sort_offset_compare_func,
                      &data);
-  else
+  else if (!gtk_tree_model_sort_sort_level_by_keys (tree_model_sort, level, &data))
     g_sequence_sort (level->seq, gtk_tree_model_sort_compare_func, &data);
 
   free_sort_data (&data);
@@ -2142,6 +2606,10 @@ gtk_tree_model_sort_set_model (GtkTreeModelSort *tree_model_sort,
                                    priv->changed_id);
       g_signal_handler_disconnect (priv->child_model,
                                    priv->inserted_id);
+      g_signal_handler_disconnect (priv->child_model,
+                                   priv->rows_inserted_id);
+      g_signal_handler_disconnect (priv->child_model,
+                                   priv->rows_inserted_after_id);
       g_signal_handler_disconnect (priv->child_model,
                                    priv->has_child_toggled_id);
       g_signal_handler_disconnect (priv->child_model,
@@ -2173,6 +2641,14 @@ gtk_tree_model_sort_set_model (GtkTreeModelSort *tree_model_sort,
         g_signal_connect (child_model, "row-inserted",
                           G_CALLBACK (gtk_tree_model_sort_row_inserted),
                           tree_model_sort);
+      priv->rows_inserted_id =
+        g_signal_connect (child_model, "rows-inserted",
+                          G_CALLBACK (gtk_tree_model_sort_rows_inserted),
+                          tree_model_sort);
+      priv->rows_inserted_after_id =
+        g_signal_connect_after (child_model, "rows-inserted",
+                                G_CALLBACK (gtk_tree_model_sort_rows_inserted_after),
+                                tree_model_sort);
       priv->has_child_toggled_id =
         g_signal_connect (child_model, "row-has-child-toggled",
                           G_CALLBACK (gtk_tree_model_sort_row_has_child_toggled),
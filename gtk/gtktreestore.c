@@ -1654,6 +1654,123 @@ gtk_tree_store_insert_with_valuesv (GtkTreeStore *tree_store,
   validate_tree ((GtkTreeStore *)tree_store);
 }
 
+/**
+ * gtk_tree_store_insert_rows_with_valuesv:
+ * @tree_store: A #GtkTreeStore
+ * @parent: (allow-none): A valid #GtkTreeIter, or %NULL
+ * @position: position to insert the first new row, or -1 for last
+ * @n_rows: the number of rows to insert
+ * @columns: (array length=n_values): an array of column numbers
+ * @values: (array): an array of @n_rows times @n_values GValues, holding
+ *     the values for the first row, then the second row, and so on
+ * @n_values: the length of the @columns array
+ *
+ * Inserts @n_rows consecutive children of @parent at @position and
+ * fills them with the given values, like calling
+ * gtk_tree_store_insert_with_valuesv() for each row.
+ *
+ * Instead of one #GtkTreeModel::row-inserted signal per row, a
+ * single #GtkTreeModel::rows-inserted signal is emitted, which lets
+ * views add all rows in one go.
+ *
+ * If the store is sorted, the rows are inserted one by one at
+ * their sorted positions, and @position is ignored.
+ *
+ * Since: 3.90
+ */
+void
+gtk_tree_store_insert_rows_with_valuesv (GtkTreeStore *tree_store,
+                                         GtkTreeIter  *parent,
+                                         gint          position,
+                                         gint          n_rows,
+                                         gint         *columns,
+                                         GValue       *values,
+                                         gint          n_values)
+{
+  GtkTreeStorePrivate *priv = tree_store->priv;
+  GtkTreePath *path;
+  GNode *parent_node;
+  GNode *sibling;
+  GNode *first_node = NULL;
+  gboolean had_children;
+  GtkTreeIter iter;
+  gboolean changed = FALSE;
+  gboolean maybe_need_sort = FALSE;
+  gint i;
+
+  g_return_if_fail (GTK_IS_TREE_STORE (tree_store));
+  g_return_if_fail (n_rows >= 0);
+  g_return_if_fail (n_values == 0 || (columns != NULL && values != NULL));
+
+  if (parent)
+    g_return_if_fail (VALID_ITER (parent, tree_store));
+
+  if (n_rows == 0)
+    return;
+
+  if (GTK_TREE_STORE_IS_SORTED (tree_store))
+    {
+      for (i = 0; i < n_rows; i++)
+        gtk_tree_store_insert_with_valuesv (tree_store, NULL, parent, -1,
+                                            columns, values + i * n_values, n_values);
+      return;
+    }
+
+  if (parent)
+    parent_node = parent->user_data;
+  else
+    parent_node = priv->root;
+
+  priv->columns_dirty = TRUE;
+
+  had_children = parent_node->children != NULL;
+
+  /* The new rows go after this node, or first if it is NULL */
+  if (position == 0)
+    sibling = NULL;
+  else
+    {
+      sibling = position > 0 ? g_node_nth_child (parent_node, position - 1) : NULL;
+      if (sibling == NULL)
+        sibling = g_node_last_child (parent_node);
+    }
+
+  iter.stamp = priv->stamp;
+
+  for (i = 0; i < n_rows; i++)
+    {
+      GNode *new_node = g_node_new (NULL);
+
+      if (sibling)
+        g_node_insert_after (parent_node, sibling, new_node);
+      else
+        g_node_prepend (parent_node, new_node);
+      sibling = new_node;
+
+      if (first_node == NULL)
+        first_node = new_node;
+
+      iter.user_data = new_node;
+      gtk_tree_store_set_vector_internal (tree_store, &iter,
+                                          &changed, &maybe_need_sort,
+                                          columns, values + i * n_values, n_values);
+    }
+
+  iter.user_data = first_node;
+  path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), &iter);
+  gtk_tree_model_rows_inserted (GTK_TREE_MODEL (tree_store), path, &iter, n_rows);
+
+  if (parent_node != priv->root && !had_children)
+    {
+      gtk_tree_path_up (path);
+      gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (tree_store), path, parent);
+    }
+
+  gtk_tree_path_free (path);
+
+  validate_tree ((GtkTreeStore *)tree_store);
+}
+
 /**
  * gtk_tree_store_prepend:
  * @tree_store: A #GtkTreeStore
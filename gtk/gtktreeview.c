@@ -29,6 +29,7 @@
 #include "gtktreednd.h"
 #include "gtktreeprivate.h"
 #include "gtkcellrenderer.h"
+#include "gtkdebug.h"
 #include "gtkmarshalers.h"
 #include "gtkbuildable.h"
 #include "gtkbutton.h"
@@ -55,6 +56,7 @@
 #include "gtksettingsprivate.h"
 #include "gtkwidgetpath.h"
 #include "gtkpixelcacheprivate.h"
+#include "gtkprefixindexprivate.h"
 #include "a11y/gtktreeviewaccessibleprivate.h"
 
 
@@ -241,10 +243,25 @@ typedef enum {
 
 #define GTK_TREE_VIEW_PRIORITY_VALIDATE (GDK_PRIORITY_REDRAW + 5)
 #define GTK_TREE_VIEW_PRIORITY_SCROLL_SYNC (GTK_TREE_VIEW_PRIORITY_VALIDATE + 2)
-/* 3/5 of gdkframeclockidle.c's FRAME_INTERVAL (16667 microsecs) */
+/* 3/5 of gdkframeclockidle.c's FRAME_INTERVAL (16667 microsecs),
+ * used when we have no frame clock to go by
+ */
 #define GTK_TREE_VIEW_TIME_MS_PER_IDLE 10
+/* Time we leave free before the next frame is due, and the least we
+ * validate per idle so that we always make progress (microsecs)
+ */
+#define GTK_TREE_VIEW_VALIDATE_FRAME_MARGIN 1000
+#define GTK_TREE_VIEW_VALIDATE_MIN_TIME 1000
+/* Rows that must have been measured with the same height before we
+ * stop validating offscreen rows
+ */
+#define GTK_TREE_VIEW_UNIFORM_HEIGHT_SAMPLE 32
 #define SCROLL_EDGE_SIZE 15
 #define GTK_TREE_VIEW_SEARCH_DIALOG_TIMEOUT 5000
+/* Inserted or deleted rows after which the search index is dropped
+ * instead of updated, if it was not used in between
+ */
+#define GTK_TREE_VIEW_SEARCH_INDEX_MAX_CHANGES 64
 #define AUTO_EXPAND_TIMEOUT 500
 
 /* Translate from bin_window coordinates to rbtree (tree coordinates) and
@@ -325,6 +342,14 @@ struct _GtkTreeViewPrivate
   guint validate_rows_timer;
   guint scroll_sync_timer;
 
+  /* Set while ignoring row-inserted for rows we added from rows-inserted */
+  guint in_rows_inserted : 1;
+
+  /* Row validation statistics for the current frame */
+  gint64 validate_frame_counter;
+  gint64 validate_frame_time;
+  guint validate_frame_rows;
+
   /* Indentation and expander layout */
   GtkTreeViewColumn *expander_column;
 
@@ -412,6 +437,11 @@ struct _GtkTreeViewPrivate
   /* fixed height */
   gint fixed_height;
 
+  /* Height assumed for rows that have not been validated, as long as
+   * all validated rows share it; -1 if rows have differing heights.
+   */
+  gint estimated_height;
+
   GtkRBNode *rubber_band_start_node;
   GtkRBTree *rubber_band_start_tree;
 
@@ -438,6 +468,8 @@ struct _GtkTreeViewPrivate
   GtkWidget *search_entry;
   gulong search_entry_changed_id;
   guint typeselect_flush_timeout;
+  GtkPrefixIndex *search_index;
+  guint search_index_changes;
 
   /* Grid and tree lines */
   GtkTreeViewGridLines grid_lines;
@@ -488,6 +520,7 @@ struct _GtkTreeViewPrivate
 
   /* interactive search */
   guint enable_search : 1;
+  guint enable_search_index : 1;
   guint disable_popdown : 1;
   guint search_custom_entry_set : 1;
   
@@ -565,6 +598,7 @@ enum {
   PROP_ENABLE_TREE_LINES,
   PROP_TOOLTIP_COLUMN,
   PROP_ACTIVATE_ON_SINGLE_CLICK,
+  PROP_ENABLE_SEARCH_INDEX,
   LAST_PROP,
   /* overridden */
   PROP_HADJUSTMENT = LAST_PROP,
@@ -685,6 +719,16 @@ static void gtk_tree_view_row_inserted                    (GtkTreeModel    *mode
 							   GtkTreePath     *path,
 							   GtkTreeIter     *iter,
 							   gpointer         data);
+static void gtk_tree_view_rows_inserted                   (GtkTreeModel    *model,
+							   GtkTreePath     *path,
+							   GtkTreeIter     *iter,
+							   gint             n_rows,
+							   gpointer         data);
+static void gtk_tree_view_rows_inserted_after             (GtkTreeModel    *model,
+							   GtkTreePath     *path,
+							   GtkTreeIter     *iter,
+							   gint             n_rows,
+							   gpointer         data);
 static void gtk_tree_view_row_has_child_toggled           (GtkTreeModel    *model,
 							   GtkTreePath     *path,
 							   GtkTreeIter     *iter,
@@ -709,6 +753,7 @@ static gboolean do_validate_rows         (GtkTreeView *tree_view,
 					  gboolean     queue_resize);
 static gboolean validate_rows            (GtkTreeView *tree_view);
 static void     install_presize_handler  (GtkTreeView *tree_view);
+static void     gtk_tree_view_flush_validate_stats (GtkTreeView *tree_view);
 static void     install_scroll_sync_handler (GtkTreeView *tree_view);
 static void     gtk_tree_view_set_top_row   (GtkTreeView *tree_view,
 					     GtkTreePath *path,
@@ -856,6 +901,11 @@ static gboolean gtk_tree_view_search_iter               (GtkTreeModel     *model
 							 gint              n);
 static void     gtk_tree_view_search_init               (GtkWidget        *entry,
 							 GtkTreeView      *tree_view);
+static gchar   *gtk_tree_view_search_get_string         (GtkTreeModel     *model,
+							 GtkTreeIter      *iter,
+							 gint              column);
+static void     gtk_tree_view_drop_search_index         (GtkTreeView      *tree_view);
+static gboolean gtk_tree_view_search_index_structure_changed (GtkTreeView *tree_view);
 static void     gtk_tree_view_put                       (GtkTreeView      *tree_view,
 							 GtkWidget        *child_widget,
                                                          GtkTreePath      *path,
@@ -1093,6 +1143,21 @@ gtk_tree_view_class_init (GtkTreeViewClass *class)
                         -1,
                         GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkTreeView:enable-search-index:
+   *
+   * Whether interactive search keeps an index of the search column.
+   * See gtk_tree_view_set_enable_search_index().
+   *
+   * Since: 3.90
+   */
+  tree_view_props[PROP_ENABLE_SEARCH_INDEX] =
+      g_param_spec_boolean ("enable-search-index",
+                            P_("Enable Search Index"),
+                            P_("Whether interactive search uses an index of the search column"),
+                            FALSE,
+                            GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
+
   /**
    * GtkTreeView:fixed-height-mode:
    *
@@ -1811,6 +1876,7 @@ gtk_tree_view_init (GtkTreeView *tree_view)
   priv->fixed_height = -1;
   priv->fixed_height_mode = FALSE;
   priv->fixed_height_check = 0;
+  priv->estimated_height = -1;
   priv->selection = _gtk_tree_selection_new_with_tree_view (tree_view);
   priv->enable_search = TRUE;
   priv->search_column = -1;
@@ -1948,6 +2014,9 @@ G_GNUC_END_IGNORE_DEPRECATIONS
     case PROP_SEARCH_COLUMN:
       gtk_tree_view_set_search_column (tree_view, g_value_get_int (value));
       break;
+    case PROP_ENABLE_SEARCH_INDEX:
+      gtk_tree_view_set_enable_search_index (tree_view, g_value_get_boolean (value));
+      break;
     case PROP_FIXED_HEIGHT_MODE:
       gtk_tree_view_set_fixed_height_mode (tree_view, g_value_get_boolean (value));
       break;
@@ -2048,6 +2117,9 @@ gtk_tree_view_get_property (GObject    *object,
     case PROP_SEARCH_COLUMN:
       g_value_set_int (value, tree_view->priv->search_column);
       break;
+    case PROP_ENABLE_SEARCH_INDEX:
+      g_value_set_boolean (value, tree_view->priv->enable_search_index);
+      break;
     case PROP_FIXED_HEIGHT_MODE:
       g_value_set_boolean (value, tree_view->priv->fixed_height_mode);
       break;
@@ -2219,6 +2291,8 @@ gtk_tree_view_destroy (GtkWidget *widget)
   gtk_tree_row_reference_free (tree_view->priv->anchor);
   tree_view->priv->anchor = NULL;
 
+  gtk_tree_view_drop_search_index (tree_view);
+
   /* destroy interactive search dialog */
   if (tree_view->priv->search_window)
     {
@@ -2546,6 +2620,8 @@ gtk_tree_view_unrealize (GtkWidget *widget)
       priv->validate_rows_timer = 0;
     }
 
+  gtk_tree_view_flush_validate_stats (tree_view);
+
   if (priv->scroll_sync_timer != 0)
     {
       g_source_remove (priv->scroll_sync_timer);
@@ -6331,6 +6407,8 @@ validate_row (GtkTreeView *tree_view,
       ! GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_COLUMN_INVALID))
     return FALSE;
 
+  tree_view->priv->validate_frame_rows++;
+
   is_separator = row_is_separator (tree_view, iter, NULL);
 
   gtk_widget_style_get (GTK_WIDGET (tree_view),
@@ -6438,6 +6516,22 @@ validate_row (GtkTreeView *tree_view,
   _gtk_rbtree_node_mark_valid (tree, node);
   tree_view->priv->post_validation_flag = TRUE;
 
+  /* Rows are verified against the estimate as they become visible.
+   * As soon as one differs, go back to measuring all rows.
+   */
+  if (tree_view->priv->estimated_height >= 0 &&
+      gtk_tree_view_get_row_height (tree_view, node) != tree_view->priv->estimated_height)
+    {
+      GTK_NOTE (TREE,
+                g_message ("%s %p: row height %d differs from estimate %d, validating all rows",
+                           G_OBJECT_TYPE_NAME (tree_view), tree_view,
+                           gtk_tree_view_get_row_height (tree_view, node),
+                           tree_view->priv->estimated_height));
+
+      tree_view->priv->estimated_height = -1;
+      install_presize_handler (tree_view);
+    }
+
   return retval;
 }
 
@@ -6842,6 +6936,90 @@ initialize_fixed_height_mode (GtkTreeView *tree_view)
                                  tree_view->priv->fixed_height, TRUE);
 }
 
+/* Returns the monotonic time at which idle validation should yield.
+ *
+ * We try to use up the time until the next frame is due, so that we
+ * don't make frames late on fast displays and don't waste idle time
+ * on slow ones. If the frame clock hasn't produced a frame for a
+ * while it is idle, and we allow ourselves one refresh interval.
+ */
+static gint64
+gtk_tree_view_get_validate_deadline (GtkTreeView *tree_view)
+{
+  GdkFrameClock *clock;
+  GdkFrameTimings *timings;
+  gint64 now, frame_time, refresh_interval, next_frame;
+
+  now = g_get_monotonic_time ();
+
+  clock = gtk_widget_get_frame_clock (GTK_WIDGET (tree_view));
+  if (clock == NULL)
+    return now + GTK_TREE_VIEW_TIME_MS_PER_IDLE * 1000;
+
+  timings = gdk_frame_clock_get_current_timings (clock);
+  if (timings == NULL)
+    return now + GTK_TREE_VIEW_TIME_MS_PER_IDLE * 1000;
+
+  frame_time = gdk_frame_timings_get_frame_time (timings);
+  gdk_frame_clock_get_refresh_info (clock, frame_time, &refresh_interval, NULL);
+  next_frame = frame_time + refresh_interval;
+
+  if (now > next_frame + refresh_interval)
+    return now + refresh_interval - GTK_TREE_VIEW_VALIDATE_FRAME_MARGIN;
+
+  return MAX (next_frame - GTK_TREE_VIEW_VALIDATE_FRAME_MARGIN,
+              now + GTK_TREE_VIEW_VALIDATE_MIN_TIME);
+}
+
+/* Validation statistics are collected per frame and printed with
+ * GTK_DEBUG=tree. Rows validated between two frames are attributed
+ * to the earlier one. The last frame's are printed when validation
+ * is done or the view is unrealized.
+ */
+static void
+gtk_tree_view_flush_validate_stats (GtkTreeView *tree_view)
+{
+  GtkTreeViewPrivate *priv = tree_view->priv;
+
+  if (priv->validate_frame_rows > 0)
+    GTK_NOTE (TREE,
+              g_message ("%s %p: frame %" G_GINT64_FORMAT ": validated %u rows in %.1f ms",
+                         G_OBJECT_TYPE_NAME (tree_view), tree_view,
+                         priv->validate_frame_counter,
+                         priv->validate_frame_rows,
+                         priv->validate_frame_time / 1000.));
+
+  priv->validate_frame_rows = 0;
+  priv->validate_frame_time = 0;
+}
+
+static gint64
+gtk_tree_view_begin_validate_stats (GtkTreeView *tree_view)
+{
+  GtkTreeViewPrivate *priv = tree_view->priv;
+  GdkFrameClock *clock;
+  gint64 frame_counter = 0;
+
+  clock = gtk_widget_get_frame_clock (GTK_WIDGET (tree_view));
+  if (clock != NULL)
+    frame_counter = gdk_frame_clock_get_frame_counter (clock);
+
+  if (frame_counter != priv->validate_frame_counter)
+    {
+      gtk_tree_view_flush_validate_stats (tree_view);
+      priv->validate_frame_counter = frame_counter;
+    }
+
+  return g_get_monotonic_time ();
+}
+
+static void
+gtk_tree_view_end_validate_stats (GtkTreeView *tree_view,
+                                  gint64       start_time)
+{
+  tree_view->priv->validate_frame_time += g_get_monotonic_time () - start_time;
+}
+
 /* Our strategy for finding nodes to validate is a little convoluted.  We find
  * the left-most uninvalidated node.  We then try walking right, validating
  * nodes.  Once we find a valid node, we repeat the previous process of finding
@@ -6859,7 +7037,7 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
   gint retval = TRUE;
   GtkTreePath *path = NULL;
   GtkTreeIter iter;
-  GTimer *timer;
+  gint64 start_time, deadline;
   gint i = 0;
 
   gint y = -1;
@@ -6883,8 +7061,14 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
       return FALSE;
     }
 
-  timer = g_timer_new ();
-  g_timer_start (timer);
+  /* All rows are assumed to have the estimated height, offscreen rows
+   * are left alone until they are scrolled to.
+   */
+  if (tree_view->priv->estimated_height >= 0)
+    return FALSE;
+
+  start_time = gtk_tree_view_begin_validate_stats (tree_view);
+  deadline = gtk_tree_view_get_validate_deadline (tree_view);
 
   do
     {
@@ -6973,14 +7157,29 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
 
       i++;
     }
-  while (g_timer_elapsed (timer, NULL) < GTK_TREE_VIEW_TIME_MS_PER_IDLE / 1000.);
+  while (g_get_monotonic_time () < deadline);
 
   if (!tree_view->priv->fixed_height_check)
    {
      if (fixed_height)
        _gtk_rbtree_set_fixed_height (tree_view->priv->tree, prev_height, FALSE);
 
-     tree_view->priv->fixed_height_check = 1;
+     /* A large enough sample of identical rows makes us assume that all
+      * rows have that height. Too small a sample is retried next time.
+      */
+     if (!fixed_height)
+       tree_view->priv->fixed_height_check = 1;
+     else if (i >= GTK_TREE_VIEW_UNIFORM_HEIGHT_SAMPLE)
+       {
+         GTK_NOTE (TREE,
+                   g_message ("%s %p: %d rows of height %d, assuming uniform rows",
+                              G_OBJECT_TYPE_NAME (tree_view), tree_view,
+                              i, prev_height));
+
+         tree_view->priv->estimated_height = prev_height;
+         tree_view->priv->fixed_height_check = 1;
+         retval = FALSE;
+       }
    }
   
  done:
@@ -7024,7 +7223,7 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
     }
 
   if (path) gtk_tree_path_free (path);
-  g_timer_destroy (timer);
+  gtk_tree_view_end_validate_stats (tree_view, start_time);
 
   if (!retval && gtk_widget_get_mapped (GTK_WIDGET (tree_view)))
     update_prelight (tree_view,
@@ -7057,6 +7256,10 @@ maybe_reenable_adjustment_animation (GtkTreeView *tree_view)
 static gboolean
 do_presize_handler (GtkTreeView *tree_view)
 {
+  gint64 start_time;
+
+  start_time = gtk_tree_view_begin_validate_stats (tree_view);
+
   if (tree_view->priv->mark_rows_col_dirty)
    {
       if (tree_view->priv->tree)
@@ -7064,6 +7267,8 @@ do_presize_handler (GtkTreeView *tree_view)
       tree_view->priv->mark_rows_col_dirty = FALSE;
     }
   validate_visible_area (tree_view);
+  gtk_tree_view_end_validate_stats (tree_view, start_time);
+
   if (tree_view->priv->presize_handler_tick_cb != 0)
     {
       gtk_widget_remove_tick_callback (GTK_WIDGET (tree_view), tree_view->priv->presize_handler_tick_cb);
@@ -7116,6 +7321,7 @@ validate_rows (GtkTreeView *tree_view)
     {
       g_source_remove (tree_view->priv->validate_rows_timer);
       tree_view->priv->validate_rows_timer = 0;
+      gtk_tree_view_flush_validate_stats (tree_view);
       maybe_reenable_adjustment_animation (tree_view);
     }
 
@@ -8456,6 +8662,12 @@ column_sizing_notify (GObject    *object,
  * Only enable this option if all rows are the same height and all
  * columns are of type %GTK_TREE_VIEW_COLUMN_FIXED.
  *
+ * Without fixed height mode, @tree_view still stops measuring offscreen
+ * rows once a sample of rows turned out to have the same height, and
+ * goes back to measuring all rows when a visible row differs. Columns
+ * that are not fixed-sized may then grow as new rows are scrolled into
+ * view.
+ *
  * Since: 2.6 
  **/
 void
@@ -8981,6 +9193,16 @@ gtk_tree_view_row_changed (GtkTreeModel *model,
   else if (iter == NULL)
     gtk_tree_model_get_iter (model, iter, path);
 
+  if (tree_view->priv->search_index && iter != NULL)
+    {
+      gchar *string;
+
+      string = gtk_tree_view_search_get_string (model, iter, tree_view->priv->search_column);
+      _gtk_prefix_index_set (tree_view->priv->search_index,
+                             gtk_tree_path_get_indices (path)[0], string);
+      g_free (string);
+    }
+
   if (_gtk_tree_view_find_node (tree_view,
 				path,
 				&tree,
@@ -9038,7 +9260,7 @@ gtk_tree_view_row_inserted (GtkTreeModel *model,
   GtkRBNode *tmpnode = NULL;
   gint depth;
   gint i = 0;
-  gint height;
+  gint height, initial_height;
   gboolean free_path = FALSE;
   gboolean node_visible = TRUE;
 
@@ -9050,6 +9272,8 @@ gtk_tree_view_row_inserted (GtkTreeModel *model,
   else
     height = 0;
 
+  initial_height = height > 0 ? height : MAX (tree_view->priv->estimated_height, 0);
+
   if (path == NULL)
     {
       path = gtk_tree_model_get_path (model, iter);
@@ -9063,6 +9287,17 @@ gtk_tree_view_row_inserted (GtkTreeModel *model,
 
   tree = tree_view->priv->tree;
 
+  if (tree_view->priv->search_index &&
+      gtk_tree_view_search_index_structure_changed (tree_view))
+    {
+      gchar *string;
+
+      string = gtk_tree_view_search_get_string (model, iter, tree_view->priv->search_column);
+      _gtk_prefix_index_insert (tree_view->priv->search_index,
+                                gtk_tree_path_get_indices (path)[0], string);
+      g_free (string);
+    }
+
   /* Update all row-references */
   gtk_tree_row_reference_inserted (G_OBJECT (data), path);
   depth = gtk_tree_path_get_depth (path);
@@ -9113,12 +9348,12 @@ gtk_tree_view_row_inserted (GtkTreeModel *model,
   if (indices[depth - 1] == 0)
     {
       tmpnode = _gtk_rbtree_find_count (tree, 1);
-      tmpnode = _gtk_rbtree_insert_before (tree, tmpnode, height, FALSE);
+      tmpnode = _gtk_rbtree_insert_before (tree, tmpnode, initial_height, FALSE);
     }
   else
     {
       tmpnode = _gtk_rbtree_find_count (tree, indices[depth - 1]);
-      tmpnode = _gtk_rbtree_insert_after (tree, tmpnode, height, FALSE);
+      tmpnode = _gtk_rbtree_insert_after (tree, tmpnode, initial_height, FALSE);
     }
 
   _gtk_tree_view_accessible_add (tree_view, tree, tmpnode);
@@ -9140,6 +9375,119 @@ gtk_tree_view_row_inserted (GtkTreeModel *model,
     gtk_tree_path_free (path);
 }
 
+/* Adds all rows to the rbtree at once, instead of waiting for the
+ * row-inserted emissions of the default handler. We ignore those
+ * until gtk_tree_view_rows_inserted_after() runs.
+ */
+static void
+gtk_tree_view_rows_inserted (GtkTreeModel *model,
+			     GtkTreePath  *path,
+			     GtkTreeIter  *iter,
+			     gint          n_rows,
+			     gpointer      data)
+{
+  GtkTreeView *tree_view = (GtkTreeView *) data;
+  GtkTreePath *row_path;
+  GtkTreeIter row_iter;
+  GtkRBTree *tree;
+  GtkRBNode *node;
+  gint *indices;
+  gint depth;
+  gint height, initial_height;
+  gint i;
+
+  depth = gtk_tree_path_get_depth (path);
+  indices = gtk_tree_path_get_indices (path);
+
+  /* Rebuilding the search index is cheaper than updating it */
+  gtk_tree_view_drop_search_index (tree_view);
+
+  if (tree_view->priv->tree == NULL)
+    {
+      if (depth > 1)
+        return;
+      tree_view->priv->tree = _gtk_rbtree_new ();
+    }
+
+  /* Find the parent tree. If it isn't shown, or something is odd,
+   * leave it to gtk_tree_view_row_inserted().
+   */
+  tree = tree_view->priv->tree;
+  for (i = 0; i < depth - 1; i++)
+    {
+      node = _gtk_rbtree_find_count (tree, indices[i] + 1);
+      if (node == NULL || node->children == NULL)
+        return;
+
+      tree = node->children;
+    }
+
+  if (tree_view->priv->fixed_height_mode
+      && tree_view->priv->fixed_height >= 0)
+    height = tree_view->priv->fixed_height;
+  else
+    height = 0;
+
+  initial_height = height > 0 ? height : MAX (tree_view->priv->estimated_height, 0);
+
+  if (indices[depth - 1] == 0)
+    node = NULL;
+  else
+    node = _gtk_rbtree_find_count (tree, indices[depth - 1]);
+
+  row_path = gtk_tree_path_copy (path);
+  row_iter = *iter;
+
+  for (i = 0; i < n_rows; i++)
+    {
+      if (i > 0)
+        {
+          gtk_tree_path_next (row_path);
+          if (!gtk_tree_model_iter_next (model, &row_iter))
+            break;
+        }
+
+      gtk_tree_row_reference_inserted (G_OBJECT (data), row_path);
+      gtk_tree_model_ref_node (model, &row_iter);
+
+      if (node == NULL)
+        node = _gtk_rbtree_insert_before (tree, _gtk_rbtree_find_count (tree, 1), initial_height, FALSE);
+      else
+        node = _gtk_rbtree_insert_after (tree, node, initial_height, FALSE);
+
+      if (height > 0)
+        _gtk_rbtree_node_mark_valid (tree, node);
+
+      _gtk_tree_view_accessible_add (tree_view, tree, node);
+    }
+
+  gtk_tree_path_free (row_path);
+
+  if (height > 0)
+    gtk_widget_queue_resize (GTK_WIDGET (tree_view));
+  else
+    install_presize_handler (tree_view);
+
+  tree_view->priv->in_rows_inserted = TRUE;
+  g_signal_handlers_block_by_func (model, gtk_tree_view_row_inserted, tree_view);
+}
+
+static void
+gtk_tree_view_rows_inserted_after (GtkTreeModel *model,
+				   GtkTreePath  *path,
+				   GtkTreeIter  *iter,
+				   gint          n_rows,
+				   gpointer      data)
+{
+  GtkTreeView *tree_view = (GtkTreeView *) data;
+
+  if (!tree_view->priv->in_rows_inserted)
+    return;
+
+  tree_view->priv->in_rows_inserted = FALSE;
+  g_signal_handlers_unblock_by_func (model, gtk_tree_view_row_inserted, tree_view);
+}
+
 static void
 gtk_tree_view_row_has_child_toggled (GtkTreeModel *model,
 				     GtkTreePath  *path,
@@ -9259,6 +9607,11 @@ gtk_tree_view_row_deleted (GtkTreeModel *model,
 
   gtk_tree_row_reference_deleted (G_OBJECT (data), path);
 
+  if (tree_view->priv->search_index &&
+      gtk_tree_view_search_index_structure_changed (tree_view))
+    _gtk_prefix_index_remove (tree_view->priv->search_index,
+                              gtk_tree_path_get_indices (path)[0]);
+
   if (_gtk_tree_view_find_node (tree_view, path, &tree, &node))
     return;
 
@@ -9399,6 +9752,14 @@ gtk_tree_view_rows_reordered (GtkTreeModel *model,
 				    iter,
 				    new_order);
 
+  if (tree_view->priv->search_index)
+    {
+      if (_gtk_prefix_index_get_n_rows (tree_view->priv->search_index) == (guint) len)
+        _gtk_prefix_index_reorder (tree_view->priv->search_index, new_order, len);
+      else
+        gtk_tree_view_drop_search_index (tree_view);
+    }
+
   if (_gtk_tree_view_find_node (tree_view,
 				parent,
 				&tree,
@@ -9573,6 +9934,8 @@ gtk_tree_view_build_tree (GtkTreeView *tree_view,
 	      _gtk_rbtree_node_mark_valid (tree, temp);
 	    }
         }
+      else if (tree_view->priv->estimated_height > 0)
+        _gtk_rbtree_node_set_height (tree, temp, tree_view->priv->estimated_height);
 
       if (tree_view->priv->is_list)
         continue;
@@ -11453,6 +11816,12 @@ gtk_tree_view_set_model (GtkTreeView  *tree_view,
       g_signal_handlers_disconnect_by_func (tree_view->priv->model,
 					    gtk_tree_view_row_inserted,
 					    tree_view);
+      g_signal_handlers_disconnect_by_func (tree_view->priv->model,
+					    gtk_tree_view_rows_inserted,
+					    tree_view);
+      g_signal_handlers_disconnect_by_func (tree_view->priv->model,
+					    gtk_tree_view_rows_inserted_after,
+					    tree_view);
       g_signal_handlers_disconnect_by_func (tree_view->priv->model,
 					    gtk_tree_view_row_has_child_toggled,
 					    tree_view);
@@ -11484,8 +11853,10 @@ gtk_tree_view_set_model (GtkTreeView  *tree_view,
       g_object_unref (tree_view->priv->model);
 
       tree_view->priv->search_column = -1;
+      gtk_tree_view_drop_search_index (tree_view);
       tree_view->priv->fixed_height_check = 0;
       tree_view->priv->fixed_height = -1;
+      tree_view->priv->estimated_height = -1;
       tree_view->priv->dy = tree_view->priv->top_row_dy = 0;
     }
 
@@ -11521,6 +11892,14 @@ gtk_tree_view_set_model (GtkTreeView  *tree_view,
 			"row-inserted",
 			G_CALLBACK (gtk_tree_view_row_inserted),
 			tree_view);
+      g_signal_connect (tree_view->priv->model,
+			"rows-inserted",
+			G_CALLBACK (gtk_tree_view_rows_inserted),
+			tree_view);
+      g_signal_connect_after (tree_view->priv->model,
+			      "rows-inserted",
+			      G_CALLBACK (gtk_tree_view_rows_inserted_after),
+			      tree_view);
       g_signal_connect (tree_view->priv->model,
 			"row-has-child-toggled",
 			G_CALLBACK (gtk_tree_view_row_has_child_toggled),
@@ -14818,6 +15197,59 @@ gtk_tree_view_get_enable_search (GtkTreeView *tree_view)
   return tree_view->priv->enable_search;
 }
 
+/**
+ * gtk_tree_view_set_enable_search_index:
+ * @tree_view: A #GtkTreeView
+ * @enable: %TRUE to keep an index of the search column
+ *
+ * If @enable is set, interactive search keeps a sorted index of the
+ * case-folded strings of the search column, so that finding the rows
+ * that start with the typed text does not need to look at every row.
+ * The index is built on the first search and kept up to date as the
+ * model changes, at the cost of memory for a copy of every string.
+ *
+ * The index is only used for models with the %GTK_TREE_MODEL_LIST_ONLY
+ * flag, and only with the default search equal function.
+ *
+ * Since: 3.90
+ */
+void
+gtk_tree_view_set_enable_search_index (GtkTreeView *tree_view,
+                                       gboolean     enable)
+{
+  g_return_if_fail (GTK_IS_TREE_VIEW (tree_view));
+
+  enable = !!enable;
+
+  if (tree_view->priv->enable_search_index == enable)
+    return;
+
+  tree_view->priv->enable_search_index = enable;
+  if (!enable)
+    gtk_tree_view_drop_search_index (tree_view);
+
+  g_object_notify_by_pspec (G_OBJECT (tree_view), tree_view_props[PROP_ENABLE_SEARCH_INDEX]);
+}
+
+/**
+ * gtk_tree_view_get_enable_search_index:
+ * @tree_view: A #GtkTreeView
+ *
+ * Returns whether interactive search keeps an index of the search column.
+ * See gtk_tree_view_set_enable_search_index().
+ *
+ * Returns: %TRUE if the search index is enabled
+ *
+ * Since: 3.90
+ */
+gboolean
+gtk_tree_view_get_enable_search_index (GtkTreeView *tree_view)
+{
+  g_return_val_if_fail (GTK_IS_TREE_VIEW (tree_view), FALSE);
+
+  return tree_view->priv->enable_search_index;
+}
+
 
 /**
  * gtk_tree_view_get_search_column:
@@ -14861,6 +15293,7 @@ gtk_tree_view_set_search_column (GtkTreeView *tree_view,
     return;
 
   tree_view->priv->search_column = column;
+  gtk_tree_view_drop_search_index (tree_view);
   g_object_notify_by_pspec (G_OBJECT (tree_view), tree_view_props[PROP_SEARCH_COLUMN]);
 }
 
@@ -14909,6 +15342,90 @@ gtk_tree_view_set_search_equal_func (GtkTreeView                *tree_view,
   tree_view->priv->search_destroy = search_destroy;
   if (tree_view->priv->search_equal_func == NULL)
     tree_view->priv->search_equal_func = gtk_tree_view_search_equal_func;
+
+  gtk_tree_view_drop_search_index (tree_view);
+}
+
+typedef struct
+{
+  GtkTreeView *tree_view;
+  const gchar *key;
+  GList *matches;
+} SearchMatchesData;
+
+static gboolean
+gtk_tree_view_search_matches_helper (GtkTreeModel *model,
+                                     GtkTreePath  *path,
+                                     GtkTreeIter  *iter,
+                                     gpointer      user_data)
+{
+  SearchMatchesData *data = user_data;
+  GtkTreeViewPrivate *priv = data->tree_view->priv;
+
+  if (!priv->search_equal_func (model, priv->search_column, data->key,
+                                iter, priv->search_user_data))
+    data->matches = g_list_prepend (data->matches, gtk_tree_path_copy (path));
+
+  return FALSE;
+}
+
+/**
+ * gtk_tree_view_get_search_matches:
+ * @tree_view: A #GtkTreeView
+ * @key: the text to search for
+ *
+ * Finds all rows of the model that interactive search would consider
+ * matches for @key, for example to highlight them. Rows inside
+ * collapsed parents are included.
+ *
+ * If the search index is enabled and can be used, see
+ * gtk_tree_view_set_enable_search_index(), this does not need to look
+ * at every row.
+ *
+ * Returns: (element-type GtkTreePath) (transfer full): the paths of the
+ *   matching rows, in model order. Free with
+ *   `g_list_free_full (list, (GDestroyNotify) gtk_tree_path_free)`.
+ *
+ * Since: 3.90
+ */
+GList *
+gtk_tree_view_get_search_matches (GtkTreeView *tree_view,
+                                  const gchar *key)
+{
+  GtkTreeViewPrivate *priv;
+  GtkPrefixIndex *index;
+  SearchMatchesData data;
+
+  g_return_val_if_fail (GTK_IS_TREE_VIEW (tree_view), NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+
+  priv = tree_view->priv;
+
+  if (priv->model == NULL || priv->search_column < 0)
+    return NULL;
+
+  data.tree_view = tree_view;
+  data.key = key;
+  data.matches = NULL;
+
+  index = gtk_tree_view_get_search_index (tree_view);
+  if (index != NULL)
+    {
+      guint *positions;
+      guint n_positions, i;
+
+      positions = _gtk_prefix_index_lookup (index, key, &n_positions);
+      for (i = n_positions; i > 0; i--)
+        data.matches = g_list_prepend (data.matches,
+                                       gtk_tree_path_new_from_indices (positions[i - 1], -1));
+      g_free (positions);
+
+      return data.matches;
+    }
+
+  gtk_tree_model_foreach (priv->model, gtk_tree_view_search_matches_helper, &data);
+
+  return g_list_reverse (data.matches);
 }
 
 /**
@@ -15394,19 +15911,15 @@ gtk_tree_view_search_move (GtkWidget   *window,
     }
 }
 
-static gboolean
-gtk_tree_view_search_equal_func (GtkTreeModel *model,
-				 gint          column,
-				 const gchar  *key,
-				 GtkTreeIter  *iter,
-				 gpointer      search_data)
+/* Returns the value of @column in the row as a newly allocated string,
+ * or %NULL if it can't be converted.
+ */
+static gchar *
+gtk_tree_view_search_get_string (GtkTreeModel *model,
+                                 GtkTreeIter  *iter,
+                                 gint          column)
 {
-  gboolean retval = TRUE;
-  const gchar *str;
-  gchar *normalized_string;
-  gchar *normalized_key;
-  gchar *case_normalized_string = NULL;
-  gchar *case_normalized_key = NULL;
+  gchar *str;
   GValue value = G_VALUE_INIT;
   GValue transformed = G_VALUE_INIT;
 
@@ -15417,17 +15930,34 @@ gtk_tree_view_search_equal_func (GtkTreeModel *model,
   if (!g_value_transform (&value, &transformed))
     {
       g_value_unset (&value);
-      return TRUE;
+      return NULL;
     }
 
   g_value_unset (&value);
 
-  str = g_value_get_string (&transformed);
+  str = g_value_dup_string (&transformed);
+  g_value_unset (&transformed);
+
+  return str;
+}
+
+static gboolean
+gtk_tree_view_search_equal_func (GtkTreeModel *model,
+				 gint          column,
+				 const gchar  *key,
+				 GtkTreeIter  *iter,
+				 gpointer      search_data)
+{
+  gboolean retval = TRUE;
+  gchar *str;
+  gchar *normalized_string;
+  gchar *normalized_key;
+  gchar *case_normalized_string = NULL;
+  gchar *case_normalized_key = NULL;
+
+  str = gtk_tree_view_search_get_string (model, iter, column);
   if (!str)
-    {
-      g_value_unset (&transformed);
-      return TRUE;
-    }
+    return TRUE;
 
   normalized_string = g_utf8_normalize (str, -1, G_NORMALIZE_ALL);
   normalized_key = g_utf8_normalize (key, -1, G_NORMALIZE_ALL);
@@ -15441,7 +15971,7 @@ gtk_tree_view_search_equal_func (GtkTreeModel *model,
         retval = FALSE;
     }
 
-  g_value_unset (&transformed);
+  g_free (str);
   g_free (normalized_key);
   g_free (normalized_string);
   g_free (case_normalized_key);
@@ -15450,6 +15980,106 @@ gtk_tree_view_search_equal_func (GtkTreeModel *model,
   return retval;
 }
 
+static void
+gtk_tree_view_drop_search_index (GtkTreeView *tree_view)
+{
+  g_clear_pointer (&tree_view->priv->search_index, _gtk_prefix_index_free);
+  tree_view->priv->search_index_changes = 0;
+}
+
+/* Called before a row is inserted or deleted. Returns whether the
+ * search index should be updated; it is dropped instead when there
+ * were many changes since the last search.
+ */
+static gboolean
+gtk_tree_view_search_index_structure_changed (GtkTreeView *tree_view)
+{
+  if (++tree_view->priv->search_index_changes <= GTK_TREE_VIEW_SEARCH_INDEX_MAX_CHANGES)
+    return TRUE;
+
+  gtk_tree_view_drop_search_index (tree_view);
+
+  return FALSE;
+}
+
+/* The index is only used where it gives the same results as the
+ * default search: for lists, with the default equal func.
+ */
+static GtkPrefixIndex *
+gtk_tree_view_get_search_index (GtkTreeView *tree_view)
+{
+  GtkTreeViewPrivate *priv = tree_view->priv;
+  GtkTreeIter iter;
+  gchar *string;
+
+  if (!priv->enable_search_index ||
+      priv->model == NULL ||
+      priv->search_column < 0 ||
+      priv->search_equal_func != gtk_tree_view_search_equal_func ||
+      !(gtk_tree_model_get_flags (priv->model) & GTK_TREE_MODEL_LIST_ONLY))
+    return NULL;
+
+  priv->search_index_changes = 0;
+
+  if (priv->search_index != NULL)
+    return priv->search_index;
+
+  priv->search_index = _gtk_prefix_index_new ();
+
+  if (gtk_tree_model_get_iter_first (priv->model, &iter))
+    {
+      do
+        {
+          string = gtk_tree_view_search_get_string (priv->model, &iter, priv->search_column);
+          _gtk_prefix_index_append (priv->search_index, string);
+          g_free (string);
+        }
+      while (gtk_tree_model_iter_next (priv->model, &iter));
+    }
+
+  return priv->search_index;
+}
+
+/* Does what gtk_tree_view_search_iter() does when starting at the
+ * first row, using the search index.
+ */
+static gboolean
+gtk_tree_view_search_index_select (GtkTreeView      *tree_view,
+                                   GtkPrefixIndex   *index,
+                                   GtkTreeSelection *selection,
+                                   const gchar      *text,
+                                   gint             *count,
+                                   gint              n)
+{
+  GtkTreePath *path;
+  GtkTreeIter iter;
+  guint *matches;
+  guint n_matches;
+
+  matches = _gtk_prefix_index_lookup (index, text, &n_matches);
+
+  if (n < 1 || (guint) n > n_matches)
+    {
+      *count += n_matches;
+      g_free (matches);
+      return FALSE;
+    }
+
+  *count += n;
+
+  path = gtk_tree_path_new_from_indices (matches[n - 1], -1);
+  gtk_tree_model_get_iter (tree_view->priv->model, &iter, path);
+
+  gtk_tree_view_scroll_to_cell (tree_view, path, NULL, TRUE, 0.5, 0.0);
+  gtk_tree_selection_select_iter (selection, &iter);
+  gtk_tree_view_real_set_cursor (tree_view, path, CLAMP_NODE);
+
+  gtk_tree_path_free (path);
+  g_free (matches);
+
+  return TRUE;
+}
+
 static gboolean
 gtk_tree_view_search_iter (GtkTreeModel     *model,
 			   GtkTreeSelection *selection,
@@ -15461,9 +16091,16 @@ gtk_tree_view_search_iter (GtkTreeModel     *model,
   GtkRBTree *tree = NULL;
   GtkRBNode *node = NULL;
   GtkTreePath *path;
+  GtkPrefixIndex *index;
 
   GtkTreeView *tree_view = gtk_tree_selection_get_tree_view (selection);
 
+  /* All callers start searching at the first row */
+  index = gtk_tree_view_get_search_index (tree_view);
+  if (index != NULL)
+    return gtk_tree_view_search_index_select (tree_view, index, selection,
+                                              text, count, n);
+
   path = gtk_tree_model_get_path (model, iter);
   _gtk_tree_view_find_node (tree_view, path, &tree, &node);
 
@@ -452,6 +452,14 @@ void                       gtk_tree_view_set_search_equal_func (GtkTreeView
 								GtkTreeViewSearchEqualFunc  search_equal_func,
 								gpointer                    search_user_data,
 								GDestroyNotify              search_destroy);
+GDK_AVAILABLE_IN_3_90
+void                       gtk_tree_view_set_enable_search_index (GtkTreeView              *tree_view,
+								  gboolean                  enable);
+GDK_AVAILABLE_IN_3_90
+gboolean                   gtk_tree_view_get_enable_search_index (GtkTreeView              *tree_view);
+GDK_AVAILABLE_IN_3_90
+GList                     *gtk_tree_view_get_search_matches    (GtkTreeView                *tree_view,
+								const gchar                *key);
 
 GDK_AVAILABLE_IN_ALL
 GtkEntry                     *gtk_tree_view_get_search_entry         (GtkTreeView                   *tree_view);
@@ -0,0 +1,447 @@
+/* gtkvirtualrange.c
+ * Copyright (C) 2017 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkvirtualrangeprivate.h"
+
+#include <string.h>
+
+/* GtkVirtualRange keeps children only for a window of a model, for
+ * GtkListBox and GtkFlowBox with a virtualized model. The window is
+ * moved after the box scrolled: children that scrolled out at one end
+ * are moved to the other end and bound to their new item, so that
+ * scrolling does not create widgets. Children that are not needed
+ * anymore are kept for reuse.
+ *
+ * Selection and cursor are kept as model positions; the children just
+ * show the state of the position they are bound to. How that looks,
+ * and how children are measured and laid out, is up to the box.
+ */
+
+void
+_gtk_virtual_range_init (GtkVirtualRange            *range,
+                         GtkWidget                  *box,
+                         const GtkVirtualRangeFuncs *funcs,
+                         GSequence                  *children,
+                         guint                       initial_children)
+{
+  memset (range, 0, sizeof (GtkVirtualRange));
+
+  range->box = box;
+  range->funcs = funcs;
+  range->children = children;
+  range->initial_children = initial_children;
+  range->cursor_position = -1;
+  range->selected_position = -1;
+}
+
+void
+_gtk_virtual_range_bind (GtkVirtualRange *range,
+                         GListModel      *model)
+{
+  range->model = model;
+  range->n_items = g_list_model_get_n_items (model);
+  range->selected_positions = _gtk_bitmask_new ();
+  range->recycled_children = g_ptr_array_new_with_free_func (g_object_unref);
+}
+
+/* Forgets the model; the box removes the children */
+void
+_gtk_virtual_range_clear (GtkVirtualRange *range)
+{
+  if (range->update_id != 0)
+    {
+      gtk_widget_remove_tick_callback (range->box, range->update_id);
+      range->update_id = 0;
+    }
+
+  g_clear_pointer (&range->selected_positions, _gtk_bitmask_free);
+  g_clear_pointer (&range->recycled_children, g_ptr_array_unref);
+
+  range->model = NULL;
+  range->n_items = 0;
+  range->first_position = 0;
+  range->top = 0;
+  range->estimated_size = 0;
+  range->cursor_position = -1;
+  range->selected_position = -1;
+}
+
+guint
+_gtk_virtual_range_get_position (GtkVirtualRange *range,
+                                 GSequenceIter   *iter)
+{
+  return range->first_position + g_sequence_iter_get_position (iter);
+}
+
+static gint
+get_child_size (GtkVirtualRange *range,
+                GtkWidget       *child)
+{
+  if (range->funcs->get_child_size == NULL)
+    return 0;
+
+  return range->funcs->get_child_size (range->box, child);
+}
+
+static void
+sync_children (GtkVirtualRange *range)
+{
+  GSequenceIter *iter;
+  guint i;
+
+  for (iter = g_sequence_get_begin_iter (range->children), i = range->first_position;
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter), i++)
+    range->funcs->sync_child (range->box, g_sequence_get (iter), i);
+}
+
+static void
+bind_child (GtkVirtualRange *range,
+            GtkWidget       *child,
+            guint            old_position,
+            guint            position)
+{
+  const GtkVirtualRangeFuncs *funcs = range->funcs;
+  gpointer item;
+
+  funcs->release_child (range->box, child, old_position);
+
+  item = g_list_model_get_item (range->model, position);
+  funcs->bind_child (range->box, child, item);
+  g_object_unref (item);
+
+  funcs->sync_child (range->box, child, position);
+  if (funcs->measure_child)
+    funcs->measure_child (range->box, child);
+}
+
+static void
+add_child (GtkVirtualRange *range,
+           guint            position,
+           gboolean         prepend)
+{
+  const GtkVirtualRangeFuncs *funcs = range->funcs;
+  GPtrArray *recycled = range->recycled_children;
+  GtkWidget *child;
+  gpointer item;
+
+  item = g_list_model_get_item (range->model, position);
+
+  if (recycled->len > 0)
+    {
+      child = g_object_ref (g_ptr_array_index (recycled, recycled->len - 1));
+      g_ptr_array_remove_index_fast (recycled, recycled->len - 1);
+      funcs->bind_child (range->box, child, item);
+    }
+  else
+    child = funcs->create_child (range->box, item);
+
+  g_object_unref (item);
+
+  funcs->insert_child (range->box, child, prepend);
+  g_object_unref (child);
+
+  funcs->sync_child (range->box, child, position);
+  if (funcs->measure_child)
+    funcs->measure_child (range->box, child);
+}
+
+static void
+recycle_child (GtkVirtualRange *range,
+               GtkWidget       *child,
+               guint            position)
+{
+  range->funcs->release_child (range->box, child, position);
+
+  g_ptr_array_add (range->recycled_children, g_object_ref (child));
+  range->funcs->remove_child (range->box, child);
+}
+
+/* Binds all children again, to the items first and up */
+static void
+rebind (GtkVirtualRange *range,
+        guint            first,
+        guint            last)
+{
+  GSequenceIter *iter;
+  GtkWidget *child;
+  guint old_first, i;
+
+  old_first = range->first_position;
+  range->first_position = first;
+
+  iter = g_sequence_get_begin_iter (range->children);
+  for (i = 0; !g_sequence_iter_is_end (iter); i++)
+    {
+      child = g_sequence_get (iter);
+      iter = g_sequence_iter_next (iter);
+
+      if (first + i < last)
+        bind_child (range, child, old_first + i, first + i);
+      else
+        recycle_child (range, child, old_first + i);
+    }
+
+  for (; first + i < last; i++)
+    add_child (range, first + i, FALSE);
+}
+
+void
+_gtk_virtual_range_set_range (GtkVirtualRange *range,
+                              guint            first,
+                              guint            last)
+{
+  GtkWidget *child;
+  guint old_first, old_last;
+  gint top;
+
+  old_first = range->first_position;
+  old_last = old_first + g_sequence_get_length (range->children);
+
+  if (first == old_first && last == old_last)
+    return;
+
+  if (last <= old_first || first >= old_last)
+    {
+      rebind (range, first, last);
+      top = first * range->estimated_size;
+    }
+  else
+    {
+      top = range->top;
+
+      /* Children that scrolled out at the top */
+      while (old_first < first)
+        {
+          child = g_sequence_get (g_sequence_get_begin_iter (range->children));
+          top += get_child_size (range, child);
+          range->first_position++;
+
+          if (old_last < last)
+            {
+              range->funcs->move_child (range->box, child, TRUE);
+              bind_child (range, child, old_first, old_last);
+              old_last++;
+            }
+          else
+            recycle_child (range, child, old_first);
+
+          old_first++;
+        }
+
+      /* Children that scrolled out at the bottom */
+      while (old_last > last)
+        {
+          child = g_sequence_get (g_sequence_iter_prev (g_sequence_get_end_iter (range->children)));
+
+          if (old_first > first)
+            {
+              range->first_position--;
+              range->funcs->move_child (range->box, child, FALSE);
+              bind_child (range, child, old_last - 1, old_first - 1);
+              top -= get_child_size (range, child);
+              old_first--;
+            }
+          else
+            recycle_child (range, child, old_last - 1);
+
+          old_last--;
+        }
+
+      while (old_first > first)
+        {
+          old_first--;
+          range->first_position--;
+          add_child (range, old_first, TRUE);
+          top -= range->estimated_size;
+        }
+
+      while (old_last < last)
+        {
+          add_child (range, old_last, FALSE);
+          old_last++;
+        }
+    }
+
+  range->first_position = first;
+
+  /* Estimates went wrong, start over from the estimate */
+  if (first == 0 || top < 0)
+    top = first * range->estimated_size;
+  range->top = top;
+
+  gtk_widget_queue_resize (range->box);
+}
+
+/* Makes sure there is a child for @position */
+GtkWidget *
+_gtk_virtual_range_realize_position (GtkVirtualRange *range,
+                                     guint            position)
+{
+  guint n_children, first;
+
+  n_children = g_sequence_get_length (range->children);
+  if (position < range->first_position || position >= range->first_position + n_children)
+    {
+      n_children = MAX (n_children, range->initial_children);
+      first = position > n_children / 2 ? position - n_children / 2 : 0;
+      _gtk_virtual_range_set_range (range, first, MIN (first + n_children, range->n_items));
+    }
+
+  return g_sequence_get (g_sequence_get_iter_at_pos (range->children,
+                                                     position - range->first_position));
+}
+
+static gint
+shift_position (gint  position,
+                guint changed,
+                guint removed,
+                guint added)
+{
+  if (position < (gint) changed)
+    return position;
+  if (position < (gint) (changed + removed))
+    return -1;
+
+  return position - removed + added;
+}
+
+/* The box drops its pointers to the anchor and cursor children before,
+ * and stores their positions in the range; the children are found
+ * again with sync_child().
+ */
+void
+_gtk_virtual_range_items_changed (GtkVirtualRange *range,
+                                  guint            position,
+                                  guint            removed,
+                                  guint            added)
+{
+  GtkBitmask *after, *moved;
+  guint n_children, first;
+
+  range->n_items = range->n_items - removed + added;
+
+  if (!_gtk_bitmask_is_empty (range->selected_positions))
+    {
+      /* Drop the selection from @position on, then put back
+       * what followed the removed items, moved to the new place
+       */
+      after = _gtk_bitmask_shift_right (_gtk_bitmask_copy (range->selected_positions), position);
+      moved = _gtk_bitmask_shift_right (_gtk_bitmask_copy (after), removed);
+      moved = _gtk_bitmask_shift_left (moved, position + added);
+      after = _gtk_bitmask_shift_left (after, position);
+
+      range->selected_positions = _gtk_bitmask_subtract (range->selected_positions, after);
+      range->selected_positions = _gtk_bitmask_union (range->selected_positions, moved);
+
+      _gtk_bitmask_free (after);
+      _gtk_bitmask_free (moved);
+    }
+
+  /* Anchor and cursor follow their items */
+  range->selected_position = shift_position (range->selected_position, position, removed, added);
+  range->cursor_position = shift_position (range->cursor_position, position, removed, added);
+
+  first = range->first_position;
+  n_children = g_sequence_get_length (range->children);
+
+  if (position + removed <= first && removed + added > 0 && position < first)
+    {
+      /* The children still show the same items */
+      range->first_position = first - removed + added;
+      range->top = MAX (range->top + ((gint) added - (gint) removed) * range->estimated_size, 0);
+    }
+  else if (position < first + n_children)
+    {
+      first = MIN (first, range->n_items > 0 ? range->n_items - 1 : 0);
+      rebind (range, first, MIN (first + n_children, range->n_items));
+    }
+  else if (n_children == 0 && range->n_items > 0)
+    rebind (range, 0, MIN (range->n_items, range->initial_children));
+
+  sync_children (range);
+
+  gtk_widget_queue_resize (range->box);
+  _gtk_virtual_range_queue_update (range);
+}
+
+void
+_gtk_virtual_range_select_range (GtkVirtualRange *range,
+                                 guint            position1,
+                                 guint            position2,
+                                 gboolean         modify)
+{
+  GtkBitmask *selection;
+  guint i;
+
+  if (position2 < position1)
+    {
+      i = position1;
+      position1 = position2;
+      position2 = i;
+    }
+
+  if (modify)
+    range->selected_positions = _gtk_bitmask_invert_range (range->selected_positions,
+                                                           position1, position2 + 1);
+  else
+    {
+      selection = _gtk_bitmask_invert_range (_gtk_bitmask_new (), position1, position2 + 1);
+      range->selected_positions = _gtk_bitmask_union (range->selected_positions, selection);
+      _gtk_bitmask_free (selection);
+    }
+
+  sync_children (range);
+}
+
+/* Appends the selected positions to @positions, in order */
+void
+_gtk_virtual_range_get_selected (GtkVirtualRange *range,
+                                 GArray          *positions)
+{
+  guint i;
+
+  for (i = 0;
+       _gtk_bitmask_next_set (range->selected_positions, i, &i) && i < range->n_items;
+       i++)
+    g_array_append_val (positions, i);
+}
+
+static gboolean
+update_cb (GtkWidget     *widget,
+           GdkFrameClock *frame_clock,
+           gpointer       user_data)
+{
+  GtkVirtualRange *range = user_data;
+
+  range->update_id = 0;
+  range->funcs->update (range->box);
+
+  return G_SOURCE_REMOVE;
+}
+
+void
+_gtk_virtual_range_queue_update (GtkVirtualRange *range)
+{
+  if (range->model == NULL || range->update_id != 0)
+    return;
+
+  /* Before the layout of the next frame */
+  range->update_id = gtk_widget_add_tick_callback (range->box, update_cb, range, NULL);
+}
@@ -0,0 +1,124 @@
+/* gtkvirtualrangeprivate.h
+ * Copyright (C) 2017 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_VIRTUAL_RANGE_PRIVATE_H__
+#define __GTK_VIRTUAL_RANGE_PRIVATE_H__
+
+#include <gio/gio.h>
+
+#include "gtkwidget.h"
+#include "gtkbitmaskprivate.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GtkVirtualRange      GtkVirtualRange;
+typedef struct _GtkVirtualRangeFuncs GtkVirtualRangeFuncs;
+
+/* What the range needs from the box. The box keeps its children in
+ * a GSequence, in the order of the items they show.
+ */
+struct _GtkVirtualRangeFuncs
+{
+  /* Returns a new child for @item, with a full reference */
+  GtkWidget * (* create_child)   (GtkWidget *box,
+                                  gpointer   item);
+  /* Makes an existing child show @item */
+  void        (* bind_child)     (GtkWidget *box,
+                                  GtkWidget *child,
+                                  gpointer   item);
+  void        (* insert_child)   (GtkWidget *box,
+                                  GtkWidget *child,
+                                  gboolean   prepend);
+  /* Takes @child out of the box, to be bound again later */
+  void        (* remove_child)   (GtkWidget *box,
+                                  GtkWidget *child);
+  void        (* move_child)     (GtkWidget *box,
+                                  GtkWidget *child,
+                                  gboolean   to_end);
+  /* Called before @child stops showing @position */
+  void        (* release_child)  (GtkWidget *box,
+                                  GtkWidget *child,
+                                  guint      position);
+  /* Makes @child show the selection and cursor state of @position */
+  void        (* sync_child)     (GtkWidget *box,
+                                  GtkWidget *child,
+                                  guint      position);
+  /* Optional; called after @child was bound to a new item */
+  void        (* measure_child)  (GtkWidget *box,
+                                  GtkWidget *child);
+  /* Optional; the height of @child, for boxes that stack their children */
+  gint        (* get_child_size) (GtkWidget *box,
+                                  GtkWidget *child);
+  /* Moves the range to the visible area, see _gtk_virtual_range_queue_update() */
+  void        (* update)         (GtkWidget *box);
+};
+
+/* The children of the box show the items first_position and up.
+ * Selection and cursor are kept as model positions. top and
+ * estimated_size are only kept with get_child_size(): the y of the
+ * first child, and the height of items without a child.
+ */
+struct _GtkVirtualRange
+{
+  GtkWidget                  *box;
+  const GtkVirtualRangeFuncs *funcs;
+  GSequence                  *children;
+  guint                       initial_children;
+
+  GListModel                 *model;
+  guint                       n_items;
+  guint                       first_position;
+  gint                        top;
+  gint                        estimated_size;
+  GtkBitmask                 *selected_positions;
+  gint                        cursor_position;
+  gint                        selected_position;
+  GPtrArray                  *recycled_children;
+  guint                       update_id;
+};
+
+void        _gtk_virtual_range_init                (GtkVirtualRange            *range,
+                                                    GtkWidget                  *box,
+                                                    const GtkVirtualRangeFuncs *funcs,
+                                                    GSequence                  *children,
+                                                    guint                       initial_children);
+void        _gtk_virtual_range_bind                (GtkVirtualRange            *range,
+                                                    GListModel                 *model);
+void        _gtk_virtual_range_clear               (GtkVirtualRange            *range);
+
+guint       _gtk_virtual_range_get_position        (GtkVirtualRange            *range,
+                                                    GSequenceIter              *iter);
+void        _gtk_virtual_range_set_range           (GtkVirtualRange            *range,
+                                                    guint                       first,
+                                                    guint                       last);
+GtkWidget * _gtk_virtual_range_realize_position    (GtkVirtualRange            *range,
+                                                    guint                       position);
+void        _gtk_virtual_range_items_changed       (GtkVirtualRange            *range,
+                                                    guint                       position,
+                                                    guint                       removed,
+                                                    guint                       added);
+void        _gtk_virtual_range_select_range        (GtkVirtualRange            *range,
+                                                    guint                       position1,
+                                                    guint                       position2,
+                                                    gboolean                    modify);
+void        _gtk_virtual_range_get_selected        (GtkVirtualRange            *range,
+                                                    GArray                     *positions);
+void        _gtk_virtual_range_queue_update        (GtkVirtualRange            *range);
+
+G_END_DECLS
+
+#endif /* __GTK_VIRTUAL_RANGE_PRIVATE_H__ */
@@ -30,6 +30,7 @@
 #include "gtkimage.h"
 #include "gtkadjustment.h"
 #include "gtkbox.h"
+#include "gtkiconthemeprivate.h"
 
 #ifdef GDK_WINDOWING_X11
 #include "x11/gdkx.h"
@@ -60,6 +61,7 @@ struct _GtkInspectorGeneralPrivate
   GtkWidget *display_box;
   GtkWidget *gl_box;
   GtkWidget *device_box;
+  GtkWidget *icon_cache_box;
   GtkWidget *gtk_version;
   GtkWidget *gdk_backend;
   GtkWidget *gl_version;
@@ -635,6 +637,56 @@ init_device (GtkInspectorGeneral *gen)
   populate_seats (gen);
 }
 
+static void
+populate_icon_cache (GtkInspectorGeneral *gen)
+{
+  GtkIconThemeCacheStats stats;
+  GtkListBox *list;
+  GList *children, *l;
+  gchar *value, *size, *budget;
+
+  list = GTK_LIST_BOX (gen->priv->icon_cache_box);
+  children = gtk_container_get_children (GTK_CONTAINER (list));
+  for (l = children; l; l = l->next)
+    gtk_widget_destroy (GTK_WIDGET (l->data));
+  g_list_free (children);
+
+  gtk_icon_theme_get_cache_stats (gtk_icon_theme_get_default (), &stats);
+
+  value = g_strdup_printf ("%u", stats.n_cached);
+  add_label_row (gen, list, "Cached icons", value, 0);
+  g_free (value);
+
+  size = g_format_size (stats.unused_size);
+  budget = g_format_size (stats.budget);
+  value = g_strdup_printf ("%u, %s of %s", stats.n_unused, size, budget);
+  add_label_row (gen, list, "Kept unused", value, 10);
+  g_free (value);
+  g_free (size);
+  g_free (budget);
+
+  value = g_strdup_printf ("%u", stats.hits);
+  add_label_row (gen, list, "Hits", value, 10);
+  g_free (value);
+
+  value = g_strdup_printf ("%u", stats.misses);
+  add_label_row (gen, list, "Misses", value, 10);
+  g_free (value);
+
+  value = g_strdup_printf ("%u", stats.evictions);
+  add_label_row (gen, list, "Evictions", value, 10);
+  g_free (value);
+}
+
+static void
+init_icon_cache (GtkInspectorGeneral *gen)
+{
+  /* the counters change all the time, so update them when shown */
+  g_signal_connect_swapped (gen, "map", G_CALLBACK (populate_icon_cache), gen);
+
+  populate_icon_cache (gen);
+}
+
 static void
 gtk_inspector_general_init (GtkInspectorGeneral *gen)
 {
@@ -645,6 +697,7 @@ gtk_inspector_general_init (GtkInspectorGeneral *gen)
   init_display (gen);
   init_gl (gen);
   init_device (gen);
+  init_icon_cache (gen);
 }
 
 static gboolean
@@ -661,6 +714,10 @@ keynav_failed (GtkWidget *widget, GtkDirectionType direction, GtkInspectorGenera
     next = gen->priv->gl_box;
   else if (direction == GTK_DIR_DOWN && widget == gen->priv->gl_box)
     next = gen->priv->device_box;
+  else if (direction == GTK_DIR_DOWN && widget == gen->priv->device_box)
+    next = gen->priv->icon_cache_box;
+  else if (direction == GTK_DIR_UP && widget == gen->priv->icon_cache_box)
+    next = gen->priv->device_box;
   else if (direction == GTK_DIR_UP && widget == gen->priv->device_box)
     next = gen->priv->gl_box;
   else if (direction == GTK_DIR_UP && widget == gen->priv->gl_box)
@@ -713,6 +770,7 @@ gtk_inspector_general_constructed (GObject *object)
    g_signal_connect (gen->priv->display_box, "keynav-failed", G_CALLBACK (keynav_failed), gen);
    g_signal_connect (gen->priv->gl_box, "keynav-failed", G_CALLBACK (keynav_failed), gen);
    g_signal_connect (gen->priv->device_box, "keynav-failed", G_CALLBACK (keynav_failed), gen);
+   g_signal_connect (gen->priv->icon_cache_box, "keynav-failed", G_CALLBACK (keynav_failed), gen);
 }
 
 static void
@@ -744,6 +802,7 @@ gtk_inspector_general_class_init (GtkInspectorGeneralClass *klass)
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorGeneral, display_composited);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorGeneral, display_rgba);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorGeneral, device_box);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorGeneral, icon_cache_box);
 }
 
 // vim: set et sw=2 ts=2:
@@ -0,0 +1,194 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Measures how long it takes to syntax highlight a large buffer,
+ * applying one tag at a time and with gtk_text_buffer_apply_tag_ranges().
+ */
+
+#include <gtk/gtk.h>
+#include <string.h>
+
+#define N_LINES 50000
+
+static const char *keywords[] = {
+  "static", "void", "int", "return", "if", "else", "for", "while", "const", "char"
+};
+
+static char *
+create_source (void)
+{
+  GString *str;
+  int i;
+
+  str = g_string_new (NULL);
+
+  for (i = 0; i < N_LINES; i++)
+    {
+      switch (i % 5)
+        {
+        case 0:
+          g_string_append_printf (str, "/* Comment number %d */\n", i);
+          break;
+        case 1:
+          g_string_append_printf (str, "static int foo_%d (const char *s)\n", i);
+          break;
+        case 2:
+          g_string_append_printf (str, "  if (s != NULL) return %d; else return \"%d\";\n", i, i);
+          break;
+        case 3:
+          g_string_append_printf (str, "  for (int j = 0; j < %d; j++) while (bar (j));\n", i);
+          break;
+        default:
+          g_string_append (str, "}\n");
+          break;
+        }
+    }
+
+  return g_string_free (str, FALSE);
+}
+
+/* A very simple tokenizer, good enough to produce a realistic
+ * number of tag ranges.
+ */
+static GArray *
+highlight (GtkTextBuffer *buffer,
+           const char    *text)
+{
+  GtkTextTagTable *table;
+  GtkTextTag *keyword_tag, *comment_tag, *string_tag, *number_tag;
+  GArray *ranges;
+  const char *p;
+  int offset;
+
+  table = gtk_text_buffer_get_tag_table (buffer);
+  keyword_tag = gtk_text_tag_table_lookup (table, "keyword");
+  comment_tag = gtk_text_tag_table_lookup (table, "comment");
+  string_tag = gtk_text_tag_table_lookup (table, "string");
+  number_tag = gtk_text_tag_table_lookup (table, "number");
+
+  ranges = g_array_new (FALSE, FALSE, sizeof (GtkTextTagRange));
+
+  /* The source is ASCII, so byte offsets are char offsets */
+  for (p = text; *p; )
+    {
+      GtkTextTagRange range;
+      const char *start = p;
+      GtkTextTag *tag = NULL;
+
+      if (p[0] == '/' && p[1] == '*')
+        {
+          p = strstr (p, "*/") + 2;
+          tag = comment_tag;
+        }
+      else if (*p == '"')
+        {
+          p = strchr (p + 1, '"') + 1;
+          tag = string_tag;
+        }
+      else if (g_ascii_isdigit (*p))
+        {
+          while (g_ascii_isdigit (*p))
+            p++;
+          tag = number_tag;
+        }
+      else if (g_ascii_isalpha (*p) || *p == '_')
+        {
+          guint i;
+
+          while (g_ascii_isalnum (*p) || *p == '_')
+            p++;
+
+          for (i = 0; i < G_N_ELEMENTS (keywords); i++)
+            {
+              if (strlen (keywords[i]) == (gsize) (p - start) &&
+                  strncmp (keywords[i], start, p - start) == 0)
+                tag = keyword_tag;
+            }
+        }
+      else
+        p++;
+
+      if (tag == NULL)
+        continue;
+
+      offset = start - text;
+      range.tag = tag;
+      gtk_text_buffer_get_iter_at_offset (buffer, &range.start, offset);
+      gtk_text_buffer_get_iter_at_offset (buffer, &range.end, offset + (p - start));
+      g_array_append_val (ranges, range);
+    }
+
+  return ranges;
+}
+
+int
+main (int argc, char **argv)
+{
+  GtkWidget *window, *sw, *view;
+  GtkTextBuffer *buffer;
+  GtkTextIter start, end;
+  GArray *ranges;
+  GTimer *timer;
+  char *text;
+  double msec;
+  guint i, j;
+
+  gtk_init (&argc, &argv);
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  gtk_window_set_default_size (GTK_WINDOW (window), 600, 800);
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (window), sw);
+  view = gtk_text_view_new ();
+  gtk_container_add (GTK_CONTAINER (sw), view);
+  gtk_widget_realize (view);
+
+  buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (view));
+  gtk_text_buffer_create_tag (buffer, "keyword", "weight", PANGO_WEIGHT_BOLD, NULL);
+  gtk_text_buffer_create_tag (buffer, "comment", "foreground", "gray", NULL);
+  gtk_text_buffer_create_tag (buffer, "string", "foreground", "red", NULL);
+  gtk_text_buffer_create_tag (buffer, "number", "foreground", "blue", NULL);
+
+  text = create_source ();
+  gtk_text_buffer_set_text (buffer, text, -1);
+
+  timer = g_timer_new ();
+
+  ranges = highlight (buffer, text);
+  g_print ("%d lines, %u tag ranges\n", N_LINES, ranges->len);
+
+  /* We do everything three times, first two as warmup */
+  for (j = 0; j < 3; j++)
+    {
+      gtk_text_buffer_get_bounds (buffer, &start, &end);
+      gtk_text_buffer_remove_all_tags (buffer, &start, &end);
+
+      g_timer_start (timer);
+      for (i = 0; i < ranges->len; i++)
+        {
+          GtkTextTagRange *range = &g_array_index (ranges, GtkTextTagRange, i);
+
+          gtk_text_buffer_apply_tag (buffer, range->tag, &range->start, &range->end);
+        }
+      msec = g_timer_elapsed (timer, NULL) * 1000;
+      if (j == 2)
+        g_print ("gtk_text_buffer_apply_tag:        %.2f msec\n", msec);
+
+      gtk_text_buffer_get_bounds (buffer, &start, &end);
+      gtk_text_buffer_remove_all_tags (buffer, &start, &end);
+
+      g_timer_start (timer);
+      gtk_text_buffer_apply_tag_ranges (buffer,
+                                        (GtkTextTagRange *) ranges->data,
+                                        ranges->len);
+      msec = g_timer_elapsed (timer, NULL) * 1000;
+      if (j == 2)
+        g_print ("gtk_text_buffer_apply_tag_ranges: %.2f msec\n", msec);
+    }
+
+  g_array_unref (ranges);
+  g_free (text);
+  g_timer_destroy (timer);
+  gtk_widget_destroy (window);
+
+  return 0;
+}
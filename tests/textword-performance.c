@@ -0,0 +1,137 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Measures how long it takes to iterate over all words of a large
+ * buffer, the way a word counter or spell checker would.
+ */
+
+#include <gtk/gtk.h>
+
+#define N_LINES 20000
+
+static const char *words[] = {
+  "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing",
+  "elit", "sed", "do", "eiusmod", "tempor", "incididunt", "ut", "labore"
+};
+
+static char *
+create_text (void)
+{
+  GString *str;
+  int i, j;
+
+  str = g_string_new (NULL);
+
+  for (i = 0; i < N_LINES; i++)
+    {
+      for (j = 0; j < 12; j++)
+        {
+          g_string_append (str, words[(i + j * 7) % G_N_ELEMENTS (words)]);
+          g_string_append_c (str, j == 11 ? '.' : ' ');
+        }
+      g_string_append_c (str, '\n');
+    }
+
+  return g_string_free (str, FALSE);
+}
+
+/* Walks forward by words, checking each word the way a spell
+ * checker does before moving on.
+ */
+static int
+count_words (GtkTextBuffer *buffer,
+             GtkTextTag    *tag)
+{
+  GtkTextIter start, end;
+  int n_words = 0;
+
+  gtk_text_buffer_get_start_iter (buffer, &end);
+
+  while (gtk_text_iter_forward_word_end (&end))
+    {
+      start = end;
+      gtk_text_iter_backward_word_start (&start);
+
+      if (!gtk_text_iter_starts_word (&start) || !gtk_text_iter_ends_word (&end))
+        g_error ("Bad word at offset %d", gtk_text_iter_get_offset (&start));
+
+      if (tag != NULL && n_words % 10 == 0)
+        gtk_text_buffer_apply_tag (buffer, tag, &start, &end);
+
+      n_words++;
+    }
+
+  return n_words;
+}
+
+static int
+count_sentences (GtkTextBuffer *buffer)
+{
+  GtkTextIter iter;
+  int n_sentences = 0;
+
+  gtk_text_buffer_get_end_iter (buffer, &iter);
+
+  while (gtk_text_iter_backward_sentence_start (&iter))
+    n_sentences++;
+
+  return n_sentences;
+}
+
+int
+main (int argc, char **argv)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter start, end;
+  GtkTextTag *tag;
+  GTimer *timer;
+  char *text;
+  double msec;
+  int n, i;
+
+  gtk_init (&argc, &argv);
+
+  buffer = gtk_text_buffer_new (NULL);
+  tag = gtk_text_buffer_create_tag (buffer, "misspelled", "underline", PANGO_UNDERLINE_ERROR, NULL);
+
+  text = create_text ();
+  gtk_text_buffer_set_text (buffer, text, -1);
+  g_free (text);
+
+  /* Make sure the chars-changed stamp is not the initial one, as it is
+   * in any buffer that has been edited.
+   */
+  gtk_text_buffer_get_end_iter (buffer, &end);
+  gtk_text_buffer_insert (buffer, &end, " ", 1);
+
+  timer = g_timer_new ();
+
+  /* We do everything three times, first two as warmup */
+  for (i = 0; i < 3; i++)
+    {
+      gtk_text_buffer_get_bounds (buffer, &start, &end);
+      gtk_text_buffer_remove_all_tags (buffer, &start, &end);
+
+      g_timer_start (timer);
+      n = count_words (buffer, NULL);
+      msec = g_timer_elapsed (timer, NULL) * 1000;
+      if (i == 2)
+        g_print ("%d words:                 %.2f msec\n", n, msec);
+
+      g_timer_start (timer);
+      n = count_words (buffer, tag);
+      msec = g_timer_elapsed (timer, NULL) * 1000;
+      if (i == 2)
+        g_print ("%d words, tagging:        %.2f msec\n", n, msec);
+
+      g_timer_start (timer);
+      n = count_sentences (buffer);
+      msec = g_timer_elapsed (timer, NULL) * 1000;
+      if (i == 2)
+        g_print ("%d sentences, backwards:  %.2f msec\n", n, msec);
+    }
+
+  g_timer_destroy (timer);
+  g_object_unref (buffer);
+
+  return 0;
+}
@@ -424,6 +424,114 @@ test_invert_range (void)
     }
 }
 
+static void
+test_shift_hardcoded (void)
+{
+  static const guint shifts[] = { 0, 1, 31, 32, 62, 63, 64, 65, 127, 200 };
+  guint t, s;
+  gsize len;
+  char *ref_str, *zeros;
+  GtkBitmask *bitmask, *ref;
+
+  for (t = 0; t < G_N_ELEMENTS (tests); t++)
+    {
+      len = strlen (tests[t]);
+
+      for (s = 0; s < G_N_ELEMENTS (shifts); s++)
+        {
+          zeros = g_strnfill (shifts[s], '0');
+          ref_str = g_strconcat (tests[t], zeros, NULL);
+          ref = gtk_bitmask_new_parse (ref_str);
+          g_free (ref_str);
+          g_free (zeros);
+
+          bitmask = _gtk_bitmask_copy (masks[t]);
+          bitmask = _gtk_bitmask_shift_left (bitmask, shifts[s]);
+          assert_cmpmasks (bitmask, ref);
+
+          bitmask = _gtk_bitmask_shift_right (bitmask, shifts[s]);
+          assert_cmpmasks (bitmask, masks[t]);
+
+          _gtk_bitmask_free (bitmask);
+          _gtk_bitmask_free (ref);
+
+          ref_str = g_strndup (tests[t], len > shifts[s] ? len - shifts[s] : 0);
+          ref = gtk_bitmask_new_parse (ref_str);
+          g_free (ref_str);
+
+          bitmask = _gtk_bitmask_copy (masks[t]);
+          bitmask = _gtk_bitmask_shift_right (bitmask, shifts[s]);
+          assert_cmpmasks (bitmask, ref);
+
+          _gtk_bitmask_free (bitmask);
+          _gtk_bitmask_free (ref);
+        }
+    }
+}
+
+static void
+test_next_set (void)
+{
+  guint i, j, n, next, index;
+  gboolean found;
+
+  for (i = 0; i < N_RUNS; i++)
+    {
+      GtkBitmask *mask;
+      guint start;
+
+      mask = _gtk_bitmask_new ();
+      n = g_test_rand_int_range (0, N_TRIES);
+      for (j = 0; j < n; j++)
+        mask = _gtk_bitmask_set (mask, g_test_rand_int_range (0, MAX_INDEX), TRUE);
+
+      for (j = 0; j < N_TRIES; j++)
+        {
+          start = g_test_rand_int_range (0, MAX_INDEX + 100);
+          for (next = start; next < MAX_INDEX; next++)
+            {
+              if (_gtk_bitmask_get (mask, next))
+                break;
+            }
+
+          found = _gtk_bitmask_next_set (mask, start, &index);
+          g_assert_cmpint (found, ==, next < MAX_INDEX);
+          if (found)
+            g_assert_cmpuint (index, ==, next);
+        }
+
+      _gtk_bitmask_free (mask);
+    }
+}
+
+static void
+test_next_set_hardcoded (void)
+{
+  guint t, i, n;
+  gsize len;
+
+  for (t = 0; t < G_N_ELEMENTS (tests); t++)
+    {
+      len = strlen (tests[t]);
+
+      n = 0;
+      for (i = 0; i < len; i++)
+        {
+          if (tests[t][i] == '1')
+            n++;
+        }
+
+      /* the set bits, in order, and nothing after the last one */
+      for (i = 0; _gtk_bitmask_next_set (masks[t], i, &i); i++)
+        {
+          g_assert_cmpuint (i, <, len);
+          g_assert (tests[t][len - i - 1] == '1');
+          n--;
+        }
+      g_assert_cmpuint (n, ==, 0);
+    }
+}
+
 /* SETUP & RUNNING */
 
 static void
@@ -468,6 +576,9 @@ main (int argc, char *argv[])
   g_test_add_func ("/bitmask/subtract_hardcoded", test_subtract_hardcoded);
   g_test_add_func ("/bitmask/invert_range", test_invert_range);
   g_test_add_func ("/bitmask/invert_range_hardcoded", test_invert_range_hardcoded);
+  g_test_add_func ("/bitmask/shift_hardcoded", test_shift_hardcoded);
+  g_test_add_func ("/bitmask/next_set", test_next_set);
+  g_test_add_func ("/bitmask/next_set_hardcoded", test_next_set_hardcoded);
 
   result = g_test_run ();
 
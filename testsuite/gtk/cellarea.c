@@ -816,6 +816,123 @@ test_completion_subclass3 (void)
   g_test_trap_assert_stderr ("*ignoring construct property*");
 }
 
+
+/* Counts how often text cells are really measured */
+static gint n_measured;
+static GtkCellRendererClass saved_text_class;
+
+static void
+counting_get_preferred_width (GtkCellRenderer *cell,
+                              GtkWidget       *widget,
+                              gint            *minimum_size,
+                              gint            *natural_size)
+{
+  n_measured++;
+  saved_text_class.get_preferred_width (cell, widget, minimum_size, natural_size);
+}
+
+static void
+counting_get_preferred_height (GtkCellRenderer *cell,
+                               GtkWidget       *widget,
+                               gint            *minimum_size,
+                               gint            *natural_size)
+{
+  n_measured++;
+  saved_text_class.get_preferred_height (cell, widget, minimum_size, natural_size);
+}
+
+static void
+counting_get_preferred_height_for_width (GtkCellRenderer *cell,
+                                         GtkWidget       *widget,
+                                         gint             width,
+                                         gint            *minimum_size,
+                                         gint            *natural_size)
+{
+  n_measured++;
+  saved_text_class.get_preferred_height_for_width (cell, widget, width, minimum_size, natural_size);
+}
+
+/* test that cached sizes follow the text of the cell */
+static void
+test_cache_sizes (void)
+{
+  GtkCellRendererClass *text_class;
+  GtkWidget *window, *label;
+  GtkCellArea *area;
+  GtkCellRenderer *cell;
+  gint short_min, short_nat, long_min, long_nat, min, nat;
+  gint n, i;
+
+  /* Count the measuring of all text cells; the cache only takes
+   * renderers that measure like GtkCellRendererText itself
+   */
+  text_class = g_type_class_ref (GTK_TYPE_CELL_RENDERER_TEXT);
+  saved_text_class = *text_class;
+  text_class->get_preferred_width = counting_get_preferred_width;
+  text_class->get_preferred_height = counting_get_preferred_height;
+  text_class->get_preferred_height_for_width = counting_get_preferred_height_for_width;
+  n_measured = 0;
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  label = gtk_label_new (NULL);
+  gtk_container_add (GTK_CONTAINER (window), label);
+
+  area = gtk_cell_area_box_new ();
+  g_object_ref_sink (area);
+  g_assert (!gtk_cell_area_get_cache_sizes (area));
+  g_object_set (area, "cache-sizes", TRUE, NULL);
+  g_assert (gtk_cell_area_get_cache_sizes (area));
+
+  cell = gtk_cell_renderer_text_new ();
+  gtk_cell_area_add (area, cell);
+
+  g_object_set (cell, "text", "a", NULL);
+  gtk_cell_area_request_renderer (area, cell, GTK_ORIENTATION_HORIZONTAL, label, -1, &short_min, &short_nat);
+  g_object_set (cell, "text", "a much longer text", NULL);
+  gtk_cell_area_request_renderer (area, cell, GTK_ORIENTATION_HORIZONTAL, label, -1, &long_min, &long_nat);
+  g_assert_cmpint (long_nat, >, short_nat);
+  g_assert_cmpint (n_measured, ==, 2);
+
+  g_object_set (cell, "text", "a", NULL);
+  gtk_cell_area_request_renderer (area, cell, GTK_ORIENTATION_HORIZONTAL, label, -1, &min, &nat);
+  g_assert_cmpint (min, ==, short_min);
+  g_assert_cmpint (nat, ==, short_nat);
+
+  /* Repeated requests come from the cache */
+  gtk_cell_area_request_renderer (area, cell, GTK_ORIENTATION_VERTICAL, label, short_nat, &min, &nat);
+  n = n_measured;
+  for (i = 0; i < 10; i++)
+    {
+      g_object_set (cell, "text", i % 2 ? "a" : "a much longer text", NULL);
+      gtk_cell_area_request_renderer (area, cell, GTK_ORIENTATION_HORIZONTAL, label, -1, &min, &nat);
+      g_assert_cmpint (nat, ==, i % 2 ? short_nat : long_nat);
+
+      g_object_set (cell, "text", "a", NULL);
+      gtk_cell_area_request_renderer (area, cell, GTK_ORIENTATION_VERTICAL, label, short_nat, &min, &nat);
+    }
+  g_assert_cmpint (n_measured, ==, n);
+
+  g_object_set (cell, "markup", "<b>a</b>", NULL);
+  gtk_cell_area_request_renderer (area, cell, GTK_ORIENTATION_HORIZONTAL, label, -1, &min, &nat);
+  g_assert_cmpint (nat, >=, short_nat);
+  g_assert_cmpint (n_measured, ==, n + 1);
+
+  /* Without the cache, every request measures */
+  gtk_cell_area_set_cache_sizes (area, FALSE);
+  g_assert (!gtk_cell_area_get_cache_sizes (area));
+  gtk_cell_area_request_renderer (area, cell, GTK_ORIENTATION_HORIZONTAL, label, -1, &min, &nat);
+  gtk_cell_area_request_renderer (area, cell, GTK_ORIENTATION_HORIZONTAL, label, -1, &min, &nat);
+  g_assert_cmpint (n_measured, ==, n + 3);
+
+  g_object_unref (area);
+  gtk_widget_destroy (window);
+
+  text_class->get_preferred_width = saved_text_class.get_preferred_width;
+  text_class->get_preferred_height = saved_text_class.get_preferred_height;
+  text_class->get_preferred_height_for_width = saved_text_class.get_preferred_height_for_width;
+  g_type_class_unref (text_class);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -868,5 +985,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/tests/completion-subclass3", test_completion_subclass3);
   g_test_add_func ("/tests/completion-subclass3/subprocess", test_completion_subclass3_subprocess);
 
+  g_test_add_func ("/tests/cache-sizes", test_cache_sizes);
+
   return g_test_run();
 }
@@ -0,0 +1,280 @@
+/* Extensive GtkColumnStore tests.
+ * Copyright (C) 2017 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+#include "treemodel.h"
+
+static const gchar *names[] = { "delta", "alpha", "echo", "charlie", "bravo" };
+
+static GtkColumnStore *
+create_store (void)
+{
+  GtkColumnStore *store;
+  GtkTreeIter iter;
+  guint i;
+
+  store = gtk_column_store_new (4, G_TYPE_INT, G_TYPE_STRING,
+                                G_TYPE_BOOLEAN, G_TYPE_DOUBLE);
+
+  for (i = 0; i < G_N_ELEMENTS (names); i++)
+    {
+      gtk_column_store_append (store, &iter);
+      gtk_column_store_set (store, &iter,
+                            0, i,
+                            1, names[i],
+                            2, i % 2 == 0,
+                            3, 0.5 * i,
+                            -1);
+    }
+
+  return store;
+}
+
+static void
+check_int_column (GtkColumnStore *store,
+                  const gint     *expected,
+                  gint            n_expected)
+{
+  GtkTreeModel *model = GTK_TREE_MODEL (store);
+  GtkTreeIter iter;
+  gint i, value;
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (model, NULL), ==, n_expected);
+
+  for (i = 0; i < n_expected; i++)
+    {
+      g_assert (gtk_tree_model_iter_nth_child (model, &iter, NULL, i));
+      gtk_tree_model_get (model, &iter, 0, &value, -1);
+      g_assert_cmpint (value, ==, expected[i]);
+    }
+}
+
+static void
+column_store_test_values (void)
+{
+  GtkColumnStore *store;
+  GtkTreeModel *model;
+  GtkTreeIter iter;
+  GtkTreePath *path;
+  gchar *name;
+  gboolean flag;
+  gdouble number;
+  gint i;
+
+  store = create_store ();
+  model = GTK_TREE_MODEL (store);
+
+  g_assert (gtk_tree_model_get_iter_first (model, &iter));
+  i = 0;
+  do
+    {
+      g_assert (gtk_column_store_iter_is_valid (store, &iter));
+
+      path = gtk_tree_model_get_path (model, &iter);
+      g_assert_cmpint (gtk_tree_path_get_indices (path)[0], ==, i);
+      gtk_tree_path_free (path);
+
+      gtk_tree_model_get (model, &iter, 1, &name, 2, &flag, 3, &number, -1);
+      g_assert_cmpstr (name, ==, names[i]);
+      g_assert (flag == (i % 2 == 0));
+      g_assert_cmpfloat (number, ==, 0.5 * i);
+      g_free (name);
+
+      i++;
+    }
+  while (gtk_tree_model_iter_next (model, &iter));
+
+  g_assert_cmpint (i, ==, G_N_ELEMENTS (names));
+
+  /* Replacing a string must not affect other rows sharing it */
+  g_assert (gtk_tree_model_iter_nth_child (model, &iter, NULL, 1));
+  gtk_column_store_set (store, &iter, 1, "delta", -1);
+  gtk_column_store_set (store, &iter, 1, NULL, -1);
+  g_assert (gtk_tree_model_iter_nth_child (model, &iter, NULL, 0));
+  gtk_tree_model_get (model, &iter, 1, &name, -1);
+  g_assert_cmpstr (name, ==, "delta");
+  g_free (name);
+
+  g_object_unref (store);
+}
+
+static void
+column_store_test_remove (void)
+{
+  GtkColumnStore *store;
+  GtkTreeIter iter;
+  gint value;
+  gint expected[] = { 0, 2, 4 };
+  gint expected_after_insert[] = { 7, 0, 2, 4 };
+  gint expected_after_remove[] = { 7, 0, 2 };
+
+  store = create_store ();
+
+  g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 1));
+  g_assert (gtk_column_store_remove (store, &iter));
+  g_assert (gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter));
+  g_assert (gtk_column_store_remove (store, &iter));
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &value, -1);
+  g_assert_cmpint (value, ==, 4);
+  check_int_column (store, expected, G_N_ELEMENTS (expected));
+
+  /* Reuses a removed row */
+  gtk_column_store_insert (store, &iter, 0);
+  gtk_column_store_set (store, &iter, 0, 7, -1);
+  check_int_column (store, expected_after_insert, G_N_ELEMENTS (expected_after_insert));
+
+  g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 3));
+  g_assert (!gtk_column_store_remove (store, &iter));
+  g_assert (!gtk_column_store_iter_is_valid (store, &iter));
+  check_int_column (store, expected_after_remove, G_N_ELEMENTS (expected_after_remove));
+
+  gtk_column_store_clear (store);
+  check_int_column (store, NULL, 0);
+
+  g_object_unref (store);
+}
+
+/* Paths of rows held on to stay right while rows are inserted
+ * and removed in the middle
+ */
+static void
+column_store_test_positions (void)
+{
+  GtkColumnStore *store;
+  GtkTreeModel *model;
+  GtkTreeIter iters[20], iter;
+  GtkTreePath *path;
+  GArray *values;
+  guint i;
+  gint j, value;
+
+  store = gtk_column_store_new (1, G_TYPE_INT);
+  model = GTK_TREE_MODEL (store);
+  values = g_array_new (FALSE, FALSE, sizeof (gint));
+
+  for (i = 0; i < G_N_ELEMENTS (iters); i++)
+    {
+      gtk_column_store_append (store, &iters[i]);
+      gtk_column_store_set (store, &iters[i], 0, i, -1);
+      g_array_append_val (values, i);
+    }
+
+  for (i = 0; i < 50; i++)
+    {
+      j = g_test_rand_int_range (0, values->len + 1);
+      value = 100 + i;
+      gtk_column_store_insert (store, &iter, j);
+      gtk_column_store_set (store, &iter, 0, value, -1);
+      g_array_insert_val (values, j, value);
+
+      if (i % 3 == 0)
+        {
+          j = g_test_rand_int_range (0, values->len);
+          if (g_array_index (values, gint, j) >= 100)
+            {
+              g_assert (gtk_tree_model_iter_nth_child (model, &iter, NULL, j));
+              gtk_column_store_remove (store, &iter);
+              g_array_remove_index (values, j);
+            }
+        }
+
+      j = g_test_rand_int_range (0, G_N_ELEMENTS (iters));
+      path = gtk_tree_model_get_path (model, &iters[j]);
+      g_assert_cmpint (g_array_index (values, gint, gtk_tree_path_get_indices (path)[0]), ==, j);
+      gtk_tree_path_free (path);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (iters); i++)
+    {
+      path = gtk_tree_model_get_path (model, &iters[i]);
+      g_assert_cmpint (g_array_index (values, gint, gtk_tree_path_get_indices (path)[0]), ==, i);
+      gtk_tree_path_free (path);
+    }
+
+  check_int_column (store, (gint *) values->data, values->len);
+
+  g_array_unref (values);
+  g_object_unref (store);
+}
+
+static void
+column_store_test_sort (void)
+{
+  GtkColumnStore *store;
+  GtkTreeIter iter;
+  GValue value = G_VALUE_INIT;
+  gint column;
+  gint by_name[] = { 1, 4, 3, 0, 2 };
+  gint by_name_desc[] = { 2, 0, 3, 4, 1 };
+  gint by_number_desc[] = { 4, 3, 2, 1, 0 };
+  gint after_insert[] = { 4, 3, 2, 1, 0, -1 };
+  gint after_change[] = { 10, 4, 2, 1, 0, -1 };
+
+  store = create_store ();
+
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), 1, GTK_SORT_ASCENDING);
+  check_int_column (store, by_name, G_N_ELEMENTS (by_name));
+
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), 1, GTK_SORT_DESCENDING);
+  check_int_column (store, by_name_desc, G_N_ELEMENTS (by_name_desc));
+
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), 3, GTK_SORT_DESCENDING);
+  check_int_column (store, by_number_desc, G_N_ELEMENTS (by_number_desc));
+
+  /* New rows are inserted in sorted position */
+  g_value_init (&value, G_TYPE_DOUBLE);
+  g_value_set_double (&value, -1.0);
+  column = 3;
+  gtk_column_store_insert_with_valuesv (store, &iter, 0, &column, &value, 1);
+  gtk_column_store_set (store, &iter, 0, -1, -1);
+  g_value_unset (&value);
+  check_int_column (store, after_insert, G_N_ELEMENTS (after_insert));
+
+  /* Changed rows are moved */
+  g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 1));
+  gtk_column_store_set (store, &iter, 0, 10, 3, 10.0, -1);
+  check_int_column (store, after_change, G_N_ELEMENTS (after_change));
+
+  g_object_unref (store);
+}
+
+static void
+column_store_test_filter (void)
+{
+  GtkColumnStore *store;
+  GtkTreeModel *filter;
+
+  store = create_store ();
+  filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (store), NULL);
+  gtk_tree_model_filter_set_visible_column (GTK_TREE_MODEL_FILTER (filter), 2);
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 3);
+
+  g_object_unref (filter);
+  g_object_unref (store);
+}
+
+void
+register_column_store_tests (void)
+{
+  g_test_add_func ("/ColumnStore/values", column_store_test_values);
+  g_test_add_func ("/ColumnStore/remove", column_store_test_remove);
+  g_test_add_func ("/ColumnStore/positions", column_store_test_positions);
+  g_test_add_func ("/ColumnStore/sort", column_store_test_sort);
+  g_test_add_func ("/ColumnStore/filter", column_store_test_filter);
+}
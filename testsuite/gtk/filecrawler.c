@@ -0,0 +1,286 @@
+/* GtkFileCrawler tests.
+ *
+ * Copyright (C) 2017 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <locale.h>
+#include <glib/gstdio.h>
+
+#include "../../gtk/gtkfilecrawlerprivate.h"
+
+#define ATTRIBUTES G_FILE_ATTRIBUTE_STANDARD_NAME "," G_FILE_ATTRIBUTE_STANDARD_TYPE
+
+/* Creates @n_dirs directories with @n_files files each in @path,
+ * @depth levels deep, and returns the number of entries below @path.
+ */
+static guint
+create_tree (const gchar *path,
+             guint        depth,
+             guint        n_dirs,
+             guint        n_files)
+{
+  gchar *name;
+  guint i, n_entries;
+
+  n_entries = 0;
+
+  for (i = 0; i < n_files; i++)
+    {
+      name = g_strdup_printf ("%s/file-%u", path, i);
+      g_assert (g_file_set_contents (name, "", 0, NULL));
+      g_free (name);
+      n_entries++;
+    }
+
+  if (depth == 0)
+    return n_entries;
+
+  for (i = 0; i < n_dirs; i++)
+    {
+      name = g_strdup_printf ("%s/dir-%u", path, i);
+      g_assert_cmpint (g_mkdir (name, 0755), ==, 0);
+      n_entries += 1 + create_tree (name, depth - 1, n_dirs, n_files);
+      g_free (name);
+    }
+
+  return n_entries;
+}
+
+static void
+remove_tree (const gchar *path)
+{
+  const gchar *name;
+  gchar *child;
+  GDir *dir;
+
+  dir = g_dir_open (path, 0, NULL);
+  g_assert (dir != NULL);
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      child = g_build_filename (path, name, NULL);
+      if (g_file_test (child, G_FILE_TEST_IS_DIR))
+        remove_tree (child);
+      else
+        g_remove (child);
+      g_free (child);
+    }
+
+  g_dir_close (dir);
+  g_rmdir (path);
+}
+
+typedef struct
+{
+  GHashTable *seen;
+  guint n_batches;
+  gboolean done;
+  gboolean cancelled;
+} Crawl;
+
+static gpointer
+match_all (GFile        *file,
+           GFileInfo    *info,
+           GCancellable *cancellable,
+           gpointer      user_data)
+{
+  return g_file_get_path (file);
+}
+
+static void
+hits_added (GList    *hits,
+            gpointer  user_data)
+{
+  Crawl *crawl = user_data;
+  GList *l;
+
+  for (l = hits; l; l = l->next)
+    {
+      g_assert (!g_hash_table_contains (crawl->seen, l->data));
+      g_hash_table_add (crawl->seen, g_strdup (l->data));
+    }
+
+  crawl->n_batches++;
+}
+
+static void
+crawl_done (gboolean cancelled,
+            gpointer user_data)
+{
+  Crawl *crawl = user_data;
+
+  g_assert (!crawl->done);
+  crawl->done = TRUE;
+  crawl->cancelled = cancelled;
+}
+
+static const GtkFileCrawlerFuncs funcs = {
+  match_all,
+  NULL,
+  hits_added,
+  crawl_done,
+  g_free
+};
+
+static void
+crawl_init (Crawl *crawl)
+{
+  crawl->seen = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  crawl->n_batches = 0;
+  crawl->done = FALSE;
+  crawl->cancelled = FALSE;
+}
+
+static void
+crawl_wait (Crawl *crawl)
+{
+  while (!crawl->done)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+crawl_clear (Crawl *crawl)
+{
+  g_hash_table_unref (crawl->seen);
+}
+
+static void
+run_crawl (const gchar *path,
+           guint        n_workers,
+           Crawl       *crawl)
+{
+  GFile *root;
+
+  root = g_file_new_for_path (path);
+  _gtk_file_crawler_start (root, ATTRIBUTES, n_workers, &funcs, crawl, NULL);
+  g_object_unref (root);
+
+  crawl_wait (crawl);
+}
+
+static void
+test_all (void)
+{
+  gchar *path;
+  guint n_entries, n_workers;
+  Crawl crawl;
+
+  path = g_dir_make_tmp ("filecrawler-XXXXXX", NULL);
+  g_assert (path != NULL);
+  n_entries = create_tree (path, 3, 4, 300);
+
+  /* Every entry is a hit exactly once, however many workers there are */
+  for (n_workers = 0; n_workers <= 4; n_workers++)
+    {
+      crawl_init (&crawl);
+      run_crawl (path, n_workers, &crawl);
+
+      g_assert (!crawl.cancelled);
+      g_assert_cmpuint (g_hash_table_size (crawl.seen), ==, n_entries);
+      /* The hits come in batches, not one by one */
+      g_assert_cmpuint (crawl.n_batches, <, n_entries / 100);
+
+      crawl_clear (&crawl);
+    }
+
+  remove_tree (path);
+  g_free (path);
+}
+
+static void
+test_cancel (void)
+{
+  GtkFileCrawler *crawler;
+  GFile *root;
+  gchar *path;
+  Crawl crawl;
+
+  path = g_dir_make_tmp ("filecrawler-XXXXXX", NULL);
+  g_assert (path != NULL);
+  create_tree (path, 3, 4, 300);
+
+  crawl_init (&crawl);
+  root = g_file_new_for_path (path);
+  crawler = _gtk_file_crawler_start (root, ATTRIBUTES, 0, &funcs, &crawl, NULL);
+  g_object_unref (root);
+
+  _gtk_file_crawler_cancel (crawler);
+  crawl_wait (&crawl);
+
+  /* No hits are delivered after the cancellation */
+  g_assert (crawl.cancelled);
+  g_assert_cmpuint (crawl.n_batches, ==, 0);
+  crawl_clear (&crawl);
+
+  /* A crawl without a root is done right away */
+  crawl_init (&crawl);
+  _gtk_file_crawler_start (NULL, ATTRIBUTES, 0, &funcs, &crawl, NULL);
+  crawl_wait (&crawl);
+  g_assert (!crawl.cancelled);
+  g_assert_cmpuint (crawl.n_batches, ==, 0);
+  crawl_clear (&crawl);
+
+  remove_tree (path);
+  g_free (path);
+}
+
+static void
+test_performance (void)
+{
+  gchar *path;
+  guint n_entries;
+  gdouble elapsed;
+  Crawl crawl;
+
+  path = g_dir_make_tmp ("filecrawler-XXXXXX", NULL);
+  g_assert (path != NULL);
+  if (g_test_perf ())
+    n_entries = create_tree (path, 4, 8, 20);
+  else
+    n_entries = create_tree (path, 2, 8, 20);
+
+  crawl_init (&crawl);
+  g_test_timer_start ();
+  run_crawl (path, 1, &crawl);
+  elapsed = g_test_timer_elapsed ();
+  g_assert_cmpuint (g_hash_table_size (crawl.seen), ==, n_entries);
+  g_test_minimized_result (elapsed, "crawl %u entries, 1 worker: %g sec", n_entries, elapsed);
+  crawl_clear (&crawl);
+
+  crawl_init (&crawl);
+  g_test_timer_start ();
+  run_crawl (path, 0, &crawl);
+  elapsed = g_test_timer_elapsed ();
+  g_assert_cmpuint (g_hash_table_size (crawl.seen), ==, n_entries);
+  g_test_minimized_result (elapsed, "crawl %u entries, default workers: %g sec", n_entries, elapsed);
+  crawl_clear (&crawl);
+
+  remove_tree (path);
+  g_free (path);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  setlocale (LC_ALL, "C");
+
+  g_test_add_func ("/filecrawler/all", test_all);
+  g_test_add_func ("/filecrawler/cancel", test_cancel);
+  g_test_add_func ("/filecrawler/performance", test_performance);
+
+  return g_test_run ();
+}
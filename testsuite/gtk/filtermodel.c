@@ -6782,6 +6782,235 @@ specific_bug_679910 (void)
   g_object_unref (store);
 }
 
+static gint refilter_flags_threshold;
+
+static gboolean
+refilter_flags_visible_func (GtkTreeModel *model,
+                             GtkTreeIter  *iter,
+                             gpointer      data)
+{
+  gint value;
+
+  gtk_tree_model_get (model, iter, 0, &value, -1);
+
+  return value % refilter_flags_threshold == 0;
+}
+
+static void
+refilter_flags_count_signal (GtkTreeModel *model,
+                             GtkTreePath  *path,
+                             gpointer      data)
+{
+  (*(gint *) data)++;
+}
+
+static void
+refilter_flags_count_runs (GtkTreeModel *model,
+                           GtkTreePath  *path,
+                           GtkTreeIter  *iter,
+                           gint          n_rows,
+                           gpointer      data)
+{
+  (*(gint *) data)++;
+}
+
+static void
+check_refilter_flags_rows (GtkTreeModel *filter,
+                           gint          n_rows)
+{
+  GtkTreeIter iter;
+  gint value, n;
+
+  n = 0;
+  if (gtk_tree_model_get_iter_first (filter, &iter))
+    do
+      {
+        gtk_tree_model_get (filter, &iter, 0, &value, -1);
+        g_assert_cmpint (value % refilter_flags_threshold, ==, 0);
+        n++;
+      }
+    while (gtk_tree_model_iter_next (filter, &iter));
+
+  g_assert_cmpint (n, ==, (n_rows + refilter_flags_threshold - 1) / refilter_flags_threshold);
+}
+
+static void
+specific_refilter_with_flags (void)
+{
+  GtkTreeModel *filter;
+  GtkListStore *store;
+  GtkTreeIter iter;
+  gint n_inserted = 0, n_deleted = 0, n_changed = 0, n_runs = 0;
+  gint i, n_rows = 10000;
+
+  store = gtk_list_store_new (1, G_TYPE_INT);
+  for (i = 0; i < n_rows; i++)
+    gtk_list_store_insert_with_values (store, &iter, i, 0, i, -1);
+
+  refilter_flags_threshold = 2;
+  filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (store), NULL);
+  gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (filter),
+                                          refilter_flags_visible_func,
+                                          NULL, NULL);
+  check_refilter_flags_rows (filter, n_rows);
+
+  g_signal_connect (filter, "row-inserted",
+                    G_CALLBACK (refilter_flags_count_signal), &n_inserted);
+  g_signal_connect (filter, "row-deleted",
+                    G_CALLBACK (refilter_flags_count_signal), &n_deleted);
+  g_signal_connect (filter, "row-changed",
+                    G_CALLBACK (refilter_flags_count_signal), &n_changed);
+  g_signal_connect (filter, "rows-inserted",
+                    G_CALLBACK (refilter_flags_count_runs), &n_runs);
+
+  /* Only the rows that are no longer visible are removed */
+  refilter_flags_threshold = 4;
+  gtk_tree_model_filter_refilter_with_flags (GTK_TREE_MODEL_FILTER (filter),
+                                             GTK_TREE_MODEL_FILTER_REFILTER_STRICTER);
+  check_refilter_flags_rows (filter, n_rows);
+  g_assert_cmpint (n_inserted, ==, 0);
+  g_assert_cmpint (n_deleted, ==, n_rows / 2 - n_rows / 4);
+  g_assert_cmpint (n_changed, ==, 0);
+
+  /* Going from multiples of 4 to multiples of 3 only touches the rows
+   * that are not multiples of 12.
+   */
+  n_deleted = 0;
+  refilter_flags_threshold = 3;
+  gtk_tree_model_filter_refilter_with_flags (GTK_TREE_MODEL_FILTER (filter),
+                                             GTK_TREE_MODEL_FILTER_REFILTER_THREAD_SAFE);
+  check_refilter_flags_rows (filter, n_rows);
+  g_assert_cmpint (n_inserted, ==, (n_rows + 2) / 3 - (n_rows + 11) / 12);
+  g_assert_cmpint (n_deleted, ==, (n_rows + 3) / 4 - (n_rows + 11) / 12);
+  g_assert_cmpint (n_changed, ==, 0);
+
+  /* Nothing changes when the criteria stay the same */
+  n_inserted = n_deleted = 0;
+  gtk_tree_model_filter_refilter_with_flags (GTK_TREE_MODEL_FILTER (filter),
+                                             GTK_TREE_MODEL_FILTER_REFILTER_NONE);
+  g_assert_cmpint (n_inserted, ==, 0);
+  g_assert_cmpint (n_deleted, ==, 0);
+  g_assert_cmpint (n_changed, ==, 0);
+
+  /* The two rows between multiples of 3 become visible together */
+  n_runs = 0;
+  refilter_flags_threshold = 1;
+  gtk_tree_model_filter_refilter_with_flags (GTK_TREE_MODEL_FILTER (filter),
+                                             GTK_TREE_MODEL_FILTER_REFILTER_NONE);
+  check_refilter_flags_rows (filter, n_rows);
+  g_assert_cmpint (n_inserted, ==, n_rows - (n_rows + 2) / 3);
+  g_assert_cmpint (n_runs, ==, (n_rows + 1) / 3);
+
+  /* Only the first row stays, the others come back in one run */
+  n_inserted = n_deleted = n_runs = 0;
+  refilter_flags_threshold = n_rows;
+  gtk_tree_model_filter_refilter_with_flags (GTK_TREE_MODEL_FILTER (filter),
+                                             GTK_TREE_MODEL_FILTER_REFILTER_STRICTER);
+  g_assert_cmpint (n_deleted, ==, n_rows - 1);
+
+  refilter_flags_threshold = 1;
+  gtk_tree_model_filter_refilter_with_flags (GTK_TREE_MODEL_FILTER (filter),
+                                             GTK_TREE_MODEL_FILTER_REFILTER_NONE);
+  check_refilter_flags_rows (filter, n_rows);
+  g_assert_cmpint (n_inserted, ==, n_rows - 1);
+  g_assert_cmpint (n_runs, ==, 1);
+  g_assert_cmpint (n_changed, ==, 0);
+
+  g_object_unref (filter);
+  g_object_unref (store);
+}
+
+static gboolean
+bulk_insert_visible_func (GtkTreeModel *model,
+                          GtkTreeIter  *iter,
+                          gpointer      data)
+{
+  gint value;
+
+  gtk_tree_model_get (model, iter, 0, &value, -1);
+
+  return value % 2 == 0;
+}
+
+static void
+bulk_insert_rows (GtkListStore *store,
+                  gint          position,
+                  gint          first,
+                  gint          n_rows)
+{
+  GValue *values;
+  gint column = 0;
+  gint i;
+
+  values = g_new0 (GValue, n_rows);
+  for (i = 0; i < n_rows; i++)
+    {
+      g_value_init (&values[i], G_TYPE_INT);
+      g_value_set_int (&values[i], first + i);
+    }
+
+  gtk_list_store_insert_rows_with_valuesv (store, position, n_rows,
+                                           &column, values, 1);
+
+  for (i = 0; i < n_rows; i++)
+    g_value_unset (&values[i]);
+  g_free (values);
+}
+
+static void
+check_bulk_insert_rows (GtkTreeModel *filter,
+                        const gint   *expected,
+                        gint          n_expected)
+{
+  GtkTreeIter iter;
+  gint value, n;
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, n_expected);
+
+  n = 0;
+  if (gtk_tree_model_get_iter_first (filter, &iter))
+    do
+      {
+        gtk_tree_model_get (filter, &iter, 0, &value, -1);
+        g_assert_cmpint (value, ==, expected[n]);
+        n++;
+      }
+    while (gtk_tree_model_iter_next (filter, &iter));
+
+  g_assert_cmpint (n, ==, n_expected);
+}
+
+static void
+specific_bulk_insert (void)
+{
+  const gint first_rows[] = { 0, 2, 4, 6, 8 };
+  const gint all_rows[] = { 10, 12, 0, 2, 4, 6, 8 };
+  GtkTreeModel *filter;
+  GtkListStore *store;
+  gint n_inserted = 0;
+
+  store = gtk_list_store_new (1, G_TYPE_INT);
+  filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (store), NULL);
+  gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (filter),
+                                          bulk_insert_visible_func,
+                                          NULL, NULL);
+  g_signal_connect (filter, "row-inserted",
+                    G_CALLBACK (refilter_flags_count_signal), &n_inserted);
+
+  /* The root level gets built while inserting into an empty model */
+  bulk_insert_rows (store, 0, 0, 10);
+  check_bulk_insert_rows (filter, first_rows, G_N_ELEMENTS (first_rows));
+  g_assert_cmpint (n_inserted, ==, G_N_ELEMENTS (first_rows));
+
+  /* And then the rows go into the existing level */
+  bulk_insert_rows (store, 0, 10, 4);
+  check_bulk_insert_rows (filter, all_rows, G_N_ELEMENTS (all_rows));
+  g_assert_cmpint (n_inserted, ==, G_N_ELEMENTS (all_rows));
+
+  g_object_unref (filter);
+  g_object_unref (store);
+}
+
 /* main */
 
 void
@@ -7143,4 +7372,8 @@ register_filter_model_tests (void)
                    specific_bug_659022_row_deleted_free_level);
   g_test_add_func ("/TreeModelFilter/specific/bug-679910",
                    specific_bug_679910);
+  g_test_add_func ("/TreeModelFilter/specific/refilter-with-flags",
+                   specific_refilter_with_flags);
+  g_test_add_func ("/TreeModelFilter/specific/bulk-insert",
+                   specific_bulk_insert);
 }
@@ -0,0 +1,130 @@
+#include <gtk/gtk.h>
+
+static GtkWidget *
+create_virtual_child (gpointer item,
+                      gpointer data)
+{
+  GtkWidget *label;
+
+  (*(gint *) data)++;
+
+  label = gtk_label_new (NULL);
+  g_object_set_data (G_OBJECT (label), "data", g_object_get_data (item, "data"));
+
+  return label;
+}
+
+static void
+bind_virtual_child (GtkFlowBoxChild *child,
+                    gpointer         item,
+                    gpointer         data)
+{
+  g_object_set_data (G_OBJECT (gtk_bin_get_child (GTK_BIN (child))), "data",
+                     g_object_get_data (item, "data"));
+}
+
+static gint
+child_data (GtkFlowBoxChild *child)
+{
+  return GPOINTER_TO_INT (g_object_get_data (G_OBJECT (gtk_bin_get_child (GTK_BIN (child))), "data"));
+}
+
+static void
+test_virtual (void)
+{
+  GtkFlowBox *box;
+  GListStore *store;
+  GtkFlowBoxChild *child;
+  GObject *item;
+  GList *children;
+  guint *positions;
+  guint n_positions;
+  gint created;
+  gint i;
+
+  box = GTK_FLOW_BOX (gtk_flow_box_new ());
+  g_object_ref_sink (box);
+  gtk_flow_box_set_selection_mode (box, GTK_SELECTION_MULTIPLE);
+
+  store = g_list_store_new (G_TYPE_OBJECT);
+  for (i = 0; i < 10000; i++)
+    {
+      item = g_object_new (G_TYPE_OBJECT, NULL);
+      g_object_set_data (item, "data", GINT_TO_POINTER (i));
+      g_list_store_append (store, item);
+      g_object_unref (item);
+    }
+
+  created = 0;
+  gtk_flow_box_bind_model_virtual (box, G_LIST_MODEL (store),
+                                   create_virtual_child, bind_virtual_child,
+                                   &created, NULL);
+
+  /* Only a window of the items gets a child */
+  children = gtk_container_get_children (GTK_CONTAINER (box));
+  g_assert_cmpint (g_list_length (children), >, 0);
+  g_assert_cmpint (g_list_length (children), <, 100);
+  g_assert_cmpint (created, ==, g_list_length (children));
+  g_list_free (children);
+
+  child = gtk_flow_box_get_child_at_index (box, 3);
+  g_assert_cmpint (gtk_flow_box_child_get_index (child), ==, 3);
+  g_assert_cmpint (child_data (child), ==, 3);
+  gtk_flow_box_select_child (box, child);
+
+  /* The cursor can move to items without a child */
+  g_signal_emit_by_name (box, "move-cursor", GTK_MOVEMENT_BUFFER_ENDS, 1);
+  child = gtk_flow_box_get_child_at_index (box, 9999);
+  g_assert (child != NULL);
+  g_assert_cmpint (child_data (child), ==, 9999);
+  g_assert (gtk_flow_box_get_child_at_index (box, 3) == NULL);
+  g_assert_cmpint (created, <, 100);
+
+  positions = gtk_flow_box_get_selected_positions (box, &n_positions);
+  g_assert_cmpuint (n_positions, ==, 1);
+  g_assert_cmpuint (positions[0], ==, 9999);
+  g_free (positions);
+
+  gtk_flow_box_select_all (box);
+  positions = gtk_flow_box_get_selected_positions (box, &n_positions);
+  g_assert_cmpuint (n_positions, ==, 10000);
+  g_free (positions);
+
+  /* Positions follow changes of the model */
+  for (i = 0; i < 2; i++)
+    {
+      item = g_object_new (G_TYPE_OBJECT, NULL);
+      g_list_store_insert (store, 0, item);
+      g_object_unref (item);
+    }
+  g_list_store_remove (store, 10001);
+
+  positions = gtk_flow_box_get_selected_positions (box, &n_positions);
+  g_assert_cmpuint (n_positions, ==, 9999);
+  g_assert_cmpuint (positions[0], ==, 2);
+  g_assert_cmpuint (positions[n_positions - 1], ==, 10000);
+  g_free (positions);
+
+  g_signal_emit_by_name (box, "move-cursor", GTK_MOVEMENT_BUFFER_ENDS, -1);
+  child = gtk_flow_box_get_child_at_index (box, 5);
+  g_assert_cmpint (child_data (child), ==, 3);
+  g_assert (!gtk_flow_box_child_is_selected (child));
+  g_assert (gtk_flow_box_child_is_selected (gtk_flow_box_get_child_at_index (box, 0)));
+
+  gtk_flow_box_bind_model_virtual (box, NULL, NULL, NULL, NULL, NULL);
+  children = gtk_container_get_children (GTK_CONTAINER (box));
+  g_assert (children == NULL);
+
+  g_object_unref (store);
+  g_object_unref (box);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/flowbox/virtual", test_virtual);
+
+  return g_test_run ();
+}
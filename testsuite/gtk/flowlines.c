@@ -0,0 +1,317 @@
+/* GtkFlowLines tests.
+ *
+ * Copyright (C) 2017 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <locale.h>
+
+#include "../../gtk/gtkflowlinesprivate.h"
+
+#define WIDTH 100
+#define COLUMN_SPACING 3
+#define ROW_SPACING 2
+#define ESTIMATE 20
+
+/* We keep the sizes in plain arrays next to the lines, break them
+ * into lines from scratch and compare.
+ */
+static gint
+size_or_estimate (GArray *sizes,
+                  guint   i)
+{
+  gint size = g_array_index (sizes, gint, i);
+
+  return size < 0 ? ESTIMATE : size;
+}
+
+static void
+check_lines (GtkFlowLines *lines,
+             GArray       *widths,
+             GArray       *heights,
+             guint         min_per_line,
+             guint         max_per_line)
+{
+  guint start, end, line, line_start, line_end, min_items, max_items, i;
+  gint y, line_y, line_height, used, height;
+
+  /* A line has at least one item, and the minimum wins over the maximum */
+  min_items = MAX (min_per_line, 1);
+  max_items = max_per_line > 0 ? MAX (max_per_line, min_items) : G_MAXUINT;
+
+  g_assert_cmpuint (_gtk_flow_lines_get_n_items (lines), ==, widths->len);
+
+  start = 0;
+  y = 0;
+  line = 0;
+  while (start < widths->len)
+    {
+      used = 0;
+      height = 0;
+      for (end = start; end < widths->len; end++)
+        {
+          gint needed = used + size_or_estimate (widths, end) + (end > start ? COLUMN_SPACING : 0);
+
+          if (end - start >= max_items)
+            break;
+          if (end - start >= min_items && needed > WIDTH)
+            break;
+
+          used = needed;
+          height = MAX (height, size_or_estimate (heights, end));
+        }
+
+      g_assert_cmpuint (line, <, _gtk_flow_lines_get_n_lines (lines));
+      _gtk_flow_lines_get_line (lines, line, &line_start, &line_end, &line_y, &line_height);
+      g_assert_cmpuint (line_start, ==, start);
+      g_assert_cmpuint (line_end, ==, end);
+      g_assert_cmpint (line_y, ==, y);
+      g_assert_cmpint (line_height, ==, height);
+
+      for (i = start; i < end; i++)
+        g_assert_cmpuint (_gtk_flow_lines_get_line_of_item (lines, i), ==, line);
+
+      g_assert_cmpuint (_gtk_flow_lines_get_line_at_y (lines, y), ==, line);
+
+      start = end;
+      y += height + ROW_SPACING;
+      line++;
+    }
+
+  g_assert_cmpuint (_gtk_flow_lines_get_n_lines (lines), ==, line);
+  g_assert_cmpint (_gtk_flow_lines_get_height (lines), ==, line > 0 ? y - ROW_SPACING : 0);
+}
+
+static void
+splice (GtkFlowLines *lines,
+        GArray       *widths,
+        GArray       *heights,
+        guint         position,
+        guint         removed,
+        guint         added)
+{
+  gint unknown = -1;
+  guint i;
+
+  g_array_remove_range (widths, position, removed);
+  g_array_remove_range (heights, position, removed);
+  for (i = 0; i < added; i++)
+    {
+      g_array_insert_val (widths, position, unknown);
+      g_array_insert_val (heights, position, unknown);
+    }
+
+  _gtk_flow_lines_splice (lines, position, removed, added);
+}
+
+static void
+set_size (GtkFlowLines *lines,
+          GArray       *widths,
+          GArray       *heights,
+          guint         position,
+          gint          width,
+          gint          height)
+{
+  g_array_index (widths, gint, position) = width;
+  g_array_index (heights, gint, position) = height;
+
+  _gtk_flow_lines_set_item_size (lines, position, width, height);
+}
+
+static void
+test_splice (void)
+{
+  GtkFlowLines *lines;
+  GArray *widths, *heights;
+
+  widths = g_array_new (FALSE, FALSE, sizeof (gint));
+  heights = g_array_new (FALSE, FALSE, sizeof (gint));
+  lines = _gtk_flow_lines_new ();
+  _gtk_flow_lines_set_params (lines, WIDTH, COLUMN_SPACING, ROW_SPACING, 0, 0, FALSE);
+  _gtk_flow_lines_set_estimate (lines, ESTIMATE, ESTIMATE);
+
+  check_lines (lines, widths, heights, 0, 0);
+
+  splice (lines, widths, heights, 0, 0, 10);
+  check_lines (lines, widths, heights, 0, 0);
+
+  /* An item that does not fit on its line pushes the rest down */
+  set_size (lines, widths, heights, 2, 70, 30);
+  check_lines (lines, widths, heights, 0, 0);
+
+  /* And a smaller one goes back to the previous line */
+  set_size (lines, widths, heights, 4, 5, 5);
+  check_lines (lines, widths, heights, 0, 0);
+
+  /* A line wider than the box still gets one item */
+  set_size (lines, widths, heights, 0, 200, 10);
+  check_lines (lines, widths, heights, 0, 0);
+
+  splice (lines, widths, heights, 3, 4, 1);
+  check_lines (lines, widths, heights, 0, 0);
+
+  splice (lines, widths, heights, 0, widths->len, 0);
+  check_lines (lines, widths, heights, 0, 0);
+
+  _gtk_flow_lines_free (lines);
+  g_array_unref (widths);
+  g_array_unref (heights);
+}
+
+static void
+test_random (void)
+{
+  GtkFlowLines *lines;
+  GArray *widths, *heights;
+  guint i, position, removed, min_per_line, max_per_line;
+
+  widths = g_array_new (FALSE, FALSE, sizeof (gint));
+  heights = g_array_new (FALSE, FALSE, sizeof (gint));
+  lines = _gtk_flow_lines_new ();
+  _gtk_flow_lines_set_params (lines, WIDTH, COLUMN_SPACING, ROW_SPACING, 0, 0, FALSE);
+  _gtk_flow_lines_set_estimate (lines, ESTIMATE, ESTIMATE);
+  min_per_line = max_per_line = 0;
+
+  for (i = 0; i < 2000; i++)
+    {
+      switch (g_test_rand_int_range (0, 5))
+        {
+        case 0:
+        case 1:
+          position = g_test_rand_int_range (0, widths->len + 1);
+          removed = g_test_rand_int_range (0, MIN (widths->len - position, 5) + 1);
+          splice (lines, widths, heights, position, removed, g_test_rand_int_range (0, 6));
+          break;
+
+        case 2:
+        case 3:
+          if (widths->len > 0)
+            set_size (lines, widths, heights,
+                      g_test_rand_int_range (0, widths->len),
+                      g_test_rand_int_range (0, 120),
+                      g_test_rand_int_range (0, 40));
+          break;
+
+        case 4:
+          if (g_test_rand_int_range (0, 10) == 0)
+            {
+              min_per_line = g_test_rand_int_range (0, 3);
+              max_per_line = g_test_rand_int_range (0, 6);
+              _gtk_flow_lines_set_params (lines, WIDTH, COLUMN_SPACING, ROW_SPACING,
+                                          min_per_line, max_per_line, FALSE);
+            }
+          break;
+
+        default:
+          g_assert_not_reached ();
+        }
+
+      check_lines (lines, widths, heights, min_per_line, max_per_line);
+    }
+
+  _gtk_flow_lines_free (lines);
+  g_array_unref (widths);
+  g_array_unref (heights);
+}
+
+static void
+test_homogeneous (void)
+{
+  GtkFlowLines *lines;
+  guint start, end;
+  gint x, y, width, height;
+
+  lines = _gtk_flow_lines_new ();
+  _gtk_flow_lines_set_params (lines, WIDTH, COLUMN_SPACING, ROW_SPACING, 0, 0, TRUE);
+  _gtk_flow_lines_set_estimate (lines, 30, 10);
+  _gtk_flow_lines_splice (lines, 0, 0, 10);
+
+  /* Sizes of single items do not matter */
+  _gtk_flow_lines_set_item_size (lines, 1, 90, 90);
+
+  g_assert_cmpuint (_gtk_flow_lines_get_n_lines (lines), ==, 4);
+  _gtk_flow_lines_get_line (lines, 3, &start, &end, &y, &height);
+  g_assert_cmpuint (start, ==, 9);
+  g_assert_cmpuint (end, ==, 10);
+  g_assert_cmpint (y, ==, 3 * (10 + ROW_SPACING));
+  g_assert_cmpint (height, ==, 10);
+
+  _gtk_flow_lines_get_item_area (lines, 5, &x, &y, &width, &height);
+  g_assert_cmpint (x, ==, 2 * (30 + COLUMN_SPACING));
+  g_assert_cmpint (y, ==, 10 + ROW_SPACING);
+  g_assert_cmpint (width, ==, 30);
+  g_assert_cmpint (height, ==, 10);
+
+  /* The lines are broken again for a new size */
+  _gtk_flow_lines_set_estimate (lines, 45, 20);
+  g_assert_cmpuint (_gtk_flow_lines_get_n_lines (lines), ==, 5);
+  _gtk_flow_lines_get_line (lines, 4, &start, &end, &y, &height);
+  g_assert_cmpuint (start, ==, 8);
+  g_assert_cmpuint (end, ==, 10);
+  g_assert_cmpint (y, ==, 4 * (20 + ROW_SPACING));
+  g_assert_cmpint (height, ==, 20);
+
+  _gtk_flow_lines_free (lines);
+}
+
+static void
+test_performance (void)
+{
+  GtkFlowLines *lines;
+  guint i, n_items;
+  gdouble elapsed;
+
+  n_items = g_test_perf () ? 1000000 : 10000;
+
+  lines = _gtk_flow_lines_new ();
+  _gtk_flow_lines_set_params (lines, 1000, 6, 6, 0, 0, FALSE);
+  _gtk_flow_lines_set_estimate (lines, 100, 100);
+
+  g_test_timer_start ();
+  _gtk_flow_lines_splice (lines, 0, 0, n_items);
+  _gtk_flow_lines_get_n_lines (lines);
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "add %u items: %g sec", n_items, elapsed);
+
+  g_test_timer_start ();
+  for (i = 0; i < 1000; i++)
+    _gtk_flow_lines_splice (lines, g_test_rand_int_range (0, n_items), 1, 1);
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "1000 changes: %g sec", elapsed);
+
+  g_test_timer_start ();
+  for (i = 0; i < 1000; i++)
+    _gtk_flow_lines_set_item_size (lines, g_test_rand_int_range (0, n_items),
+                                   g_test_rand_int_range (50, 150),
+                                   g_test_rand_int_range (50, 150));
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "1000 measured items: %g sec", elapsed);
+
+  _gtk_flow_lines_free (lines);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  setlocale (LC_ALL, "C");
+
+  g_test_add_func ("/flowlines/splice", test_splice);
+  g_test_add_func ("/flowlines/random", test_random);
+  g_test_add_func ("/flowlines/homogeneous", test_homogeneous);
+  g_test_add_func ("/flowlines/performance", test_performance);
+
+  return g_test_run ();
+}
@@ -776,6 +776,298 @@ log_writer_drop_warnings (GLogLevelFlags   log_level,
   return g_log_writer_default (log_level, fields, n_fields, user_data);
 }
 
+static void
+test_missing (void)
+{
+  const gchar *names[] = { "this-icon-does-not-exist", "size-test", NULL };
+  GtkIconTheme *theme;
+  GtkIconInfo *info;
+  gint i;
+
+  theme = get_test_icontheme (FALSE);
+
+  /* Missing icons are remembered, but only by name */
+  for (i = 0; i < 2; i++)
+    {
+      info = gtk_icon_theme_lookup_icon (theme, names[0], 16, 0);
+      g_assert (info == NULL);
+      g_assert (!gtk_icon_theme_has_icon (theme, names[0]));
+    }
+
+  info = gtk_icon_theme_choose_icon (theme, names, 16, 0);
+  g_assert (info != NULL);
+  g_assert (g_str_has_suffix (gtk_icon_info_get_filename (info), "size-test.png"));
+  g_object_unref (info);
+
+  g_assert (gtk_icon_theme_has_icon (theme, names[1]));
+}
+
+static void
+test_lru_cache (void)
+{
+  GtkIconTheme *theme;
+  GtkIconInfo *info;
+  GdkPixbuf *pixbuf;
+  gint size;
+
+  theme = get_test_icontheme (TRUE);
+
+  /* Icons nobody uses are kept by the memory they take,
+   * not by their number, so many small ones stay around
+   */
+  for (size = 16; size < 80; size++)
+    {
+      info = gtk_icon_theme_lookup_icon (theme, "size-test", size, GTK_ICON_LOOKUP_FORCE_SIZE);
+      g_assert (info != NULL);
+      g_object_set_data (G_OBJECT (info), "size", GINT_TO_POINTER (size));
+      pixbuf = gtk_icon_info_load_icon (info, NULL);
+      g_assert (pixbuf != NULL);
+      g_object_unref (pixbuf);
+      g_object_unref (info);
+    }
+
+  for (size = 16; size < 80; size++)
+    {
+      info = gtk_icon_theme_lookup_icon (theme, "size-test", size, GTK_ICON_LOOKUP_FORCE_SIZE);
+      g_assert (info != NULL);
+      g_assert_cmpint (GPOINTER_TO_INT (g_object_get_data (G_OBJECT (info), "size")), ==, size);
+      g_object_unref (info);
+    }
+}
+
+/* Checks that every visible pixel of @pixbuf has the color @rgba */
+static void
+assert_pixbuf_color (GdkPixbuf     *pixbuf,
+                     const GdkRGBA *rgba)
+{
+  guchar *pixels, *p;
+  gint x, y, stride, n_visible;
+
+  g_assert_cmpint (gdk_pixbuf_get_n_channels (pixbuf), ==, 4);
+
+  pixels = gdk_pixbuf_get_pixels (pixbuf);
+  stride = gdk_pixbuf_get_rowstride (pixbuf);
+  n_visible = 0;
+
+  for (y = 0; y < gdk_pixbuf_get_height (pixbuf); y++)
+    for (x = 0; x < gdk_pixbuf_get_width (pixbuf); x++)
+      {
+        p = pixels + y * stride + 4 * x;
+        if (p[3] == 0)
+          continue;
+
+        g_assert_cmpint (p[0], ==, (gint) (rgba->red * 255));
+        g_assert_cmpint (p[1], ==, (gint) (rgba->green * 255));
+        g_assert_cmpint (p[2], ==, (gint) (rgba->blue * 255));
+        n_visible++;
+      }
+
+  g_assert_cmpint (n_visible, >, 0);
+}
+
+static void
+test_symbolic_colors (void)
+{
+  GdkRGBA colors[3] = {
+    { 1.0, 0.0, 0.0, 1.0 },
+    { 0.0, 0.0, 1.0, 1.0 },
+    { 1.0, 1.0, 1.0, 0.5 }
+  };
+  GtkIconTheme *theme;
+  GtkIconInfo *info;
+  GdkPixbuf *pixbuf;
+  gboolean was_symbolic;
+  GError *error = NULL;
+  gint i;
+
+  theme = get_test_icontheme (FALSE);
+  info = gtk_icon_theme_lookup_icon (theme, "everything-symbolic", 24, 0);
+  g_assert (info != NULL);
+
+  /* With all colors the same, the whole icon has that color,
+   * wherever the parts of the different colors are
+   */
+  for (i = 0; i < G_N_ELEMENTS (colors); i++)
+    {
+      pixbuf = gtk_icon_info_load_symbolic (info, &colors[i], &colors[i], &colors[i], &colors[i],
+                                            &was_symbolic, &error);
+      g_assert_no_error (error);
+      g_assert (was_symbolic);
+      assert_pixbuf_color (pixbuf, &colors[i]);
+      g_object_unref (pixbuf);
+    }
+
+  g_object_unref (info);
+}
+
+/* Checks the pixels inside a quarter of @pixbuf, away from its edges */
+static void
+assert_quarter_color (GdkPixbuf     *pixbuf,
+                      gint           column,
+                      gint           row,
+                      const GdkRGBA *rgba)
+{
+  guchar *pixels, *p;
+  gint x, y, x0, y0, width, height, stride;
+
+  pixels = gdk_pixbuf_get_pixels (pixbuf);
+  stride = gdk_pixbuf_get_rowstride (pixbuf);
+  width = gdk_pixbuf_get_width (pixbuf) / 2;
+  height = gdk_pixbuf_get_height (pixbuf) / 2;
+  x0 = column * width;
+  y0 = row * height;
+
+  for (y = y0 + 2; y < y0 + height - 2; y++)
+    for (x = x0 + 2; x < x0 + width - 2; x++)
+      {
+        p = pixels + y * stride + 4 * x;
+
+        /* The stylesheet rendering rounded the colors to 8 bits */
+        g_assert_cmpint (ABS (p[0] - (gint) (0.5 + rgba->red * 255)), <=, 1);
+        g_assert_cmpint (ABS (p[1] - (gint) (0.5 + rgba->green * 255)), <=, 1);
+        g_assert_cmpint (ABS (p[2] - (gint) (0.5 + rgba->blue * 255)), <=, 1);
+        g_assert_cmpint (p[3], ==, (gint) (rgba->alpha * 255));
+      }
+}
+
+static void
+test_symbolic_distinct_colors (void)
+{
+  GdkRGBA colors[4] = {
+    { 0.2, 0.4, 0.6, 1.0 },
+    { 0.1, 0.7, 0.3, 1.0 },
+    { 0.9, 0.5, 0.15, 1.0 },
+    { 0.75, 0.05, 0.1, 1.0 }
+  };
+  GtkIconTheme *theme;
+  GtkIconInfo *info;
+  GdkPixbuf *pixbuf;
+  gboolean was_symbolic;
+  GError *error = NULL;
+  const GdkRGBA *fg, *success, *warning, *err;
+  gint i;
+
+  theme = get_test_icontheme (FALSE);
+  info = gtk_icon_theme_lookup_icon (theme, "everything-symbolic", 24, 0);
+  g_assert (info != NULL);
+
+  /* The icon has a quarter for the foreground and for each of the
+   * success, warning and error classes. The first load renders the
+   * mask of the icon, the others recolor it.
+   */
+  for (i = 0; i < 4; i++)
+    {
+      fg = &colors[i];
+      success = &colors[(i + 1) % 4];
+      warning = &colors[(i + 2) % 4];
+      err = &colors[(i + 3) % 4];
+
+      pixbuf = gtk_icon_info_load_symbolic (info, fg, success, warning, err,
+                                            &was_symbolic, &error);
+      g_assert_no_error (error);
+      g_assert (was_symbolic);
+
+      assert_quarter_color (pixbuf, 0, 0, fg);
+      assert_quarter_color (pixbuf, 1, 0, success);
+      assert_quarter_color (pixbuf, 0, 1, warning);
+      assert_quarter_color (pixbuf, 1, 1, err);
+      g_object_unref (pixbuf);
+    }
+
+  g_object_unref (info);
+}
+
+typedef struct {
+  GHashTable *seen;
+  gboolean done;
+} Prefetch;
+
+static void
+prefetch_icon (GtkIconTheme                 *theme,
+               const GtkIconPrefetchRequest *request,
+               GtkIconInfo                  *info,
+               gpointer                      data)
+{
+  Prefetch *prefetch = data;
+  GdkPixbuf *pixbuf;
+
+  g_assert (!prefetch->done);
+  g_assert (!g_hash_table_contains (prefetch->seen, request->data));
+  g_hash_table_add (prefetch->seen, request->data);
+
+  if (g_str_equal (request->icon_name, "this-icon-does-not-exist"))
+    {
+      g_assert (info == NULL);
+      return;
+    }
+
+  g_assert (info != NULL);
+  g_object_set_data (G_OBJECT (info), "prefetched", GINT_TO_POINTER (TRUE));
+
+  /* The icon is decoded already, at the size of its request */
+  pixbuf = gtk_icon_info_load_icon (info, NULL);
+  g_assert (pixbuf != NULL);
+  g_assert_cmpint (gdk_pixbuf_get_width (pixbuf), ==, request->size * request->scale);
+  g_object_unref (pixbuf);
+}
+
+static void
+prefetch_done (GObject      *source,
+               GAsyncResult *result,
+               gpointer      data)
+{
+  Prefetch *prefetch = data;
+  GError *error = NULL;
+
+  g_assert (gtk_icon_theme_prefetch_icons_finish (GTK_ICON_THEME (source), result, &error));
+  g_assert_no_error (error);
+  prefetch->done = TRUE;
+}
+
+static void
+test_prefetch (void)
+{
+  GtkIconPrefetchRequest requests[] = {
+    { "twosize-fixed", 16, 1, GINT_TO_POINTER (1) },
+    { "twosize-fixed", 32, 1, GINT_TO_POINTER (2) },
+    { "size-test", 16, 1, GINT_TO_POINTER (3) },
+    { "size-test", 16, 2, GINT_TO_POINTER (4) },
+    { "this-icon-does-not-exist", 16, 1, GINT_TO_POINTER (5) }
+  };
+  GtkIconTheme *theme;
+  GtkIconInfo *info;
+  Prefetch prefetch;
+  guint i;
+
+  theme = get_test_icontheme (TRUE);
+
+  prefetch.seen = g_hash_table_new (NULL, NULL);
+  prefetch.done = FALSE;
+  gtk_icon_theme_prefetch_icons_async (theme, requests, G_N_ELEMENTS (requests),
+                                       GTK_ICON_LOOKUP_FORCE_SIZE,
+                                       NULL, prefetch_icon, prefetch_done, &prefetch);
+
+  /* Nothing is delivered before we return to the main loop */
+  g_assert_cmpuint (g_hash_table_size (prefetch.seen), ==, 0);
+
+  while (!prefetch.done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (g_hash_table_size (prefetch.seen), ==, G_N_ELEMENTS (requests));
+  g_hash_table_unref (prefetch.seen);
+
+  /* The prefetched icons stay in the cache, at each size and scale */
+  for (i = 0; i < G_N_ELEMENTS (requests) - 1; i++)
+    {
+      info = gtk_icon_theme_lookup_icon_for_scale (theme, requests[i].icon_name,
+                                                   requests[i].size, requests[i].scale,
+                                                   GTK_ICON_LOOKUP_FORCE_SIZE);
+      g_assert (info != NULL);
+      g_assert (g_object_get_data (G_OBJECT (info), "prefetched") != NULL);
+      g_object_unref (info);
+    }
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -803,6 +1095,11 @@ main (int argc, char *argv[])
   g_test_add_func ("/icontheme/async", test_async);
   g_test_add_func ("/icontheme/inherit", test_inherit);
   g_test_add_func ("/icontheme/nonsquare-symbolic", test_nonsquare_symbolic);
+  g_test_add_func ("/icontheme/missing", test_missing);
+  g_test_add_func ("/icontheme/lru-cache", test_lru_cache);
+  g_test_add_func ("/icontheme/prefetch", test_prefetch);
+  g_test_add_func ("/icontheme/symbolic-colors", test_symbolic_colors);
+  g_test_add_func ("/icontheme/symbolic-distinct-colors", test_symbolic_distinct_colors);
 
   return g_test_run();
 }
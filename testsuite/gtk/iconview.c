@@ -0,0 +1,110 @@
+#include <gtk/gtk.h>
+
+#define N_COLUMNS 5
+
+static void
+append_items (GtkListStore *store,
+              gint          n_items)
+{
+  GtkTreeIter iter;
+  gchar *text;
+  gint i;
+
+  for (i = 0; i < n_items; i++)
+    {
+      text = g_strdup_printf ("Item %d", i);
+      gtk_list_store_insert_with_values (store, &iter, -1, 0, text, -1);
+      g_free (text);
+    }
+}
+
+/* Items are laid out in rows of @n_columns, in order */
+static void
+check_layout (GtkIconView *icon_view,
+              gint         n_columns)
+{
+  GtkTreeModel *model = gtk_icon_view_get_model (icon_view);
+  GdkRectangle rect, prev = { 0, };
+  GtkTreePath *path;
+  gint n_items, i;
+
+  n_items = gtk_tree_model_iter_n_children (model, NULL);
+
+  for (i = 0; i < n_items; i++)
+    {
+      path = gtk_tree_path_new_from_indices (i, -1);
+
+      g_assert_cmpint (gtk_icon_view_get_item_row (icon_view, path), ==, i / n_columns);
+      g_assert_cmpint (gtk_icon_view_get_item_column (icon_view, path), ==, i % n_columns);
+
+      g_assert (gtk_icon_view_get_cell_rect (icon_view, path, NULL, &rect));
+      if (i % n_columns == 0)
+        g_assert_cmpint (rect.y, >, prev.y);
+      else
+        {
+          g_assert_cmpint (rect.y, ==, prev.y);
+          g_assert_cmpint (rect.x, >, prev.x);
+        }
+      prev = rect;
+
+      gtk_tree_path_free (path);
+    }
+}
+
+static void
+test_layout (void)
+{
+  GtkWidget *window, *icon_view;
+  GtkListStore *store;
+  GtkTreeIter iter;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  append_items (store, 23);
+
+  window = gtk_offscreen_window_new ();
+  icon_view = gtk_icon_view_new_with_model (GTK_TREE_MODEL (store));
+  gtk_icon_view_set_text_column (GTK_ICON_VIEW (icon_view), 0);
+  gtk_icon_view_set_columns (GTK_ICON_VIEW (icon_view), N_COLUMNS);
+  gtk_container_add (GTK_CONTAINER (window), icon_view);
+  gtk_widget_show_all (window);
+
+  gtk_test_widget_wait_for_draw (window);
+  check_layout (GTK_ICON_VIEW (icon_view), N_COLUMNS);
+
+  /* Appending only lays out the last rows */
+  append_items (store, 12);
+  gtk_test_widget_wait_for_draw (window);
+  check_layout (GTK_ICON_VIEW (icon_view), N_COLUMNS);
+
+  /* A changed item is measured again */
+  gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 7);
+  gtk_list_store_set (store, &iter, 0, "A much longer text that needs to wrap over several lines", -1);
+  gtk_test_widget_wait_for_draw (window);
+  check_layout (GTK_ICON_VIEW (icon_view), N_COLUMNS);
+
+  /* Removing items moves the following ones */
+  gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 2);
+  gtk_list_store_remove (store, &iter);
+  gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
+  gtk_list_store_remove (store, &iter);
+  gtk_test_widget_wait_for_draw (window);
+  check_layout (GTK_ICON_VIEW (icon_view), N_COLUMNS);
+
+  /* Rewrapping */
+  gtk_icon_view_set_columns (GTK_ICON_VIEW (icon_view), 3);
+  gtk_test_widget_wait_for_draw (window);
+  check_layout (GTK_ICON_VIEW (icon_view), 3);
+
+  gtk_widget_destroy (window);
+  g_object_unref (store);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/iconview/layout", test_layout);
+
+  return g_test_run ();
+}
@@ -434,6 +434,125 @@ test_header (void)
   g_object_unref (list);
 }
 
+static GtkWidget *
+create_virtual_row (gpointer item,
+                    gpointer data)
+{
+  GtkWidget *label;
+
+  (*(gint *) data)++;
+
+  label = gtk_label_new (NULL);
+  g_object_set_data (G_OBJECT (label), "data", g_object_get_data (item, "data"));
+
+  return label;
+}
+
+static void
+bind_virtual_row (GtkListBoxRow *row,
+                  gpointer       item,
+                  gpointer       data)
+{
+  g_object_set_data (G_OBJECT (gtk_bin_get_child (GTK_BIN (row))), "data",
+                     g_object_get_data (item, "data"));
+}
+
+static gint
+row_data (GtkListBoxRow *row)
+{
+  return GPOINTER_TO_INT (g_object_get_data (G_OBJECT (gtk_bin_get_child (GTK_BIN (row))), "data"));
+}
+
+static void
+test_virtual (void)
+{
+  GtkListBox *list;
+  GListStore *store;
+  GtkListBoxRow *row;
+  GObject *item;
+  GList *children;
+  guint *positions;
+  guint n_positions;
+  gint created;
+  gint i;
+
+  list = GTK_LIST_BOX (gtk_list_box_new ());
+  g_object_ref_sink (list);
+  gtk_list_box_set_selection_mode (list, GTK_SELECTION_MULTIPLE);
+
+  store = g_list_store_new (G_TYPE_OBJECT);
+  for (i = 0; i < 10000; i++)
+    {
+      item = g_object_new (G_TYPE_OBJECT, NULL);
+      g_object_set_data (item, "data", GINT_TO_POINTER (i));
+      g_list_store_append (store, item);
+      g_object_unref (item);
+    }
+
+  created = 0;
+  gtk_list_box_bind_model_virtual (list, G_LIST_MODEL (store),
+                                   create_virtual_row, bind_virtual_row,
+                                   &created, NULL);
+
+  /* Only a window of the items gets a row */
+  children = gtk_container_get_children (GTK_CONTAINER (list));
+  g_assert_cmpint (g_list_length (children), >, 0);
+  g_assert_cmpint (g_list_length (children), <, 100);
+  g_assert_cmpint (created, ==, g_list_length (children));
+  g_list_free (children);
+
+  row = gtk_list_box_get_row_at_index (list, 3);
+  g_assert_cmpint (gtk_list_box_row_get_index (row), ==, 3);
+  g_assert_cmpint (row_data (row), ==, 3);
+  gtk_list_box_select_row (list, row);
+
+  /* The cursor can move to items without a row */
+  g_signal_emit_by_name (list, "move-cursor", GTK_MOVEMENT_BUFFER_ENDS, 1);
+  row = gtk_list_box_get_row_at_index (list, 9999);
+  g_assert (row != NULL);
+  g_assert_cmpint (row_data (row), ==, 9999);
+  g_assert (gtk_list_box_get_row_at_index (list, 3) == NULL);
+  g_assert_cmpint (created, <, 100);
+
+  positions = gtk_list_box_get_selected_positions (list, &n_positions);
+  g_assert_cmpuint (n_positions, ==, 1);
+  g_assert_cmpuint (positions[0], ==, 9999);
+  g_free (positions);
+
+  gtk_list_box_select_all (list);
+  positions = gtk_list_box_get_selected_positions (list, &n_positions);
+  g_assert_cmpuint (n_positions, ==, 10000);
+  g_free (positions);
+
+  /* Positions follow changes of the model */
+  for (i = 0; i < 2; i++)
+    {
+      item = g_object_new (G_TYPE_OBJECT, NULL);
+      g_list_store_insert (store, 0, item);
+      g_object_unref (item);
+    }
+  g_list_store_remove (store, 10001);
+
+  positions = gtk_list_box_get_selected_positions (list, &n_positions);
+  g_assert_cmpuint (n_positions, ==, 9999);
+  g_assert_cmpuint (positions[0], ==, 2);
+  g_assert_cmpuint (positions[n_positions - 1], ==, 10000);
+  g_free (positions);
+
+  g_signal_emit_by_name (list, "move-cursor", GTK_MOVEMENT_BUFFER_ENDS, -1);
+  row = gtk_list_box_get_row_at_index (list, 5);
+  g_assert_cmpint (row_data (row), ==, 3);
+  g_assert (!gtk_list_box_row_is_selected (row));
+  g_assert (gtk_list_box_row_is_selected (gtk_list_box_get_row_at_index (list, 0)));
+
+  gtk_list_box_bind_model_virtual (list, NULL, NULL, NULL, NULL, NULL);
+  children = gtk_container_get_children (GTK_CONTAINER (list));
+  g_assert (children == NULL);
+
+  g_object_unref (store);
+  g_object_unref (list);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -444,6 +563,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/listbox/multi-selection", test_multi_selection);
   g_test_add_func ("/listbox/filter", test_filter);
   g_test_add_func ("/listbox/header", test_header);
+  g_test_add_func ("/listbox/virtual", test_virtual);
 
   return g_test_run ();
 }
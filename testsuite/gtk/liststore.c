@@ -179,6 +179,157 @@ list_store_test_insert_high_values (void)
   g_object_unref (store);
 }
 
+static void
+count_signal (GtkTreeModel *model,
+              GtkTreePath  *path,
+              GtkTreeIter  *iter,
+              gint         *count)
+{
+  (*count)++;
+}
+
+static void
+count_rows_signal (GtkTreeModel *model,
+                   GtkTreePath  *path,
+                   GtkTreeIter  *iter,
+                   gint          n_rows,
+                   gint         *count)
+{
+  g_assert_cmpint (gtk_tree_path_get_indices (path)[0], ==, 1);
+  g_assert_cmpint (n_rows, ==, 3);
+  (*count)++;
+}
+
+static void
+list_store_test_insert_rows (void)
+{
+  GtkTreeIter iter;
+  GtkListStore *store;
+  GValue values[3] = { G_VALUE_INIT, G_VALUE_INIT, G_VALUE_INIT };
+  gint columns[1] = { 0 };
+  gint expected[5] = { 0, 10, 11, 12, 1 };
+  gint n_inserted = 0;
+  gint n_rows_inserted = 0;
+  gint i;
+
+  store = gtk_list_store_new (1, G_TYPE_INT);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, 0, -1);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, 1, -1);
+
+  for (i = 0; i < 3; i++)
+    {
+      g_value_init (&values[i], G_TYPE_INT);
+      g_value_set_int (&values[i], 10 + i);
+    }
+
+  g_signal_connect (store, "row-inserted",
+                    G_CALLBACK (count_signal), &n_inserted);
+  g_signal_connect (store, "rows-inserted",
+                    G_CALLBACK (count_rows_signal), &n_rows_inserted);
+
+  gtk_list_store_insert_rows_with_valuesv (store, 1, 3, columns, values, 1);
+
+  g_assert_cmpint (n_rows_inserted, ==, 1);
+  g_assert_cmpint (n_inserted, ==, 3);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL), ==, 5);
+
+  g_assert (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter));
+  for (i = 0; i < 5; i++)
+    {
+      gint value;
+
+      gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &value, -1);
+      g_assert_cmpint (value, ==, expected[i]);
+      g_assert (iter_position (store, &iter, i));
+      gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter);
+    }
+
+  for (i = 0; i < 3; i++)
+    g_value_unset (&values[i]);
+
+  g_object_unref (store);
+}
+
+/* Refers to every row of the model, on the first emission */
+static void
+reference_rows (GtkTreeModel  *model,
+                GtkTreePath   *path,
+                GtkTreeIter   *iter,
+                GPtrArray     *references)
+{
+  GtkTreePath *row_path;
+  gint i;
+
+  if (references->len > 0)
+    return;
+
+  for (i = 0; i < gtk_tree_model_iter_n_children (model, NULL); i++)
+    {
+      row_path = gtk_tree_path_new_from_indices (i, -1);
+      g_ptr_array_add (references, gtk_tree_row_reference_new (model, row_path));
+      gtk_tree_path_free (row_path);
+    }
+}
+
+static void
+list_store_test_insert_rows_references (void)
+{
+  GtkTreeIter iter;
+  GtkListStore *store;
+  GtkTreeRowReference *before;
+  GtkTreePath *path;
+  GPtrArray *references;
+  GValue values[3] = { G_VALUE_INIT, G_VALUE_INIT, G_VALUE_INIT };
+  gint columns[1] = { 0 };
+  gint expected[5] = { 0, 10, 11, 12, 1 };
+  gint value;
+  guint i;
+
+  store = gtk_list_store_new (1, G_TYPE_INT);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, 0, -1);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, 1, -1);
+
+  path = gtk_tree_path_new_from_indices (1, -1);
+  before = gtk_tree_row_reference_new (GTK_TREE_MODEL (store), path);
+  gtk_tree_path_free (path);
+
+  for (i = 0; i < 3; i++)
+    {
+      g_value_init (&values[i], G_TYPE_INT);
+      g_value_set_int (&values[i], 10 + i);
+    }
+
+  /* The rows are all in the model when the first one is announced,
+   * references made then must not be moved by the later emissions
+   */
+  references = g_ptr_array_new_with_free_func ((GDestroyNotify) gtk_tree_row_reference_free);
+  g_signal_connect (store, "row-inserted",
+                    G_CALLBACK (reference_rows), references);
+
+  gtk_list_store_insert_rows_with_valuesv (store, 1, 3, columns, values, 1);
+
+  path = gtk_tree_row_reference_get_path (before);
+  g_assert_cmpint (gtk_tree_path_get_indices (path)[0], ==, 4);
+  gtk_tree_path_free (path);
+
+  g_assert_cmpint (references->len, ==, 5);
+  for (i = 0; i < references->len; i++)
+    {
+      path = gtk_tree_row_reference_get_path (g_ptr_array_index (references, i));
+      g_assert (gtk_tree_model_get_iter (GTK_TREE_MODEL (store), &iter, path));
+      gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &value, -1);
+      g_assert_cmpint (value, ==, expected[i]);
+      gtk_tree_path_free (path);
+    }
+
+  for (i = 0; i < 3; i++)
+    g_value_unset (&values[i]);
+
+  g_ptr_array_unref (references);
+  gtk_tree_row_reference_free (before);
+  g_object_unref (store);
+}
+
 static void
 list_store_test_append (void)
 {
@@ -1021,6 +1172,10 @@ register_list_store_tests (void)
   /* insertion */
   g_test_add_func ("/ListStore/insert-high-values",
 	           list_store_test_insert_high_values);
+  g_test_add_func ("/ListStore/insert-rows",
+		   list_store_test_insert_rows);
+  g_test_add_func ("/ListStore/insert-rows-references",
+		   list_store_test_insert_rows_references);
   g_test_add_func ("/ListStore/append",
 		   list_store_test_append);
   g_test_add_func ("/ListStore/prepend",
@@ -0,0 +1,243 @@
+/* GtkPrefixIndex tests.
+ *
+ * Copyright (C) 2017 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <locale.h>
+#include <string.h>
+
+#include "../../gtk/gtkprefixindexprivate.h"
+
+static const gchar *words[] = {
+  "Apple", "apricot", "Banana", "band", "BANDANA", "cherry", "Chestnut",
+  "\xc3\x89clair", "e\xcc\x81tude", "Zebra", "zeppelin", NULL
+};
+
+/* We keep a plain array of strings next to the index and compare */
+static void
+check_lookup (GtkPrefixIndex *index,
+              GPtrArray      *rows,
+              const gchar    *prefix)
+{
+  gchar *key;
+  guint *matches;
+  guint n_matches, i, j;
+
+  key = _gtk_prefix_index_fold (prefix);
+  matches = _gtk_prefix_index_lookup (index, prefix, &n_matches);
+
+  j = 0;
+  for (i = 0; i < rows->len; i++)
+    {
+      gchar *row = _gtk_prefix_index_fold (g_ptr_array_index (rows, i));
+
+      if (row != NULL && strncmp (row, key, strlen (key)) == 0)
+        {
+          g_assert_cmpuint (j, <, n_matches);
+          g_assert_cmpuint (matches[j], ==, i);
+          j++;
+        }
+
+      g_free (row);
+    }
+
+  g_assert_cmpuint (j, ==, n_matches);
+
+  g_free (matches);
+  g_free (key);
+}
+
+static void
+check_index (GtkPrefixIndex *index,
+             GPtrArray      *rows)
+{
+  guint i;
+
+  g_assert_cmpuint (_gtk_prefix_index_get_n_rows (index), ==, rows->len);
+
+  check_lookup (index, rows, "");
+  check_lookup (index, rows, "a");
+  check_lookup (index, rows, "BAN");
+  check_lookup (index, rows, "\xc3\xa9");
+  check_lookup (index, rows, "nothing");
+
+  for (i = 0; words[i]; i++)
+    check_lookup (index, rows, words[i]);
+}
+
+static void
+test_append (void)
+{
+  GtkPrefixIndex *index;
+  GPtrArray *rows;
+  guint i;
+
+  index = _gtk_prefix_index_new ();
+  rows = g_ptr_array_new ();
+
+  for (i = 0; i < 100; i++)
+    {
+      const gchar *word = (i % 13 == 0) ? NULL : words[i % (G_N_ELEMENTS (words) - 1)];
+
+      _gtk_prefix_index_append (index, word);
+      g_ptr_array_add (rows, (gpointer) word);
+    }
+
+  check_index (index, rows);
+
+  g_ptr_array_unref (rows);
+  _gtk_prefix_index_free (index);
+}
+
+static void
+test_random (void)
+{
+  GtkPrefixIndex *index;
+  GPtrArray *rows;
+  guint i, position;
+  const gchar *word;
+
+  index = _gtk_prefix_index_new ();
+  rows = g_ptr_array_new ();
+
+  for (i = 0; i < 2000; i++)
+    {
+      word = words[g_test_rand_int_range (0, G_N_ELEMENTS (words))];
+
+      switch (g_test_rand_int_range (0, 4))
+        {
+        case 0:
+        case 1:
+          position = g_test_rand_int_range (0, rows->len + 1);
+          _gtk_prefix_index_insert (index, position, word);
+          g_ptr_array_insert (rows, position, (gpointer) word);
+          break;
+
+        case 2:
+          if (rows->len == 0)
+            break;
+          position = g_test_rand_int_range (0, rows->len);
+          _gtk_prefix_index_remove (index, position);
+          g_ptr_array_remove_index (rows, position);
+          break;
+
+        case 3:
+          if (rows->len == 0)
+            break;
+          position = g_test_rand_int_range (0, rows->len);
+          _gtk_prefix_index_set (index, position, word);
+          rows->pdata[position] = (gpointer) word;
+          break;
+
+        default:
+          g_assert_not_reached ();
+        }
+
+      if (i % 100 == 0)
+        check_index (index, rows);
+    }
+
+  check_index (index, rows);
+
+  g_ptr_array_unref (rows);
+  _gtk_prefix_index_free (index);
+}
+
+static void
+test_reorder (void)
+{
+  GtkPrefixIndex *index;
+  GPtrArray *rows, *reordered;
+  gint *new_order;
+  guint i, n = 50;
+
+  index = _gtk_prefix_index_new ();
+  rows = g_ptr_array_new ();
+
+  for (i = 0; i < n; i++)
+    {
+      _gtk_prefix_index_insert (index, i, words[i % (G_N_ELEMENTS (words) - 1)]);
+      g_ptr_array_add (rows, (gpointer) words[i % (G_N_ELEMENTS (words) - 1)]);
+    }
+
+  /* Reverse */
+  new_order = g_new (gint, n);
+  reordered = g_ptr_array_new ();
+  for (i = 0; i < n; i++)
+    {
+      new_order[i] = n - 1 - i;
+      g_ptr_array_add (reordered, g_ptr_array_index (rows, n - 1 - i));
+    }
+
+  _gtk_prefix_index_reorder (index, new_order, n);
+  check_index (index, reordered);
+
+  g_free (new_order);
+  g_ptr_array_unref (reordered);
+  g_ptr_array_unref (rows);
+  _gtk_prefix_index_free (index);
+}
+
+static void
+test_performance (void)
+{
+  GtkPrefixIndex *index;
+  gchar *string;
+  guint *matches;
+  guint n_matches, i, n_rows;
+  gdouble elapsed;
+
+  n_rows = g_test_perf () ? 300000 : 3000;
+
+  index = _gtk_prefix_index_new ();
+
+  g_test_timer_start ();
+  for (i = 0; i < n_rows; i++)
+    {
+      string = g_strdup_printf ("%s %u", words[i % (G_N_ELEMENTS (words) - 1)], i);
+      _gtk_prefix_index_append (index, string);
+      g_free (string);
+    }
+  matches = _gtk_prefix_index_lookup (index, "b", &n_matches);
+  g_free (matches);
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "build %u rows: %g sec", n_rows, elapsed);
+
+  g_test_timer_start ();
+  for (i = 0; i < 1000; i++)
+    {
+      matches = _gtk_prefix_index_lookup (index, "zebra 1", &n_matches);
+      g_free (matches);
+    }
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "1000 lookups: %g sec", elapsed);
+
+  _gtk_prefix_index_free (index);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  setlocale (LC_ALL, "C");
+
+  g_test_add_func ("/prefixindex/append", test_append);
+  g_test_add_func ("/prefixindex/random", test_random);
+  g_test_add_func ("/prefixindex/reorder", test_reorder);
+  g_test_add_func ("/prefixindex/performance", test_performance);
+
+  return g_test_run ();
+}
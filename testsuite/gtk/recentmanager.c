@@ -17,11 +17,13 @@
  * License along with this library. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
 #include <glib/gstdio.h>
 #include <gtk/gtk.h>
 
 const gchar *uri = "file:///tmp/testrecentchooser.txt";
 const gchar *uri2 = "file:///tmp/testrecentchooser2.txt";
+const gchar *uri3 = "file:///tmp/testrecentchooser3.txt";
 
 static void
 recent_manager_get_default (void)
@@ -294,6 +296,150 @@ recent_manager_purge (void)
   g_assert (n == 1);
 }
 
+static void
+quit_on_changed (GtkRecentManager *manager,
+                 gpointer          data)
+{
+  g_main_loop_quit (data);
+}
+
+static gboolean
+quit_loop (gpointer data)
+{
+  g_main_loop_quit (data);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+count_changed (GtkRecentManager *manager,
+               gpointer          data)
+{
+  *(gint *) data += 1;
+}
+
+static GtkRecentManager *
+recent_manager_new_journaled (const gchar *filename)
+{
+  GtkRecentManager *manager;
+
+  g_setenv ("GTK_RECENT_FILES_JOURNAL", "1", TRUE);
+  manager = g_object_new (GTK_TYPE_RECENT_MANAGER, "filename", filename, NULL);
+  g_unsetenv ("GTK_RECENT_FILES_JOURNAL");
+
+  return manager;
+}
+
+static void
+recent_manager_journal (void)
+{
+  GtkRecentManager *manager, *manager2;
+  GtkRecentData *recent_data;
+  GMainLoop *loop;
+  gchar *dir, *filename, *journal, *contents;
+  gint n, n_changed;
+
+  dir = g_dir_make_tmp ("recentmanager-XXXXXX", NULL);
+  g_assert (dir != NULL);
+  filename = g_build_filename (dir, "recently-used.xbel", NULL);
+  journal = g_strconcat (filename, ".journal", NULL);
+
+  recent_data = g_slice_new0 (GtkRecentData);
+  recent_data->mime_type = "text/plain";
+  recent_data->app_name = "testrecentchooser";
+  recent_data->app_exec = "testrecentchooser %u";
+
+  manager = recent_manager_new_journaled (filename);
+
+  /* without a journal, the first change writes the file and starts one */
+  gtk_recent_manager_add_full (manager, uri, recent_data);
+  loop = g_main_loop_new (NULL, FALSE);
+  g_signal_connect (manager, "changed", G_CALLBACK (quit_on_changed), loop);
+  g_main_loop_run (loop);
+  g_signal_handlers_disconnect_by_func (manager, quit_on_changed, loop);
+  g_assert (g_file_test (filename, G_FILE_TEST_EXISTS));
+  g_assert (g_file_test (journal, G_FILE_TEST_EXISTS));
+
+  /* later changes only go to the journal */
+  gtk_recent_manager_add_full (manager, uri2, recent_data);
+  g_assert (g_file_get_contents (journal, &contents, NULL, NULL));
+  g_assert (strstr (contents, uri2) != NULL);
+  g_free (contents);
+  g_assert (g_file_get_contents (filename, &contents, NULL, NULL));
+  g_assert (strstr (contents, uri2) == NULL);
+  g_free (contents);
+
+  /* managers without the journal only see the file */
+  manager2 = g_object_new (GTK_TYPE_RECENT_MANAGER, "filename", filename, NULL);
+  g_assert (gtk_recent_manager_has_item (manager2, uri));
+  g_assert (!gtk_recent_manager_has_item (manager2, uri2));
+  g_object_unref (manager2);
+
+  /* the others apply the journal on top of it */
+  manager2 = recent_manager_new_journaled (filename);
+  g_assert (gtk_recent_manager_has_item (manager2, uri));
+  g_assert (gtk_recent_manager_has_item (manager2, uri2));
+
+  /* the file is written shortly after the changes, and the others
+   * do not load it again
+   */
+  n_changed = 0;
+  g_signal_connect (manager2, "changed", G_CALLBACK (count_changed), &n_changed);
+  g_timeout_add_seconds (3, quit_loop, loop);
+  g_main_loop_run (loop);
+  g_assert (g_file_get_contents (filename, &contents, NULL, NULL));
+  g_assert (strstr (contents, uri2) != NULL);
+  g_free (contents);
+  g_assert_cmpint (n_changed, ==, 0);
+  g_object_unref (manager2);
+
+  manager2 = g_object_new (GTK_TYPE_RECENT_MANAGER, "filename", filename, NULL);
+  g_assert (gtk_recent_manager_has_item (manager2, uri2));
+
+  /* journaled changes survive a manager without the journal writing
+   * the file, and are merged into it
+   */
+  gtk_recent_manager_add_full (manager, uri3, recent_data);
+  g_assert (gtk_recent_manager_remove_item (manager2, uri2, NULL));
+  g_signal_connect (manager2, "changed", G_CALLBACK (quit_on_changed), loop);
+  g_main_loop_run (loop);
+  g_signal_handlers_disconnect_by_func (manager2, quit_on_changed, loop);
+  g_object_unref (manager2);
+
+  g_object_unref (manager);
+  manager = recent_manager_new_journaled (filename);
+  g_assert (gtk_recent_manager_has_item (manager, uri));
+  g_assert (!gtk_recent_manager_has_item (manager, uri2));
+  g_assert (gtk_recent_manager_has_item (manager, uri3));
+  g_assert (g_file_get_contents (filename, &contents, NULL, NULL));
+  g_assert (strstr (contents, uri3) != NULL);
+  g_free (contents);
+
+  /* the others catch up before they change anything */
+  manager2 = recent_manager_new_journaled (filename);
+  g_assert (gtk_recent_manager_remove_item (manager, uri3, NULL));
+  n = gtk_recent_manager_purge_items (manager2, NULL);
+  g_assert_cmpint (n, ==, 1);
+
+  g_object_unref (manager2);
+  g_object_unref (manager);
+
+  manager = recent_manager_new_journaled (filename);
+  g_assert (!gtk_recent_manager_has_item (manager, uri));
+  g_assert (!gtk_recent_manager_has_item (manager, uri2));
+  g_assert (!gtk_recent_manager_has_item (manager, uri3));
+  g_object_unref (manager);
+
+  g_main_loop_unref (loop);
+  g_slice_free (GtkRecentData, recent_data);
+  g_unlink (journal);
+  g_unlink (filename);
+  g_rmdir (dir);
+  g_free (journal);
+  g_free (filename);
+  g_free (dir);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -308,6 +454,7 @@ main (int    argc,
   g_test_add_func ("/recent-manager/lookup-item", recent_manager_lookup_item);
   g_test_add_func ("/recent-manager/remove-item", recent_manager_remove_item);
   g_test_add_func ("/recent-manager/purge", recent_manager_purge);
+  g_test_add_func ("/recent-manager/journal", recent_manager_journal);
 
   return g_test_run ();
 }
@@ -1202,6 +1202,200 @@ specific_bug_698846 (void)
   g_assert_cmpuint (count, ==, 2);
 }
 
+static gint
+compare_first_column (GtkTreeModel *model,
+                      GtkTreeIter  *a,
+                      GtkTreeIter  *b,
+                      gpointer      user_data)
+{
+  gint value_a, value_b;
+
+  gtk_tree_model_get (model, a, 0, &value_a, -1);
+  gtk_tree_model_get (model, b, 0, &value_b, -1);
+
+  return value_a - value_b;
+}
+
+static void
+check_sorted_by_int (GtkTreeModel *sort_model,
+                     gboolean      check_stable)
+{
+  GtkTreeIter iter;
+  gint value, index;
+  gint last_value = G_MININT, last_index = -1;
+
+  if (!gtk_tree_model_get_iter_first (sort_model, &iter))
+    return;
+
+  do
+    {
+      gtk_tree_model_get (sort_model, &iter, 0, &value, 2, &index, -1);
+      g_assert_cmpint (value, >=, last_value);
+      if (check_stable && value == last_value)
+        g_assert_cmpint (index, >, last_index);
+      last_value = value;
+      last_index = index;
+    }
+  while (gtk_tree_model_iter_next (sort_model, &iter));
+}
+
+/* Sorts large list stores, both with the default comparison of a
+ * column, which uses precomputed keys and sorts in parallel above
+ * some size, and with a custom sort function.
+ */
+static void
+sort_performance (void)
+{
+  guint n = g_test_perf () ? 1000000 : 70000;
+  GtkListStore *store;
+  GtkTreeModel *sort_model;
+  GtkTreeIter iter, child_iter;
+  gchar *last_string, *string;
+  GRand *rand;
+  double elapsed;
+  guint i;
+
+  rand = g_rand_new_with_seed (42);
+  store = gtk_list_store_new (3, G_TYPE_INT, G_TYPE_STRING, G_TYPE_INT);
+  for (i = 0; i < n; i++)
+    {
+      gchar buffer[16];
+
+      g_snprintf (buffer, sizeof (buffer), "%08x", g_rand_int (rand));
+      gtk_list_store_insert_with_values (store, NULL, -1,
+                                         0, g_rand_int_range (rand, 0, 1000),
+                                         1, buffer,
+                                         2, i,
+                                         -1);
+    }
+  g_rand_free (rand);
+
+  sort_model = gtk_tree_model_sort_new_with_model (GTK_TREE_MODEL (store));
+  gtk_tree_sortable_set_sort_func (GTK_TREE_SORTABLE (sort_model), 3,
+                                   compare_first_column, NULL, NULL);
+
+  /* Build the level, so that we time sorting it */
+  g_assert (gtk_tree_model_get_iter_first (sort_model, &iter));
+
+  g_test_timer_start ();
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model), 0,
+                                        GTK_SORT_ASCENDING);
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "sorting %u rows by int column: %gsec", n, elapsed);
+  check_sorted_by_int (sort_model, TRUE);
+
+  g_test_timer_start ();
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model), 3,
+                                        GTK_SORT_ASCENDING);
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "sorting %u rows with a sort func: %gsec", n, elapsed);
+  check_sorted_by_int (sort_model, FALSE);
+
+  g_test_timer_start ();
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model), 1,
+                                        GTK_SORT_DESCENDING);
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "sorting %u rows by string column: %gsec", n, elapsed);
+
+  g_assert (gtk_tree_model_get_iter_first (sort_model, &iter));
+  gtk_tree_model_get (sort_model, &iter, 1, &last_string, -1);
+  while (gtk_tree_model_iter_next (sort_model, &iter))
+    {
+      gtk_tree_model_get (sort_model, &iter, 1, &string, -1);
+      g_assert_cmpint (g_utf8_collate (last_string, string), >=, 0);
+      g_free (last_string);
+      last_string = string;
+    }
+  g_free (last_string);
+
+  /* Changing a row only moves that row */
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model), 0,
+                                        GTK_SORT_ASCENDING);
+  g_test_timer_start ();
+  for (i = 0; i < 100; i++)
+    {
+      gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &child_iter, NULL, i * (n / 100));
+      gtk_list_store_set (store, &child_iter, 0, 999 - i, -1);
+    }
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "changing 100 of %u sorted rows: %gsec", n, elapsed);
+  check_sorted_by_int (sort_model, FALSE);
+
+  g_object_unref (sort_model);
+  g_object_unref (store);
+}
+
+static void
+count_row_inserted (GtkTreeModel *model,
+                    GtkTreePath  *path,
+                    GtkTreeIter  *iter,
+                    gpointer      data)
+{
+  (*(gint *) data)++;
+}
+
+static void
+bulk_insert_rows (GtkListStore *store,
+                  gint          position,
+                  gint          first,
+                  gint          n_rows)
+{
+  GValue *values;
+  gint columns[2] = { 0, 2 };
+  gint i;
+
+  /* Values go down, so that sorting reverses them */
+  values = g_new0 (GValue, 2 * n_rows);
+  for (i = 0; i < n_rows; i++)
+    {
+      g_value_init (&values[2 * i], G_TYPE_INT);
+      g_value_set_int (&values[2 * i], 1000 - first - i);
+      g_value_init (&values[2 * i + 1], G_TYPE_INT);
+      g_value_set_int (&values[2 * i + 1], first + i);
+    }
+
+  gtk_list_store_insert_rows_with_valuesv (store, position, n_rows,
+                                           columns, values, 2);
+
+  for (i = 0; i < 2 * n_rows; i++)
+    g_value_unset (&values[i]);
+  g_free (values);
+}
+
+static void
+bulk_insert (void)
+{
+  GtkListStore *store;
+  GtkTreeModel *sort_model;
+  gint n_inserted = 0;
+
+  store = gtk_list_store_new (3, G_TYPE_INT, G_TYPE_STRING, G_TYPE_INT);
+  sort_model = gtk_tree_model_sort_new_with_model (GTK_TREE_MODEL (store));
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model), 0,
+                                        GTK_SORT_ASCENDING);
+  g_signal_connect (sort_model, "row-inserted",
+                    G_CALLBACK (count_row_inserted), &n_inserted);
+
+  /* The root level gets built while inserting into an empty model */
+  bulk_insert_rows (store, 0, 0, 10);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (sort_model, NULL), ==, 10);
+  g_assert_cmpint (n_inserted, ==, 10);
+  check_sorted_by_int (sort_model, FALSE);
+
+  /* And then the rows go into the existing level */
+  bulk_insert_rows (store, 5, 10, 5);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (sort_model, NULL), ==, 15);
+  g_assert_cmpint (n_inserted, ==, 15);
+  check_sorted_by_int (sort_model, FALSE);
+
+  g_object_unref (sort_model);
+  g_object_unref (store);
+}
+
 /* main */
 
 void
@@ -1228,6 +1422,8 @@ register_sort_model_tests (void)
                    rows_reordered_single_level);
   g_test_add_func ("/TreeModelSort/rows-reordered/two-levels",
                    rows_reordered_two_levels);
+  g_test_add_func ("/TreeModelSort/bulk-insert",
+                   bulk_insert);
   g_test_add_func ("/TreeModelSort/sorted-insert",
                    sorted_insert);
 
@@ -1239,5 +1435,8 @@ register_sort_model_tests (void)
                    specific_bug_674587);
   g_test_add_func ("/TreeModelSort/specific/bug-698846",
                    specific_bug_698846);
+
+  g_test_add_func ("/TreeModelSort/performance",
+                   sort_performance);
 }
 
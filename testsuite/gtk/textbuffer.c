@@ -1345,6 +1345,63 @@ test_tag (void)
   g_object_unref (buffer);
 }
 
+static void
+test_tag_ranges (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextTag *bold, *italic;
+  GtkTextTagRange ranges[4];
+  GtkTextIter iter, end;
+
+  buffer = gtk_text_buffer_new (NULL);
+  bold = gtk_text_buffer_create_tag (buffer, NULL, "weight", PANGO_WEIGHT_BOLD, NULL);
+  italic = gtk_text_buffer_create_tag (buffer, NULL, "style", PANGO_STYLE_ITALIC, NULL);
+
+  gtk_text_buffer_set_text (buffer, "0123456789\n0123456789", -1);
+
+  /* Overlapping, adjacent, reversed and unsorted ranges */
+  ranges[0].tag = bold;
+  gtk_text_buffer_get_iter_at_offset (buffer, &ranges[0].start, 5);
+  gtk_text_buffer_get_iter_at_offset (buffer, &ranges[0].end, 8);
+  ranges[1].tag = bold;
+  gtk_text_buffer_get_iter_at_offset (buffer, &ranges[1].start, 4);
+  gtk_text_buffer_get_iter_at_offset (buffer, &ranges[1].end, 2);
+  ranges[2].tag = italic;
+  gtk_text_buffer_get_iter_at_offset (buffer, &ranges[2].start, 9);
+  gtk_text_buffer_get_iter_at_offset (buffer, &ranges[2].end, 15);
+  ranges[3].tag = bold;
+  gtk_text_buffer_get_iter_at_offset (buffer, &ranges[3].start, 3);
+  gtk_text_buffer_get_iter_at_offset (buffer, &ranges[3].end, 5);
+
+  gtk_text_buffer_apply_tag_ranges (buffer, ranges, G_N_ELEMENTS (ranges));
+
+  gtk_text_buffer_get_start_iter (buffer, &iter);
+  g_assert (gtk_text_iter_forward_to_tag_toggle (&iter, bold));
+  g_assert_cmpint (gtk_text_iter_get_offset (&iter), ==, 2);
+  g_assert (gtk_text_iter_forward_to_tag_toggle (&iter, bold));
+  g_assert_cmpint (gtk_text_iter_get_offset (&iter), ==, 8);
+  g_assert (!gtk_text_iter_forward_to_tag_toggle (&iter, bold));
+
+  gtk_text_buffer_get_iter_at_offset (buffer, &iter, 12);
+  g_assert (gtk_text_iter_has_tag (&iter, italic));
+
+  run_tests (buffer);
+
+  /* Removing in one go as well */
+  gtk_text_buffer_get_bounds (buffer, &ranges[0].start, &ranges[0].end);
+  ranges[1].tag = italic;
+  gtk_text_buffer_get_bounds (buffer, &ranges[1].start, &ranges[1].end);
+  gtk_text_buffer_remove_tag_ranges (buffer, ranges, 2);
+
+  gtk_text_buffer_get_start_iter (buffer, &iter);
+  gtk_text_buffer_get_end_iter (buffer, &end);
+  g_assert (!gtk_text_iter_forward_to_tag_toggle (&iter, bold));
+  gtk_text_buffer_get_start_iter (buffer, &iter);
+  g_assert (!gtk_text_iter_forward_to_tag_toggle (&iter, italic));
+
+  g_object_unref (buffer);
+}
+
 static void
 check_buffer_contents (GtkTextBuffer *buffer,
                        const gchar   *contents)
@@ -1556,6 +1613,87 @@ test_get_iter (void)
   g_object_unref (buffer);
 }
 
+static void
+check_load (GtkTextBuffer *buffer,
+            const gchar   *text)
+{
+  GtkTextBuffer *reference;
+  GInputStream *stream;
+  GtkTextIter iter, ref_iter;
+  GError *error = NULL;
+  gboolean retval;
+
+  reference = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (reference, text, -1);
+
+  stream = g_memory_input_stream_new_from_data (text, -1, NULL);
+  retval = gtk_text_buffer_load_from_stream (buffer, stream, NULL, &error);
+  g_assert_no_error (error);
+  g_assert (retval);
+  g_object_unref (stream);
+
+  check_buffer_contents (buffer, text);
+  g_assert_cmpint (gtk_text_buffer_get_line_count (buffer), ==,
+                   gtk_text_buffer_get_line_count (reference));
+  g_assert_cmpint (gtk_text_buffer_get_char_count (buffer), ==,
+                   gtk_text_buffer_get_char_count (reference));
+
+  /* Marks end up where set_text() puts them */
+  gtk_text_buffer_get_iter_at_mark (buffer, &iter,
+                                    gtk_text_buffer_get_insert (buffer));
+  gtk_text_buffer_get_iter_at_mark (reference, &ref_iter,
+                                    gtk_text_buffer_get_insert (reference));
+  g_assert_cmpint (gtk_text_iter_get_offset (&iter), ==,
+                   gtk_text_iter_get_offset (&ref_iter));
+
+  gtk_text_buffer_get_iter_at_mark (buffer, &iter,
+                                    gtk_text_buffer_get_mark (buffer, "start"));
+  g_assert (gtk_text_iter_is_start (&iter));
+
+  g_object_unref (reference);
+}
+
+static void
+test_load (void)
+{
+  GtkTextBuffer *buffer;
+  GInputStream *stream;
+  GError *error = NULL;
+  GString *str;
+  GtkTextIter iter;
+  int i;
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_get_start_iter (buffer, &iter);
+  gtk_text_buffer_create_mark (buffer, "start", &iter, TRUE);
+
+  check_load (buffer, "Hello");
+  check_load (buffer, "Hello\n");
+  check_load (buffer, "Hello\r\nBar\rFoo");
+  check_load (buffer, "\n\n\n");
+
+  /* Enough lines for a tree of several levels */
+  str = g_string_new (NULL);
+  for (i = 0; i < 5000; i++)
+    g_string_append_printf (str, "Line %d\n", i);
+  g_string_append (str, "No newline at the end");
+  check_load (buffer, str->str);
+  g_string_free (str, TRUE);
+
+  run_tests (buffer);
+
+  /* Invalid text leaves the buffer alone */
+  stream = g_memory_input_stream_new_from_data ("Foo\xff", -1, NULL);
+  g_assert (!gtk_text_buffer_load_from_stream (buffer, stream, NULL, &error));
+  g_assert_error (error, G_CONVERT_ERROR, G_CONVERT_ERROR_ILLEGAL_SEQUENCE);
+  g_clear_error (&error);
+  g_object_unref (stream);
+
+  g_assert_cmpint (gtk_text_buffer_get_line_count (buffer), ==, 5001);
+
+  g_object_unref (buffer);
+}
+
 int
 main (int argc, char** argv)
 {
@@ -1573,8 +1711,10 @@ main (int argc, char** argv)
   g_test_add_func ("/TextBuffer/Get and Set", test_get_set);
   g_test_add_func ("/TextBuffer/Fill and Empty", test_fill_empty);
   g_test_add_func ("/TextBuffer/Tag", test_tag);
+  g_test_add_func ("/TextBuffer/Tag ranges", test_tag_ranges);
   g_test_add_func ("/TextBuffer/Clipboard", test_clipboard);
   g_test_add_func ("/TextBuffer/Get iter", test_get_iter);
+  g_test_add_func ("/TextBuffer/Load", test_load);
 
   return g_test_run();
 }
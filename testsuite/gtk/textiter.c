@@ -279,6 +279,59 @@ test_search_caseless (void)
   check_found_backward ("aa \303\200", "aa", flags, 0, 2, "aa");
 }
 
+static gboolean
+collect_match (const GtkTextIter *match_start,
+               const GtkTextIter *match_end,
+               gpointer           user_data)
+{
+  GString *str = user_data;
+
+  g_string_append_printf (str, "%d-%d ",
+                          gtk_text_iter_get_offset (match_start),
+                          gtk_text_iter_get_offset (match_end));
+
+  return FALSE;
+}
+
+static void
+check_search_all (const gchar        *haystack,
+                  const gchar        *needle,
+                  GtkTextSearchFlags  flags,
+                  gint                expected_n_matches,
+                  const gchar        *expected_matches)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter start;
+  GString *matches;
+  gint n_matches;
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, haystack, -1);
+  gtk_text_buffer_get_start_iter (buffer, &start);
+
+  matches = g_string_new (NULL);
+  n_matches = gtk_text_iter_forward_search_all (&start, needle, flags, NULL,
+                                                collect_match, matches);
+
+  g_assert_cmpint (n_matches, ==, expected_n_matches);
+  g_assert_cmpstr (matches->str, ==, expected_matches);
+
+  g_string_free (matches, TRUE);
+  g_object_unref (buffer);
+}
+
+static void
+test_search_all (void)
+{
+  check_search_all ("foo bar foo\nfoofoo", "foo", 0, 4, "0-3 8-11 12-15 15-18 ");
+  check_search_all ("foo bar foo\nfoofoo", "Foo", 0, 0, "");
+  check_search_all ("foo bar Foo\nfOOfoo", "Foo", GTK_TEXT_SEARCH_CASE_INSENSITIVE, 4, "0-3 8-11 12-15 15-18 ");
+  check_search_all ("aaaa", "aa", 0, 2, "0-2 2-4 ");
+  check_search_all ("foo\nfoo\nfoo", "foo\n", 0, 2, "0-4 4-8 ");
+  check_search_all ("foo\nfoo\nfoo", "o\nf", 0, 2, "2-5 6-9 ");
+  check_search_all ("\303\200 \303\240", "\303\240", GTK_TEXT_SEARCH_CASE_INSENSITIVE, 2, "0-1 2-3 ");
+}
+
 static void
 test_forward_to_tag_toggle (void)
 {
@@ -752,6 +805,7 @@ main (int argc, char** argv)
   g_test_add_func ("/TextIter/Search Full Buffer", test_search_full_buffer);
   g_test_add_func ("/TextIter/Search", test_search);
   g_test_add_func ("/TextIter/Search Caseless", test_search_caseless);
+  g_test_add_func ("/TextIter/Search All", test_search_all);
   g_test_add_func ("/TextIter/Forward To Tag Toggle", test_forward_to_tag_toggle);
   g_test_add_func ("/TextIter/Forward To Line End", test_forward_to_line_end);
   g_test_add_func ("/TextIter/Word Boundaries", test_word_boundaries);
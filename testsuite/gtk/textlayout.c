@@ -0,0 +1,211 @@
+/* GtkTextLayout tests.
+ *
+ * Copyright (C) 2017 The GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#define GTK_TEXT_USE_INTERNAL_UNSUPPORTED_API
+#include <gtk/gtk.h>
+#include "gtk/gtktextlayout.h"
+
+/* Enough lines for asynchronous validation to kick in */
+#define N_LINES 20000
+
+static GtkTextBuffer *
+create_buffer (gint n_lines)
+{
+  GtkTextBuffer *buffer;
+  GString *text;
+  gint i;
+
+  text = g_string_new (NULL);
+  for (i = 0; i < n_lines; i++)
+    {
+      /* some lines are empty, some wrap */
+      if (i % 13 != 0)
+        g_string_append_printf (text, "Line %d", i);
+      if (i % 7 == 0)
+        g_string_append (text, " has enough words in it to wrap at least once,"
+                               " and more than that if the font is narrow");
+      g_string_append_c (text, '\n');
+    }
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, text->str, text->len);
+  g_string_free (text, TRUE);
+
+  return buffer;
+}
+
+static GtkTextLayout *
+create_layout (GtkTextBuffer *buffer,
+               gboolean       async_validation)
+{
+  GtkTextLayout *layout;
+  GtkTextAttributes *style;
+  PangoFontDescription *font;
+  PangoContext *ltr_context, *rtl_context;
+
+  layout = gtk_text_layout_new ();
+  gtk_text_layout_set_async_validation (layout, async_validation);
+  gtk_text_layout_set_buffer (layout, buffer);
+  gtk_text_layout_set_cursor_visible (layout, FALSE);
+
+  font = pango_font_description_from_string ("Sans 10");
+
+  ltr_context = pango_font_map_create_context (pango_cairo_font_map_get_default ());
+  pango_context_set_font_description (ltr_context, font);
+  pango_context_set_base_dir (ltr_context, PANGO_DIRECTION_LTR);
+  rtl_context = pango_font_map_create_context (pango_cairo_font_map_get_default ());
+  pango_context_set_font_description (rtl_context, font);
+  pango_context_set_base_dir (rtl_context, PANGO_DIRECTION_RTL);
+  gtk_text_layout_set_contexts (layout, ltr_context, rtl_context);
+  g_object_unref (ltr_context);
+  g_object_unref (rtl_context);
+
+  style = gtk_text_attributes_new ();
+  style->font = font;
+  style->wrap_mode = GTK_WRAP_WORD;
+  gtk_text_layout_set_default_style (layout, style);
+  gtk_text_attributes_unref (style);
+
+  gtk_text_layout_set_screen_width (layout, 300);
+
+  return layout;
+}
+
+static gint
+get_line_y (GtkTextLayout *layout,
+            GtkTextBuffer *buffer,
+            gint           line)
+{
+  GtkTextIter iter;
+  gint y;
+
+  gtk_text_buffer_get_iter_at_line (buffer, &iter, line);
+  gtk_text_layout_get_line_yrange (layout, &iter, &y, NULL);
+
+  return y;
+}
+
+/* Validates like GtkTextView does, in steps, waiting for the
+ * worker threads in between.  Returns whether they were used.
+ */
+static gboolean
+validate_async (GtkTextLayout *layout)
+{
+  gboolean used_threads = FALSE;
+
+  while (!gtk_text_layout_is_valid (layout))
+    {
+      gtk_text_layout_validate (layout, 2000);
+
+      while (gtk_text_layout_is_validating_async (layout))
+        {
+          used_threads = TRUE;
+          g_main_context_iteration (NULL, TRUE);
+        }
+    }
+
+  return used_threads;
+}
+
+static void
+test_async_validation (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextLayout *sync_layout, *async_layout;
+  GtkTextIter iter;
+  GdkRectangle sync_rect, async_rect;
+  gint sync_width, sync_height, async_width, async_height;
+  gint sync_y, sync_line_height, async_y, async_line_height;
+  gint i;
+
+  buffer = create_buffer (N_LINES);
+  sync_layout = create_layout (buffer, FALSE);
+  async_layout = create_layout (buffer, TRUE);
+
+  gtk_text_layout_validate (sync_layout, G_MAXINT);
+  g_assert (gtk_text_layout_is_valid (sync_layout));
+  g_assert (validate_async (async_layout));
+
+  gtk_text_layout_get_size (sync_layout, &sync_width, &sync_height);
+  gtk_text_layout_get_size (async_layout, &async_width, &async_height);
+  g_assert_cmpint (async_width, ==, sync_width);
+  g_assert_cmpint (async_height, ==, sync_height);
+
+  for (i = 0; i < N_LINES; i++)
+    {
+      gtk_text_buffer_get_iter_at_line (buffer, &iter, i);
+      gtk_text_layout_get_line_yrange (sync_layout, &iter, &sync_y, &sync_line_height);
+      gtk_text_layout_get_line_yrange (async_layout, &iter, &async_y, &async_line_height);
+      g_assert_cmpint (async_y, ==, sync_y);
+      g_assert_cmpint (async_line_height, ==, sync_line_height);
+    }
+
+  /* This wraps the lines again, exactly */
+  for (i = 0; i < N_LINES; i += 97)
+    {
+      gtk_text_buffer_get_iter_at_line (buffer, &iter, i);
+      if (!gtk_text_iter_ends_line (&iter))
+        gtk_text_iter_forward_to_line_end (&iter);
+      gtk_text_layout_get_iter_location (sync_layout, &iter, &sync_rect);
+      gtk_text_layout_get_iter_location (async_layout, &iter, &async_rect);
+      g_assert_cmpint (async_rect.x, ==, sync_rect.x);
+      g_assert_cmpint (async_rect.y, ==, sync_rect.y);
+      g_assert_cmpint (async_rect.width, ==, sync_rect.width);
+      g_assert_cmpint (async_rect.height, ==, sync_rect.height);
+    }
+
+  g_object_unref (async_layout);
+  g_object_unref (sync_layout);
+  g_object_unref (buffer);
+}
+
+static void
+test_async_validation_estimates (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextLayout *layout;
+
+  /* small buffers are not estimated */
+  buffer = create_buffer (100);
+  layout = create_layout (buffer, TRUE);
+  g_assert_cmpint (get_line_y (layout, buffer, 99), ==, 0);
+  validate_async (layout);
+  g_assert_cmpint (get_line_y (layout, buffer, 99), >, 0);
+  g_object_unref (layout);
+  g_object_unref (buffer);
+
+  /* large ones are, before they are validated */
+  buffer = create_buffer (N_LINES);
+  layout = create_layout (buffer, TRUE);
+  g_assert_cmpint (get_line_y (layout, buffer, N_LINES - 1), >, 0);
+  g_object_unref (layout);
+  g_object_unref (buffer);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/TextLayout/async-validation", test_async_validation);
+  g_test_add_func ("/TextLayout/async-validation-estimates", test_async_validation_estimates);
+
+  return g_test_run ();
+}
@@ -227,6 +227,101 @@ test_row_separator_height (void)
   gtk_widget_destroy (tree_view);
 }
 
+/* Waits until the visible rows are drawn and idle validation is done */
+static void
+wait_for_validation (GtkWidget *window)
+{
+  gtk_test_widget_wait_for_draw (window);
+
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, FALSE);
+}
+
+static void
+get_row_area (GtkTreeView *tree_view,
+              gint         row,
+              gint        *y,
+              gint        *height)
+{
+  GtkTreePath *path;
+  GdkRectangle rect;
+
+  path = gtk_tree_path_new_from_indices (row, -1);
+  gtk_tree_view_get_background_area (tree_view, path, NULL, &rect);
+  gtk_tree_path_free (path);
+
+  gtk_tree_view_convert_bin_window_to_tree_coords (tree_view, rect.x, rect.y, NULL, y);
+  *height = rect.height;
+}
+
+static void
+test_uniform_height_estimate (void)
+{
+  GtkListStore *store;
+  GtkWidget *window, *sw, *tree_view;
+  GtkTreePath *path;
+  GtkTreeIter iter;
+  gint height, tall_height, y, h;
+  gint i;
+
+  /* far enough apart that the first validation batch only sees
+   * rows of the same height
+   */
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (i = 0; i < 20000; i++)
+    {
+      gchar *text;
+
+      if (i == 10000 || i == 15000)
+        text = g_strdup ("Two\nlines");
+      else
+        text = g_strdup_printf ("Row %d", i);
+      gtk_list_store_insert_with_values (store, &iter, i, 0, text, -1);
+      g_free (text);
+    }
+
+  window = gtk_offscreen_window_new ();
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_widget_set_size_request (sw, 200, 200);
+  tree_view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (tree_view),
+                                               0,
+                                               "Test",
+                                               gtk_cell_renderer_text_new (),
+                                               "text", 0,
+                                               NULL);
+  gtk_container_add (GTK_CONTAINER (sw), tree_view);
+  gtk_container_add (GTK_CONTAINER (window), sw);
+  gtk_widget_show_all (window);
+
+  wait_for_validation (window);
+
+  /* offscreen rows were not measured, they got the sampled height */
+  get_row_area (GTK_TREE_VIEW (tree_view), 0, &y, &height);
+  g_assert_cmpint (height, >, 0);
+  get_row_area (GTK_TREE_VIEW (tree_view), 10000, &y, &h);
+  g_assert_cmpint (h, ==, height);
+  get_row_area (GTK_TREE_VIEW (tree_view), 19999, &y, &h);
+  g_assert_cmpint (y, ==, 19999 * height);
+
+  /* a visible row that differs makes all rows get measured */
+  path = gtk_tree_path_new_from_indices (10000, -1);
+  gtk_tree_view_scroll_to_cell (GTK_TREE_VIEW (tree_view), path, NULL, TRUE, 0.5, 0.0);
+  gtk_tree_path_free (path);
+
+  wait_for_validation (window);
+
+  get_row_area (GTK_TREE_VIEW (tree_view), 10000, &y, &tall_height);
+  g_assert_cmpint (tall_height, >, height);
+  get_row_area (GTK_TREE_VIEW (tree_view), 15000, &y, &h);
+  g_assert_cmpint (h, ==, tall_height);
+  get_row_area (GTK_TREE_VIEW (tree_view), 19999, &y, &h);
+  g_assert_cmpint (y, ==, 19997 * height + 2 * tall_height);
+
+  gtk_widget_destroy (window);
+  g_object_unref (store);
+}
+
 static void
 test_selection_count (void)
 {
@@ -334,6 +429,74 @@ test_selection_empty (void)
   gtk_widget_destroy (view);
 }
 
+static void
+check_search_matches (GtkTreeView *view,
+                      const gchar *key,
+                      const gint  *expected,
+                      gint         n_expected)
+{
+  GList *matches, *l;
+  gint i;
+
+  matches = gtk_tree_view_get_search_matches (view, key);
+
+  for (l = matches, i = 0; l; l = l->next, i++)
+    {
+      g_assert_cmpint (i, <, n_expected);
+      g_assert_cmpint (gtk_tree_path_get_indices (l->data)[0], ==, expected[i]);
+    }
+  g_assert_cmpint (i, ==, n_expected);
+
+  g_list_free_full (matches, (GDestroyNotify) gtk_tree_path_free);
+}
+
+static void
+test_search_matches (void)
+{
+  const gchar *names[] = { "Banana", "apple", "band", "Cherry", "APRICOT", NULL };
+  GtkListStore *list_store;
+  GtkWidget *view;
+  GtkTreeIter iter;
+  gint i, indexed;
+  gint ap[] = { 1, 4 };
+  gint ban[] = { 0, 2 };
+  gint ap_changed[] = { 2, 3, 5 };
+  gint ap_removed[] = { 2, 4 };
+  gint ap_sorted[] = { 0, 1 };
+
+  list_store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (i = 0; names[i]; i++)
+    gtk_list_store_insert_with_values (list_store, NULL, i, 0, names[i], -1);
+
+  view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (list_store));
+  gtk_tree_view_set_search_column (GTK_TREE_VIEW (view), 0);
+
+  /* Without and with the index, the results must be the same */
+  for (indexed = 0; indexed < 2; indexed++)
+    {
+      gtk_tree_view_set_enable_search_index (GTK_TREE_VIEW (view), indexed);
+
+      check_search_matches (GTK_TREE_VIEW (view), "ap", ap, G_N_ELEMENTS (ap));
+      check_search_matches (GTK_TREE_VIEW (view), "BAN", ban, G_N_ELEMENTS (ban));
+      check_search_matches (GTK_TREE_VIEW (view), "x", NULL, 0);
+    }
+
+  /* The index follows changes to the model */
+  gtk_list_store_insert_with_values (list_store, NULL, 0, 0, "Durian", -1);
+  gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (list_store), &iter, NULL, 3);
+  gtk_list_store_set (list_store, &iter, 0, "apex", -1);
+  check_search_matches (GTK_TREE_VIEW (view), "ap", ap_changed, G_N_ELEMENTS (ap_changed));
+
+  gtk_list_store_remove (list_store, &iter);
+  check_search_matches (GTK_TREE_VIEW (view), "ap", ap_removed, G_N_ELEMENTS (ap_removed));
+
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (list_store), 0, GTK_SORT_ASCENDING);
+  check_search_matches (GTK_TREE_VIEW (view), "ap", ap_sorted, G_N_ELEMENTS (ap_sorted));
+
+  gtk_widget_destroy (view);
+  g_object_unref (list_store);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -347,8 +510,11 @@ main (int    argc,
                    test_select_collapsed_row);
   g_test_add_func ("/TreeView/sizing/row-separator-height",
                    test_row_separator_height);
+  g_test_add_func ("/TreeView/sizing/uniform-height-estimate",
+                   test_uniform_height_estimate);
   g_test_add_func ("/TreeView/selection/count", test_selection_count);
   g_test_add_func ("/TreeView/selection/empty", test_selection_empty);
+  g_test_add_func ("/TreeView/search/matches", test_search_matches);
 
   return g_test_run ();
 }